@@ -0,0 +1,65 @@
+/*
+ * Copyright 2012 ZXing authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import "ZXBarcodeFormat.h"
+
+@class ZXEncodeHints;
+
+/**
+ * Encodes many payloads with one template -- format, raster size and hints such as the error
+ * correction level and margin -- into packed 1 bit per pixel rasters, spreading the symbols over
+ * a pool of workers.
+ *
+ * Each raster is width x height pixels. Rows are bytesPerRow bytes with the leftmost pixel in the
+ * most significant bit and 1 meaning black, and rasters follow one another bytesPerRaster apart.
+ * Symbols are placed exactly as the format's ZXWriter would place them at that size. QR Codes are
+ * scaled straight from the module matrix into the raster; other formats are packed from their
+ * writer's ZXBitMatrix.
+ *
+ * Each worker keeps its own writer and scratch row across calls, so a long job can be streamed
+ * through encodeContents:buffer: a chunk at a time. A batch writer must not be used from two
+ * threads at once.
+ */
+
+@interface ZXBatchWriter : NSObject
+
+@property (nonatomic, assign, readonly) ZXBarcodeFormat format;
+@property (nonatomic, assign, readonly) int width;
+@property (nonatomic, assign, readonly) int height;
+@property (nonatomic, retain, readonly) ZXEncodeHints *hints;
+@property (nonatomic, assign, readonly) int bytesPerRow;
+@property (nonatomic, assign, readonly) size_t bytesPerRaster;
+
+/**
+ * The most symbols encoded at once. Defaults to the number of active processors.
+ */
+@property (nonatomic, assign) int maxConcurrentEncodes;
+
+- (id)initWithFormat:(ZXBarcodeFormat)format width:(int)width height:(int)height hints:(ZXEncodeHints *)hints;
+
+/**
+ * Writes one raster per string in contents to buffer, which must hold
+ * contents.count * bytesPerRaster bytes. Returns the indexes of contents that could not be
+ * encoded, or whose symbol does not fit in width x height; their rasters are left white.
+ */
+- (NSIndexSet *)encodeContents:(NSArray *)contents buffer:(unsigned char *)buffer;
+
+/**
+ * As encodeContents:buffer:, into a newly allocated buffer.
+ */
+- (NSData *)encodeContents:(NSArray *)contents failedIndexes:(NSIndexSet **)failedIndexes;
+
+@end
@@ -0,0 +1,255 @@
+/*
+ * Copyright 2012 ZXing authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import "ZXBatchWriter.h"
+#import "ZXBitMatrix.h"
+#import "ZXByteMatrix.h"
+#import "ZXEncodeHints.h"
+#import "ZXEncoder.h"
+#import "ZXErrorCorrectionLevel.h"
+#import "ZXMultiFormatWriter.h"
+#import "ZXQRCode.h"
+#import "ZXQRCodeWriter.h"
+
+// Workers drain their autorelease pool after this many symbols.
+int const BATCH_WRITER_SYMBOLS_PER_POOL = 32;
+
+static unsigned char ZXBatchWriterReversedBytes[256];
+
+/**
+ * Sets count bits starting at bit start of a row packed most significant bit first.
+ */
+static void ZXBatchWriterSetBits(unsigned char *row, int start, int count) {
+  int end = start + count;
+  for (; start < end && (start & 7) != 0; start++) {
+    row[start >> 3] |= 0x80 >> (start & 7);
+  }
+  int wholeBytes = (end - start) >> 3;
+  memset(row + (start >> 3), 0xFF, wholeBytes);
+  for (start += wholeBytes << 3; start < end; start++) {
+    row[start >> 3] |= 0x80 >> (start & 7);
+  }
+}
+
+@interface ZXBatchWriter ()
+
+@property (nonatomic, assign) ZXBarcodeFormat format;
+@property (nonatomic, assign) int width;
+@property (nonatomic, assign) int height;
+@property (nonatomic, retain) ZXEncodeHints *hints;
+@property (nonatomic, assign) int bytesPerRow;
+@property (nonatomic, assign) size_t bytesPerRaster;
+@property (nonatomic, retain) ZXErrorCorrectionLevel *errorCorrectionLevel;
+@property (nonatomic, assign) int quietZone;
+@property (nonatomic, retain) NSMutableArray *writers;
+
+- (void)prepareWorkers:(int)workers;
+- (BOOL)renderQRCode:(NSString *)contents raster:(unsigned char *)raster scratchRow:(unsigned char *)row;
+- (BOOL)render:(NSString *)contents writer:(id<ZXWriter>)writer raster:(unsigned char *)raster;
+
+@end
+
+@implementation ZXBatchWriter {
+  unsigned char *scratchRows;
+}
+
+@synthesize format;
+@synthesize width;
+@synthesize height;
+@synthesize hints;
+@synthesize bytesPerRow;
+@synthesize bytesPerRaster;
+@synthesize errorCorrectionLevel;
+@synthesize quietZone;
+@synthesize writers;
+@synthesize maxConcurrentEncodes;
+
++ (void)initialize {
+  for (int i = 0; i < 256; i++) {
+    int reversed = 0;
+    for (int bit = 0; bit < 8; bit++) {
+      if (i & (1 << bit)) {
+        reversed |= 0x80 >> bit;
+      }
+    }
+    ZXBatchWriterReversedBytes[i] = (unsigned char)reversed;
+  }
+}
+
+- (id)initWithFormat:(ZXBarcodeFormat)aFormat width:(int)aWidth height:(int)aHeight hints:(ZXEncodeHints *)someHints {
+  if (aWidth <= 0 || aHeight <= 0) {
+    [NSException raise:NSInvalidArgumentException format:@"Requested dimensions are too small: %dx%d", aWidth, aHeight];
+  }
+
+  if (self = [super init]) {
+    self.format = aFormat;
+    self.width = aWidth;
+    self.height = aHeight;
+    self.hints = someHints;
+    self.bytesPerRow = (aWidth + 7) >> 3;
+    self.bytesPerRaster = (size_t)self.bytesPerRow * aHeight;
+    self.errorCorrectionLevel = someHints.errorCorrectionLevel ? someHints.errorCorrectionLevel : [ZXErrorCorrectionLevel errorCorrectionLevelL];
+    self.quietZone = someHints.margin ? [someHints.margin intValue] : QUIET_ZONE_SIZE;
+    // Fail now, rather than on a worker, for formats that have no writer.
+    self.writers = [NSMutableArray arrayWithObject:[ZXMultiFormatWriter writerForFormat:aFormat]];
+    self.maxConcurrentEncodes = (int)[[NSProcessInfo processInfo] activeProcessorCount];
+  }
+
+  return self;
+}
+
+- (void)dealloc {
+  free(scratchRows);
+  [hints release];
+  [errorCorrectionLevel release];
+  [writers release];
+
+  [super dealloc];
+}
+
+- (void)prepareWorkers:(int)workers {
+  while (self.writers.count < workers) {
+    [self.writers addObject:[ZXMultiFormatWriter writerForFormat:self.format]];
+  }
+  scratchRows = (unsigned char *)realloc(scratchRows, self.writers.count * self.bytesPerRow);
+}
+
+- (NSIndexSet *)encodeContents:(NSArray *)contents buffer:(unsigned char *)buffer {
+  int count = (int)contents.count;
+  memset(buffer, 0, count * self.bytesPerRaster);
+  if (count == 0) {
+    return [NSIndexSet indexSet];
+  }
+
+  int workers = MAX(1, MIN(self.maxConcurrentEncodes, count));
+  [self prepareWorkers:workers];
+  BOOL isQRCode = self.format == kBarcodeFormatQRCode;
+  size_t rasterSize = self.bytesPerRaster;
+  BOOL *failed = (BOOL *)calloc(count, sizeof(BOOL));
+
+  dispatch_apply(workers, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t worker) {
+    id<ZXWriter> writer = [self.writers objectAtIndex:worker];
+    unsigned char *row = scratchRows + worker * self.bytesPerRow;
+    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+    int encodedSinceDrain = 0;
+    for (int i = (int)worker; i < count; i += workers) {
+      unsigned char *raster = buffer + i * rasterSize;
+      NSString *symbolContents = [contents objectAtIndex:i];
+      BOOL encoded;
+      @try {
+        encoded = isQRCode ? [self renderQRCode:symbolContents raster:raster scratchRow:row]
+                           : [self render:symbolContents writer:writer raster:raster];
+      } @catch (NSException *exception) {
+        encoded = NO;
+      }
+      if (!encoded) {
+        failed[i] = YES;
+        memset(raster, 0, rasterSize);
+      }
+      if (++encodedSinceDrain == BATCH_WRITER_SYMBOLS_PER_POOL) {
+        [pool drain];
+        pool = [[NSAutoreleasePool alloc] init];
+        encodedSinceDrain = 0;
+      }
+    }
+    [pool drain];
+  });
+
+  NSMutableIndexSet *failedIndexes = [NSMutableIndexSet indexSet];
+  for (int i = 0; i < count; i++) {
+    if (failed[i]) {
+      [failedIndexes addIndex:i];
+    }
+  }
+  free(failed);
+  return failedIndexes;
+}
+
+- (NSData *)encodeContents:(NSArray *)contents failedIndexes:(NSIndexSet **)failedIndexes {
+  size_t length = contents.count * self.bytesPerRaster;
+  unsigned char *buffer = (unsigned char *)malloc(MAX(length, 1));
+  NSIndexSet *failed = [self encodeContents:contents buffer:buffer];
+  if (failedIndexes) *failedIndexes = failed;
+  return [NSData dataWithBytesNoCopy:buffer length:length freeWhenDone:YES];
+}
+
+/**
+ * Lays the QR Code out as ZXQRCodeWriter does at this size, scaling each module row once into
+ * the scratch row and copying it down for every pixel row it covers.
+ */
+- (BOOL)renderQRCode:(NSString *)contents raster:(unsigned char *)raster scratchRow:(unsigned char *)row {
+  if (contents.length == 0) {
+    return NO;
+  }
+  ZXQRCode *code = [ZXEncoder encode:contents ecLevel:self.errorCorrectionLevel hints:self.hints error:nil];
+  ZXByteMatrix *input = code.matrix;
+  if (input == nil) {
+    return NO;
+  }
+  int inputWidth = input.width;
+  int inputHeight = input.height;
+  int qrWidth = inputWidth + (self.quietZone << 1);
+  int qrHeight = inputHeight + (self.quietZone << 1);
+  if (qrWidth > self.width || qrHeight > self.height) {
+    return NO;
+  }
+  int multiple = MIN(self.width / qrWidth, self.height / qrHeight);
+  int leftPadding = (self.width - (inputWidth * multiple)) / 2;
+  int topPadding = (self.height - (inputHeight * multiple)) / 2;
+
+  int rowBytes = self.bytesPerRow;
+  unsigned char **array = input.array;
+  for (int inputY = 0, outputY = topPadding; inputY < inputHeight; inputY++, outputY += multiple) {
+    memset(row, 0, rowBytes);
+    unsigned char *inputRow = array[inputY];
+    for (int inputX = 0; inputX < inputWidth; inputX++) {
+      if (inputRow[inputX] == 1) {
+        int runEnd = inputX + 1;
+        while (runEnd < inputWidth && inputRow[runEnd] == 1) {
+          runEnd++;
+        }
+        ZXBatchWriterSetBits(row, leftPadding + inputX * multiple, (runEnd - inputX) * multiple);
+        inputX = runEnd;
+      }
+    }
+    for (int y = 0; y < multiple; y++) {
+      memcpy(raster + (outputY + y) * rowBytes, row, rowBytes);
+    }
+  }
+  return YES;
+}
+
+/**
+ * Encodes with the format's writer and packs its matrix, which must come out at exactly the
+ * requested size.
+ */
+- (BOOL)render:(NSString *)contents writer:(id<ZXWriter>)writer raster:(unsigned char *)raster {
+  ZXBitMatrix *matrix = [writer encode:contents format:self.format width:self.width height:self.height hints:self.hints error:nil];
+  if (matrix == nil || matrix.width != self.width || matrix.height != self.height) {
+    return NO;
+  }
+  int rowBytes = self.bytesPerRow;
+  for (int y = 0; y < self.height; y++) {
+    const unsigned int *bits = (const unsigned int *)matrix.bits + y * matrix.rowSize;
+    unsigned char *outputRow = raster + y * rowBytes;
+    for (int i = 0; i < rowBytes; i++) {
+      outputRow[i] = ZXBatchWriterReversedBytes[(bits[i >> 2] >> ((i & 3) << 3)) & 0xFF];
+    }
+  }
+  return YES;
+}
+
+@end
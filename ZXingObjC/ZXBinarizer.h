@@ -24,6 +24,8 @@
 #import "ZXBitMatrix.h"
 #import "ZXLuminanceSource.h"
 
+@class ZXFrameBufferPool;
+
 /**
  * This class hierarchy provides a set of methods to convert luminance data to 1 bit data.
  * It allows the algorithm to vary polymorphically, for example allowing a very expensive
@@ -36,12 +38,23 @@
 @property (nonatomic, retain, readonly) ZXLuminanceSource *luminanceSource;
 @property (nonatomic, assign, readonly) int width;
 @property (nonatomic, assign, readonly) int height;
+@property (nonatomic, retain) ZXFrameBufferPool *bufferPool;
 
 - (id)initWithSource:(ZXLuminanceSource *)source;
 + (id)binarizerWithSource:(ZXLuminanceSource *)source;
 - (ZXBitMatrix *)blackMatrixWithError:(NSError **)error;
 - (ZXBitArray *)blackRow:(int)y row:(ZXBitArray *)row error:(NSError **)error;
 - (ZXBinarizer *)createBinarizer:(ZXLuminanceSource *)source;
+
+/**
+ * For subclasses: buffers taken from bufferPool when there is one, or newly allocated otherwise.
+ * Pooled buffers are recycled when the binarizer is deallocated, so a black matrix or row made by
+ * a pooled binarizer must not be used once the binarizer is gone.
+ */
+- (NSMutableData *)dataWithLength:(int)length;
+- (ZXBitMatrix *)bitMatrixWithWidth:(int)width height:(int)height;
+- (ZXBitArray *)bitArrayWithSize:(int)size;
+
 - (CGImageRef)createImage;
 
 @end
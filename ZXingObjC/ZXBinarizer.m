@@ -15,6 +15,7 @@
  */
 
 #import "ZXBinarizer.h"
+#import "ZXFrameBufferPool.h"
 
 #if TARGET_OS_EMBEDDED || TARGET_IPHONE_SIMULATOR
 #import <UIKit/UIKit.h>
@@ -25,15 +26,21 @@
 #define ZXWhite CGColorGetConstantColor(kCGColorWhite)
 #endif
 
-@interface ZXBinarizer ()
+@interface ZXBinarizer () {
+  // Buffers checked out of bufferPool, recycled on dealloc
+  NSMutableArray *pooledBuffers;
+}
 
 @property (nonatomic, retain) ZXLuminanceSource *luminanceSource;
 
+- (id)pooledBuffer:(id)buffer;
+
 @end
 
 @implementation ZXBinarizer
 
 @synthesize luminanceSource;
+@synthesize bufferPool;
 
 - (id)initWithSource:(ZXLuminanceSource *)source {
   if (self = [super init]) {
@@ -48,7 +55,12 @@
 }
 
 - (void)dealloc {
+  for (id buffer in pooledBuffers) {
+    [bufferPool recycle:buffer];
+  }
+  [pooledBuffers release];
   [luminanceSource release];
+  [bufferPool release];
 
   [super dealloc];
 }
@@ -93,6 +105,41 @@
                                userInfo:nil];
 }
 
+- (NSMutableData *)dataWithLength:(int)length {
+  if (self.bufferPool == nil) {
+    return [NSMutableData dataWithLength:length];
+  }
+  return [self pooledBuffer:[self.bufferPool dataWithLength:length]];
+}
+
+- (ZXBitMatrix *)bitMatrixWithWidth:(int)width height:(int)height {
+  if (self.bufferPool == nil) {
+    return [[[ZXBitMatrix alloc] initWithWidth:width height:height] autorelease];
+  }
+  return [self pooledBuffer:[self.bufferPool bitMatrixWithWidth:width height:height]];
+}
+
+- (ZXBitArray *)bitArrayWithSize:(int)size {
+  if (self.bufferPool == nil) {
+    return [[[ZXBitArray alloc] initWithSize:size] autorelease];
+  }
+  return [self pooledBuffer:[self.bufferPool bitArrayWithSize:size]];
+}
+
+/**
+ * Remembers a buffer checked out of bufferPool so that dealloc can recycle it. Readers running
+ * concurrently on one bitmap may ask for rows at the same time.
+ */
+- (id)pooledBuffer:(id)buffer {
+  @synchronized(self) {
+    if (pooledBuffers == nil) {
+      pooledBuffers = [[NSMutableArray alloc] init];
+    }
+    [pooledBuffers addObject:buffer];
+  }
+  return buffer;
+}
+
 - (CGImageRef)createImage {
   ZXBitMatrix *matrix = [self blackMatrixWithError:nil];
   if (!matrix) {
@@ -33,6 +33,7 @@
 - (ZXBitArray *)blackRow:(int)y row:(ZXBitArray *)row error:(NSError **)error;
 - (ZXBitMatrix *)blackMatrixWithError:(NSError **)error;
 - (ZXBinaryBitmap *)crop:(int)left top:(int)top width:(int)width height:(int)height;
+- (ZXBinaryBitmap *)cropBinarized:(int)left top:(int)top width:(int)width height:(int)height;
 - (ZXBinaryBitmap *)rotateCounterClockwise;
 - (ZXBinaryBitmap *)rotateCounterClockwise45;
 
@@ -18,6 +18,7 @@
 #import "ZXBinaryBitmap.h"
 #import "ZXBitArray.h"
 #import "ZXBitMatrix.h"
+#import "ZXDecodeTrace.h"
 
 @interface ZXBinaryBitmap ()
 
@@ -70,7 +71,10 @@
  * This method is intended for decoding 1D barcodes and may choose to apply sharpening.
  */
 - (ZXBitArray *)blackRow:(int)y row:(ZXBitArray *)row error:(NSError **)error {
-  return [self.binarizer blackRow:y row:row error:error];
+  ZX_TRACE_BEGIN(traceStart);
+  ZXBitArray *blackRow = [self.binarizer blackRow:y row:row error:error];
+  ZX_TRACE_END(traceStart, kZXDecodeStageBinarize);
+  return blackRow;
 }
 
 
@@ -81,10 +85,15 @@
  * fetched using blackRow(), so don't mix and match between them.
  */
 - (ZXBitMatrix *)blackMatrixWithError:(NSError **)error {
-  if (self.matrix == nil) {
-    self.matrix = [self.binarizer blackMatrixWithError:error];
+  // Readers running concurrently on one bitmap must share a single binarization.
+  @synchronized(self) {
+    if (self.matrix == nil) {
+      ZX_TRACE_BEGIN(traceStart);
+      self.matrix = [self.binarizer blackMatrixWithError:error];
+      ZX_TRACE_END(traceStart, kZXDecodeStageBinarize);
+    }
+    return self.matrix;
   }
-  return self.matrix;
 }
 
 
@@ -102,6 +111,23 @@
   return [[[ZXBinaryBitmap alloc] initWithBinarizer:[self.binarizer createBinarizer:newSource]] autorelease];
 }
 
+/**
+ * Like crop, but if this object's black matrix has already been computed, the new object's black
+ * matrix is cut out of it instead of binarizing the cropped luminance again. Rows are still
+ * binarized from the cropped luminance on demand.
+ */
+- (ZXBinaryBitmap *)cropBinarized:(int)left top:(int)top width:(int)aWidth height:(int)aHeight {
+  ZXBitMatrix *blackMatrix;
+  @synchronized(self) {
+    blackMatrix = [[self.matrix retain] autorelease];
+  }
+  ZXBinaryBitmap *cropped = [self crop:left top:top width:aWidth height:aHeight];
+  if (blackMatrix != nil) {
+    cropped.matrix = [blackMatrix regionAtLeft:left top:top width:aWidth height:aHeight];
+  }
+  return cropped;
+}
+
 - (BOOL)rotateSupported {
   return [[binarizer luminanceSource] rotateSupported];
 }
@@ -37,6 +37,12 @@
  */
 @property (nonatomic, retain) NSArray *allowedLengths;
 
+/**
+ * Set from another thread to make a decode using these hints give up early and find nothing.
+ * Readers check it between the rows they scan. Copies start out with the same value.
+ */
+@property (atomic, assign) BOOL cancelled;
+
 /**
  * Specifies what character encoding to use when decoding, where applicable (type String)
  */
@@ -28,6 +28,7 @@
 @synthesize assumeCode39CheckDigit;
 @synthesize allowedLengths;
 @synthesize barcodeFormats;
+@synthesize cancelled;
 @synthesize encoding;
 @synthesize other;
 @synthesize pureBarcode;
@@ -50,6 +51,7 @@
   ZXDecodeHints *result = [[[self class] allocWithZone:zone] init];
   if (result) {
     result.assumeCode39CheckDigit = self.assumeCode39CheckDigit;
+    result.cancelled = self.cancelled;
     result.allowedLengths = [[self.allowedLengths copy] autorelease];
 
     for (NSNumber *formatNumber in self.barcodeFormats) {
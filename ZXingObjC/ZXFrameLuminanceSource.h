@@ -0,0 +1,50 @@
+/*
+ * Copyright 2012 ZXing authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import "ZXLuminanceSource.h"
+
+@class ZXFrameBufferPool;
+
+typedef enum {
+  // 8 bits of luma per pixel, e.g. the first plane of NV12 (420v/420f) or NV21 frames
+  kZXFramePixelFormatLuminance = 0,
+  // 32 bits per pixel in B, G, R, A byte order, as delivered by kCVPixelFormatType_32BGRA
+  kZXFramePixelFormatBGRA
+} ZXFramePixelFormat;
+
+/**
+ * A luminance source over a raw camera frame given as a pointer and a row stride, with no
+ * dependency on CoreVideo or CoreGraphics.
+ *
+ * The frame is rotated clockwise by 0, 90, 180 or 270 degrees and optionally box-averaged down by
+ * 2x or 4x while luma is extracted, all in a single pass into one owned buffer. Rows that do not
+ * fill a whole box at the right or bottom edge are dropped. BGRA pixels are converted with the
+ * same weights as ZXCGImageLuminanceSource.
+ *
+ * Crops share the buffer, and both rotateCounterClockwise and rotateCounterClockwise45 are
+ * supported, so try harder decoding can rotate these frames.
+ */
+
+@interface ZXFrameLuminanceSource : ZXLuminanceSource
+
+- (id)initWithPixels:(const unsigned char *)pixels pixelFormat:(ZXFramePixelFormat)pixelFormat
+           dataWidth:(int)dataWidth dataHeight:(int)dataHeight bytesPerRow:(int)bytesPerRow
+            rotation:(int)rotation downscale:(int)downscale;
+- (id)initWithPixels:(const unsigned char *)pixels pixelFormat:(ZXFramePixelFormat)pixelFormat
+           dataWidth:(int)dataWidth dataHeight:(int)dataHeight bytesPerRow:(int)bytesPerRow
+            rotation:(int)rotation downscale:(int)downscale bufferPool:(ZXFrameBufferPool *)bufferPool;
+
+@end
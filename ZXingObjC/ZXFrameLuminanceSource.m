@@ -0,0 +1,318 @@
+/*
+ * Copyright 2012 ZXing authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import "ZXFrameBufferPool.h"
+#import "ZXFrameLuminanceSource.h"
+
+/**
+ * Where the box at source column bx and row by lands in a destination of the given width, as a
+ * start offset and the steps taken per source column and per source row.
+ */
+static void ZXFrameRotationSteps(int rotation, int boxesWide, int boxesHigh, int destWidth,
+                                 int *start, int *columnStep, int *rowStep) {
+  switch (rotation) {
+    case 90:
+      *start = boxesHigh - 1;
+      *columnStep = destWidth;
+      *rowStep = -1;
+      break;
+    case 180:
+      *start = boxesWide * boxesHigh - 1;
+      *columnStep = -1;
+      *rowStep = -destWidth;
+      break;
+    case 270:
+      *start = (boxesWide - 1) * destWidth;
+      *columnStep = -destWidth;
+      *rowStep = 1;
+      break;
+    default:
+      *start = 0;
+      *columnStep = 1;
+      *rowStep = destWidth;
+      break;
+  }
+}
+
+static void ZXFrameExtractLuminance(const unsigned char *pixels, int bytesPerRow, int boxesWide, int boxesHigh,
+                                    int boxSize, int boxShift, unsigned char *dest,
+                                    int start, int columnStep, int rowStep) {
+  int half = (1 << boxShift) >> 1;
+  for (int by = 0; by < boxesHigh; by++) {
+    const unsigned char *boxRow = pixels + by * boxSize * bytesPerRow;
+    unsigned char *out = dest + start + by * rowStep;
+    if (boxSize == 1) {
+      for (int bx = 0; bx < boxesWide; bx++, out += columnStep) {
+        *out = boxRow[bx];
+      }
+      continue;
+    }
+    for (int bx = 0; bx < boxesWide; bx++, out += columnStep) {
+      const unsigned char *p = boxRow + bx * boxSize;
+      int sum = 0;
+      for (int y = 0; y < boxSize; y++, p += bytesPerRow) {
+        for (int x = 0; x < boxSize; x++) {
+          sum += p[x];
+        }
+      }
+      *out = (unsigned char)((sum + half) >> boxShift);
+    }
+  }
+}
+
+// Luma is (306 R + 601 G + 117 B) / 1024, summed over the box before the single rounding shift.
+static void ZXFrameExtractBGRA(const unsigned char *pixels, int bytesPerRow, int boxesWide, int boxesHigh,
+                               int boxSize, int boxShift, unsigned char *dest,
+                               int start, int columnStep, int rowStep) {
+  int shift = boxShift + 10;
+  int half = 1 << (shift - 1);
+  for (int by = 0; by < boxesHigh; by++) {
+    const unsigned char *boxRow = pixels + by * boxSize * bytesPerRow;
+    unsigned char *out = dest + start + by * rowStep;
+    for (int bx = 0; bx < boxesWide; bx++, out += columnStep) {
+      const unsigned char *p = boxRow + bx * boxSize * 4;
+      int sum = 0;
+      for (int y = 0; y < boxSize; y++, p += bytesPerRow) {
+        for (int x = 0; x < boxSize * 4; x += 4) {
+          sum += 117 * p[x] + 601 * p[x + 1] + 306 * p[x + 2];
+        }
+      }
+      *out = (unsigned char)((sum + half) >> shift);
+    }
+  }
+}
+
+@interface ZXFrameLuminanceSource ()
+
+- (id)initWithLumaBuffer:(NSMutableData *)lumaBuffer dataWidth:(int)dataWidth dataHeight:(int)dataHeight
+                    left:(int)left top:(int)top width:(int)width height:(int)height
+              bufferPool:(ZXFrameBufferPool *)bufferPool owner:(ZXFrameLuminanceSource *)owner;
+- (NSMutableData *)lumaBufferWithLength:(int)length;
+
+@end
+
+@implementation ZXFrameLuminanceSource {
+  ZXFrameBufferPool *bufferPool;
+  // The source whose buffer this crop shares, or nil when lumaBuffer is this source's own
+  ZXFrameLuminanceSource *owner;
+  NSMutableData *lumaBuffer;
+  unsigned char *luma;
+  int dataWidth;
+  int dataHeight;
+  int left;
+  int top;
+}
+
+- (id)initWithPixels:(const unsigned char *)pixels pixelFormat:(ZXFramePixelFormat)pixelFormat
+           dataWidth:(int)_dataWidth dataHeight:(int)_dataHeight bytesPerRow:(int)bytesPerRow
+            rotation:(int)rotation downscale:(int)downscale {
+  return [self initWithPixels:pixels pixelFormat:pixelFormat dataWidth:_dataWidth dataHeight:_dataHeight
+                  bytesPerRow:bytesPerRow rotation:rotation downscale:downscale bufferPool:nil];
+}
+
+/**
+ * The frame is always copied, since camera buffers are recycled by the driver; the copy is the
+ * rotated, downscaled luma itself, so no intermediate image is made.
+ */
+- (id)initWithPixels:(const unsigned char *)pixels pixelFormat:(ZXFramePixelFormat)pixelFormat
+           dataWidth:(int)_dataWidth dataHeight:(int)_dataHeight bytesPerRow:(int)bytesPerRow
+            rotation:(int)rotation downscale:(int)downscale bufferPool:(ZXFrameBufferPool *)_bufferPool {
+  if (rotation != 0 && rotation != 90 && rotation != 180 && rotation != 270) {
+    [NSException raise:NSInvalidArgumentException
+                format:@"Rotation must be 0, 90, 180 or 270 degrees: %d", rotation];
+  }
+  if (downscale != 1 && downscale != 2 && downscale != 4) {
+    [NSException raise:NSInvalidArgumentException
+                format:@"Downscale must be 1, 2 or 4: %d", downscale];
+  }
+  int bytesPerPixel = pixelFormat == kZXFramePixelFormatBGRA ? 4 : 1;
+  if (bytesPerRow < _dataWidth * bytesPerPixel) {
+    [NSException raise:NSInvalidArgumentException
+                format:@"Row stride %d is too small for %d pixels", bytesPerRow, _dataWidth];
+  }
+
+  int boxShift = downscale == 4 ? 4 : downscale == 2 ? 2 : 0;
+  int boxesWide = _dataWidth / downscale;
+  int boxesHigh = _dataHeight / downscale;
+  BOOL quarterTurn = rotation == 90 || rotation == 270;
+  int _width = quarterTurn ? boxesHigh : boxesWide;
+  int _height = quarterTurn ? boxesWide : boxesHigh;
+
+  if (self = [super initWithWidth:_width height:_height]) {
+    bufferPool = [_bufferPool retain];
+    lumaBuffer = [[self lumaBufferWithLength:_width * _height] retain];
+    luma = (unsigned char *)[lumaBuffer mutableBytes];
+    dataWidth = _width;
+    dataHeight = _height;
+    left = 0;
+    top = 0;
+
+    int start, columnStep, rowStep;
+    ZXFrameRotationSteps(rotation, boxesWide, boxesHigh, _width, &start, &columnStep, &rowStep);
+    if (pixelFormat == kZXFramePixelFormatBGRA) {
+      ZXFrameExtractBGRA(pixels, bytesPerRow, boxesWide, boxesHigh, downscale, boxShift, luma,
+                         start, columnStep, rowStep);
+    } else {
+      ZXFrameExtractLuminance(pixels, bytesPerRow, boxesWide, boxesHigh, downscale, boxShift, luma,
+                              start, columnStep, rowStep);
+    }
+  }
+
+  return self;
+}
+
+/**
+ * Crops and rotations made from an existing source take over a buffer that is already filled.
+ * Buffers are never written after the initializer that filled them returns, so sharing is safe.
+ * A crop keeps the owner of the buffer alive, and only the owner recycles it.
+ */
+- (id)initWithLumaBuffer:(NSMutableData *)_lumaBuffer dataWidth:(int)_dataWidth dataHeight:(int)_dataHeight
+                    left:(int)_left top:(int)_top width:(int)_width height:(int)_height
+              bufferPool:(ZXFrameBufferPool *)_bufferPool owner:(ZXFrameLuminanceSource *)_owner {
+  if (self = [super initWithWidth:_width height:_height]) {
+    if (_left < 0 || _top < 0 || _left + _width > _dataWidth || _top + _height > _dataHeight) {
+      [NSException raise:NSInvalidArgumentException
+                  format:@"Crop rectangle does not fit within image data."];
+    }
+
+    bufferPool = [_bufferPool retain];
+    owner = [_owner retain];
+    lumaBuffer = [_lumaBuffer retain];
+    luma = (unsigned char *)[lumaBuffer mutableBytes];
+    dataWidth = _dataWidth;
+    dataHeight = _dataHeight;
+    left = _left;
+    top = _top;
+  }
+
+  return self;
+}
+
+- (void)dealloc {
+  if (owner == nil) {
+    [bufferPool recycle:lumaBuffer];
+  }
+  [owner release];
+  [bufferPool release];
+  [lumaBuffer release];
+  luma = NULL;
+
+  [super dealloc];
+}
+
+- (NSMutableData *)lumaBufferWithLength:(int)length {
+  if (bufferPool != nil) {
+    return [bufferPool dataWithLength:length];
+  }
+  return [NSMutableData dataWithLength:length];
+}
+
+- (unsigned char *)row:(int)y {
+  if (y < 0 || y >= self.height) {
+    [NSException raise:NSInvalidArgumentException
+                format:@"Requested row is outside the image: %d", y];
+  }
+  unsigned char *row = (unsigned char *)malloc(self.width * sizeof(unsigned char));
+  memcpy(row, luma + (y + top) * dataWidth + left, self.width);
+  return row;
+}
+
+- (unsigned char *)matrix {
+  int area = self.width * self.height;
+  unsigned char *matrix = (unsigned char *)malloc(area * sizeof(unsigned char));
+  const unsigned char *input = luma + top * dataWidth + left;
+
+  if (self.width == dataWidth) {
+    memcpy(matrix, input, area);
+    return matrix;
+  }
+
+  for (int y = 0; y < self.height; y++, input += dataWidth) {
+    memcpy(matrix + y * self.width, input, self.width);
+  }
+  return matrix;
+}
+
+- (const unsigned char *)borrowLuminances:(int *)rowStride {
+  *rowStride = dataWidth;
+  return luma + top * dataWidth + left;
+}
+
+- (BOOL)cropSupported {
+  return YES;
+}
+
+- (ZXLuminanceSource *)crop:(int)_left top:(int)_top width:(int)_width height:(int)_height {
+  return [[[ZXFrameLuminanceSource alloc] initWithLumaBuffer:lumaBuffer dataWidth:dataWidth dataHeight:dataHeight
+                                                        left:left + _left top:top + _top
+                                                       width:_width height:_height
+                                                  bufferPool:bufferPool
+                                                       owner:owner != nil ? owner : self] autorelease];
+}
+
+- (BOOL)rotateSupported {
+  return YES;
+}
+
+/**
+ * Rotating counterclockwise by 90 degrees is the same single pass as a 270 degree clockwise frame
+ * rotation, run over this source's own luma.
+ */
+- (ZXLuminanceSource *)rotateCounterClockwise {
+  return [[[ZXFrameLuminanceSource alloc] initWithPixels:luma + top * dataWidth + left
+                                             pixelFormat:kZXFramePixelFormatLuminance
+                                               dataWidth:self.width dataHeight:self.height
+                                             bytesPerRow:dataWidth rotation:270 downscale:1
+                                              bufferPool:bufferPool] autorelease];
+}
+
+/**
+ * The result is the square bounding box of the rotated image, sampled nearest neighbour in 16.16
+ * fixed point. Corners outside the original image are white, like a quiet zone.
+ */
+- (ZXLuminanceSource *)rotateCounterClockwise45 {
+  int sourceWidth = self.width;
+  int sourceHeight = self.height;
+  int size = (int)ceil((sourceWidth + sourceHeight) * M_SQRT1_2);
+  NSMutableData *rotatedBuffer = [self lumaBufferWithLength:size * size];
+  unsigned char *rotated = (unsigned char *)[rotatedBuffer mutableBytes];
+  const unsigned char *input = luma + top * dataWidth + left;
+
+  // A destination offset (u, v) from the centre samples the source at ((u - v) / sqrt(2), (u + v) / sqrt(2)).
+  int step = (int)(M_SQRT1_2 * 65536 + 0.5);
+  int64_t u = (int64_t)(1 - size) << 15;
+  for (int y = 0; y < size; y++) {
+    int64_t v = (int64_t)(2 * y + 1 - size) << 15;
+    int64_t sx = ((int64_t)sourceWidth << 15) + (((u - v) * step) >> 16);
+    int64_t sy = ((int64_t)sourceHeight << 15) + (((u + v) * step) >> 16);
+    unsigned char *out = rotated + y * size;
+    for (int x = 0; x < size; x++, sx += step, sy += step) {
+      int ix = (int)(sx >> 16);
+      int iy = (int)(sy >> 16);
+      if (sx < 0 || sy < 0 || ix >= sourceWidth || iy >= sourceHeight) {
+        out[x] = 0xFF;
+      } else {
+        out[x] = input[iy * dataWidth + ix];
+      }
+    }
+  }
+
+  return [[[ZXFrameLuminanceSource alloc] initWithLumaBuffer:rotatedBuffer dataWidth:size dataHeight:size
+                                                        left:0 top:0 width:size height:size
+                                                  bufferPool:bufferPool owner:nil] autorelease];
+}
+
+@end
@@ -35,6 +35,7 @@
 - (id)initWithWidth:(int)width height:(int)height;
 - (unsigned char *)row:(int)y;
 - (unsigned char *)matrix;
+- (const unsigned char *)borrowLuminances:(int *)rowStride;
 - (ZXLuminanceSource *)crop:(int)left top:(int)top width:(int)width height:(int)height;
 - (ZXLuminanceSource *)invert;
 - (ZXLuminanceSource *)rotateCounterClockwise;
@@ -72,6 +72,20 @@
 }
 
 
+/**
+ * Returns a read-only pointer to the luminance of the top-left pixel without copying anything.
+ * Row y starts at the returned pointer plus y * rowStride bytes, and each row holds width values.
+ * The pointer is owned by the receiver and stays valid, with unchanged contents, for as long as
+ * the receiver is alive; callers must neither free nor write through it.
+ *
+ * Returns NULL, leaving rowStride untouched, when the luminance has to be computed rather than
+ * read in place. Callers should then fall back to the copying row: and matrix methods.
+ */
+- (const unsigned char *)borrowLuminances:(int *)rowStride {
+  return NULL;
+}
+
+
 /**
  * Returns a new object with cropped image data. Implementations may keep a reference to the
  * original data rather than a copy. Only callable if isCropSupported() is true.
@@ -22,12 +22,30 @@
  * can provide a hints object to request different behavior, for example only decoding QR codes.
  */
 
-@class ZXDecodeHints;
+@class ZXDecodeHints, ZXReaderStatistics;
 
 @interface ZXMultiFormatReader : NSObject <ZXReader>
 
 @property (nonatomic, retain) ZXDecodeHints *hints;
 
+/**
+ * When YES, the format readers run in parallel on the global dispatch queue against the one
+ * binarized image instead of one after another. When more than one reader succeeds, the result of
+ * the one that comes first in the serial order is returned, as a serial decode would; a success
+ * cancels only the readers after it. The 1D, QR code and PDF417 readers stop at their next row;
+ * the Data Matrix and Aztec detectors don't scan rows, so those readers stop before detection or
+ * decoding, and MaxiCode only reads pure barcodes. Any ZXResultPointCallback in the hints may be
+ * called from several threads. Defaults to NO.
+ */
+@property (nonatomic, assign) BOOL concurrent;
+
+/**
+ * When set, every reader attempt is recorded here and each decode first reorders the readers,
+ * and the 1D format sub-readers, so that the formats seen most often lately are tried first.
+ * Read it back for monitoring. Defaults to nil, which keeps the fixed order.
+ */
+@property (nonatomic, retain) ZXReaderStatistics *statistics;
+
 + (id)reader;
 - (ZXResult *)decodeWithState:(ZXBinaryBitmap *)image error:(NSError **)error;
 
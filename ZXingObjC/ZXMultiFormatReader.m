@@ -18,12 +18,14 @@
 #import "ZXBinaryBitmap.h"
 #import "ZXDataMatrixReader.h"
 #import "ZXDecodeHints.h"
+#import "ZXDecodeTrace.h"
 #import "ZXErrors.h"
 #import "ZXMaxiCodeReader.h"
 #import "ZXMultiFormatOneDReader.h"
 #import "ZXMultiFormatReader.h"
 #import "ZXPDF417Reader.h"
 #import "ZXQRCodeReader.h"
+#import "ZXReaderStatistics.h"
 #import "ZXResult.h"
 
 @interface ZXMultiFormatReader ()
@@ -31,13 +33,18 @@
 @property (nonatomic, retain) NSMutableArray *readers;
 
 - (ZXResult *)decodeInternal:(ZXBinaryBitmap *)image error:(NSError **)error;
+- (ZXResult *)decodeConcurrently:(ZXBinaryBitmap *)image;
+- (ZXResult *)decode:(ZXBinaryBitmap *)image withReader:(id<ZXReader>)reader hints:(ZXDecodeHints *)readerHints;
+- (void)shareStatistics;
 
 @end
 
 @implementation ZXMultiFormatReader
 
+@synthesize concurrent;
 @synthesize hints;
 @synthesize readers;
+@synthesize statistics;
 
 - (id)init {
   if (self = [super init]) {
@@ -141,6 +148,25 @@
       [self.readers addObject:[[[ZXMultiFormatOneDReader alloc] initWithHints:hints] autorelease]];
     }
   }
+  [self shareStatistics];
+}
+
+- (void)setStatistics:(ZXReaderStatistics *)_statistics {
+  [statistics release];
+  statistics = [_statistics retain];
+
+  [self shareStatistics];
+}
+
+/**
+ * Hands the statistics to the 1D reader so that it orders its format sub-readers too.
+ */
+- (void)shareStatistics {
+  for (id<ZXReader> reader in self.readers) {
+    if ([reader isKindOfClass:[ZXMultiFormatOneDReader class]]) {
+      ((ZXMultiFormatOneDReader *)reader).statistics = self.statistics;
+    }
+  }
 }
 
 - (void)reset {
@@ -152,9 +178,18 @@
 }
 
 - (ZXResult *)decodeInternal:(ZXBinaryBitmap *)image error:(NSError **)error {
-  if (self.readers != nil) {
+  if (self.statistics != nil && [self.readers count] > 1) {
+    self.readers = [[[self.statistics orderedReaders:self.readers] mutableCopy] autorelease];
+  }
+
+  if (self.concurrent && [self.readers count] > 1) {
+    ZXResult *result = [self decodeConcurrently:image];
+    if (result) {
+      return result;
+    }
+  } else if (self.readers != nil) {
     for (id<ZXReader> reader in self.readers) {
-      ZXResult *result = [reader decode:image hints:self.hints error:nil];
+      ZXResult *result = [self decode:image withReader:reader hints:self.hints];
       if (result) {
         return result;
       }
@@ -165,9 +200,81 @@
   return nil;
 }
 
+/**
+ * Runs every reader on the global queue and returns the result of the earliest reader, in the
+ * serial order, that succeeds. Each reader gets its own copy of the hints; when a reader succeeds,
+ * only the readers after it are cancelled, so they give up at their next row while the ones before
+ * it run to completion and can still win. All readers are waited for, since the reader objects are
+ * reused by the next decode.
+ */
+- (ZXResult *)decodeConcurrently:(ZXBinaryBitmap *)image {
+  NSArray *currentReaders = self.readers;
+  long count = (long)[currentReaders count];
+  NSMutableArray *readerHints = [NSMutableArray arrayWithCapacity:count];
+  for (long i = 0; i < count; i++) {
+    [readerHints addObject:self.hints != nil ? [[self.hints copy] autorelease] : [ZXDecodeHints hints]];
+  }
+
+  ZXResult **results = (ZXResult **)calloc(count, sizeof(ZXResult *));
+  long winningIndex = count;
+  long *winningIndexPtr = &winningIndex;
+
+  dispatch_apply(count, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+    ZXDecodeHints *decodeHints = [readerHints objectAtIndex:i];
+    if (decodeHints.cancelled) {
+      return;
+    }
+
+    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+    ZXResult *result = [self decode:image withReader:[currentReaders objectAtIndex:i] hints:decodeHints];
+    if (result) {
+      // Keep the result alive past this thread's autorelease pool until the winner is known.
+      results[i] = [result retain];
+
+      long current = *winningIndexPtr;
+      while ((long)i < current && !__sync_bool_compare_and_swap(winningIndexPtr, current, (long)i)) {
+        current = *winningIndexPtr;
+      }
+      if ((long)i < current) {
+        for (long j = (long)i + 1; j < count; j++) {
+          ((ZXDecodeHints *)[readerHints objectAtIndex:j]).cancelled = YES;
+        }
+      }
+    }
+    [pool drain];
+  });
+
+  ZXResult *winningResult = winningIndex < count ? [results[winningIndex] autorelease] : nil;
+  for (long i = 0; i < count; i++) {
+    if (i != winningIndex) {
+      [results[i] release];
+    }
+  }
+  free(results);
+  return winningResult;
+}
+
+/**
+ * Runs one reader, recording the attempt when adaptive ordering is on. A reader that was cancelled
+ * didn't get a fair try, so its miss isn't recorded.
+ */
+- (ZXResult *)decode:(ZXBinaryBitmap *)image withReader:(id<ZXReader>)reader hints:(ZXDecodeHints *)readerHints {
+  if (self.statistics == nil) {
+    return [reader decode:image hints:readerHints error:nil];
+  }
+
+  uint64_t start = ZXDecodeTraceNow();
+  ZXResult *result = [reader decode:image hints:readerHints error:nil];
+  if (result != nil || !readerHints.cancelled) {
+    [self.statistics recordReader:reader hit:result != nil duration:(ZXDecodeTraceNow() - start) / 1e9];
+  }
+  return result;
+}
+
 - (void)dealloc {
   [hints release];
   [readers release];
+  [statistics release];
 
   [super dealloc];
 }
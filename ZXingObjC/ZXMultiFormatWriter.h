@@ -24,5 +24,6 @@
 @interface ZXMultiFormatWriter : NSObject <ZXWriter>
 
 + (id)writer;
++ (id<ZXWriter>)writerForFormat:(ZXBarcodeFormat)format;
 
 @end
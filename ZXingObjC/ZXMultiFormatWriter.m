@@ -39,7 +39,11 @@
 }
 
 - (ZXBitMatrix *)encode:(NSString *)contents format:(ZXBarcodeFormat)format width:(int)width height:(int)height hints:(ZXEncodeHints *)hints error:(NSError **)error {
-  id<ZXWriter> writer;
+  return [[ZXMultiFormatWriter writerForFormat:format] encode:contents format:format width:width height:height hints:hints error:error];
+}
+
++ (id<ZXWriter>)writerForFormat:(ZXBarcodeFormat)format {
+  id<ZXWriter> writer = nil;
   switch (format) {
     case kBarcodeFormatEan8:
       writer = [[[ZXEAN8Writer alloc] init] autorelease];
@@ -89,7 +93,7 @@
       [NSException raise:NSInvalidArgumentException 
                   format:@"No encoder available for format"];
   }
-  return [writer encode:contents format:format width:width height:height hints:hints error:error];
+  return writer;
 }
 
 @end
@@ -16,6 +16,8 @@
 
 #import "ZXLuminanceSource.h"
 
+@class ZXFrameBufferPool;
+
 /**
  * This object extends LuminanceSource around an array of YUV data returned from the camera driver,
  * with the option to crop to a rectangle within the full data. This can be used to exclude
@@ -33,6 +35,9 @@
 - (id)initWithYuvData:(unsigned char *)yuvData yuvDataLen:(int)yuvDataLen dataWidth:(int)dataWidth
            dataHeight:(int)dataHeight left:(int)left top:(int)top width:(int)width height:(int)height
     reverseHorizontal:(BOOL)reverseHorizontal;
+- (id)initWithYuvData:(unsigned char *)yuvData yuvDataLen:(int)yuvDataLen dataWidth:(int)dataWidth
+           dataHeight:(int)dataHeight left:(int)left top:(int)top width:(int)width height:(int)height
+    reverseHorizontal:(BOOL)reverseHorizontal bufferPool:(ZXFrameBufferPool *)bufferPool;
 - (int *)renderThumbnail;
 
 @end
@@ -14,17 +14,25 @@
  * limitations under the License.
  */
 
+#import "ZXFrameBufferPool.h"
 #import "ZXPlanarYUVLuminanceSource.h"
 
 const int THUMBNAIL_SCALE_FACTOR = 2;
 
 @interface ZXPlanarYUVLuminanceSource ()
 
+- (id)initWithYuvBuffer:(NSMutableData *)yuvBuffer dataWidth:(int)dataWidth dataHeight:(int)dataHeight
+                   left:(int)left top:(int)top width:(int)width height:(int)height
+                  owner:(ZXPlanarYUVLuminanceSource *)owner;
 - (void)reverseHorizontal:(int)width height:(int)height;
 
 @end
 
 @implementation ZXPlanarYUVLuminanceSource {
+  ZXFrameBufferPool *bufferPool;
+  // The source whose buffer this crop shares, or nil when yuvBuffer is this source's own
+  ZXPlanarYUVLuminanceSource *owner;
+  NSMutableData *yuvBuffer;
   unsigned char *yuvData;
   int yuvDataLen;
   int dataWidth;
@@ -36,6 +44,18 @@ const int THUMBNAIL_SCALE_FACTOR = 2;
 - (id)initWithYuvData:(unsigned char *)_yuvData yuvDataLen:(int)_yuvDataLen dataWidth:(int)_dataWidth
            dataHeight:(int)_dataHeight left:(int)_left top:(int)_top width:(int)_width height:(int)_height
     reverseHorizontal:(BOOL)_reverseHorizontal {
+  return [self initWithYuvData:_yuvData yuvDataLen:_yuvDataLen dataWidth:_dataWidth dataHeight:_dataHeight
+                          left:_left top:_top width:_width height:_height reverseHorizontal:_reverseHorizontal
+                    bufferPool:nil];
+}
+
+/**
+ * The frame is still copied, since camera buffers are recycled by the driver, but into a buffer
+ * taken from bufferPool when one is given so that continuous scanning doesn't allocate per frame.
+ */
+- (id)initWithYuvData:(unsigned char *)_yuvData yuvDataLen:(int)_yuvDataLen dataWidth:(int)_dataWidth
+           dataHeight:(int)_dataHeight left:(int)_left top:(int)_top width:(int)_width height:(int)_height
+    reverseHorizontal:(BOOL)_reverseHorizontal bufferPool:(ZXFrameBufferPool *)_bufferPool {
   if (self = [super initWithWidth:_width height:_height]) {
     if (_left + _width > _dataWidth || _top + _height > _dataHeight) {
       [NSException raise:NSInvalidArgumentException
@@ -44,8 +64,14 @@ const int THUMBNAIL_SCALE_FACTOR = 2;
     }
 
     yuvDataLen = _yuvDataLen;
-    yuvData = (unsigned char *)malloc(_yuvDataLen * sizeof(unsigned char));
-    memcpy(yuvData, _yuvData, _yuvDataLen);
+    bufferPool = [_bufferPool retain];
+    if (bufferPool != nil) {
+      yuvBuffer = [[bufferPool dataWithLength:_yuvDataLen] retain];
+      memcpy([yuvBuffer mutableBytes], _yuvData, _yuvDataLen);
+    } else {
+      yuvBuffer = [[NSMutableData alloc] initWithBytes:_yuvData length:_yuvDataLen];
+    }
+    yuvData = (unsigned char *)[yuvBuffer mutableBytes];
     dataWidth = _dataWidth;
     dataHeight = _dataHeight;
     left = _left;
@@ -58,11 +84,41 @@ const int THUMBNAIL_SCALE_FACTOR = 2;
   return self;
 }
 
+/**
+ * Crops share the parent's buffer instead of copying it. The buffer is never written after the
+ * parent's initializer returns, so sharing it is safe. The crop keeps the owner of the buffer
+ * alive so that the buffer isn't recycled under it.
+ */
+- (id)initWithYuvBuffer:(NSMutableData *)_yuvBuffer dataWidth:(int)_dataWidth dataHeight:(int)_dataHeight
+                   left:(int)_left top:(int)_top width:(int)_width height:(int)_height
+                  owner:(ZXPlanarYUVLuminanceSource *)_owner {
+  if (self = [super initWithWidth:_width height:_height]) {
+    if (_left + _width > _dataWidth || _top + _height > _dataHeight) {
+      [NSException raise:NSInvalidArgumentException
+                  format:@"Crop rectangle does not fit within image data."];
+    }
+
+    owner = [_owner retain];
+    yuvBuffer = [_yuvBuffer retain];
+    yuvData = (unsigned char *)[yuvBuffer mutableBytes];
+    yuvDataLen = (int)[yuvBuffer length];
+    dataWidth = _dataWidth;
+    dataHeight = _dataHeight;
+    left = _left;
+    top = _top;
+  }
+
+  return self;
+}
+
 - (void)dealloc {
-  if (yuvData != NULL) {
-    free(yuvData);
-    yuvData = NULL;
+  if (owner == nil) {
+    [bufferPool recycle:yuvBuffer];
   }
+  [owner release];
+  [bufferPool release];
+  [yuvBuffer release];
+  yuvData = NULL;
 
   [super dealloc];
 }
@@ -98,14 +154,20 @@ const int THUMBNAIL_SCALE_FACTOR = 2;
   return matrix;
 }
 
+- (const unsigned char *)borrowLuminances:(int *)rowStride {
+  *rowStride = dataWidth;
+  return yuvData + top * dataWidth + left;
+}
+
 - (BOOL)cropSupported {
   return YES;
 }
 
 - (ZXLuminanceSource *)crop:(int)_left top:(int)_top width:(int)_width height:(int)_height {
-  return [[[self class] alloc] initWithYuvData:yuvData yuvDataLen:yuvDataLen dataWidth:dataWidth
-                                    dataHeight:dataHeight left:left + _left top:top + _top
-                                         width:_width height:_height reverseHorizontal:NO];
+  return [[[[self class] alloc] initWithYuvBuffer:yuvBuffer dataWidth:dataWidth dataHeight:dataHeight
+                                             left:left + _left top:top + _top
+                                            width:_width height:_height
+                                            owner:owner != nil ? owner : self] autorelease];
 }
 
 - (int *)renderThumbnail {
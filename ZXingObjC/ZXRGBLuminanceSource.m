@@ -18,6 +18,7 @@
 
 @interface ZXRGBLuminanceSource ()
 
+@property (nonatomic, retain) NSMutableData *luminanceData;
 @property (nonatomic, assign) unsigned char *luminances;
 @property (nonatomic, assign) int luminancesCount;
 @property (nonatomic, assign) int dataWidth;
@@ -25,10 +26,14 @@
 @property (nonatomic, assign) int left;
 @property (nonatomic, assign) int top;
 
+- (id)initWithLuminanceData:(NSMutableData *)luminanceData dataWidth:(int)dataWidth dataHeight:(int)dataHeight
+                       left:(int)left top:(int)top width:(int)width height:(int)height;
+
 @end
 
 @implementation ZXRGBLuminanceSource
 
+@synthesize luminanceData;
 @synthesize luminances;
 @synthesize luminancesCount;
 @synthesize dataWidth;
@@ -46,7 +51,8 @@
     // In order to measure pure decoding speed, we convert the entire image to a greyscale array
     // up front, which is the same as the Y channel of the YUVLuminanceSource in the real app.
     self.luminancesCount = self.width * self.height;
-    self.luminances = (unsigned char *)malloc(self.luminancesCount * sizeof(unsigned char));
+    self.luminanceData = [NSMutableData dataWithLength:self.luminancesCount * sizeof(unsigned char)];
+    self.luminances = (unsigned char *)[self.luminanceData mutableBytes];
     for (int y = 0; y < self.height; y++) {
       int offset = y * self.width;
       for (int x = 0; x < self.width; x++) {
@@ -68,8 +74,11 @@
   return self;
 }
 
-- (id)initWithPixels:(unsigned char *)pixels pixelsLen:(int)pixelsLen dataWidth:(int)aDataWidth dataHeight:(int)aDataHeight
-                left:(int)aLeft top:(int)aTop width:(int)aWidth height:(int)aHeight {
+/**
+ * Crops share the parent's luminance buffer, which is never written after initialization.
+ */
+- (id)initWithLuminanceData:(NSMutableData *)aLuminanceData dataWidth:(int)aDataWidth dataHeight:(int)aDataHeight
+                       left:(int)aLeft top:(int)aTop width:(int)aWidth height:(int)aHeight {
   if (self = [super initWithWidth:aWidth height:aHeight]) {
     if (aLeft + self.width > aDataWidth || aTop + self.height > aDataHeight) {
       [NSException raise:NSInvalidArgumentException
@@ -77,9 +86,9 @@
 
     }
 
-    self.luminancesCount = pixelsLen;
-    self.luminances = (unsigned char *)malloc(pixelsLen * sizeof(unsigned char));
-    memcpy(self.luminances, pixels, pixelsLen * sizeof(char));
+    self.luminanceData = aLuminanceData;
+    self.luminances = (unsigned char *)[aLuminanceData mutableBytes];
+    self.luminancesCount = (int)[aLuminanceData length];
 
     self.dataWidth = aDataWidth;
     self.dataHeight = aDataHeight;
@@ -90,6 +99,12 @@
   return self;
 }
 
+- (void)dealloc {
+  [luminanceData release];
+
+  [super dealloc];
+}
+
 - (unsigned char *)row:(int)y {
   if (y < 0 || y >= self.height) {
     [NSException raise:NSInvalidArgumentException
@@ -122,19 +137,23 @@
   return matrix;
 }
 
+- (const unsigned char *)borrowLuminances:(int *)rowStride {
+  *rowStride = self.dataWidth;
+  return self.luminances + self.top * self.dataWidth + self.left;
+}
+
 - (BOOL)cropSupported {
   return YES;
 }
 
 - (ZXLuminanceSource *)crop:(int)aLeft top:(int)aTop width:(int)aWidth height:(int)aHeight {
-  return [[[[self class] alloc] initWithPixels:self.luminances
-                                     pixelsLen:self.luminancesCount
-                                     dataWidth:self.dataWidth
-                                    dataHeight:self.dataHeight
-                                          left:self.left + aLeft
-                                           top:self.top + aTop
-                                         width:aWidth
-                                        height:aHeight] autorelease];
+  return [[[[self class] alloc] initWithLuminanceData:self.luminanceData
+                                            dataWidth:self.dataWidth
+                                           dataHeight:self.dataHeight
+                                                 left:self.left + aLeft
+                                                  top:self.top + aTop
+                                                width:aWidth
+                                               height:aHeight] autorelease];
 }
 
 @end
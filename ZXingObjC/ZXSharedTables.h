@@ -0,0 +1,30 @@
+/*
+ * Copyright 2012 ZXing authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/**
+ * The library keeps a number of shared tables: Galois fields, version and mask tables, mode
+ * and character set lookups, and the per-class constants set up in +initialize. Each one is
+ * built exactly once and is safe to read from any thread, but building them costs the first
+ * decode noticeably. Call initializeSharedTables once at process start, from any thread, to
+ * pay that cost up front. Calling it again is a no-op.
+ */
+
+@interface ZXSharedTables : NSObject
+
++ (void)initializeSharedTables;
+
+@end
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2012 ZXing authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#import "ZXAbstractRSSReader.h"
+#import "ZXAztecEncoder.h"
+#import "ZXCalendarParsedResult.h"
+#import "ZXCharacterSetECI.h"
+#import "ZXCodaBarReader.h"
+#import "ZXCode128Reader.h"
+#import "ZXDataMask.h"
+#import "ZXDataMatrixErrorCorrection.h"
+#import "ZXDataMatrixVersion.h"
+#import "ZXEmailDoCoMoResultParser.h"
+#import "ZXErrorCorrectionLevel.h"
+#import "ZXFieldParser.h"
+#import "ZXGenericGF.h"
+#import "ZXGeoResultParser.h"
+#import "ZXGridSampler.h"
+#import "ZXHighLevelEncoder.h"
+#import "ZXITFReader.h"
+#import "ZXMode.h"
+#import "ZXPDF417DecodedBitStreamParser.h"
+#import "ZXPDF417HighLevelEncoder.h"
+#import "ZXQRCodeVersion.h"
+#import "ZXResultParser.h"
+#import "ZXRSS14Reader.h"
+#import "ZXRSSExpandedReader.h"
+#import "ZXSharedTables.h"
+#import "ZXSymbolInfo.h"
+#import "ZXSymbolShapeHint.h"
+#import "ZXURIParsedResult.h"
+#import "ZXURIResultParser.h"
+#import "ZXVCardResultParser.h"
+
+@implementation ZXSharedTables
+
++ (void)initializeSharedTables {
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    // Reed-Solomon fields
+    [ZXGenericGF AztecData12];
+    [ZXGenericGF AztecData10];
+    [ZXGenericGF AztecData6];
+    [ZXGenericGF AztecParam];
+    [ZXGenericGF QrCodeField256];
+    [ZXGenericGF DataMatrixField256];
+
+    [ZXGridSampler instance];
+    [ZXCharacterSetECI characterSetECIByValue:0];
+
+    // QR Code
+    [ZXQRCodeVersion versionForNumber:1];
+    [ZXErrorCorrectionLevel forBits:0];
+    for (int reference = 0; reference < 8; reference++) {
+      [ZXDataMask forReference:reference];
+    }
+    for (int bits = 0; bits <= 0xD; bits++) {
+      [ZXMode forBits:bits];
+    }
+
+    // Data Matrix
+    [ZXDataMatrixVersion class];
+    [ZXSymbolInfo class];
+    [ZXSymbolShapeHint forceNone];
+    [ZXSymbolShapeHint forceSquare];
+    [ZXSymbolShapeHint forceRectangle];
+    [ZXHighLevelEncoder class];
+    [ZXDataMatrixErrorCorrection class];
+
+    // PDF417 and Aztec
+    [ZXPDF417DecodedBitStreamParser class];
+    [ZXPDF417HighLevelEncoder class];
+    [ZXAztecEncoder class];
+
+    // 1D
+    [ZXCodaBarReader class];
+    [ZXCode128Reader class];
+    [ZXITFReader class];
+    [ZXAbstractRSSReader class];
+    [ZXRSS14Reader class];
+    [ZXRSSExpandedReader class];
+    [ZXFieldParser class];
+
+    // Result parsing
+    [ZXResultParser class];
+    [ZXEmailDoCoMoResultParser class];
+    [ZXGeoResultParser class];
+    [ZXURIResultParser class];
+    [ZXVCardResultParser class];
+    [ZXURIParsedResult class];
+    [ZXCalendarParsedResult class];
+  });
+}
+
+@end
@@ -92,14 +92,17 @@
 #import "ZXBitMatrix.h"
 #import "ZXBitSource.h"
 #import "ZXCharacterSetECI.h"
+#import "ZXDecodeTrace.h"
 #import "ZXDecoderResult.h"
 #import "ZXDefaultGridSampler.h"
 #import "ZXDetectorResult.h"
 #import "ZXECI.h"
+#import "ZXFrameBufferPool.h"
 #import "ZXGlobalHistogramBinarizer.h"
 #import "ZXGridSampler.h"
 #import "ZXHybridBinarizer.h"
 #import "ZXPerspectiveTransform.h"
+#import "ZXReaderStatistics.h"
 #import "ZXStringUtils.h"
 
 // ZXingObjC/datamatrix/decoder
@@ -123,6 +126,7 @@
 #import "ZXEdifactEncoder.h"
 #import "ZXEncoderContext.h"
 #import "ZXHighLevelEncoder.h"
+#import "ZXMinimalEncoder.h"
 #import "ZXSymbolInfo.h"
 #import "ZXSymbolShapeHint.h"
 #import "ZXTextEncoder.h"
@@ -274,12 +278,14 @@
 
 // ZXingObjC
 #import "ZXBarcodeFormat.h"
+#import "ZXBatchWriter.h"
 #import "ZXBinarizer.h"
 #import "ZXBinaryBitmap.h"
 #import "ZXDecodeHints.h"
 #import "ZXDimension.h"
 #import "ZXEncodeHints.h"
 #import "ZXErrors.h"
+#import "ZXFrameLuminanceSource.h"
 #import "ZXInvertedLuminanceSource.h"
 #import "ZXLuminanceSource.h"
 #import "ZXMultiFormatReader.h"
@@ -291,4 +297,5 @@
 #import "ZXResultPoint.h"
 #import "ZXResultPointCallback.h"
 #import "ZXRGBLuminanceSource.h"
+#import "ZXSharedTables.h"
 #import "ZXWriter.h"
@@ -20,7 +20,9 @@
 #import "ZXAztecReader.h"
 #import "ZXBinaryBitmap.h"
 #import "ZXDecodeHints.h"
+#import "ZXDecodeTrace.h"
 #import "ZXDecoderResult.h"
+#import "ZXErrors.h"
 #import "ZXReader.h"
 #import "ZXResult.h"
 #import "ZXResultPointCallback.h"
@@ -40,10 +42,23 @@
     return nil;
   }
 
+  // The detector walks out from the center to the bull's eye rather than scanning rows, so
+  // cancellation is checked around it instead of inside it.
+  if (hints.cancelled) {
+    if (error) *error = NotFoundErrorInstance();
+    return nil;
+  }
+  ZX_TRACE_BEGIN(traceStart);
   ZXAztecDetectorResult *detectorResult = [[[[ZXAztecDetector alloc] initWithImage:matrix] autorelease] detectWithError:error];
+  ZX_TRACE_END(traceStart, kZXDecodeStageDetect);
   if (!detectorResult) {
     return nil;
   }
+  ZX_TRACE_COUNT(candidatesFound, 1);
+  if (hints.cancelled) {
+    if (error) *error = NotFoundErrorInstance();
+    return nil;
+  }
   NSArray *points = [detectorResult points];
 
   if (hints != nil) {
@@ -16,7 +16,9 @@
 
 #import "ZXAztecDecoder.h"
 #import "ZXAztecDetectorResult.h"
+#import "ZXBitArray.h"
 #import "ZXBitMatrix.h"
+#import "ZXDecodeTrace.h"
 #import "ZXDecoderResult.h"
 #import "ZXErrors.h"
 #import "ZXGenericGF.h"
@@ -49,31 +51,60 @@ static int NB_DATABLOCK[] = {
   940, 1020, 920, 992, 1066, 1144, 1224, 1306, 1392, 1480, 1570, 1664
 };
 
-static NSString *UPPER_TABLE[] = {
-  @"CTRL_PS", @" ", @"A", @"B", @"C", @"D", @"E", @"F", @"G", @"H", @"I", @"J", @"K", @"L", @"M", @"N", @"O", @"P",
-  @"Q", @"R", @"S", @"T", @"U", @"V", @"W", @"X", @"Y", @"Z", @"CTRL_LL", @"CTRL_ML", @"CTRL_DL", @"CTRL_BS"
+static const char *UPPER_TABLE[] = {
+  "CTRL_PS", " ", "A", "B", "C", "D", "E", "F", "G", "H", "I", "J", "K", "L", "M", "N", "O", "P",
+  "Q", "R", "S", "T", "U", "V", "W", "X", "Y", "Z", "CTRL_LL", "CTRL_ML", "CTRL_DL", "CTRL_BS"
 };
 
-static NSString *LOWER_TABLE[] = {
-  @"CTRL_PS", @" ", @"a", @"b", @"c", @"d", @"e", @"f", @"g", @"h", @"i", @"j", @"k", @"l", @"m", @"n", @"o", @"p",
-  @"q", @"r", @"s", @"t", @"u", @"v", @"w", @"x", @"y", @"z", @"CTRL_US", @"CTRL_ML", @"CTRL_DL", @"CTRL_BS"
+static const char *LOWER_TABLE[] = {
+  "CTRL_PS", " ", "a", "b", "c", "d", "e", "f", "g", "h", "i", "j", "k", "l", "m", "n", "o", "p",
+  "q", "r", "s", "t", "u", "v", "w", "x", "y", "z", "CTRL_US", "CTRL_ML", "CTRL_DL", "CTRL_BS"
 };
 
-static NSString *MIXED_TABLE[] = {
-  @"CTRL_PS", @" ", @"\1", @"\2", @"\3", @"\4", @"\5", @"\6", @"\7", @"\b", @"\t", @"\n",
-  @"\13", @"\f", @"\r", @"\33", @"\34", @"\35", @"\36", @"\37", @"@", @"\\", @"^", @"_",
-  @"`", @"|", @"~", @"\177", @"CTRL_LL", @"CTRL_UL", @"CTRL_PL", @"CTRL_BS"
+static const char *MIXED_TABLE[] = {
+  "CTRL_PS", " ", "\1", "\2", "\3", "\4", "\5", "\6", "\7", "\b", "\t", "\n",
+  "\13", "\f", "\r", "\33", "\34", "\35", "\36", "\37", "@", "\\", "^", "_",
+  "`", "|", "~", "\177", "CTRL_LL", "CTRL_UL", "CTRL_PL", "CTRL_BS"
 };
 
-static NSString *PUNCT_TABLE[] = {
-  @"", @"\r", @"\r\n", @". ", @", ", @": ", @"!", @"\"", @"#", @"$", @"%", @"&", @"'", @"(", @")",
-  @"*", @"+", @",", @"-", @".", @"/", @":", @";", @"<", @"=", @">", @"?", @"[", @"]", @"{", @"}", @"CTRL_UL"
+static const char *PUNCT_TABLE[] = {
+  "", "\r", "\r\n", ". ", ", ", ": ", "!", "\"", "#", "$", "%", "&", "'", "(", ")",
+  "*", "+", ",", "-", ".", "/", ":", ";", "<", "=", ">", "?", "[", "]", "{", "}", "CTRL_UL"
 };
 
-static NSString *DIGIT_TABLE[] = {
-  @"CTRL_PS", @" ", @"0", @"1", @"2", @"3", @"4", @"5", @"6", @"7", @"8", @"9", @",", @".", @"CTRL_UL", @"CTRL_US"
+static const char *DIGIT_TABLE[] = {
+  "CTRL_PS", " ", "0", "1", "2", "3", "4", "5", "6", "7", "8", "9", ",", ".", "CTRL_UL", "CTRL_US"
 };
 
+static inline int ZXAztecModule(const int *bits, int rowSize, int x, int y) {
+  return (bits[y * rowSize + (x >> 5)] >> (x & 0x1f)) & 1;
+}
+
+/**
+ * Reads a code of given length and at given index in an array of bits
+ */
+static int ZXAztecReadCode(const int *bits, int startIndex, int length) {
+  int res = 0;
+  for (int i = startIndex; i < startIndex + length; i++) {
+    res = (res << 1) | ((bits[i >> 5] >> (i & 0x1f)) & 1);
+  }
+  return res;
+}
+
+/**
+ * Fills coordinates with the matrix coordinates that are left once the control dashed lines of a
+ * full Aztec code are taken out, and returns how many there are.
+ */
+static int ZXAztecDataCoordinates(int *coordinates, int matrixSize) {
+  int size = 0;
+  for (int i = 0; i < matrixSize; i++) {
+    if ((matrixSize / 2 - i) % 16 != 0) {
+      coordinates[size++] = i;
+    }
+  }
+  return size;
+}
+
 @interface ZXAztecDecoder ()
 
 @property (nonatomic, assign) int codewordSize;
@@ -81,13 +112,11 @@ static NSString *DIGIT_TABLE[] = {
 @property (nonatomic, assign) int invertedBitCount;
 @property (nonatomic, assign) int numCodewords;
 
-- (NSString *)character:(int)table code:(int)code;
-- (NSArray *)correctBits:(NSArray *)rawbits error:(NSError **)error;
-- (NSString *)encodedData:(NSArray *)correctedBits error:(NSError **)error;
-- (NSArray *)extractBits:(ZXBitMatrix *)matrix;
-- (int)readCode:(NSArray *)rawbits startIndex:(int)startIndex length:(unsigned int)length;
-- (ZXBitMatrix *)removeDashedLines:(ZXBitMatrix *)matrix;
-- (int)table:(unichar)t;
+- (const char *)character:(int)table code:(int)code;
+- (ZXBitArray *)correctBits:(ZXBitArray *)rawbits error:(NSError **)error;
+- (NSString *)encodedData:(ZXBitArray *)correctedBits error:(NSError **)error;
+- (ZXBitArray *)extractBits:(ZXBitMatrix *)matrix;
+- (int)table:(char)t;
 
 @end
 
@@ -100,20 +129,18 @@ static NSString *DIGIT_TABLE[] = {
 
 - (ZXDecoderResult *)decode:(ZXAztecDetectorResult *)detectorResult error:(NSError **)error {
   self.ddata = detectorResult;
-  ZXBitMatrix *matrix = [detectorResult bits];
-  if (![ddata compact]) {
-    matrix = [self removeDashedLines:[ddata bits]];
-  }
-  NSArray *rawbits = [self extractBits:matrix];
+  ZXBitArray *rawbits = [self extractBits:[detectorResult bits]];
   if (!rawbits) {
     if (error) *error = FormatErrorInstance();
     return nil;
   }
-  NSArray *correctedBits = [self correctBits:rawbits error:error];
+  ZXBitArray *correctedBits = [self correctBits:rawbits error:error];
   if (!correctedBits) {
     return nil;
   }
+  ZX_TRACE_BEGIN(traceStart);
   NSString *result = [self encodedData:correctedBits error:error];
+  ZX_TRACE_END(traceStart, kZXDecodeStageParse);
   if (!result) {
     return nil;
   }
@@ -125,15 +152,22 @@ static NSString *DIGIT_TABLE[] = {
  * 
  * Gets the string encoded in the aztec code bits
  */
-- (NSString *)encodedData:(NSArray *)correctedBits error:(NSError **)error {
+- (NSString *)encodedData:(ZXBitArray *)correctedBits error:(NSError **)error {
   int endIndex = self.codewordSize * [self.ddata nbDatablocks] - self.invertedBitCount;
-  if (endIndex > [correctedBits count]) {
+  if (endIndex > correctedBits.size) {
     if (error) *error = FormatErrorInstance();
+    return nil;
   }
+  const int *bits = correctedBits.bits;
+
+  // Every code of four or more bits yields at most two characters
+  int resultCapacity = MAX(endIndex, 0) / 2 + 2;
+  unichar *result = (unichar *)malloc(resultCapacity * sizeof(unichar));
+  int resultLength = 0;
+
   int lastTable = UPPER;
   int table = UPPER;
   int startIndex = 0;
-  NSMutableString *result = [NSMutableString stringWithCapacity:20];
   BOOL end = NO;
   BOOL shift = NO;
   BOOL switchShift = NO;
@@ -152,14 +186,14 @@ static NSString *DIGIT_TABLE[] = {
         break;
       }
 
-      int length = [self readCode:correctedBits startIndex:startIndex length:5];
+      int length = ZXAztecReadCode(bits, startIndex, 5);
       startIndex += 5;
       if (length == 0) {
         if (endIndex - startIndex < 11) {
           break;
         }
 
-        length = [self readCode:correctedBits startIndex:startIndex length:11] + 31;
+        length = ZXAztecReadCode(bits, startIndex, 11) + 31;
         startIndex += 11;
       }
       for (int charCount = 0; charCount < length; charCount++) {
@@ -168,9 +202,8 @@ static NSString *DIGIT_TABLE[] = {
           break;
         }
 
-        code = [self readCode:correctedBits startIndex:startIndex length:8];
-        unichar uCode = (unichar)code;
-        [result appendString:[NSString stringWithCharacters:&uCode length:1]];
+        code = ZXAztecReadCode(bits, startIndex, 8);
+        result[resultLength++] = (unichar)code;
         startIndex += 8;
       }
       binaryShift = false;
@@ -179,11 +212,10 @@ static NSString *DIGIT_TABLE[] = {
         if (endIndex - startIndex < 8) {
           break;
         }
-        code = [self readCode:correctedBits startIndex:startIndex length:8];
+        code = ZXAztecReadCode(bits, startIndex, 8);
         startIndex += 8;
 
-        unichar uCode = (unichar)code;
-        [result appendString:[NSString stringWithCharacters:&uCode length:1]];
+        result[resultLength++] = (unichar)code;
       } else {
         int size = 5;
 
@@ -195,22 +227,24 @@ static NSString *DIGIT_TABLE[] = {
           break;
         }
 
-        code = [self readCode:correctedBits startIndex:startIndex length:size];
+        code = ZXAztecReadCode(bits, startIndex, size);
         startIndex += size;
 
-        NSString *str = [self character:table code:code];
-        if ([str hasPrefix:@"CTRL_"]) {
+        const char *str = [self character:table code:code];
+        if (strncmp(str, "CTRL_", 5) == 0) {
           // Table changes
-          table = [self table:[str characterAtIndex:5]];
+          table = [self table:str[5]];
 
-          if ([str characterAtIndex:6] == 'S') {
+          if (str[6] == 'S') {
             shift = YES;
-            if ([str characterAtIndex:5] == 'B') {
+            if (str[5] == 'B') {
               binaryShift = YES;
             }
           }
         } else {
-          [result appendString:str];
+          while (*str) {
+            result[resultLength++] = (unsigned char)*str++;
+          }
         }
       }
     }
@@ -222,14 +256,16 @@ static NSString *DIGIT_TABLE[] = {
     }
   }
 
-  return result;
+  NSString *text = [NSString stringWithCharacters:result length:resultLength];
+  free(result);
+  return text;
 }
 
 
 /**
  * gets the table corresponding to the char passed
  */
-- (int)table:(unichar)t {
+- (int)table:(char)t {
   int table = UPPER;
 
   switch (t) {
@@ -259,7 +295,7 @@ static NSString *DIGIT_TABLE[] = {
 /**
  * Gets the character (or string) corresponding to the passed code in the given table
  */
-- (NSString *)character:(int)table code:(int)code {
+- (const char *)character:(int)table code:(int)code {
   switch (table) {
   case UPPER:
     return UPPER_TABLE[code];
@@ -272,7 +308,7 @@ static NSString *DIGIT_TABLE[] = {
   case DIGIT:
     return DIGIT_TABLE[code];
   default:
-    return @"";
+    return "";
   }
 }
 
@@ -280,7 +316,7 @@ static NSString *DIGIT_TABLE[] = {
 /**
  * Performs RS error correction on an array of bits
  */
-- (NSArray *)correctBits:(NSArray *)rawbits error:(NSError **)error {
+- (ZXBitArray *)correctBits:(ZXBitArray *)rawbits error:(NSError **)error {
   ZXGenericGF *gf;
   if ([self.ddata nbLayers] <= 2) {
     self.codewordSize = 6;
@@ -310,15 +346,9 @@ static NSString *DIGIT_TABLE[] = {
 
   int dataWordsLen = self.numCodewords;
   int dataWords[dataWordsLen];
+  const int *rawWords = rawbits.bits;
   for (int i = 0; i < dataWordsLen; i++) {
-    dataWords[i] = 0;
-    int flag = 1;
-    for (int j = 1; j <= self.codewordSize; j++) {
-      if ([[rawbits objectAtIndex:codewordSize * i + codewordSize - j + offset] boolValue]) {
-        dataWords[i] += flag;
-      }
-      flag <<= 1;
-    }
+    dataWords[i] = ZXAztecReadCode(rawWords, codewordSize * i + offset, codewordSize);
   }
 
   ZXReedSolomonDecoder *rsDecoder = [[[ZXReedSolomonDecoder alloc] initWithField:gf] autorelease];
@@ -335,10 +365,8 @@ static NSString *DIGIT_TABLE[] = {
   offset = 0;
   self.invertedBitCount = 0;
 
-  NSMutableArray *correctedBits = [NSMutableArray array];
-  for (int i = 0; i < numDataCodewords*codewordSize; i++) {
-    [correctedBits addObject:[NSNumber numberWithBool:NO]];
-  }
+  ZXBitArray *correctedBits = [[[ZXBitArray alloc] initWithSize:numDataCodewords * codewordSize] autorelease];
+  int *correctedWords = correctedBits.bits;
 
   for (int i = 0; i < numDataCodewords; i++) {
     BOOL seriesColor = NO;
@@ -365,7 +393,10 @@ static NSString *DIGIT_TABLE[] = {
           seriesColor = color;
         }
 
-        [correctedBits replaceObjectAtIndex:i * self.codewordSize + j - offset withObject:[NSNumber numberWithBool:color]];
+        if (color) {
+          int index = i * self.codewordSize + j - offset;
+          correctedWords[index >> 5] |= 1 << (index & 0x1f);
+        }
       }
 
       flag = (int)(((unsigned int)flag) >> 1);
@@ -379,8 +410,7 @@ static NSString *DIGIT_TABLE[] = {
 /**
  * Gets the array of bits from an Aztec Code matrix
  */
-- (NSArray *)extractBits:(ZXBitMatrix *)matrix {
-  NSMutableArray *rawbits;
+- (ZXBitArray *)extractBits:(ZXBitMatrix *)matrix {
   int capacity;
   if ([self.ddata compact]) {
     if ([self.ddata nbLayers] > (sizeof(NB_BITS_COMPACT) / sizeof(int))) {
@@ -396,36 +426,50 @@ static NSString *DIGIT_TABLE[] = {
     self.numCodewords = NB_DATABLOCK[[self.ddata nbLayers]];
   }
 
-  rawbits = [NSMutableArray arrayWithCapacity:capacity];
-  for (int i = 0; i < capacity; i++) {
-    [rawbits addObject:[NSNumber numberWithBool:NO]];
+  ZXBitArray *rawbits = [[[ZXBitArray alloc] initWithSize:capacity] autorelease];
+  int *rawWords = rawbits.bits;
+
+  // Full codes are read as if their control dashed lines had been removed, by looking the
+  // coordinates up in a table of the remaining rows and columns.
+  int size = matrix.height;
+  int coordinates[size];
+  if ([self.ddata compact]) {
+    for (int i = 0; i < size; i++) {
+      coordinates[i] = i;
+    }
+  } else {
+    size = ZXAztecDataCoordinates(coordinates, matrix.width);
   }
 
+  const int *bits = matrix.bits;
+  int rowSize = matrix.rowSize;
   int layer = [self.ddata nbLayers];
-  int size = matrix.height;
   int rawbitsOffset = 0;
   int matrixOffset = 0;
 
   while (layer != 0) {
+    if (size < 2 || rawbitsOffset + 8 * size - 16 > capacity) {
+      return nil;
+    }
     int flip = 0;
 
     for (int i = 0; i < 2 * size - 4; i++) {
-      [rawbits replaceObjectAtIndex:rawbitsOffset + i
-                         withObject:[NSNumber numberWithBool:[matrix getX:matrixOffset + flip y:matrixOffset + i / 2]]];
+      int index = rawbitsOffset + i;
+      rawWords[index >> 5] |= ZXAztecModule(bits, rowSize, coordinates[matrixOffset + flip], coordinates[matrixOffset + i / 2]) << (index & 0x1f);
 
-      [rawbits replaceObjectAtIndex:rawbitsOffset + 2 * size - 4 + i
-                         withObject:[NSNumber numberWithBool:[matrix getX:matrixOffset + i / 2 y:matrixOffset + size - 1 - flip]]];
+      index = rawbitsOffset + 2 * size - 4 + i;
+      rawWords[index >> 5] |= ZXAztecModule(bits, rowSize, coordinates[matrixOffset + i / 2], coordinates[matrixOffset + size - 1 - flip]) << (index & 0x1f);
 
       flip = (flip + 1) % 2;
     }
 
     flip = 0;
     for (int i = 2 * size + 1; i > 5; i--) {
-      [rawbits replaceObjectAtIndex:rawbitsOffset + 4 * size - 8 + (2 * size - i) + 1
-                         withObject:[NSNumber numberWithBool:[matrix getX:matrixOffset + size - 1 - flip y:matrixOffset + i / 2 - 1]]];
+      int index = rawbitsOffset + 4 * size - 8 + (2 * size - i) + 1;
+      rawWords[index >> 5] |= ZXAztecModule(bits, rowSize, coordinates[matrixOffset + size - 1 - flip], coordinates[matrixOffset + i / 2 - 1]) << (index & 0x1f);
 
-      [rawbits replaceObjectAtIndex:rawbitsOffset + 6 * size - 12 + (2 * size - i) + 1
-                         withObject:[NSNumber numberWithBool:[matrix getX:matrixOffset + i / 2 - 1 y:matrixOffset + flip]]];
+      index = rawbitsOffset + 6 * size - 12 + (2 * size - i) + 1;
+      rawWords[index >> 5] |= ZXAztecModule(bits, rowSize, coordinates[matrixOffset + i / 2 - 1], coordinates[matrixOffset + flip]) << (index & 0x1f);
 
       flip = (flip + 1) % 2;
     }
@@ -439,54 +483,6 @@ static NSString *DIGIT_TABLE[] = {
   return rawbits;
 }
 
-
-/**
- * Transforms an Aztec code matrix by removing the control dashed lines
- */
-- (ZXBitMatrix *)removeDashedLines:(ZXBitMatrix *)matrix {
-  int nbDashed = 1 + 2 * ((matrix.width - 1) / 2 / 16);
-  ZXBitMatrix *newMatrix = [[[ZXBitMatrix alloc] initWithWidth:matrix.width - nbDashed height:matrix.height - nbDashed] autorelease];
-  int nx = 0;
-
-  for (int x = 0; x < matrix.width; x++) {
-    if ((matrix.width / 2 - x) % 16 == 0) {
-      continue;
-    }
-    int ny = 0;
-
-    for (int y = 0; y < matrix.height; y++) {
-      if ((matrix.width / 2 - y) % 16 == 0) {
-        continue;
-      }
-      if ([matrix getX:x y:y]) {
-        [newMatrix setX:nx y:ny];
-      }
-      ny++;
-    }
-
-    nx++;
-  }
-
-  return newMatrix;
-}
-
-
-/**
- * Reads a code of given length and at given index in an array of bits
- */
-- (int)readCode:(NSArray *)rawbits startIndex:(int)startIndex length:(unsigned int)length {
-  int res = 0;
-
-  for (int i = startIndex; i < startIndex + length; i++) {
-    res <<= 1;
-    if ([[rawbits objectAtIndex:i] boolValue]) {
-      res++;
-    }
-  }
-
-  return res;
-}
-
 - (void) dealloc {
   [ddata release];
 
@@ -16,6 +16,7 @@
 
 #import "ZXAztecDetector.h"
 #import "ZXAztecDetectorResult.h"
+#import "ZXDecodeTrace.h"
 #import "ZXErrors.h"
 #import "ZXGenericGF.h"
 #import "ZXGridSampler.h"
@@ -63,7 +64,7 @@
 
 - (NSArray *)bullEyeCornerPoints:(ZXAztecPoint *)pCenter;
 - (int)color:(ZXAztecPoint *)p1 p2:(ZXAztecPoint *)p2;
-- (BOOL)correctParameterData:(NSMutableArray *)parameterData compact:(BOOL)compact error:(NSError **)error;
+- (BOOL)correctParameterData:(BOOL *)parameterData compact:(BOOL)compact error:(NSError **)error;
 - (float)distance:(ZXAztecPoint *)a b:(ZXAztecPoint *)b;
 - (BOOL)extractParameters:(NSArray *)bullEyeCornerPoints error:(NSError **)error;
 - (ZXAztecPoint *)firstDifferent:(ZXAztecPoint *)init color:(BOOL)color dx:(int)dx dy:(int)dy;
@@ -71,14 +72,14 @@
 - (BOOL)isWhiteOrBlackRectangle:(ZXAztecPoint *)p1 p2:(ZXAztecPoint *)p2 p3:(ZXAztecPoint *)p3 p4:(ZXAztecPoint *)p4;
 - (ZXAztecPoint *)matrixCenterWithError:(NSError **)error;
 - (NSArray *)matrixCornerPoints:(NSArray *)bullEyeCornerPoints;
-- (void)parameters:(NSMutableArray *)parameterData;
+- (void)parameters:(const BOOL *)parameterData;
 - (ZXBitMatrix *)sampleGrid:(ZXBitMatrix *)image
                     topLeft:(ZXResultPoint *)topLeft
                  bottomLeft:(ZXResultPoint *)bottomLeft
                 bottomRight:(ZXResultPoint *)bottomRight
                    topRight:(ZXResultPoint *)topRight
                       error:(NSError **)error;
-- (NSArray *)sampleLine:(ZXAztecPoint *)p1 p2:(ZXAztecPoint *)p2 size:(int)size;
+- (int)sampleLine:(ZXAztecPoint *)p1 p2:(ZXAztecPoint *)p2 size:(int)size;
 
 @end
 
@@ -163,65 +164,58 @@
 
   int twoCenterLayers = 2 * self.nbCenterLayers;
 
-  // Get the bits around the bull's eye
-  NSArray *resab = [self sampleLine:p0 p2:p1 size:twoCenterLayers + 1];
-  NSArray *resbc = [self sampleLine:p1 p2:p2 size:twoCenterLayers + 1];
-  NSArray *rescd = [self sampleLine:p2 p2:p3 size:twoCenterLayers + 1];
-  NSArray *resda = [self sampleLine:p3 p2:p0 size:twoCenterLayers + 1];
+  // Get the bits around the bull's eye, sample i of each side in bit i
+  int resab = [self sampleLine:p0 p2:p1 size:twoCenterLayers + 1];
+  int resbc = [self sampleLine:p1 p2:p2 size:twoCenterLayers + 1];
+  int rescd = [self sampleLine:p2 p2:p3 size:twoCenterLayers + 1];
+  int resda = [self sampleLine:p3 p2:p0 size:twoCenterLayers + 1];
 
   // Determine the orientation of the matrix
-  if ([[resab objectAtIndex:0] boolValue] && [[resab objectAtIndex:twoCenterLayers] boolValue]) {
+  int corners = 1 | (1 << twoCenterLayers);
+  if ((resab & corners) == corners) {
     self.shift = 0;
-  } else if ([[resbc objectAtIndex:0] boolValue] && [[resbc objectAtIndex:twoCenterLayers] boolValue]) {
+  } else if ((resbc & corners) == corners) {
     self.shift = 1;
-  } else if ([[rescd objectAtIndex:0] boolValue] && [[rescd objectAtIndex:twoCenterLayers] boolValue]) {
+  } else if ((rescd & corners) == corners) {
     self.shift = 2;
-  } else if ([[resda objectAtIndex:0] boolValue] && [[resda objectAtIndex:twoCenterLayers] boolValue]) {
+  } else if ((resda & corners) == corners) {
     self.shift = 3;
   } else {
     if (error) *error = NotFoundErrorInstance();
     return NO;
   }
 
-  NSMutableArray *parameterData = [NSMutableArray array];
-  NSMutableArray *shiftedParameterData = [NSMutableArray array];
+  BOOL parameterData[40];
+  BOOL shiftedParameterData[40];
   if (self.compact) {
-    for (int i = 0; i < 28; i++) {
-      [shiftedParameterData addObject:[NSNumber numberWithBool:NO]];
-    }
-
     for (int i = 0; i < 7; i++) {
-      [shiftedParameterData replaceObjectAtIndex:i withObject:[resab objectAtIndex:2+i]];
-      [shiftedParameterData replaceObjectAtIndex:i + 7 withObject:[resbc objectAtIndex:2+i]];
-      [shiftedParameterData replaceObjectAtIndex:i + 14 withObject:[rescd objectAtIndex:2+i]];
-      [shiftedParameterData replaceObjectAtIndex:i + 21 withObject:[resda objectAtIndex:2+i]];
+      shiftedParameterData[i] = (resab >> (2 + i)) & 1;
+      shiftedParameterData[i + 7] = (resbc >> (2 + i)) & 1;
+      shiftedParameterData[i + 14] = (rescd >> (2 + i)) & 1;
+      shiftedParameterData[i + 21] = (resda >> (2 + i)) & 1;
     }
 
     for (int i = 0; i < 28; i++) {
-      [parameterData addObject:[shiftedParameterData objectAtIndex:(i + shift * 7) % 28]];
+      parameterData[i] = shiftedParameterData[(i + shift * 7) % 28];
     }
   } else {
-    for (int i = 0; i < 40; i++) {
-      [shiftedParameterData addObject:[NSNumber numberWithBool:NO]];
-    }
-
     for (int i = 0; i < 11; i++) {
       if (i < 5) {
-        [shiftedParameterData replaceObjectAtIndex:i withObject:[resab objectAtIndex:2 + i]];
-        [shiftedParameterData replaceObjectAtIndex:i + 10 withObject:[resbc objectAtIndex:2 + i]];
-        [shiftedParameterData replaceObjectAtIndex:i + 20 withObject:[rescd objectAtIndex:2 + i]];
-        [shiftedParameterData replaceObjectAtIndex:i + 30 withObject:[resda objectAtIndex:2 + i]];
+        shiftedParameterData[i] = (resab >> (2 + i)) & 1;
+        shiftedParameterData[i + 10] = (resbc >> (2 + i)) & 1;
+        shiftedParameterData[i + 20] = (rescd >> (2 + i)) & 1;
+        shiftedParameterData[i + 30] = (resda >> (2 + i)) & 1;
       }
       if (i > 5) {
-        [shiftedParameterData replaceObjectAtIndex:i - 1 withObject:[resab objectAtIndex:2 + i]];
-        [shiftedParameterData replaceObjectAtIndex:i + 9 withObject:[resbc objectAtIndex:2 + i]];
-        [shiftedParameterData replaceObjectAtIndex:i + 19 withObject:[rescd objectAtIndex:2 + i]];
-        [shiftedParameterData replaceObjectAtIndex:i + 29 withObject:[resda objectAtIndex:2 + i]];
+        shiftedParameterData[i - 1] = (resab >> (2 + i)) & 1;
+        shiftedParameterData[i + 9] = (resbc >> (2 + i)) & 1;
+        shiftedParameterData[i + 19] = (rescd >> (2 + i)) & 1;
+        shiftedParameterData[i + 29] = (resda >> (2 + i)) & 1;
       }
     }
 
     for (int i = 0; i < 40; i++) {
-      [parameterData addObject:[shiftedParameterData objectAtIndex:(i + shift * 10) % 40]];
+      parameterData[i] = shiftedParameterData[(i + shift * 10) % 40];
     }
   }
 
@@ -283,7 +277,7 @@
 /**
  * Corrects the parameter bits using Reed-Solomon algorithm
  */
-- (BOOL)correctParameterData:(NSMutableArray *)parameterData compact:(BOOL)isCompact error:(NSError **)error {
+- (BOOL)correctParameterData:(BOOL *)parameterData compact:(BOOL)isCompact error:(NSError **)error {
   int numCodewords;
   int numDataCodewords;
 
@@ -304,7 +298,7 @@
     parameterWords[i] = 0;
     int flag = 1;
     for (int j = 1; j <= codewordSize; j++) {
-      if ([[parameterData objectAtIndex:codewordSize * i + codewordSize - j] boolValue]) {
+      if (parameterData[codewordSize * i + codewordSize - j]) {
         parameterWords[i] += flag;
       }
       flag <<= 1;
@@ -325,8 +319,7 @@
   for (int i = 0; i < numDataCodewords; i++) {
     int flag = 1;
     for (int j = 1; j <= codewordSize; j++) {
-      [parameterData replaceObjectAtIndex:i * codewordSize + codewordSize - j
-                               withObject:[NSNumber numberWithBool:(parameterWords[i] & flag) == flag]];
+      parameterData[i * codewordSize + codewordSize - j] = (parameterWords[i] & flag) == flag;
       flag <<= 1;
     }
   }
@@ -491,33 +484,36 @@
 
   ZXGridSampler *sampler = [ZXGridSampler instance];
 
-  return [sampler sampleGrid:anImage
-                  dimensionX:dimension
-                  dimensionY:dimension
-                       p1ToX:0.5f
-                       p1ToY:0.5f
-                       p2ToX:dimension - 0.5f
-                       p2ToY:0.5f
-                       p3ToX:dimension - 0.5f
-                       p3ToY:dimension - 0.5f
-                       p4ToX:0.5f
-                       p4ToY:dimension - 0.5f
-                     p1FromX:topLeft.x
-                     p1FromY:topLeft.y
-                     p2FromX:topRight.x
-                     p2FromY:topRight.y
-                     p3FromX:bottomRight.x
-                     p3FromY:bottomRight.y
-                     p4FromX:bottomLeft.x
-                     p4FromY:bottomLeft.y
-                       error:error];
+  ZX_TRACE_BEGIN(traceStart);
+  ZXBitMatrix *bits = [sampler sampleGrid:anImage
+                               dimensionX:dimension
+                               dimensionY:dimension
+                                    p1ToX:0.5f
+                                    p1ToY:0.5f
+                                    p2ToX:dimension - 0.5f
+                                    p2ToY:0.5f
+                                    p3ToX:dimension - 0.5f
+                                    p3ToY:dimension - 0.5f
+                                    p4ToX:0.5f
+                                    p4ToY:dimension - 0.5f
+                                  p1FromX:topLeft.x
+                                  p1FromY:topLeft.y
+                                  p2FromX:topRight.x
+                                  p2FromY:topRight.y
+                                  p3FromX:bottomRight.x
+                                  p3FromY:bottomRight.y
+                                  p4FromX:bottomLeft.x
+                                  p4FromY:bottomLeft.y
+                                    error:error];
+  ZX_TRACE_END(traceStart, kZXDecodeStageSample);
+  return bits;
 }
 
 
 /**
  * Sets number of layers and number of data blocks from parameter bits
  */
-- (void)parameters:(NSArray *)parameterData {
+- (void)parameters:(const BOOL *)parameterData {
   int nbBitsForNbLayers;
   int nbBitsForNbDatablocks;
 
@@ -531,14 +527,14 @@
 
   for (int i = 0; i < nbBitsForNbLayers; i++) {
     self.nbLayers <<= 1;
-    if ([[parameterData objectAtIndex:i] boolValue]) {
+    if (parameterData[i]) {
       self.nbLayers++;
     }
   }
 
   for (int i = nbBitsForNbLayers; i < nbBitsForNbLayers + nbBitsForNbDatablocks; i++) {
     self.nbDataBlocks <<= 1;
-    if ([[parameterData objectAtIndex:i] boolValue]) {
+    if (parameterData[i]) {
       self.nbDataBlocks++;
     }
   }
@@ -551,8 +547,8 @@
 /**
  * Samples a line
  */
-- (NSArray *)sampleLine:(ZXAztecPoint *)p1 p2:(ZXAztecPoint *)p2 size:(int)size {
-  NSMutableArray *res = [NSMutableArray arrayWithCapacity:size];
+- (int)sampleLine:(ZXAztecPoint *)p1 p2:(ZXAztecPoint *)p2 size:(int)size {
+  int res = 0;
   float d = [self distance:p1 b:p2];
   float moduleSize = d / (size - 1);
   float dx = moduleSize * (p2.x - p1.x) / d;
@@ -562,7 +558,9 @@
   float py = p1.y;
 
   for (int i = 0; i < size; i++) {
-    [res addObject:[NSNumber numberWithBool:[self.image getX:[ZXMathUtils round:px] y:[ZXMathUtils round:py]]]];
+    if ([self.image getX:[ZXMathUtils round:px] y:[ZXMathUtils round:py]]) {
+      res |= 1 << i;
+    }
     px += dx;
     py += dy;
   }
@@ -570,7 +568,6 @@
   return res;
 }
 
-
 /**
  * return true if the border of the rectangle passed in parameter is compound of white points only
  * or black points only
@@ -174,7 +174,7 @@ static int WORD_SIZE[33] = {
   }
 
   // generate check words
-  ZXReedSolomonEncoder *rs = [[[ZXReedSolomonEncoder alloc] initWithField:[self getGF:wordSize]] autorelease];
+  ZXReedSolomonEncoder *rs = [ZXReedSolomonEncoder encoderForField:[self getGF:wordSize]];
   int totalSizeInFullWords = totalSymbolBits / wordSize;
 
   int messageWords[totalSizeInFullWords];
@@ -332,7 +332,7 @@ static int WORD_SIZE[33] = {
   for (int i = messageSizeInWords * wordSize - stuffedBits.size; i > 0; i--) {
     [stuffedBits appendBit:YES];
   }
-  ZXReedSolomonEncoder *rs = [[[ZXReedSolomonEncoder alloc] initWithField:[self getGF:wordSize]] autorelease];
+  ZXReedSolomonEncoder *rs = [ZXReedSolomonEncoder encoderForField:[self getGF:wordSize]];
   int totalSizeInFullWords = totalSymbolBits / wordSize;
 
   int messageWords[totalSizeInFullWords];
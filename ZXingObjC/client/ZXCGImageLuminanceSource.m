@@ -178,6 +178,11 @@
   return result;
 }
 
+- (const unsigned char *)borrowLuminances:(int *)rowStride {
+  *rowStride = self.width;
+  return data;
+}
+
 - (void)initializeWithImage:(CGImageRef)cgimage left:(int)_left top:(int)_top width:(int)_width height:(int)_height {
   data = 0;
   image = CGImageRetain(cgimage);
@@ -18,7 +18,7 @@
 #import "ZXCaptureDelegate.h"
 
 @protocol ZXReader;
-@class ZXDecodeHints;
+@class ZXDecodeHints, ZXFrameBufferPool;
 
 #if !TARGET_IPHONE_SIMULATOR
 #if TARGET_OS_EMBEDDED
@@ -75,6 +75,7 @@ ZX(<CAAction ZXAVC(AVCaptureVideoDataOutputSampleBufferDelegate)>) {
   int capture_device_index;
   CGAffineTransform transform;
   BOOL cameraIsReady;
+  ZXFrameBufferPool *bufferPool;
 }
 
 @property (nonatomic, assign) id<ZXCaptureDelegate> delegate;
@@ -20,6 +20,8 @@
 #include "ZXCGImageLuminanceSource.h"
 #include "ZXBinaryBitmap.h"
 #include "ZXDecodeHints.h"
+#include "ZXFrameBufferPool.h"
+#include "ZXFrameLuminanceSource.h"
 #include "ZXHybridBinarizer.h"
 #include "ZXMultiFormatReader.h"
 #include "ZXReader.h"
@@ -99,6 +101,51 @@ static bool isIPad();
   }
 }
 
+/**
+ * Reads luma straight out of the locked pixel buffer, rotated in the same pass, instead of copying
+ * the frame into a CGImage, drawing it rotated and drawing it once more to extract luma. Returns nil
+ * for pixel formats it doesn't know or rotations other than right angles, which take the CGImage path.
+ */
+- (ZXLuminanceSource *)frameLuminanceSource:(CVImageBufferRef)videoFrame {
+  int degrees = (int)rotation;
+  if (degrees != rotation || degrees % 90 != 0) {
+    return nil;
+  }
+  // Matches rotateImage:degrees:, which turns frames clockwise on iOS and counterclockwise on the Mac.
+#if TARGET_OS_EMBEDDED || TARGET_IPHONE_SIMULATOR
+  int clockwise = ((degrees % 360) + 360) % 360;
+#else
+  int clockwise = ((-degrees % 360) + 360) % 360;
+#endif
+
+  OSType pixelFormat = CVPixelBufferGetPixelFormatType(videoFrame);
+  BOOL planar = pixelFormat == kCVPixelFormatType_420YpCbCr8BiPlanarVideoRange ||
+                pixelFormat == kCVPixelFormatType_420YpCbCr8BiPlanarFullRange;
+  if (!planar && pixelFormat != kCVPixelFormatType_32BGRA) {
+    return nil;
+  }
+
+  CVPixelBufferLockBaseAddress(videoFrame, kCVPixelBufferLock_ReadOnly);
+  ZXFrameLuminanceSource *source;
+  if (planar) {
+    source = [[ZXFrameLuminanceSource alloc] initWithPixels:CVPixelBufferGetBaseAddressOfPlane(videoFrame, 0)
+                                                pixelFormat:kZXFramePixelFormatLuminance
+                                                  dataWidth:(int)CVPixelBufferGetWidthOfPlane(videoFrame, 0)
+                                                 dataHeight:(int)CVPixelBufferGetHeightOfPlane(videoFrame, 0)
+                                                bytesPerRow:(int)CVPixelBufferGetBytesPerRowOfPlane(videoFrame, 0)
+                                                   rotation:clockwise downscale:1 bufferPool:bufferPool];
+  } else {
+    source = [[ZXFrameLuminanceSource alloc] initWithPixels:CVPixelBufferGetBaseAddress(videoFrame)
+                                                pixelFormat:kZXFramePixelFormatBGRA
+                                                  dataWidth:(int)CVPixelBufferGetWidth(videoFrame)
+                                                 dataHeight:(int)CVPixelBufferGetHeight(videoFrame)
+                                                bytesPerRow:(int)CVPixelBufferGetBytesPerRow(videoFrame)
+                                                   rotation:clockwise downscale:1 bufferPool:bufferPool];
+  }
+  CVPixelBufferUnlockBaseAddress(videoFrame, kCVPixelBufferLock_ReadOnly);
+  return [source autorelease];
+}
+
 - (ZXCapture *)init {
   if ((self = [super init])) {
     on_screen = running = NO;
@@ -118,6 +165,7 @@ static bool isIPad();
       });
     self.reader = [ZXMultiFormatReader reader];
     self.hints = [ZXDecodeHints hints];
+    bufferPool = [[ZXFrameBufferPool alloc] init];
   }
   return self;
 }
@@ -492,6 +540,7 @@ static bool isIPad();
   [session release];
   [reader release];
   [hints release];
+  [bufferPool release];
   [super dealloc];
 }
 
@@ -566,26 +615,32 @@ ZXAV(didOutputSampleBuffer:(CMSampleBufferRef)sampleBuffer)
   }
 #endif
 
-  CGImageRef videoFrameImage = [ZXCGImageLuminanceSource createImageFromBuffer:videoFrame];
-  CGImageRef rotatedImage = [self rotateImage:videoFrameImage degrees:rotation];
-
-  ZXCGImageLuminanceSource *source
-    = [[[ZXCGImageLuminanceSource alloc]
-        initWithCGImage:rotatedImage]
-        autorelease];
-
-  if (luminance) {
-    CGImageRef image = source.image;
-    CGImageRetain(image);
-    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, 0), dispatch_get_main_queue(), ^{
-        luminance.contents = (id)image;
-        CGImageRelease(image);
-      });
+  // The luminance layer shows a CGImage, so only decode-only capture can skip making one.
+  ZXLuminanceSource *source = luminance ? nil : [self frameLuminanceSource:videoFrame];
+  if (!source) {
+    CGImageRef videoFrameImage = [ZXCGImageLuminanceSource createImageFromBuffer:videoFrame];
+    CGImageRef rotatedImage = [self rotateImage:videoFrameImage degrees:rotation];
+
+    ZXCGImageLuminanceSource *imageSource
+      = [[[ZXCGImageLuminanceSource alloc]
+          initWithCGImage:rotatedImage]
+          autorelease];
+    source = imageSource;
+
+    if (luminance) {
+      CGImageRef image = imageSource.image;
+      CGImageRetain(image);
+      dispatch_after(dispatch_time(DISPATCH_TIME_NOW, 0), dispatch_get_main_queue(), ^{
+          luminance.contents = (id)image;
+          CGImageRelease(image);
+        });
+    }
   }
 
   if (binary || delegate) {
     ZXHybridBinarizer *binarizer = [ZXHybridBinarizer alloc];
     [[binarizer initWithSource:source] autorelease];
+    binarizer.bufferPool = bufferPool;
 
     if (binary) {
       CGImageRef image = binarizer.createImage;
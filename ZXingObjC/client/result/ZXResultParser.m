@@ -68,6 +68,10 @@ static unichar BYTE_ORDER_MARK = L'\ufeff';
 @implementation ZXResultParser
 
 + (void)initialize {
+  if (self != [ZXResultParser class]) {
+    return;
+  }
+
   PARSERS = [[NSArray alloc] initWithObjects:
              [[[ZXBookmarkDoCoMoResultParser alloc] init] autorelease],
              [[[ZXAddressBookDoCoMoResultParser alloc] init] autorelease],
@@ -16,6 +16,11 @@
 
 /**
  * A simple, fast array of bits, represented compactly by an array of ints internally.
+ *
+ * The array can also be viewed as runs of equal bits, which is how the 1D readers walk a row.
+ * The runs are found with word scans on first use and cached until the array is next modified
+ * through one of its methods. Code that writes to bits directly must do so after clear and before
+ * asking for the runs.
  */
 
 @interface ZXBitArray : NSObject
@@ -40,5 +45,6 @@
 - (void)xor:(ZXBitArray *)other;
 - (void)toBytes:(int)bitOffset array:(unsigned char *)array offset:(int)offset numBytes:(int)numBytes;
 - (void)reverse;
+- (const int *)runStarts:(int *)runCount;
 
 @end
@@ -15,8 +15,14 @@
  */
 
 #import "ZXBitArray.h"
+#import "ZXDecodeTrace.h"
 
-@interface ZXBitArray ()
+@interface ZXBitArray () {
+  int *runs;
+  int runsCapacity;
+  int runsCount;
+  BOOL runsValid;
+}
 
 @property (nonatomic, assign) int size;
 @property (nonatomic, assign) int *bits;
@@ -24,10 +30,48 @@
 
 - (void)ensureCapacity:(int)aSize;
 - (int *)makeArray:(int)size;
-- (int)numberOfTrailingZeros:(int)i;
 
 @end
 
+#ifndef __has_builtin
+#define __has_builtin(x) 0
+#endif
+
+static inline unsigned int ZXBitArrayReverse32(unsigned int x) {
+#if __has_builtin(__builtin_bitreverse32)
+  return __builtin_bitreverse32(x);
+#else
+  x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+  x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+  x = ((x >> 4) & 0x0F0F0F0Fu) | ((x & 0x0F0F0F0Fu) << 4);
+  return __builtin_bswap32(x);
+#endif
+}
+
+/**
+ * Bits firstBit through lastBit inclusive, both within one word.
+ */
+static inline unsigned int ZXBitArrayMask(int firstBit, int lastBit) {
+  return (0xFFFFFFFFu >> (31 - lastBit)) & (0xFFFFFFFFu << firstBit);
+}
+
+/**
+ * Returns the index of the first bit at or after from that equals value, or size if there is none.
+ */
+static int ZXBitArrayNextBit(const int *bits, int bitsLength, int size, int from, BOOL value) {
+  int bitsOffset = from >> 5;
+  unsigned int flip = value ? 0 : 0xFFFFFFFFu;
+  unsigned int currentBits = ((unsigned int)bits[bitsOffset] ^ flip) & ~((1u << (from & 0x1F)) - 1);
+  while (currentBits == 0) {
+    if (++bitsOffset == bitsLength) {
+      return size;
+    }
+    currentBits = (unsigned int)bits[bitsOffset] ^ flip;
+  }
+  int result = (bitsOffset << 5) + __builtin_ctz(currentBits);
+  return result > size ? size : result;
+}
+
 @implementation ZXBitArray
 
 @synthesize bits;
@@ -50,6 +94,7 @@
     self.size = aSize;
     self.bits = [self makeArray:aSize];
     self.bitsLength = (aSize + 31) >> 5;
+    ZX_TRACE_COUNT(allocations, 1);
   }
 
   return self;
@@ -61,6 +106,7 @@
     free(bits);
     bits = NULL;
   }
+  free(runs);
 
   [super dealloc];
 }
@@ -69,31 +115,28 @@
   return (self.size + 7) >> 3;
 }
 
+/**
+ * Grows the array geometrically, so appending bit by bit copies each word a constant number of
+ * times on average. Words past size are always clear.
+ */
 - (void)ensureCapacity:(int)aSize {
-  if (aSize > self.bitsLength << 5) {
-    int *newBits = [self makeArray:aSize];
-    
-    for (int i = 0; i < self.bitsLength; i++) {
-      newBits[i] = self.bits[i];
-    }
-
-    if (self.bits != NULL) {
-      free(self.bits);
-      self.bits = NULL;
-    }
-    self.bits = newBits;
-    self.bitsLength = (aSize + 31) >> 5;
+  if (aSize > bitsLength << 5) {
+    int newLength = MAX((aSize + 31) >> 5, bitsLength + (bitsLength >> 1) + 1);
+    bits = (int *)realloc(bits, newLength * sizeof(int));
+    memset(bits + bitsLength, 0, (newLength - bitsLength) * sizeof(int));
+    bitsLength = newLength;
   }
 }
 
 
 - (BOOL)get:(int)i {
-  return (self.bits[i >> 5] & (1 << (i & 0x1F))) != 0;
+  return (bits[i >> 5] & (1 << (i & 0x1F))) != 0;
 }
 
 
 - (void)set:(int)i {
-  self.bits[i >> 5] |= 1 << (i & 0x1F);
+  bits[i >> 5] |= 1 << (i & 0x1F);
+  runsValid = NO;
 }
 
 
@@ -101,43 +144,22 @@
  * Flips bit i.
  */
 - (void)flip:(int)i {
-  self.bits[i >> 5] ^= 1 << (i & 0x1F);
+  bits[i >> 5] ^= 1 << (i & 0x1F);
+  runsValid = NO;
 }
 
 - (int)nextSet:(int)from {
-  if (from >= self.size) {
-    return self.size;
+  if (from >= size) {
+    return size;
   }
-  int bitsOffset = from >> 5;
-  int currentBits = self.bits[bitsOffset];
-  // mask off lesser bits first
-  currentBits &= ~((1 << (from & 0x1F)) - 1);
-  while (currentBits == 0) {
-    if (++bitsOffset == self.bitsLength) {
-      return self.size;
-    }
-    currentBits = self.bits[bitsOffset];
-  }
-  int result = (bitsOffset << 5) + [self numberOfTrailingZeros:currentBits];
-  return result > self.size ? self.size : result;
+  return ZXBitArrayNextBit(bits, bitsLength, size, from, YES);
 }
 
 - (int)nextUnset:(int)from {
-  if (from >= self.size) {
-    return self.size;
-  }
-  int bitsOffset = from >> 5;
-  int currentBits = ~self.bits[bitsOffset];
-  // mask off lesser bits first
-  currentBits &= ~((1 << (from & 0x1F)) - 1);
-  while (currentBits == 0) {
-    if (++bitsOffset == self.bitsLength) {
-      return size;
-    }
-    currentBits = ~self.bits[bitsOffset];
+  if (from >= size) {
+    return size;
   }
-  int result = (bitsOffset << 5) + [self numberOfTrailingZeros:currentBits];
-  return result > self.size ? self.size : result;
+  return ZXBitArrayNextBit(bits, bitsLength, size, from, NO);
 }
 
 /**
@@ -148,6 +170,7 @@
  */
 - (void)setBulk:(int)i newBits:(int)newBits {
   self.bits[i >> 5] = newBits;
+  runsValid = NO;
 }
 
 /**
@@ -160,22 +183,14 @@
   if (end == start) {
     return;
   }
+  runsValid = NO;
   end--; // will be easier to treat this as the last actually set bit -- inclusive
   int firstInt = start >> 5;
   int lastInt = end >> 5;
   for (int i = firstInt; i <= lastInt; i++) {
     int firstBit = i > firstInt ? 0 : start & 0x1F;
     int lastBit = i < lastInt ? 31 : end & 0x1F;
-    int mask;
-    if (firstBit == 0 && lastBit == 31) {
-      mask = -1;
-    } else {
-      mask = 0;
-      for (int j = firstBit; j <= lastBit; j++) {
-        mask |= 1 << j;
-      }
-    }
-    self.bits[i] |= mask;
+    bits[i] |= (int)ZXBitArrayMask(firstBit, lastBit);
   }
 }
 
@@ -184,6 +199,7 @@
  */
 - (void)clear {
   memset(self.bits, 0, self.bitsLength * sizeof(int));
+  runsValid = NO;
 }
 
 /**
@@ -200,20 +216,12 @@
   int firstInt = start >> 5;
   int lastInt = end >> 5;
 
+  unsigned int expected = value ? 0xFFFFFFFFu : 0;
   for (int i = firstInt; i <= lastInt; i++) {
     int firstBit = i > firstInt ? 0 : start & 0x1F;
     int lastBit = i < lastInt ? 31 : end & 0x1F;
-    int mask;
-    if (firstBit == 0 && lastBit == 31) {
-      mask = -1;
-    } else {
-      mask = 0;
-
-      for (int j = firstBit; j <= lastBit; j++) {
-        mask |= 1 << j;
-      }
-    }
-    if ((self.bits[i] & mask) != (value ? mask : 0)) {
+    unsigned int mask = ZXBitArrayMask(firstBit, lastBit);
+    if ((((unsigned int)bits[i] ^ expected) & mask) != 0) {
       return NO;
     }
   }
@@ -222,11 +230,12 @@
 }
 
 - (void)appendBit:(BOOL)bit {
-  [self ensureCapacity:self.size + 1];
+  [self ensureCapacity:size + 1];
   if (bit) {
-    self.bits[self.size >> 5] |= 1 << (self.size & 0x1F);
+    bits[size >> 5] |= 1 << (size & 0x1F);
   }
-  self.size++;
+  size++;
+  runsValid = NO;
 }
 
 /**
@@ -240,63 +249,144 @@
                                    reason:@"Num bits must be between 0 and 32"
                                  userInfo:nil];
   }
-  [self ensureCapacity:self.size + numBits];
-  for (int numBitsLeft = numBits; numBitsLeft > 0; numBitsLeft--) {
-    [self appendBit:((value >> (numBitsLeft - 1)) & 0x01) == 1];
+  if (numBits == 0) {
+    return;
+  }
+  [self ensureCapacity:size + numBits];
+  // Reversing puts the most significant of the numBits bits at the lowest index, as appended first.
+  unsigned int appended = ZXBitArrayReverse32((unsigned int)value) >> (32 - numBits);
+  int offset = size & 0x1F;
+  bits[size >> 5] |= (int)(appended << offset);
+  if (offset + numBits > 32) {
+    bits[(size >> 5) + 1] |= (int)(appended >> (32 - offset));
   }
+  size += numBits;
+  runsValid = NO;
 }
 
 - (void)appendBitArray:(ZXBitArray *)other {
   int otherSize = [other size];
-  [self ensureCapacity:self.size + otherSize];
+  if (otherSize == 0) {
+    return;
+  }
+  [self ensureCapacity:size + otherSize];
+
+  int otherWords = (otherSize + 31) >> 5;
+  const unsigned int *source = (const unsigned int *)other->bits;
+  unsigned int *copy = NULL;
+  if (other == self) {
+    copy = (unsigned int *)malloc(otherWords * sizeof(unsigned int));
+    memcpy(copy, bits, otherWords * sizeof(unsigned int));
+    source = copy;
+  }
 
-  for (int i = 0; i < otherSize; i++) {
-    [self appendBit:[other get:i]];
+  unsigned int *dest = (unsigned int *)bits + (size >> 5);
+  int offset = size & 0x1F;
+  unsigned int lastMask = (otherSize & 0x1F) == 0 ? 0xFFFFFFFFu : (1u << (otherSize & 0x1F)) - 1;
+  for (int i = 0; i < otherWords; i++) {
+    unsigned int word = i == otherWords - 1 ? source[i] & lastMask : source[i];
+    dest[i] |= word << offset;
+    // Any bits carried into the next word lie below size + otherSize, so that word exists.
+    if (offset != 0 && (word >> (32 - offset)) != 0) {
+      dest[i + 1] |= word >> (32 - offset);
+    }
   }
+  free(copy);
+  size += otherSize;
+  runsValid = NO;
 }
 
 - (void)xor:(ZXBitArray *)other {
-  if (self.bitsLength != other->bitsLength) {
+  if (size != other->size) {
     @throw [NSException exceptionWithName:NSInvalidArgumentException
                                    reason:@"Sizes don't match"
                                  userInfo:nil];
   }
 
-  for (int i = 0; i < self.bitsLength; i++) {
-    self.bits[i] ^= other.bits[i];
+  // The arrays may have grown to different capacities, but the words past size are clear in both.
+  int words = (size + 31) >> 5;
+  for (int i = 0; i < words; i++) {
+    bits[i] ^= other->bits[i];
   }
+  runsValid = NO;
 }
 
 
+/**
+ * Writes numBytes bytes starting at bitOffset, the bit at the lower index becoming the more
+ * significant bit of each byte. Each byte is cut out of one or two words and then bit-reversed.
+ */
 - (void)toBytes:(int)bitOffset array:(unsigned char *)array offset:(int)offset numBytes:(int)numBytes {
-  for (int i = 0; i < numBytes; i++) {
-    int theByte = 0;
-    for (int j = 0; j < 8; j++) {
-      if ([self get:bitOffset]) {
-        theByte |= 1 << (7 - j);
-      }
-      bitOffset++;
+  const unsigned int *words = (const unsigned int *)bits;
+  for (int i = 0; i < numBytes; i++, bitOffset += 8) {
+    int shift = bitOffset & 0x1F;
+    unsigned int theByte = words[bitOffset >> 5] >> shift;
+    if (shift > 24) {
+      theByte |= words[(bitOffset >> 5) + 1] << (32 - shift);
     }
-    array[offset + i] = (char)theByte;
+    array[offset + i] = (unsigned char)(ZXBitArrayReverse32(theByte & 0xFF) >> 24);
   }
 }
 
 /**
- * Reverses all bits in the array.
+ * Reverses all bits in the array, in place: the words are swapped end for end and bit-reversed,
+ * and then everything is shifted down over the clear bits that were above size in the last word.
  */
 - (void)reverse {
-  int *newBits = (int *)malloc(self.size * sizeof(int));
-  for (int i = 0; i < self.size; i++) {
-    newBits[i] = 0;
-    if ([self get:self.size - i - 1]) {
-      newBits[i >> 5] |= 1 << (i & 0x1F);
+  int words = (size + 31) >> 5;
+  unsigned int *reversed = (unsigned int *)bits;
+  for (int lo = 0, hi = words - 1; lo <= hi; lo++, hi--) {
+    unsigned int low = reversed[lo];
+    reversed[lo] = ZXBitArrayReverse32(reversed[hi]);
+    reversed[hi] = ZXBitArrayReverse32(low);
+  }
+  int padding = (words << 5) - size;
+  if (padding != 0) {
+    for (int i = 0; i < words - 1; i++) {
+      reversed[i] = (reversed[i] >> padding) | (reversed[i + 1] << (32 - padding));
+    }
+    reversed[words - 1] >>= padding;
+  }
+
+  // Reversing the bits reverses the runs; flip the cached run starts rather than scanning again.
+  if (runsValid) {
+    for (int lo = 0, hi = runsCount; lo <= hi; lo++, hi--) {
+      int start = runs[lo];
+      runs[lo] = self.size - runs[hi];
+      runs[hi] = self.size - start;
     }
   }
+}
+
+/**
+ * Returns the start of each run of equal bits: run k covers [runStarts[k], runStarts[k + 1]).
+ * runCount is set to the number of runs, and runStarts[runCount] is size. The first run is black
+ * (set) exactly when [self get:0] is YES. The returned array belongs to the receiver and is valid
+ * until the next modification.
+ */
+- (const int *)runStarts:(int *)runCount {
+  if (!runsValid) {
+    if (runsCapacity < self.size + 1) {
+      free(runs);
+      runsCapacity = self.size + 1;
+      runs = (int *)malloc(runsCapacity * sizeof(int));
+    }
 
-  if (self.bits != NULL) {
-    free(self.bits);
+    int count = 0;
+    if (self.size > 0) {
+      BOOL value = [self get:0];
+      for (int i = 0; i < self.size; i = ZXBitArrayNextBit(self.bits, self.bitsLength, self.size, i, value)) {
+        runs[count++] = i;
+        value = !value;
+      }
+    }
+    runs[count] = self.size;
+    runsCount = count;
+    runsValid = YES;
   }
-  self.bits = newBits;
+
+  *runCount = runsCount;
+  return runs;
 }
 
 - (int *)makeArray:(int)aSize {
@@ -319,16 +409,4 @@
   return result;
 }
 
-// Ported from OpenJDK Integer.numberOfTrailingZeros implementation
-- (int)numberOfTrailingZeros:(int)i {
-  int y;
-  if (i == 0) return 32;
-  int n = 31;
-  y = i <<16; if (y != 0) { n = n -16; i = y; }
-  y = i << 8; if (y != 0) { n = n - 8; i = y; }
-  y = i << 4; if (y != 0) { n = n - 4; i = y; }
-  y = i << 2; if (y != 0) { n = n - 2; i = y; }
-  return n - (int)(((unsigned int)(i << 1)) >> 31);
-}
-
 @end
@@ -34,6 +34,7 @@
 @property (nonatomic, readonly) int width;
 @property (nonatomic, readonly) int height;
 @property (nonatomic, readonly) int *bits;
+@property (nonatomic, readonly) int rowSize;
 
 + (ZXBitMatrix *)bitMatrixWithDimension:(int)dimension;
 + (ZXBitMatrix *)bitMatrixWithWidth:(int)width height:(int)height;
@@ -46,6 +47,7 @@
 - (void)flipX:(int)x y:(int)y;
 - (void)clear;
 - (void)setRegionAtLeft:(int)left top:(int)top width:(int)width height:(int)height;
+- (ZXBitMatrix *)regionAtLeft:(int)left top:(int)top width:(int)width height:(int)height;
 - (ZXBitArray *)rowAtY:(int)y row:(ZXBitArray *)row;
 - (void)setRowAtY:(int)y row:(ZXBitArray *)row;
 - (NSArray *)enclosingRectangle;
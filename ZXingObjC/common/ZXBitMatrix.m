@@ -16,6 +16,7 @@
 
 #import "ZXBitArray.h"
 #import "ZXBitMatrix.h"
+#import "ZXDecodeTrace.h"
 
 @interface ZXBitMatrix ()
 
@@ -60,6 +61,7 @@
     self.bitsSize = self.rowSize * self.height;
     self.bits = (int *)malloc(self.bitsSize * sizeof(int));
     [self clear];
+    ZX_TRACE_COUNT(allocations, 1);
   }
 
   return self;
@@ -127,12 +129,59 @@
                                    reason:@"The region must fit inside the matrix"
                                  userInfo:nil];
   }
+  // Each row sets the same masks over the same words, so work them out once.
+  int firstInt = left >> 5;
+  int lastInt = (right - 1) >> 5;
+  unsigned int firstMask = 0xFFFFFFFFu << (left & 0x1f);
+  unsigned int lastMask = 0xFFFFFFFFu >> (31 - ((right - 1) & 0x1f));
+  int *matrixBits = self.bits;
+  int matrixRowSize = self.rowSize;
   for (int y = top; y < bottom; y++) {
-    int offset = y * self.rowSize;
-    for (int x = left; x < right; x++) {
-      self.bits[offset + (x >> 5)] |= 1 << (x & 0x1f);
+    int *row = matrixBits + y * matrixRowSize;
+    for (int i = firstInt; i <= lastInt; i++) {
+      unsigned int mask = 0xFFFFFFFFu;
+      if (i == firstInt) {
+        mask &= firstMask;
+      }
+      if (i == lastInt) {
+        mask &= lastMask;
+      }
+      row[i] |= (int)mask;
+    }
+  }
+}
+
+/**
+ * Returns a new matrix holding a copy of the given region, shifting whole words at a time rather
+ * than copying bit by bit.
+ */
+- (ZXBitMatrix *)regionAtLeft:(int)left top:(int)top width:(int)aWidth height:(int)aHeight {
+  if (top < 0 || left < 0 || aWidth < 1 || aHeight < 1 || left + aWidth > self.width || top + aHeight > self.height) {
+    @throw [NSException exceptionWithName:NSInvalidArgumentException
+                                   reason:@"The region must fit inside the matrix"
+                                 userInfo:nil];
+  }
+
+  ZXBitMatrix *region = [[[ZXBitMatrix alloc] initWithWidth:aWidth height:aHeight] autorelease];
+  int shift = left & 0x1f;
+  int regionRowSize = region.rowSize;
+  // Bits past the right edge of the region in its last word must stay clear.
+  unsigned int lastMask = (aWidth & 0x1f) == 0 ? 0xFFFFFFFFu : (1u << (aWidth & 0x1f)) - 1;
+  for (int y = 0; y < aHeight; y++) {
+    const unsigned int *src = (const unsigned int *)self.bits + (top + y) * self.rowSize + (left >> 5);
+    const unsigned int *srcEnd = (const unsigned int *)self.bits + (top + y + 1) * self.rowSize;
+    unsigned int *dst = (unsigned int *)region.bits + y * regionRowSize;
+    for (int i = 0; i < regionRowSize; i++) {
+      unsigned int word = src[i] >> shift;
+      if (shift != 0 && src + i + 1 < srcEnd) {
+        word |= src[i + 1] << (32 - shift);
+      }
+      dst[i] = word;
     }
+    dst[regionRowSize - 1] &= lastMask;
   }
+
+  return region;
 }
 
 /**
@@ -151,9 +200,7 @@
 }
 
 - (void)setRowAtY:(int)y row:(ZXBitArray *)row {
-  for (int i = 0; i > self.rowSize; i++) {
-    self.bits[y * self.rowSize + i] = row.bits[y * self.rowSize + i];
-  }
+  memcpy(self.bits + y * self.rowSize, row.bits, self.rowSize * sizeof(int));
 }
 
 /**
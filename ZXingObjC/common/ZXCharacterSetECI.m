@@ -82,9 +82,6 @@ static NSMutableDictionary *ENCODING_TO_ECI = nil;
 }
 
 + (ZXCharacterSetECI *)characterSetECIByValue:(int)value {
-  if (VALUE_TO_ECI == nil) {
-    [self initialize];
-  }
   if (value < 0 || value >= 900) {
     return nil;
   }
@@ -93,9 +90,6 @@ static NSMutableDictionary *ENCODING_TO_ECI = nil;
 
 
 + (ZXCharacterSetECI *)characterSetECIByEncoding:(NSStringEncoding)encoding {
-  if (ENCODING_TO_ECI == nil) {
-    [self initialize];
-  }
   return [ENCODING_TO_ECI objectForKey:[NSNumber numberWithUnsignedInteger:encoding]];
 }
 
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2012 ZXing authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Per-decode tracing of where time goes: monotonic timestamps and durations for each pipeline
+ * stage, plus counts of rows scanned, detector candidates, corrected codewords and large buffer
+ * allocations.
+ *
+ * The hooks in the library compile out entirely unless it is built with ZX_DECODE_TRACE=1, as the
+ * Debug configuration is. With tracing compiled in, a hook costs one thread-local lookup while no
+ * trace is running on the thread, and a clock read or an increment while one is. ZXDecodeTrace
+ * itself is always available, so callers need no conditional code; without the hooks its counters
+ * stay zero.
+ *
+ * A trace records work done on the thread that began it. Stages run inside other stages are
+ * timed in both; grid sampling is part of detection, for example.
+ *
+ *   ZXDecodeTrace *trace = [ZXDecodeTrace trace];
+ *   [trace begin];
+ *   ZXResult *result = [reader decode:bitmap hints:hints error:&error];
+ *   [trace end];
+ *   ZXDecodeStats stats = trace.stats;
+ */
+
+#ifndef ZX_DECODE_TRACE
+#define ZX_DECODE_TRACE 0
+#endif
+
+typedef enum {
+  kZXDecodeStageBinarize = 0,
+  kZXDecodeStageDetect,
+  kZXDecodeStageSample,
+  kZXDecodeStageErrorCorrect,
+  kZXDecodeStageParse,
+  kZXDecodeStageCount
+} ZXDecodeStage;
+
+/**
+ * Times are monotonic nanoseconds. A stage that never ran has a zero count and zero times.
+ */
+typedef struct {
+  uint64_t startTime;
+  uint64_t endTime;
+  uint64_t stageFirstStart[kZXDecodeStageCount];
+  uint64_t stageLastEnd[kZXDecodeStageCount];
+  uint64_t stageDuration[kZXDecodeStageCount];
+  int stageCount[kZXDecodeStageCount];
+  int rowsScanned;
+  int candidatesFound;
+  int errorsCorrected;
+  int allocations;
+} ZXDecodeStats;
+
+uint64_t ZXDecodeTraceNow(void);
+ZXDecodeStats *ZXDecodeTraceCurrentStats(void);
+uint64_t ZXDecodeTraceBeginStage(void);
+void ZXDecodeTraceEndStage(ZXDecodeStage stage, uint64_t start);
+
+#if ZX_DECODE_TRACE
+#define ZX_TRACE_BEGIN(name) uint64_t name = ZXDecodeTraceBeginStage()
+#define ZX_TRACE_END(name, stage) ZXDecodeTraceEndStage(stage, name)
+#define ZX_TRACE_COUNT(counter, n) do { \
+    ZXDecodeStats *zxTraceStats = ZXDecodeTraceCurrentStats(); \
+    if (zxTraceStats) zxTraceStats->counter += (n); \
+  } while (0)
+#else
+#define ZX_TRACE_BEGIN(name)
+#define ZX_TRACE_END(name, stage)
+#define ZX_TRACE_COUNT(counter, n)
+#endif
+
+@interface ZXDecodeTrace : NSObject
+
+@property (nonatomic, assign, readonly) ZXDecodeStats stats;
+
++ (id)trace;
++ (BOOL)enabled;
++ (NSString *)nameOfStage:(ZXDecodeStage)stage;
+- (void)begin;
+- (void)end;
+- (NSDictionary *)dictionary;
+
+@end
@@ -0,0 +1,175 @@
+/*
+ * Copyright 2012 ZXing authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import <pthread.h>
+#if defined(__APPLE__)
+#import <mach/mach_time.h>
+#else
+#import <time.h>
+#endif
+#import "ZXDecodeTrace.h"
+
+static pthread_key_t ZXDecodeTraceKey;
+
+static pthread_key_t ZXDecodeTraceCurrentKey(void) {
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    pthread_key_create(&ZXDecodeTraceKey, NULL);
+  });
+  return ZXDecodeTraceKey;
+}
+
+uint64_t ZXDecodeTraceNow(void) {
+#if defined(__APPLE__)
+  static mach_timebase_info_data_t timebase;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    mach_timebase_info(&timebase);
+  });
+  return mach_absolute_time() * timebase.numer / timebase.denom;
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+#endif
+}
+
+ZXDecodeStats *ZXDecodeTraceCurrentStats(void) {
+  return (ZXDecodeStats *)pthread_getspecific(ZXDecodeTraceCurrentKey());
+}
+
+/**
+ * Returns 0 without reading the clock when no trace is running, so untraced decodes skip it.
+ */
+uint64_t ZXDecodeTraceBeginStage(void) {
+  return ZXDecodeTraceCurrentStats() ? ZXDecodeTraceNow() : 0;
+}
+
+void ZXDecodeTraceEndStage(ZXDecodeStage stage, uint64_t start) {
+  ZXDecodeStats *stats = ZXDecodeTraceCurrentStats();
+  if (!stats || start == 0) {
+    return;
+  }
+  uint64_t end = ZXDecodeTraceNow();
+  if (stats->stageCount[stage] == 0) {
+    stats->stageFirstStart[stage] = start;
+  }
+  stats->stageLastEnd[stage] = end;
+  stats->stageDuration[stage] += end - start;
+  stats->stageCount[stage]++;
+}
+
+@implementation ZXDecodeTrace {
+  ZXDecodeStats stats;
+  ZXDecodeStats *previous;
+  BOOL running;
+}
+
++ (id)trace {
+  return [[[self alloc] init] autorelease];
+}
+
++ (BOOL)enabled {
+  return ZX_DECODE_TRACE != 0;
+}
+
++ (NSString *)nameOfStage:(ZXDecodeStage)stage {
+  switch (stage) {
+    case kZXDecodeStageBinarize:
+      return @"binarize";
+    case kZXDecodeStageDetect:
+      return @"detect";
+    case kZXDecodeStageSample:
+      return @"sample";
+    case kZXDecodeStageErrorCorrect:
+      return @"errorCorrect";
+    case kZXDecodeStageParse:
+      return @"parse";
+    default:
+      return nil;
+  }
+}
+
+- (void)dealloc {
+  if (running) {
+    [self end];
+  }
+
+  [super dealloc];
+}
+
+- (ZXDecodeStats)stats {
+  return stats;
+}
+
+/**
+ * Clears the counters and makes this the current trace of the calling thread. Traces nest: a
+ * trace begun inside another takes over until it ends.
+ */
+- (void)begin {
+  if (running) {
+    [NSException raise:NSInternalInconsistencyException format:@"The trace is already running."];
+  }
+  pthread_key_t key = ZXDecodeTraceCurrentKey();
+  memset(&stats, 0, sizeof(stats));
+  previous = (ZXDecodeStats *)pthread_getspecific(key);
+  running = YES;
+  stats.startTime = ZXDecodeTraceNow();
+  pthread_setspecific(key, &stats);
+}
+
+/**
+ * Must be called on the thread that called begin.
+ */
+- (void)end {
+  if (!running) {
+    return;
+  }
+  stats.endTime = ZXDecodeTraceNow();
+  pthread_setspecific(ZXDecodeTraceCurrentKey(), previous);
+  previous = NULL;
+  running = NO;
+}
+
+/**
+ * Flattens the stats for export, with durations and stage offsets from the start in nanoseconds.
+ */
+- (NSDictionary *)dictionary {
+  NSMutableDictionary *stages = [NSMutableDictionary dictionaryWithCapacity:kZXDecodeStageCount];
+  for (int stage = 0; stage < kZXDecodeStageCount; stage++) {
+    if (stats.stageCount[stage] == 0) {
+      continue;
+    }
+    [stages setObject:[NSDictionary dictionaryWithObjectsAndKeys:
+                       [NSNumber numberWithInt:stats.stageCount[stage]], @"count",
+                       [NSNumber numberWithUnsignedLongLong:stats.stageDuration[stage]], @"duration",
+                       [NSNumber numberWithUnsignedLongLong:stats.stageFirstStart[stage] - stats.startTime], @"firstStart",
+                       [NSNumber numberWithUnsignedLongLong:stats.stageLastEnd[stage] - stats.startTime], @"lastEnd",
+                       nil]
+               forKey:[ZXDecodeTrace nameOfStage:(ZXDecodeStage)stage]];
+  }
+  uint64_t endTime = running ? ZXDecodeTraceNow() : stats.endTime;
+  return [NSDictionary dictionaryWithObjectsAndKeys:
+          [NSNumber numberWithUnsignedLongLong:endTime - stats.startTime], @"duration",
+          stages, @"stages",
+          [NSNumber numberWithInt:stats.rowsScanned], @"rowsScanned",
+          [NSNumber numberWithInt:stats.candidatesFound], @"candidatesFound",
+          [NSNumber numberWithInt:stats.errorsCorrected], @"errorsCorrected",
+          [NSNumber numberWithInt:stats.allocations], @"allocations",
+          nil];
+}
+
+@end
@@ -19,6 +19,13 @@
 #import "ZXErrors.h"
 #import "ZXPerspectiveTransform.h"
 
+@interface ZXDefaultGridSampler ()
+
+- (BOOL)gridInside:(ZXBitMatrix *)image dimensionX:(int)dimensionX dimensionY:(int)dimensionY transform:(ZXPerspectiveTransform *)transform;
+- (void)sampleInsideGrid:(ZXBitMatrix *)image bits:(ZXBitMatrix *)bits transform:(ZXPerspectiveTransform *)transform;
+
+@end
+
 @implementation ZXDefaultGridSampler
 
 - (ZXBitMatrix *)sampleGrid:(ZXBitMatrix *)image
@@ -55,6 +62,11 @@
     return nil;
   }
   ZXBitMatrix *bits = [[[ZXBitMatrix alloc] initWithWidth:dimensionX height:dimensionY] autorelease];
+  if ([self gridInside:image dimensionX:dimensionX dimensionY:dimensionY transform:transform]) {
+    [self sampleInsideGrid:image bits:bits transform:transform];
+    return bits;
+  }
+
   int pointsLen = dimensionX << 1;
   float pointsf[pointsLen];
   memset(pointsf, 0, pointsLen * sizeof(float));
@@ -88,4 +100,55 @@
   return bits;
 }
 
+/**
+ * A perspective transform maps the grid onto the convex quadrilateral spanned by its corners
+ * as long as the denominator keeps its sign across them, so if the four corner modules land
+ * inside the image with a pixel to spare, every module does and no per-module checks or nudging
+ * are needed.
+ */
+- (BOOL)gridInside:(ZXBitMatrix *)image dimensionX:(int)dimensionX dimensionY:(int)dimensionY transform:(ZXPerspectiveTransform *)transform {
+  float corners[8] = {0.5f, 0.5f, dimensionX - 0.5f, 0.5f, 0.5f, dimensionY - 0.5f, dimensionX - 0.5f, dimensionY - 0.5f};
+  if (![transform preservesConvexityOfPoints:corners pointsLen:8]) {
+    return NO;
+  }
+  [transform transformPoints:corners pointsLen:8];
+  for (int i = 0; i < 8; i += 2) {
+    if (!(corners[i] >= 1.0f && corners[i] < image.width - 1 &&
+          corners[i + 1] >= 1.0f && corners[i + 1] < image.height - 1)) {
+      return NO;
+    }
+  }
+  return YES;
+}
+
+/**
+ * Samples a grid already known to lie inside the image, reading the image words directly and
+ * filling each output word before storing it.
+ */
+- (void)sampleInsideGrid:(ZXBitMatrix *)image bits:(ZXBitMatrix *)bits transform:(ZXPerspectiveTransform *)transform {
+  int dimensionX = bits.width;
+  int dimensionY = bits.height;
+  const unsigned int *imageBits = (const unsigned int *)image.bits;
+  int imageRowSize = image.rowSize;
+  int rowSize = bits.rowSize;
+  float xValues[dimensionX];
+  float yValues[dimensionX];
+
+  for (int y = 0; y < dimensionY; y++) {
+    [transform transformGridRow:(float)y + 0.5f count:dimensionX xValues:xValues yValues:yValues];
+    int *row = bits.bits + y * rowSize;
+    for (int word = 0; word < rowSize; word++) {
+      int start = word << 5;
+      int end = MIN(start + 32, dimensionX);
+      unsigned int currentBits = 0;
+      for (int x = start; x < end; x++) {
+        int xx = (int)xValues[x];
+        int yy = (int)yValues[x];
+        currentBits |= ((imageBits[yy * imageRowSize + (xx >> 5)] >> (xx & 0x1F)) & 1) << (x & 0x1F);
+      }
+      row[word] = (int)currentBits;
+    }
+  }
+}
+
 @end
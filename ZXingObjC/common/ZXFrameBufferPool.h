@@ -0,0 +1,51 @@
+/*
+ * Copyright 2012 ZXing authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Recycles the large per-frame buffers of continuous scanning: the luminance copy, the binarized
+ * ZXBitMatrix, the black point grid and ZXBitArray rows. A scanning session keeps one pool and
+ * hands it to each frame's luminance source and binarizer.
+ *
+ * A buffer is checked out with one of the ...With... methods and checked back in with recycle:
+ * once its user is done with it. The luminance sources and binarizers that take buffers from a
+ * pool recycle them when they are deallocated; crops and rotations keep the source whose buffer
+ * they read alive until they are done. A buffer that is never recycled is simply freed when its
+ * last reference goes.
+ *
+ * Recycled buffers are matched by their exact dimensions, so a stream of equally sized frames
+ * settles on a fixed set of buffers. At most maxBufferCount recycled buffers are kept; beyond
+ * that the least recently recycled one is dropped, so a session whose frame size changes does not
+ * hold on to buffers of the old sizes.
+ *
+ * The pool is safe to use from several threads.
+ */
+
+@class ZXBitArray, ZXBitMatrix;
+
+@interface ZXFrameBufferPool : NSObject
+
+@property (nonatomic, assign, readonly) int allocationCount;
+@property (nonatomic, assign, readonly) int reuseCount;
+@property (nonatomic, assign, readonly) int recycledCount;
+@property (nonatomic, assign) int maxBufferCount;
+
+- (NSMutableData *)dataWithLength:(int)length;
+- (ZXBitMatrix *)bitMatrixWithWidth:(int)width height:(int)height;
+- (ZXBitArray *)bitArrayWithSize:(int)size;
+- (void)recycle:(id)buffer;
+- (void)removeAllBuffers;
+
+@end
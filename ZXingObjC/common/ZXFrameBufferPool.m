@@ -0,0 +1,253 @@
+/*
+ * Copyright 2012 ZXing authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import "ZXBitArray.h"
+#import "ZXBitMatrix.h"
+#import "ZXDecodeTrace.h"
+#import "ZXFrameBufferPool.h"
+
+const int FRAME_BUFFER_POOL_DEFAULT_MAX_BUFFERS = 32;
+
+enum {
+  ZXFrameBufferKindData,
+  ZXFrameBufferKindBitMatrix,
+  ZXFrameBufferKindBitArray
+};
+
+/**
+ * What a recycled buffer is matched on: its kind and exact dimensions.
+ */
+typedef struct {
+  int kind;
+  int width;
+  int height;
+} ZXFrameBufferKey;
+
+static const void *ZXFrameBufferKeyRetain(CFAllocatorRef allocator, const void *value) {
+  ZXFrameBufferKey *key = (ZXFrameBufferKey *)malloc(sizeof(ZXFrameBufferKey));
+  *key = *(const ZXFrameBufferKey *)value;
+  return key;
+}
+
+static void ZXFrameBufferKeyRelease(CFAllocatorRef allocator, const void *value) {
+  free((void *)value);
+}
+
+static Boolean ZXFrameBufferKeyEqual(const void *value1, const void *value2) {
+  const ZXFrameBufferKey *key1 = (const ZXFrameBufferKey *)value1;
+  const ZXFrameBufferKey *key2 = (const ZXFrameBufferKey *)value2;
+  return key1->kind == key2->kind && key1->width == key2->width && key1->height == key2->height;
+}
+
+static CFHashCode ZXFrameBufferKeyHash(const void *value) {
+  const ZXFrameBufferKey *key = (const ZXFrameBufferKey *)value;
+  return (CFHashCode)((key->kind * 31 + key->width) * 31 + key->height);
+}
+
+static ZXFrameBufferKey ZXFrameBufferKeyOf(id buffer) {
+  ZXFrameBufferKey key;
+  if ([buffer isKindOfClass:[ZXBitMatrix class]]) {
+    key.kind = ZXFrameBufferKindBitMatrix;
+    key.width = [(ZXBitMatrix *)buffer width];
+    key.height = [(ZXBitMatrix *)buffer height];
+  } else if ([buffer isKindOfClass:[ZXBitArray class]]) {
+    key.kind = ZXFrameBufferKindBitArray;
+    key.width = [(ZXBitArray *)buffer size];
+    key.height = 0;
+  } else {
+    key.kind = ZXFrameBufferKindData;
+    key.width = (int)[(NSData *)buffer length];
+    key.height = 0;
+  }
+  return key;
+}
+
+@interface ZXFrameBufferPool () {
+  // Recycled buffers by ZXFrameBufferKey, each an NSMutableArray with the most recent last
+  CFMutableDictionaryRef freeBuffers;
+  // The same buffers, least recently recycled first
+  NSMutableArray *recycleOrder;
+}
+
+@property (nonatomic, assign) int allocationCount;
+@property (nonatomic, assign) int reuseCount;
+
+- (id)checkOut:(ZXFrameBufferKey)key;
+- (void)evictToCount:(int)count;
+
+@end
+
+@implementation ZXFrameBufferPool
+
+@synthesize allocationCount;
+@synthesize reuseCount;
+@synthesize maxBufferCount;
+
+- (id)init {
+  if (self = [super init]) {
+    self.allocationCount = 0;
+    self.reuseCount = 0;
+    maxBufferCount = FRAME_BUFFER_POOL_DEFAULT_MAX_BUFFERS;
+    CFDictionaryKeyCallBacks keyCallBacks = {0, ZXFrameBufferKeyRetain, ZXFrameBufferKeyRelease, NULL,
+                                             ZXFrameBufferKeyEqual, ZXFrameBufferKeyHash};
+    freeBuffers = CFDictionaryCreateMutable(kCFAllocatorDefault, 0, &keyCallBacks, &kCFTypeDictionaryValueCallBacks);
+    recycleOrder = [[NSMutableArray alloc] init];
+  }
+
+  return self;
+}
+
+- (void)dealloc {
+  CFRelease(freeBuffers);
+  [recycleOrder release];
+
+  [super dealloc];
+}
+
+/**
+ * Returns a byte buffer of exactly length bytes. Its previous contents are undefined.
+ */
+- (NSMutableData *)dataWithLength:(int)length {
+  ZXFrameBufferKey key = {ZXFrameBufferKindData, length, 0};
+  NSMutableData *data = [self checkOut:key];
+  if (data == nil) {
+    data = [[[NSMutableData alloc] initWithLength:length] autorelease];
+    @synchronized(self) {
+      self.allocationCount++;
+    }
+    ZX_TRACE_COUNT(allocations, 1);
+  }
+  return data;
+}
+
+/**
+ * Returns a cleared bit matrix of the given dimensions.
+ */
+- (ZXBitMatrix *)bitMatrixWithWidth:(int)width height:(int)height {
+  ZXFrameBufferKey key = {ZXFrameBufferKindBitMatrix, width, height};
+  ZXBitMatrix *matrix = [self checkOut:key];
+  if (matrix != nil) {
+    [matrix clear];
+  } else {
+    matrix = [[[ZXBitMatrix alloc] initWithWidth:width height:height] autorelease];
+    @synchronized(self) {
+      self.allocationCount++;
+    }
+  }
+  return matrix;
+}
+
+/**
+ * Returns a cleared bit array of the given size.
+ */
+- (ZXBitArray *)bitArrayWithSize:(int)size {
+  ZXFrameBufferKey key = {ZXFrameBufferKindBitArray, size, 0};
+  ZXBitArray *array = [self checkOut:key];
+  if (array != nil) {
+    [array clear];
+  } else {
+    array = [[[ZXBitArray alloc] initWithSize:size] autorelease];
+    @synchronized(self) {
+      self.allocationCount++;
+    }
+  }
+  return array;
+}
+
+/**
+ * Checks a buffer back in. The caller must not use it afterwards; the pool may hand it out again
+ * right away. Recycling a buffer that is already in the pool does nothing.
+ */
+- (void)recycle:(id)buffer {
+  if (buffer == nil) {
+    return;
+  }
+  @synchronized(self) {
+    if ([recycleOrder indexOfObjectIdenticalTo:buffer] != NSNotFound) {
+      return;
+    }
+    ZXFrameBufferKey key = ZXFrameBufferKeyOf(buffer);
+    NSMutableArray *buffers = (NSMutableArray *)CFDictionaryGetValue(freeBuffers, &key);
+    if (buffers == nil) {
+      buffers = [NSMutableArray array];
+      CFDictionarySetValue(freeBuffers, &key, buffers);
+    }
+    [buffers addObject:buffer];
+    [recycleOrder addObject:buffer];
+    [self evictToCount:self.maxBufferCount];
+  }
+}
+
+- (int)recycledCount {
+  @synchronized(self) {
+    return (int)[recycleOrder count];
+  }
+}
+
+- (void)setMaxBufferCount:(int)count {
+  @synchronized(self) {
+    maxBufferCount = count;
+    [self evictToCount:count];
+  }
+}
+
+/**
+ * Drops the pool's references to all recycled buffers, for example when the frame size changes.
+ */
+- (void)removeAllBuffers {
+  @synchronized(self) {
+    CFDictionaryRemoveAllValues(freeBuffers);
+    [recycleOrder removeAllObjects];
+  }
+}
+
+/**
+ * Takes the most recently recycled buffer matching key out of the pool, or returns nil. The
+ * extra autoreleased reference keeps it alive for the caller once the pool lets go of it.
+ */
+- (id)checkOut:(ZXFrameBufferKey)key {
+  @synchronized(self) {
+    NSMutableArray *buffers = (NSMutableArray *)CFDictionaryGetValue(freeBuffers, &key);
+    id buffer = [buffers lastObject];
+    if (buffer == nil) {
+      return nil;
+    }
+    [[buffer retain] autorelease];
+    [buffers removeLastObject];
+    [recycleOrder removeObjectIdenticalTo:buffer];
+    self.reuseCount++;
+    return buffer;
+  }
+}
+
+/**
+ * Drops the least recently recycled buffers until at most count are left, along with the lists
+ * of sizes that no longer have any.
+ */
+- (void)evictToCount:(int)count {
+  while ((int)[recycleOrder count] > MAX(count, 0)) {
+    id oldest = [recycleOrder objectAtIndex:0];
+    ZXFrameBufferKey key = ZXFrameBufferKeyOf(oldest);
+    NSMutableArray *buffers = (NSMutableArray *)CFDictionaryGetValue(freeBuffers, &key);
+    [buffers removeObjectIdenticalTo:oldest];
+    if ([buffers count] == 0) {
+      CFDictionaryRemoveValue(freeBuffers, &key);
+    }
+    [recycleOrder removeObjectAtIndex:0];
+  }
+}
+
+@end
@@ -20,81 +20,194 @@
 #import "ZXErrors.h"
 #import "ZXLuminanceSource.h"
 
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define ZX_GLOBAL_HISTOGRAM_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define ZX_GLOBAL_HISTOGRAM_SSE2 1
+#endif
+
 int const LUMINANCE_BITS = 5;
 int const LUMINANCE_SHIFT = 8 - LUMINANCE_BITS;
 int const LUMINANCE_BUCKETS = 1 << LUMINANCE_BITS;
 
-@interface ZXGlobalHistogramBinarizer ()
+#define LUMINANCE_BUCKETS_LEN 32
 
-@property (nonatomic, assign) unsigned char *luminances;
-@property (nonatomic, assign) int luminancesCount;
-@property (nonatomic, retain) NSMutableArray *buckets;
+@interface ZXGlobalHistogramBinarizer ()
 
-- (void)initArrays:(int)luminanceSize;
-- (int)estimateBlackPoint:(NSArray *)buckets;
+- (int)estimateBlackPoint:(int *)buckets;
 
 @end
 
-@implementation ZXGlobalHistogramBinarizer
+/**
+ * Adds the luminances in [0, count) to buckets. Four interleaved partial histograms are used so
+ * that neighbouring pixels falling into the same bucket don't serialize on a single counter.
+ */
+static void ZXGlobalHistogramAccumulate(const unsigned char *luminances, int count, int *buckets) {
+  int partial[4][LUMINANCE_BUCKETS_LEN];
+  memset(partial, 0, sizeof(partial));
+
+  int x = 0;
+  for (; x + 4 <= count; x += 4) {
+    partial[0][luminances[x] >> LUMINANCE_SHIFT]++;
+    partial[1][luminances[x + 1] >> LUMINANCE_SHIFT]++;
+    partial[2][luminances[x + 2] >> LUMINANCE_SHIFT]++;
+    partial[3][luminances[x + 3] >> LUMINANCE_SHIFT]++;
+  }
+  for (; x < count; x++) {
+    partial[0][luminances[x] >> LUMINANCE_SHIFT]++;
+  }
 
-@synthesize luminances;
-@synthesize luminancesCount;
-@synthesize buckets;
+  for (int i = 0; i < LUMINANCE_BUCKETS_LEN; i++) {
+    buckets[i] += partial[0][i] + partial[1][i] + partial[2][i] + partial[3][i];
+  }
+}
 
-- (id)initWithSource:(ZXLuminanceSource *)source {
-  if (self = [super initWithSource:source]) {
-    self.luminances = NULL;
-    self.luminancesCount = 0;
-    self.buckets = [NSMutableArray arrayWithCapacity:LUMINANCE_BUCKETS];
+/**
+ * Scalar form of the sharpening filter: returns the bits, relative to base, for every x in
+ * [from, to) whose sharpened luminance is below blackPoint. Callers must keep x inside
+ * [1, width - 1) so both neighbours exist.
+ */
+static unsigned int ZXGlobalHistogramSharpenScalar(const unsigned char *luminances, int base, int from, int to, int blackPoint) {
+  unsigned int mask = 0;
+  for (int x = from; x < to; x++) {
+    int luminance = ((luminances[x] << 2) - luminances[x - 1] - luminances[x + 1]) >> 1;
+    if (luminance < blackPoint) {
+      mask |= 1u << (x - base);
+    }
   }
+  return mask;
+}
+
+/**
+ * Sharpens and thresholds the 8 pixels starting at x. Reads luminances[x - 1] through
+ * luminances[x + 8], which must all be in range.
+ */
+static inline unsigned int ZXGlobalHistogramSharpen8(const unsigned char *luminances, int x, int blackPoint) {
+#if defined(ZX_GLOBAL_HISTOGRAM_SSE2)
+  __m128i zero = _mm_setzero_si128();
+  __m128i left = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(luminances + x - 1)), zero);
+  __m128i center = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(luminances + x)), zero);
+  __m128i right = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(luminances + x + 1)), zero);
+  __m128i sharpened = _mm_srai_epi16(_mm_sub_epi16(_mm_sub_epi16(_mm_slli_epi16(center, 2), left), right), 1);
+  __m128i black = _mm_cmplt_epi16(sharpened, _mm_set1_epi16((short)blackPoint));
+  return (unsigned int)_mm_movemask_epi8(_mm_packs_epi16(black, zero)) & 0xFF;
+#elif defined(ZX_GLOBAL_HISTOGRAM_NEON)
+  static const uint8_t weights[8] = {1, 2, 4, 8, 16, 32, 64, 128};
+  int16x8_t left = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(luminances + x - 1)));
+  int16x8_t center = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(luminances + x)));
+  int16x8_t right = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(luminances + x + 1)));
+  int16x8_t sharpened = vshrq_n_s16(vsubq_s16(vsubq_s16(vshlq_n_s16(center, 2), left), right), 1);
+  uint8x8_t black = vand_u8(vmovn_u16(vcltq_s16(sharpened, vdupq_n_s16((int16_t)blackPoint))), vld1_u8(weights));
+  black = vpadd_u8(black, black);
+  black = vpadd_u8(black, black);
+  black = vpadd_u8(black, black);
+  return vget_lane_u8(black, 0);
+#else
+  return ZXGlobalHistogramSharpenScalar(luminances, x, x, x + 8, blackPoint);
+#endif
+}
 
-  return self;
+/**
+ * Applies the [-1 4 -1] / 2 sharpening filter to one row and ORs the resulting black pixels
+ * directly into the words of bits. The first and last pixels are never set.
+ */
+static void ZXGlobalHistogramSharpenRow(const unsigned char *luminances, int width, int blackPoint, int *bits) {
+  for (int base = 0; base < width; base += 32) {
+    unsigned int word = 0;
+    for (int x = base; x < base + 32 && x < width; x += 8) {
+      if (x >= 1 && x + 8 < width) {
+        word |= ZXGlobalHistogramSharpen8(luminances, x, blackPoint) << (x - base);
+      } else {
+        int from = x < 1 ? 1 : x;
+        int to = x + 8 < width - 1 ? x + 8 : width - 1;
+        word |= ZXGlobalHistogramSharpenScalar(luminances, base, from, to, blackPoint);
+      }
+    }
+    bits[base >> 5] |= (int)word;
+  }
 }
 
-- (void)dealloc {
-  if (luminances != NULL) {
-    free(luminances);
-    luminances = NULL;
+/**
+ * Returns one bit per pixel in [x, x + count) whose luminance is below blackPoint.
+ */
+static inline unsigned int ZXGlobalHistogramThreshold16(const unsigned char *luminances, int x, int count, int blackPoint) {
+  if (count == 16) {
+#if defined(ZX_GLOBAL_HISTOGRAM_SSE2)
+    // SSE2 only has a signed byte compare, so bias both sides into the signed range.
+    __m128i bias = _mm_set1_epi8((char)0x80);
+    __m128i pixels = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(luminances + x)), bias);
+    __m128i threshold = _mm_set1_epi8((char)(blackPoint ^ 0x80));
+    return (unsigned int)_mm_movemask_epi8(_mm_cmplt_epi8(pixels, threshold)) & 0xFFFF;
+#elif defined(ZX_GLOBAL_HISTOGRAM_NEON)
+    static const uint8_t weights[8] = {1, 2, 4, 8, 16, 32, 64, 128};
+    uint8x16_t black = vcltq_u8(vld1q_u8(luminances + x), vdupq_n_u8((uint8_t)blackPoint));
+    uint8x8_t low = vand_u8(vget_low_u8(black), vld1_u8(weights));
+    uint8x8_t high = vand_u8(vget_high_u8(black), vld1_u8(weights));
+    uint8x8_t sum = vpadd_u8(low, high);
+    sum = vpadd_u8(sum, sum);
+    sum = vpadd_u8(sum, sum);
+    return vget_lane_u8(sum, 0) | ((unsigned int)vget_lane_u8(sum, 1) << 8);
+#endif
   }
-  [buckets release];
 
-  [super dealloc];
+  unsigned int mask = 0;
+  for (int i = 0; i < count; i++) {
+    if (luminances[x + i] < blackPoint) {
+      mask |= 1u << i;
+    }
+  }
+  return mask;
 }
 
+/**
+ * Thresholds one row against blackPoint and ORs the black pixels directly into the words of bits.
+ */
+static void ZXGlobalHistogramThresholdRow(const unsigned char *luminances, int width, int blackPoint, int *bits) {
+  for (int base = 0; base < width; base += 32) {
+    unsigned int word = 0;
+    for (int x = base; x < base + 32 && x < width; x += 16) {
+      int count = width - x < 16 ? width - x : 16;
+      word |= ZXGlobalHistogramThreshold16(luminances, x, count, blackPoint) << (x - base);
+    }
+    bits[base >> 5] |= (int)word;
+  }
+}
+
+@implementation ZXGlobalHistogramBinarizer
+
 - (ZXBitArray *)blackRow:(int)y row:(ZXBitArray *)row error:(NSError **)error {
   ZXLuminanceSource *source = self.luminanceSource;
   int width = source.width;
   if (row == nil || row.size < width) {
-    row = [[[ZXBitArray alloc] initWithSize:width] autorelease];
+    row = [self bitArrayWithSize:width];
   } else {
     [row clear];
   }
 
-  [self initArrays:width];
-  unsigned char *localLuminances = [source row:y];
-  NSMutableArray *localBuckets = [NSMutableArray arrayWithArray:buckets];
-  for (int x = 0; x < width; x++) {
-    int pixel = localLuminances[x] & 0xff;
-    [localBuckets replaceObjectAtIndex:pixel >> LUMINANCE_SHIFT
-                            withObject:[NSNumber numberWithInt:[[localBuckets objectAtIndex:pixel >> LUMINANCE_SHIFT] intValue] + 1]];
+  // Read the row in place when the source allows it; copiedLuminances is only set otherwise.
+  int stride;
+  unsigned char *copiedLuminances = NULL;
+  const unsigned char *localLuminances = [source borrowLuminances:&stride];
+  if (localLuminances != NULL) {
+    localLuminances += y * stride;
+  } else {
+    localLuminances = copiedLuminances = [source row:y];
   }
+
+  int localBuckets[LUMINANCE_BUCKETS_LEN];
+  memset(localBuckets, 0, sizeof(localBuckets));
+  ZXGlobalHistogramAccumulate(localLuminances, width, localBuckets);
   int blackPoint = [self estimateBlackPoint:localBuckets];
   if (blackPoint == -1) {
+    free(copiedLuminances);
     if (error) *error = NotFoundErrorInstance();
     return nil;
   }
 
-  int left = localLuminances[0] & 0xff;
-  int center = localLuminances[1] & 0xff;
-  for (int x = 1; x < width - 1; x++) {
-    int right = localLuminances[x + 1] & 0xff;
-    int luminance = ((center << 2) - left - right) >> 1;
-    if (luminance < blackPoint) {
-      [row set:x];
-    }
-    left = center;
-    center = right;
-  }
+  ZXGlobalHistogramSharpenRow(localLuminances, width, blackPoint, row.bits);
+  free(copiedLuminances);
 
   return row;
 }
@@ -103,72 +216,61 @@ int const LUMINANCE_BUCKETS = 1 << LUMINANCE_BITS;
   ZXLuminanceSource *source = self.luminanceSource;
   int width = source.width;
   int height = source.height;
-  ZXBitMatrix *matrix = [[[ZXBitMatrix alloc] initWithWidth:width height:height] autorelease];
+  ZXBitMatrix *matrix = [self bitMatrixWithWidth:width height:height];
 
-  [self initArrays:width];
-  NSMutableArray *localBuckets = [NSMutableArray arrayWithArray:self.buckets];
+  // Read the luminance in place when the source allows it; copiedLuminances is only set otherwise.
+  int stride;
+  unsigned char *copiedLuminances = NULL;
+  const unsigned char *localLuminances = [source borrowLuminances:&stride];
+  if (localLuminances == NULL) {
+    localLuminances = copiedLuminances = source.matrix;
+    stride = width;
+  }
+
+  int localBuckets[LUMINANCE_BUCKETS_LEN];
+  memset(localBuckets, 0, sizeof(localBuckets));
   for (int y = 1; y < 5; y++) {
     int row = height * y / 5;
-    unsigned char *localLuminances = [source row:row];
+    int left = width / 5;
     int right = (width << 2) / 5;
-    for (int x = width / 5; x < right; x++) {
-      int pixel = localLuminances[x] & 0xff;
-      [localBuckets replaceObjectAtIndex:pixel >> LUMINANCE_SHIFT
-                              withObject:[NSNumber numberWithInt:[[localBuckets objectAtIndex:pixel >> LUMINANCE_SHIFT] intValue] + 1]];
-    }
+    ZXGlobalHistogramAccumulate(localLuminances + row * stride + left, right - left, localBuckets);
   }
   int blackPoint = [self estimateBlackPoint:localBuckets];
   if (blackPoint == -1) {
+    free(copiedLuminances);
     if (error) *error = NotFoundErrorInstance();
     return nil;
   }
 
-  unsigned char *localLuminances = source.matrix;
+  int *bits = matrix.bits;
+  int rowSize = matrix.rowSize;
   for (int y = 0; y < height; y++) {
-    int offset = y * width;
-    for (int x = 0; x < width; x++) {
-      int pixel = localLuminances[offset + x] & 0xff;
-      if (pixel < blackPoint) {
-        [matrix setX:x y:y];
-      }
-    }
+    ZXGlobalHistogramThresholdRow(localLuminances + y * stride, width, blackPoint, bits + y * rowSize);
   }
+  free(copiedLuminances);
 
   return matrix;
 }
 
 - (ZXBinarizer *)createBinarizer:(ZXLuminanceSource *)source {
-  return [[[ZXGlobalHistogramBinarizer alloc] initWithSource:source] autorelease];
-}
-
-- (void)initArrays:(int)luminanceSize {
-  if (self.luminances == NULL || self.luminancesCount < luminanceSize) {
-    if (self.luminances != NULL) {
-      free(self.luminances);
-    }
-    self.luminances = (unsigned char *)malloc(luminanceSize * sizeof(unsigned char));
-    self.luminancesCount = luminanceSize;
-  }
-
-  self.buckets = [NSMutableArray arrayWithCapacity:LUMINANCE_BUCKETS];
-  for (int x = 0; x < LUMINANCE_BUCKETS; x++) {
-    [self.buckets addObject:[NSNumber numberWithInt:0]];
-  }
+  ZXGlobalHistogramBinarizer *binarizer = [[[ZXGlobalHistogramBinarizer alloc] initWithSource:source] autorelease];
+  binarizer.bufferPool = self.bufferPool;
+  return binarizer;
 }
 
-- (int)estimateBlackPoint:(NSArray *)otherBuckets {
-  int numBuckets = [otherBuckets count];
+- (int)estimateBlackPoint:(int *)buckets {
+  int numBuckets = LUMINANCE_BUCKETS;
   int maxBucketCount = 0;
   int firstPeak = 0;
   int firstPeakSize = 0;
 
   for (int x = 0; x < numBuckets; x++) {
-    if ([[otherBuckets objectAtIndex:x] intValue] > firstPeakSize) {
+    if (buckets[x] > firstPeakSize) {
       firstPeak = x;
-      firstPeakSize = [[otherBuckets objectAtIndex:x] intValue];
+      firstPeakSize = buckets[x];
     }
-    if ([[otherBuckets objectAtIndex:x] intValue] > maxBucketCount) {
-      maxBucketCount = [[otherBuckets objectAtIndex:x] intValue];
+    if (buckets[x] > maxBucketCount) {
+      maxBucketCount = buckets[x];
     }
   }
 
@@ -176,7 +278,7 @@ int const LUMINANCE_BUCKETS = 1 << LUMINANCE_BITS;
   int secondPeakScore = 0;
   for (int x = 0; x < numBuckets; x++) {
     int distanceToBiggest = x - firstPeak;
-    int score = [[otherBuckets objectAtIndex:x] intValue] * distanceToBiggest * distanceToBiggest;
+    int score = buckets[x] * distanceToBiggest * distanceToBiggest;
     if (score > secondPeakScore) {
       secondPeak = x;
       secondPeakScore = score;
@@ -197,7 +299,7 @@ int const LUMINANCE_BUCKETS = 1 << LUMINANCE_BITS;
   int bestValleyScore = -1;
   for (int x = secondPeak - 1; x > firstPeak; x--) {
     int fromFirst = x - firstPeak;
-    int score = fromFirst * fromFirst * (secondPeak - x) * (maxBucketCount - [[otherBuckets objectAtIndex:x] intValue]);
+    int score = fromFirst * fromFirst * (secondPeak - x) * (maxBucketCount - buckets[x]);
     if (score > bestValleyScore) {
       bestValley = x;
       bestValleyScore = score;
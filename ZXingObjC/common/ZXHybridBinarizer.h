@@ -36,4 +36,11 @@
 
 @interface ZXHybridBinarizer : ZXGlobalHistogramBinarizer
 
+/**
+ * The number of bands of 8-pixel block rows that blackMatrixWithError: splits the image into and
+ * binarizes concurrently on the global dispatch queue. The result is identical to the serial
+ * path. Defaults to 1 (serial); worth raising for multi-megapixel stills.
+ */
+@property (nonatomic, assign) int concurrency;
+
 @end
@@ -16,6 +16,14 @@
 
 #import "ZXHybridBinarizer.h"
 
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define ZX_HYBRID_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define ZX_HYBRID_SSE2 1
+#endif
+
 // This class uses 5x5 blocks to compute local luminance, where each block is 8x8 pixels.
 // So this is the smallest dimension in each axis we can accept.
 const int BLOCK_SIZE_POWER = 3;
@@ -28,20 +36,141 @@ const int MIN_DYNAMIC_RANGE = 24;
 
 @property (nonatomic, retain) ZXBitMatrix *matrix;
 
-- (int **)calculateBlackPoints:(unsigned char *)luminances subWidth:(int)subWidth subHeight:(int)subHeight width:(int)width height:(int)height;
-- (void)calculateThresholdForBlock:(unsigned char *)luminances subWidth:(int)subWidth subHeight:(int)subHeight width:(int)width height:(int)height blackPoints:(int **)blackPoints matrix:(ZXBitMatrix *)matrix;
+- (int **)calculateBlackPoints:(const unsigned char *)luminances subWidth:(int)subWidth subHeight:(int)subHeight width:(int)width height:(int)height stride:(int)stride;
+- (void)calculateThresholdForBlock:(const unsigned char *)luminances subWidth:(int)subWidth subHeight:(int)subHeight width:(int)width height:(int)height stride:(int)stride blackPoints:(int **)blackPoints matrix:(ZXBitMatrix *)matrix;
 - (int)cap:(int)value min:(int)min max:(int)max;
-- (void)thresholdBlock:(unsigned char *)luminances xoffset:(int)xoffset yoffset:(int)yoffset threshold:(int)threshold stride:(int)stride matrix:(ZXBitMatrix *)matrix;
+- (void)processBlockRows:(int)subHeight height:(int)height usingBlock:(void (^)(int startRow, int endRow))block;
 
 @end
 
+/**
+ * Computes the sum, minimum and maximum of the 8x8 block of pixels starting at offset.
+ */
+static void ZXHybridBlockStatistics(const unsigned char *luminances, int offset, int stride, int *sum, int *min, int *max) {
+#if defined(ZX_HYBRID_SSE2)
+  __m128i zero = _mm_setzero_si128();
+  __m128i sad = zero;
+  __m128i minimum = _mm_set1_epi8((char)0xFF);
+  __m128i maximum = zero;
+  for (int yy = 0; yy < 8; yy += 2, offset += stride << 1) {
+    __m128i rows = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)(luminances + offset)),
+                                      _mm_loadl_epi64((const __m128i *)(luminances + offset + stride)));
+    sad = _mm_add_epi64(sad, _mm_sad_epu8(rows, zero));
+    minimum = _mm_min_epu8(minimum, rows);
+    maximum = _mm_max_epu8(maximum, rows);
+  }
+  minimum = _mm_min_epu8(minimum, _mm_srli_si128(minimum, 8));
+  minimum = _mm_min_epu8(minimum, _mm_srli_si128(minimum, 4));
+  minimum = _mm_min_epu8(minimum, _mm_srli_si128(minimum, 2));
+  minimum = _mm_min_epu8(minimum, _mm_srli_si128(minimum, 1));
+  maximum = _mm_max_epu8(maximum, _mm_srli_si128(maximum, 8));
+  maximum = _mm_max_epu8(maximum, _mm_srli_si128(maximum, 4));
+  maximum = _mm_max_epu8(maximum, _mm_srli_si128(maximum, 2));
+  maximum = _mm_max_epu8(maximum, _mm_srli_si128(maximum, 1));
+  *sum = _mm_cvtsi128_si32(sad) + _mm_extract_epi16(sad, 4);
+  *min = _mm_cvtsi128_si32(minimum) & 0xFF;
+  *max = _mm_cvtsi128_si32(maximum) & 0xFF;
+#elif defined(ZX_HYBRID_NEON)
+  uint16x8_t total = vdupq_n_u16(0);
+  uint8x8_t minimum = vdup_n_u8(0xFF);
+  uint8x8_t maximum = vdup_n_u8(0);
+  for (int yy = 0; yy < 8; yy++, offset += stride) {
+    uint8x8_t row = vld1_u8(luminances + offset);
+    total = vaddw_u8(total, row);
+    minimum = vmin_u8(minimum, row);
+    maximum = vmax_u8(maximum, row);
+  }
+  minimum = vpmin_u8(minimum, minimum);
+  minimum = vpmin_u8(minimum, minimum);
+  minimum = vpmin_u8(minimum, minimum);
+  maximum = vpmax_u8(maximum, maximum);
+  maximum = vpmax_u8(maximum, maximum);
+  maximum = vpmax_u8(maximum, maximum);
+  uint64x2_t wide = vpaddlq_u32(vpaddlq_u16(total));
+  *sum = (int)(vgetq_lane_u64(wide, 0) + vgetq_lane_u64(wide, 1));
+  *min = vget_lane_u8(minimum, 0);
+  *max = vget_lane_u8(maximum, 0);
+#else
+  int total = 0;
+  int minimum = 0xFF;
+  int maximum = 0;
+  for (int yy = 0; yy < 8; yy++, offset += stride) {
+    for (int xx = 0; xx < 8; xx++) {
+      int pixel = luminances[offset + xx];
+      total += pixel;
+      if (pixel < minimum) {
+        minimum = pixel;
+      }
+      if (pixel > maximum) {
+        maximum = pixel;
+      }
+    }
+  }
+  *sum = total;
+  *min = minimum;
+  *max = maximum;
+#endif
+}
+
+/**
+ * Returns one bit per pixel, least significant first, for each of the 8 pixels starting at
+ * offset whose luminance is <= threshold.
+ */
+static inline unsigned int ZXHybridThreshold8(const unsigned char *luminances, int offset, int threshold) {
+#if defined(ZX_HYBRID_SSE2)
+  __m128i pixels = _mm_loadl_epi64((const __m128i *)(luminances + offset));
+  __m128i black = _mm_cmpeq_epi8(_mm_min_epu8(pixels, _mm_set1_epi8((char)threshold)), pixels);
+  return (unsigned int)_mm_movemask_epi8(black) & 0xFF;
+#elif defined(ZX_HYBRID_NEON)
+  static const uint8_t weights[8] = {1, 2, 4, 8, 16, 32, 64, 128};
+  uint8x8_t black = vand_u8(vcle_u8(vld1_u8(luminances + offset), vdup_n_u8((uint8_t)threshold)), vld1_u8(weights));
+  black = vpadd_u8(black, black);
+  black = vpadd_u8(black, black);
+  black = vpadd_u8(black, black);
+  return vget_lane_u8(black, 0);
+#else
+  unsigned int mask = 0;
+  for (int x = 0; x < 8; x++) {
+    if (luminances[offset + x] <= threshold) {
+      mask |= 1u << x;
+    }
+  }
+  return mask;
+#endif
+}
+
+/**
+ * Applies a single threshold to a block of pixels, ORing each row of 8 results directly into the
+ * row words of bits. Blocks clamped to the right edge need not be word-aligned, so a row may
+ * straddle two words.
+ */
+static void ZXHybridThresholdBlock(const unsigned char *luminances, int xoffset, int yoffset, int threshold,
+                                   int stride, int *bits, int rowSize) {
+  int word = xoffset >> 5;
+  int shift = xoffset & 0x1F;
+  int *rowBits = bits + yoffset * rowSize + word;
+  for (int y = 0, offset = yoffset * stride + xoffset; y < BLOCK_SIZE; y++, offset += stride, rowBits += rowSize) {
+    // Comparison needs to be <= so that black == 0 pixels are black even if the threshold is 0
+    unsigned int mask = ZXHybridThreshold8(luminances, offset, threshold);
+    if (mask == 0) {
+      continue;
+    }
+    rowBits[0] |= (int)(mask << shift);
+    if (shift > 32 - BLOCK_SIZE) {
+      rowBits[1] |= (int)(mask >> (32 - shift));
+    }
+  }
+}
+
 @implementation ZXHybridBinarizer
 
 @synthesize matrix;
+@synthesize concurrency;
 
 - (id)initWithSource:(ZXLuminanceSource *)aSource {
   if (self = [super initWithSource:aSource]) {
     self.matrix = nil;
+    self.concurrency = 1;
   }
 
   return self;
@@ -66,7 +195,14 @@ const int MIN_DYNAMIC_RANGE = 24;
   int width = source.width;
   int height = source.height;
   if (width >= MINIMUM_DIMENSION && height >= MINIMUM_DIMENSION) {
-    unsigned char *_luminances = source.matrix;
+    // Read the luminance in place when the source allows it; copiedLuminances is only set otherwise.
+    int stride;
+    unsigned char *copiedLuminances = NULL;
+    const unsigned char *_luminances = [source borrowLuminances:&stride];
+    if (_luminances == NULL) {
+      _luminances = copiedLuminances = source.matrix;
+      stride = width;
+    }
     int subWidth = width >> BLOCK_SIZE_POWER;
     if ((width & BLOCK_SIZE_MASK) != 0) {
       subWidth++;
@@ -75,18 +211,13 @@ const int MIN_DYNAMIC_RANGE = 24;
     if ((height & BLOCK_SIZE_MASK) != 0) {
       subHeight++;
     }
-    int **blackPoints = [self calculateBlackPoints:_luminances subWidth:subWidth subHeight:subHeight width:width height:height];
+    int **blackPoints = [self calculateBlackPoints:_luminances subWidth:subWidth subHeight:subHeight width:width height:height stride:stride];
 
-    ZXBitMatrix *newMatrix = [[[ZXBitMatrix alloc] initWithWidth:width height:height] autorelease];
-    [self calculateThresholdForBlock:_luminances subWidth:subWidth subHeight:subHeight width:width height:height blackPoints:blackPoints matrix:newMatrix];
+    ZXBitMatrix *newMatrix = [self bitMatrixWithWidth:width height:height];
+    [self calculateThresholdForBlock:_luminances subWidth:subWidth subHeight:subHeight width:width height:height stride:stride blackPoints:blackPoints matrix:newMatrix];
     self.matrix = newMatrix;
 
-    free(_luminances);
-
-    for (int i = 0; i < subHeight; i++) {
-      free(blackPoints[i]);
-    }
-    free(blackPoints);
+    free(copiedLuminances);
   } else {
     // If the image is too small, fall back to the global histogram approach.
     self.matrix = [super blackMatrixWithError:error];
@@ -95,7 +226,35 @@ const int MIN_DYNAMIC_RANGE = 24;
 }
 
 - (ZXBinarizer *)createBinarizer:(ZXLuminanceSource *)source {
-  return [[[ZXHybridBinarizer alloc] initWithSource:source] autorelease];
+  ZXHybridBinarizer *binarizer = [[[ZXHybridBinarizer alloc] initWithSource:source] autorelease];
+  binarizer.concurrency = self.concurrency;
+  binarizer.bufferPool = self.bufferPool;
+  return binarizer;
+}
+
+/**
+ * Runs block over [0, subHeight) block rows, either in one call or split into up to concurrency
+ * bands run on the global concurrent queue. Bands only write the black points and pixel rows
+ * they own; the 5x5 neighbourhood reads that cross band edges are satisfied because all black
+ * points are resolved before any thresholding starts.
+ */
+- (void)processBlockRows:(int)subHeight height:(int)height usingBlock:(void (^)(int startRow, int endRow))block {
+  // The last block row is clamped to height - BLOCK_SIZE, so when the height isn't a multiple of
+  // BLOCK_SIZE it shares pixel rows with the block row above it. Never split those two apart.
+  int splitRows = (height & BLOCK_SIZE_MASK) != 0 ? subHeight - 1 : subHeight;
+  int bands = self.concurrency < splitRows ? self.concurrency : splitRows;
+  if (bands <= 1) {
+    block(0, subHeight);
+    return;
+  }
+
+  int rowsPerBand = (splitRows + bands - 1) / bands;
+  bands = (splitRows + rowsPerBand - 1) / rowsPerBand;
+  dispatch_apply(bands, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t band) {
+    int startRow = (int)band * rowsPerBand;
+    int endRow = startRow + rowsPerBand < splitRows ? startRow + rowsPerBand : subHeight;
+    block(startRow, endRow);
+  });
 }
 
 /**
@@ -103,136 +262,122 @@ const int MIN_DYNAMIC_RANGE = 24;
  * of the blocks around it. Also handles the corner cases (fractional blocks are computed based
  * on the last pixels in the row/column which are also used in the previous block).
  */
-- (void)calculateThresholdForBlock:(unsigned char *)_luminances
+- (void)calculateThresholdForBlock:(const unsigned char *)_luminances
                           subWidth:(int)subWidth
                          subHeight:(int)subHeight
                              width:(int)width
                             height:(int)height
+                            stride:(int)stride
                        blackPoints:(int **)blackPoints
                             matrix:(ZXBitMatrix *)_matrix {
-  for (int y = 0; y < subHeight; y++) {
-    int yoffset = y << BLOCK_SIZE_POWER;
-    int maxYOffset = height - BLOCK_SIZE;
-    if (yoffset > maxYOffset) {
-      yoffset = maxYOffset;
-    }
-    for (int x = 0; x < subWidth; x++) {
-      int xoffset = x << BLOCK_SIZE_POWER;
-      int maxXOffset = width - BLOCK_SIZE;
-      if (xoffset > maxXOffset) {
-        xoffset = maxXOffset;
+  int *bits = _matrix.bits;
+  int rowSize = _matrix.rowSize;
+  [self processBlockRows:subHeight height:height usingBlock:^(int startRow, int endRow) {
+    for (int y = startRow; y < endRow; y++) {
+      int yoffset = y << BLOCK_SIZE_POWER;
+      int maxYOffset = height - BLOCK_SIZE;
+      if (yoffset > maxYOffset) {
+        yoffset = maxYOffset;
       }
-      int left = [self cap:x min:2 max:subWidth - 3];
-      int top = [self cap:y min:2 max:subHeight - 3];
-      int sum = 0;
-      for (int z = -2; z <= 2; z++) {
-        int *blackRow = blackPoints[top + z];
-        sum += blackRow[left - 2] + blackRow[left - 1] + blackRow[left] + blackRow[left + 1] + blackRow[left + 2];
+      for (int x = 0; x < subWidth; x++) {
+        int xoffset = x << BLOCK_SIZE_POWER;
+        int maxXOffset = width - BLOCK_SIZE;
+        if (xoffset > maxXOffset) {
+          xoffset = maxXOffset;
+        }
+        int left = [self cap:x min:2 max:subWidth - 3];
+        int top = [self cap:y min:2 max:subHeight - 3];
+        int sum = 0;
+        for (int z = -2; z <= 2; z++) {
+          int *blackRow = blackPoints[top + z];
+          sum += blackRow[left - 2] + blackRow[left - 1] + blackRow[left] + blackRow[left + 1] + blackRow[left + 2];
+        }
+        int average = sum / 25;
+        ZXHybridThresholdBlock(_luminances, xoffset, yoffset, average, stride, bits, rowSize);
       }
-      int average = sum / 25;
-      [self thresholdBlock:_luminances xoffset:xoffset yoffset:yoffset threshold:average stride:width matrix:_matrix];
     }
-  }
+  }];
 }
 
 - (int)cap:(int)value min:(int)min max:(int)max {
   return value < min ? min : value > max ? max : value;
 }
 
-/**
- * Applies a single threshold to a block of pixels.
- */
-- (void)thresholdBlock:(unsigned char *)_luminances
-               xoffset:(int)xoffset
-               yoffset:(int)yoffset
-             threshold:(int)threshold
-                stride:(int)stride
-                matrix:(ZXBitMatrix *)_matrix {
-  for (int y = 0, offset = yoffset * stride + xoffset; y < BLOCK_SIZE; y++, offset += stride) {
-    for (int x = 0; x < BLOCK_SIZE; x++) {
-      // Comparison needs to be <= so that black == 0 pixels are black even if the threshold is 0
-      if ((_luminances[offset + x] & 0xFF) <= threshold) {
-        [_matrix setX:xoffset + x y:yoffset + y];
-      }
-    }
-  }
-}
-
 /**
  * Calculates a single black point for each block of pixels and saves it away.
  * See the following thread for a discussion of this algorithm:
  *  http://groups.google.com/group/zxing/browse_thread/thread/d06efa2c35a7ddc0
  */
-- (int **)calculateBlackPoints:(unsigned char *)_luminances
+- (int **)calculateBlackPoints:(const unsigned char *)_luminances
                          subWidth:(int)subWidth
                         subHeight:(int)subHeight
                             width:(int)width
-                           height:(int)height {
-  int **blackPoints = (int **)malloc(subHeight * sizeof(int *));
+                           height:(int)height
+                           stride:(int)stride {
+  // The black points live in buffers owned by the binarizer, taken from its pool when it has one.
+  int **blackPoints = (int **)[[self dataWithLength:subHeight * sizeof(int *)] mutableBytes];
+  int *points = (int *)[[self dataWithLength:subHeight * subWidth * sizeof(int)] mutableBytes];
   for (int y = 0; y < subHeight; y++) {
-    blackPoints[y] = (int *)malloc(subWidth * sizeof(int));
+    blackPoints[y] = points + y * subWidth;
+  }
 
-    int yoffset = y << BLOCK_SIZE_POWER;
-    int maxYOffset = height - BLOCK_SIZE;
-    if (yoffset > maxYOffset) {
-      yoffset = maxYOffset;
-    }
-    for (int x = 0; x < subWidth; x++) {
-      int xoffset = x << BLOCK_SIZE_POWER;
-      int maxXOffset = width - BLOCK_SIZE;
-      if (xoffset > maxXOffset) {
-        xoffset = maxXOffset;
+  // First pass: per-block statistics, which are independent of each other and can run in bands.
+  // Low contrast blocks are parked as -1 - min until their neighbours are known.
+  [self processBlockRows:subHeight height:height usingBlock:^(int startRow, int endRow) {
+    for (int y = startRow; y < endRow; y++) {
+      int yoffset = y << BLOCK_SIZE_POWER;
+      int maxYOffset = height - BLOCK_SIZE;
+      if (yoffset > maxYOffset) {
+        yoffset = maxYOffset;
       }
-      int sum = 0;
-      int min = 0xFF;
-      int max = 0;
-      for (int yy = 0, offset = yoffset * width + xoffset; yy < BLOCK_SIZE; yy++, offset += width) {
-        for (int xx = 0; xx < BLOCK_SIZE; xx++) {
-          int pixel = _luminances[offset + xx] & 0xFF;
-          sum += pixel;
-          // still looking for good contrast
-          if (pixel < min) {
-            min = pixel;
-          }
-          if (pixel > max) {
-            max = pixel;
-          }
-        }
-        // short-circuit min/max tests once dynamic range is met
-        if (max - min > MIN_DYNAMIC_RANGE) {
-          // finish the rest of the rows quickly
-          for (yy++, offset += width; yy < BLOCK_SIZE; yy++, offset += width) {
-            for (int xx = 0; xx < BLOCK_SIZE; xx++) {
-              sum += _luminances[offset + xx] & 0xFF;
-            }
-          }
+      for (int x = 0; x < subWidth; x++) {
+        int xoffset = x << BLOCK_SIZE_POWER;
+        int maxXOffset = width - BLOCK_SIZE;
+        if (xoffset > maxXOffset) {
+          xoffset = maxXOffset;
         }
+        // The full-block minimum and maximum give the same dynamic range test as short-circuiting
+        // once the range is met, since min is only consulted when the range was never exceeded.
+        int sum;
+        int min;
+        int max;
+        ZXHybridBlockStatistics(_luminances, yoffset * stride + xoffset, stride, &sum, &min, &max);
+
+        // The default estimate is the average of the values in the block.
+        blackPoints[y][x] = max - min > MIN_DYNAMIC_RANGE ? sum >> (BLOCK_SIZE_POWER * 2) : -1 - min;
       }
+    }
+  }];
+
+  // Second pass: low contrast blocks depend on their already resolved upper and left neighbours,
+  // so this runs serially in raster order. It only touches integers and is cheap.
+  for (int y = 0; y < subHeight; y++) {
+    for (int x = 0; x < subWidth; x++) {
+      if (blackPoints[y][x] >= 0) {
+        continue;
+      }
+      int min = -1 - blackPoints[y][x];
+
+      // If variation within the block is low, assume this is a block with only light or only
+      // dark pixels. In that case we do not want to use the average, as it would divide this
+      // low contrast area into black and white pixels, essentially creating data out of noise.
+      //
+      // The default assumption is that the block is light/background. Since no estimate for
+      // the level of dark pixels exists locally, use half the min for the block.
+      int average = min >> 1;
+
+      if (y > 0 && x > 0) {
+        // Correct the "white background" assumption for blocks that have neighbors by comparing
+        // the pixels in this block to the previously calculated black points. This is based on
+        // the fact that dark barcode symbology is always surrounded by some amount of light
+        // background for which reasonable black point estimates were made. The bp estimated at
+        // the boundaries is used for the interior.
 
-      // The default estimate is the average of the values in the block.
-      int average = sum >> (BLOCK_SIZE_POWER * 2);
-      if (max - min <= MIN_DYNAMIC_RANGE) {
-        // If variation within the block is low, assume this is a block with only light or only
-        // dark pixels. In that case we do not want to use the average, as it would divide this
-        // low contrast area into black and white pixels, essentially creating data out of noise.
-        //
-        // The default assumption is that the block is light/background. Since no estimate for
-        // the level of dark pixels exists locally, use half the min for the block.
-        average = min >> 1;
-
-        if (y > 0 && x > 0) {
-          // Correct the "white background" assumption for blocks that have neighbors by comparing
-          // the pixels in this block to the previously calculated black points. This is based on
-          // the fact that dark barcode symbology is always surrounded by some amount of light
-          // background for which reasonable black point estimates were made. The bp estimated at
-          // the boundaries is used for the interior.
-
-          // The (min < bp) is arbitrary but works better than other heuristics that were tried.
-          int averageNeighborBlackPoint = (blackPoints[y - 1][x] + (2 * blackPoints[y][x - 1]) +
-                                           blackPoints[y - 1][x - 1]) >> 2;
-          if (min < averageNeighborBlackPoint) {
-            average = averageNeighborBlackPoint;
-          }
+        // The (min < bp) is arbitrary but works better than other heuristics that were tried.
+        int averageNeighborBlackPoint = (blackPoints[y - 1][x] + (2 * blackPoints[y][x - 1]) +
+                                         blackPoints[y - 1][x - 1]) >> 2;
+        if (min < averageNeighborBlackPoint) {
+          average = averageNeighborBlackPoint;
         }
       }
       blackPoints[y][x] = average;
@@ -25,6 +25,8 @@
 + (ZXPerspectiveTransform *) quadrilateralToQuadrilateral:(float)x0 y0:(float)y0 x1:(float)x1 y1:(float)y1 x2:(float)x2 y2:(float)y2 x3:(float)x3 y3:(float)y3 x0p:(float)x0p y0p:(float)y0p x1p:(float)x1p y1p:(float)y1p x2p:(float)x2p y2p:(float)y2p x3p:(float)x3p y3p:(float)y3p;
 - (void) transformPoints:(float *)points pointsLen:(int)pointsLen;
 - (void) transformPoints:(float *)xValues yValues:(float *)yValues pointsLen:(int)pointsLen;
+- (void) transformGridRow:(float)y count:(int)count xValues:(float *)xValues yValues:(float *)yValues;
+- (BOOL) preservesConvexityOfPoints:(float *)points pointsLen:(int)pointsLen;
 + (ZXPerspectiveTransform *) squareToQuadrilateral:(float)x0 y0:(float)y0 x1:(float)x1 y1:(float)y1 x2:(float)x2 y2:(float)y2 x3:(float)x3 y3:(float)y3;
 + (ZXPerspectiveTransform *) quadrilateralToSquare:(float)x0 y0:(float)y0 x1:(float)x1 y1:(float)y1 x2:(float)x2 y2:(float)y2 x3:(float)x3 y3:(float)y3;
 - (ZXPerspectiveTransform *) buildAdjoint;
@@ -90,6 +90,44 @@
   }
 }
 
+/**
+ * Transforms the centers (x + 0.5, y) of a row of count modules, x = 0 .. count - 1. The
+ * terms that only depend on y are computed once for the row, and each module then costs a few
+ * multiply-adds and one divide. There is no dependency between modules, so the loop is
+ * vectorized and several modules are evaluated at once.
+ */
+- (void)transformGridRow:(float)y count:(int)count xValues:(float *)xValues yValues:(float *)yValues {
+  float m11 = self.a11;
+  float m12 = self.a12;
+  float m13 = self.a13;
+  float rowX = self.a21 * y + self.a31;
+  float rowY = self.a22 * y + self.a32;
+  float rowDenominator = self.a23 * y + self.a33;
+  for (int i = 0; i < count; i++) {
+    float x = (float)i + 0.5f;
+    float scale = 1.0f / (m13 * x + rowDenominator);
+    xValues[i] = (m11 * x + rowX) * scale;
+    yValues[i] = (m12 * x + rowY) * scale;
+  }
+}
+
+/**
+ * Whether the denominator of the transform has the same, non-zero sign at all the points. When
+ * it does, no point of their convex hull is sent to infinity, and the hull maps onto the convex
+ * hull of the transformed points.
+ */
+- (BOOL)preservesConvexityOfPoints:(float *)points pointsLen:(int)pointsLen {
+  BOOL positive = NO;
+  for (int i = 0; i < pointsLen; i += 2) {
+    float denominator = self.a13 * points[i] + self.a23 * points[i + 1] + self.a33;
+    if (denominator == 0.0f || isnan(denominator) || (i > 0 && (denominator > 0.0f) != positive)) {
+      return NO;
+    }
+    positive = denominator > 0.0f;
+  }
+  return YES;
+}
+
 + (ZXPerspectiveTransform *)squareToQuadrilateral:(float)x0 y0:(float)y0 x1:(float)x1 y1:(float)y1 x2:(float)x2 y2:(float)y2 x3:(float)x3 y3:(float)y3 {
   float dx3 = x0 - x1 + x2 - x3;
   float dy3 = y0 - y1 + y2 - y3;
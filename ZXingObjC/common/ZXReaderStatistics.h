@@ -0,0 +1,49 @@
+/*
+ * Copyright 2012 ZXing authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/**
+ * Tracks how often each reader finds a barcode and how long it takes, over a moving window of its
+ * most recent attempts, and orders readers so the ones most likely to succeed cheaply run first.
+ * Give one to ZXMultiFormatReader to turn on adaptive ordering; it is shared with the 1D reader,
+ * which orders its format sub-readers the same way.
+ *
+ * Readers are ranked by hit rate divided by average time per attempt, which minimizes the expected
+ * time to the first hit when readers are tried one after another. Readers with no hits in the
+ * window keep their relative default order behind the others, and are still tried on every frame
+ * that nothing else decodes, so a format that starts appearing is picked up again.
+ *
+ * Statistics are keyed by reader class name. The object is safe to use from several threads.
+ */
+
+extern NSString * const ZXReaderStatisticsAttemptsKey;
+extern NSString * const ZXReaderStatisticsHitsKey;
+extern NSString * const ZXReaderStatisticsHitRateKey;
+extern NSString * const ZXReaderStatisticsAverageDurationKey;
+
+@interface ZXReaderStatistics : NSObject
+
+@property (nonatomic, assign, readonly) int windowSize;
+
++ (id)statisticsWithWindowSize:(int)windowSize;
+- (id)initWithWindowSize:(int)windowSize;
+- (void)recordReader:(id)reader hit:(BOOL)hit duration:(NSTimeInterval)duration;
+- (void)recordReaders:(NSArray *)readers hits:(const BOOL *)hits durations:(const NSTimeInterval *)durations;
+- (NSArray *)orderedReaders:(NSArray *)readers;
+- (NSDictionary *)statistics;
+- (void)reset;
+
+@end
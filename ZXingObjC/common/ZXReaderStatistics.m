@@ -0,0 +1,235 @@
+/*
+ * Copyright 2012 ZXing authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#import "ZXReaderStatistics.h"
+
+NSString * const ZXReaderStatisticsAttemptsKey = @"attempts";
+NSString * const ZXReaderStatisticsHitsKey = @"hits";
+NSString * const ZXReaderStatisticsHitRateKey = @"hitRate";
+NSString * const ZXReaderStatisticsAverageDurationKey = @"averageDuration";
+
+/**
+ * The last windowSize attempts of one reader, kept as a ring buffer with running sums.
+ */
+@interface ZXReaderStatisticsWindow : NSObject {
+  BOOL *hits;
+  NSTimeInterval *durations;
+  int windowSize;
+  int count;
+  int next;
+  int hitSum;
+  NSTimeInterval durationSum;
+}
+
+- (id)initWithWindowSize:(int)windowSize;
+- (void)recordHit:(BOOL)hit duration:(NSTimeInterval)duration;
+- (int)count;
+- (int)hitSum;
+- (NSTimeInterval)durationSum;
+- (double)score;
+
+@end
+
+@implementation ZXReaderStatisticsWindow
+
+- (id)initWithWindowSize:(int)aWindowSize {
+  if (self = [super init]) {
+    windowSize = aWindowSize;
+    hits = (BOOL *)calloc(windowSize, sizeof(BOOL));
+    durations = (NSTimeInterval *)calloc(windowSize, sizeof(NSTimeInterval));
+  }
+
+  return self;
+}
+
+- (void)dealloc {
+  free(hits);
+  free(durations);
+
+  [super dealloc];
+}
+
+- (void)recordHit:(BOOL)hit duration:(NSTimeInterval)duration {
+  if (count == windowSize) {
+    hitSum -= hits[next] ? 1 : 0;
+    durationSum -= durations[next];
+  } else {
+    count++;
+  }
+  hits[next] = hit;
+  durations[next] = duration;
+  hitSum += hit ? 1 : 0;
+  durationSum += duration;
+  next = (next + 1) % windowSize;
+}
+
+- (int)count {
+  return count;
+}
+
+- (int)hitSum {
+  return hitSum;
+}
+
+- (NSTimeInterval)durationSum {
+  return durationSum;
+}
+
+/**
+ * Hit rate over average duration, which simplifies to hits over total time.
+ */
+- (double)score {
+  if (hitSum == 0) {
+    return 0.0;
+  }
+  return hitSum / (durationSum > 1e-9 ? durationSum : 1e-9);
+}
+
+@end
+
+@interface ZXReaderStatistics ()
+
+@property (nonatomic, assign) int windowSize;
+@property (nonatomic, retain) NSMutableDictionary *windows;
+
+@end
+
+@implementation ZXReaderStatistics
+
+@synthesize windowSize;
+@synthesize windows;
+
++ (id)statisticsWithWindowSize:(int)windowSize {
+  return [[[self alloc] initWithWindowSize:windowSize] autorelease];
+}
+
+- (id)init {
+  return [self initWithWindowSize:64];
+}
+
+- (id)initWithWindowSize:(int)aWindowSize {
+  if (self = [super init]) {
+    if (aWindowSize < 1) {
+      [NSException raise:NSInvalidArgumentException
+                  format:@"Window size must be at least 1."];
+    }
+
+    self.windowSize = aWindowSize;
+    self.windows = [NSMutableDictionary dictionary];
+  }
+
+  return self;
+}
+
+- (void)dealloc {
+  [windows release];
+
+  [super dealloc];
+}
+
+/**
+ * Records one attempt by reader, whether it found a barcode, and how long it took.
+ */
+- (void)recordReader:(id)reader hit:(BOOL)hit duration:(NSTimeInterval)duration {
+  [self recordReaders:[NSArray arrayWithObject:reader] hits:&hit durations:&duration];
+}
+
+/**
+ * Records one attempt by each of readers under a single lock, for callers that gather a whole
+ * decode's worth of attempts before reporting them.
+ */
+- (void)recordReaders:(NSArray *)readers hits:(const BOOL *)hits durations:(const NSTimeInterval *)durations {
+  NSUInteger count = [readers count];
+  @synchronized(self) {
+    for (NSUInteger i = 0; i < count; i++) {
+      NSString *key = NSStringFromClass([[readers objectAtIndex:i] class]);
+      ZXReaderStatisticsWindow *window = [self.windows objectForKey:key];
+      if (window == nil) {
+        window = [[[ZXReaderStatisticsWindow alloc] initWithWindowSize:self.windowSize] autorelease];
+        [self.windows setObject:window forKey:key];
+      }
+      [window recordHit:hits[i] duration:durations[i]];
+    }
+  }
+}
+
+/**
+ * Returns readers sorted by descending score. The sort is stable, so readers with equal scores,
+ * including all readers that haven't hit yet, keep the order they were given in.
+ */
+- (NSArray *)orderedReaders:(NSArray *)readers {
+  NSUInteger count = [readers count];
+  double *scores = (double *)malloc(count * sizeof(double));
+  @synchronized(self) {
+    for (NSUInteger i = 0; i < count; i++) {
+      ZXReaderStatisticsWindow *window = [self.windows objectForKey:NSStringFromClass([[readers objectAtIndex:i] class])];
+      scores[i] = window == nil ? 0.0 : [window score];
+    }
+  }
+
+  NSMutableArray *indexes = [NSMutableArray arrayWithCapacity:count];
+  for (NSUInteger i = 0; i < count; i++) {
+    [indexes addObject:[NSNumber numberWithUnsignedInteger:i]];
+  }
+  [indexes sortWithOptions:NSSortStable usingComparator:^NSComparisonResult(id a, id b) {
+    double scoreA = scores[[a unsignedIntegerValue]];
+    double scoreB = scores[[b unsignedIntegerValue]];
+    if (scoreA > scoreB) {
+      return NSOrderedAscending;
+    } else if (scoreA < scoreB) {
+      return NSOrderedDescending;
+    }
+    return NSOrderedSame;
+  }];
+  free(scores);
+
+  NSMutableArray *ordered = [NSMutableArray arrayWithCapacity:count];
+  for (NSNumber *index in indexes) {
+    [ordered addObject:[readers objectAtIndex:[index unsignedIntegerValue]]];
+  }
+  return ordered;
+}
+
+/**
+ * Returns a snapshot of the window for monitoring, mapping each reader class name to a dictionary
+ * with the ZXReaderStatistics*Key entries. Durations are in seconds.
+ */
+- (NSDictionary *)statistics {
+  NSMutableDictionary *statistics = [NSMutableDictionary dictionary];
+  @synchronized(self) {
+    for (NSString *key in self.windows) {
+      ZXReaderStatisticsWindow *window = [self.windows objectForKey:key];
+      int attempts = [window count];
+      [statistics setObject:[NSDictionary dictionaryWithObjectsAndKeys:
+                             [NSNumber numberWithInt:attempts], ZXReaderStatisticsAttemptsKey,
+                             [NSNumber numberWithInt:[window hitSum]], ZXReaderStatisticsHitsKey,
+                             [NSNumber numberWithDouble:attempts == 0 ? 0.0 : (double)[window hitSum] / attempts], ZXReaderStatisticsHitRateKey,
+                             [NSNumber numberWithDouble:attempts == 0 ? 0.0 : [window durationSum] / attempts], ZXReaderStatisticsAverageDurationKey,
+                             nil]
+                     forKey:key];
+    }
+  }
+  return statistics;
+}
+
+- (void)reset {
+  @synchronized(self) {
+    [self.windows removeAllObjects];
+  }
+}
+
+@end
@@ -30,6 +30,8 @@
 @property (nonatomic, retain, readonly) ZXGenericGFPoly *one;
 @property (nonatomic, assign, readonly) int size;
 @property (nonatomic, assign, readonly) int generatorBase;
+@property (nonatomic, assign, readonly) int *expTable;
+@property (nonatomic, assign, readonly) int *logTable;
 
 + (ZXGenericGF *)AztecData12;
 + (ZXGenericGF *)AztecData10;
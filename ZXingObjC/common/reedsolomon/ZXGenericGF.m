@@ -82,49 +82,55 @@
 
 + (ZXGenericGF *)AztecData12 {
   static ZXGenericGF *AztecData12 = nil;
-  if (!AztecData12) {
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
     AztecData12 = [[ZXGenericGF alloc] initWithPrimitive:0x1069 size:4096 b:1]; // x^12 + x^6 + x^5 + x^3 + 1
-  }
+  });
   return AztecData12;
 }
 
 + (ZXGenericGF *)AztecData10 {
   static ZXGenericGF *AztecData10 = nil;
-  if (!AztecData10) {
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
     AztecData10 = [[ZXGenericGF alloc] initWithPrimitive:0x409 size:1024 b:1]; // x^10 + x^3 + 1
-  }
+  });
   return AztecData10;
 }
 
 + (ZXGenericGF *)AztecData6 {
   static ZXGenericGF *AztecData6 = nil;
-  if (!AztecData6) {
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
     AztecData6 = [[ZXGenericGF alloc] initWithPrimitive:0x43 size:64 b:1]; // x^6 + x + 1
-  }
+  });
   return AztecData6;
 }
 
 + (ZXGenericGF *)AztecParam {
   static ZXGenericGF *AztecParam = nil;
-  if (!AztecParam) {
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
     AztecParam = [[ZXGenericGF alloc] initWithPrimitive:0x13 size:16 b:1]; // x^4 + x + 1
-  }
+  });
   return AztecParam;
 }
 
 + (ZXGenericGF *)QrCodeField256 {
   static ZXGenericGF *QrCodeField256 = nil;
-  if (!QrCodeField256) {
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
     QrCodeField256 = [[ZXGenericGF alloc] initWithPrimitive:0x011D size:256 b:0]; // x^8 + x^4 + x^3 + x^2 + 1
-  }
+  });
   return QrCodeField256;
 }
 
 + (ZXGenericGF *)DataMatrixField256 {
   static ZXGenericGF *DataMatrixField256 = nil;
-  if (!DataMatrixField256) {
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
     DataMatrixField256 = [[ZXGenericGF alloc] initWithPrimitive:0x012D size:256 b:1]; // x^8 + x^5 + x^3 + x^2 + 1
-  }
+  });
   return DataMatrixField256;
 }
 
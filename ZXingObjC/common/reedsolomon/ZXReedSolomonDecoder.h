@@ -26,7 +26,9 @@
  *
  * J.I. Hall. www.mth.msu.edu/~jhall/classes/codenotes/GRS.pdf
  * "Chapter 5. Generalized Reed-Solomon Codes"
- * (see discussion of Euclidean algorithm)
+ *
+ * The error locator is found with Berlekamp-Massey and its roots with a Chien search;
+ * all arithmetic runs on the field's log/antilog tables without allocating.
  * 
  * Much credit is due to William Rucklidge since portions of this code are an indirect
  * port of his C++ Reed-Solomon implementation.
@@ -14,188 +14,199 @@
  * limitations under the License.
  */
 
+#import "ZXDecodeTrace.h"
 #import "ZXErrors.h"
 #import "ZXGenericGF.h"
-#import "ZXGenericGFPoly.h"
 #import "ZXReedSolomonDecoder.h"
 
 @interface ZXReedSolomonDecoder ()
 
 @property (nonatomic, retain) ZXGenericGF *field;
 
-- (NSArray *)runEuclideanAlgorithm:(ZXGenericGFPoly *)a b:(ZXGenericGFPoly *)b R:(int)R error:(NSError **)error;
-- (NSArray *)findErrorLocations:(ZXGenericGFPoly *)errorLocator error:(NSError **)error;
-- (NSArray *)findErrorMagnitudes:(ZXGenericGFPoly *)errorEvaluator errorLocations:(NSArray *)errorLocations;
-
 @end
 
-
-@implementation ZXReedSolomonDecoder
-
-@synthesize field;
-
-- (id)initWithField:(ZXGenericGF *)aField {
-  if (self = [super init]) {
-    self.field = aField;
+static inline int ZXReedSolomonMultiplyLog(const int *expTable, const int *logTable, int order, int a, int logB) {
+  if (a == 0) {
+    return 0;
   }
-
-  return self;
+  int e = logTable[a] + logB;
+  return expTable[e >= order ? e - order : e];
 }
 
-- (void)dealloc {
-  [field release];
-
-  [super dealloc];
-}
-
-
 /**
- * Decodes given set of received codewords, which include both data and error-correction
- * codewords. Really, this means it uses Reed-Solomon to detect and correct errors, in-place,
- * in the input.
+ * Syndromes by Horner's rule, Berlekamp-Massey for the error locator, a Chien search
+ * over the received positions and Forney's formula for the magnitudes. Works entirely
+ * on the field's log/antilog tables and stack scratch space; returns NULL on success
+ * or a description of why the codewords could not be corrected.
  */
-- (BOOL)decode:(int *)received receivedLen:(int)receivedLen twoS:(int)twoS error:(NSError **)error {
-  ZXGenericGFPoly *poly = [[[ZXGenericGFPoly alloc] initWithField:field coefficients:received coefficientsLen:receivedLen] autorelease];
-  int syndromeCoefficientsLen = twoS;
-  int syndromeCoefficients[syndromeCoefficientsLen];
+static const char *ZXReedSolomonDecodeWords(const int *expTable, const int *logTable, int size, int generatorBase,
+                                            int *received, int receivedLen, int twoS) {
+  int order = size - 1;
+  int syndromes[twoS];
   BOOL noError = YES;
-
   for (int i = 0; i < twoS; i++) {
-    int eval = [poly evaluateAt:[field exp:i + field.generatorBase]];
-    syndromeCoefficients[syndromeCoefficientsLen - 1 - i] = eval;
+    int logX = (i + generatorBase) % order;
+    int eval = 0;
+    for (int j = 0; j < receivedLen; j++) {
+      eval = ZXReedSolomonMultiplyLog(expTable, logTable, order, eval, logX) ^ received[j];
+    }
+    syndromes[i] = eval;
     if (eval != 0) {
       noError = NO;
     }
   }
   if (noError) {
-    return YES;
+    return NULL;
   }
-  ZXGenericGFPoly *syndrome = [[[ZXGenericGFPoly alloc] initWithField:field coefficients:syndromeCoefficients coefficientsLen:syndromeCoefficientsLen] autorelease];
-  NSArray *sigmaOmega = [self runEuclideanAlgorithm:[field buildMonomial:twoS coefficient:1] b:syndrome R:twoS error:error];
-  if (!sigmaOmega) {
-    return NO;
+
+  int lambda[twoS + 1];
+  int prev[twoS + 1];
+  int temp[twoS + 1];
+  memset(lambda, 0, sizeof(lambda));
+  memset(prev, 0, sizeof(prev));
+  lambda[0] = prev[0] = 1;
+  int numErrors = 0;
+  int shift = 1;
+  int prevDiscrepancy = 1;
+  for (int k = 0; k < twoS; k++) {
+    int discrepancy = syndromes[k];
+    for (int i = 1; i <= numErrors; i++) {
+      if (lambda[i] != 0) {
+        discrepancy ^= ZXReedSolomonMultiplyLog(expTable, logTable, order, syndromes[k - i], logTable[lambda[i]]);
+      }
+    }
+    if (discrepancy == 0) {
+      shift++;
+      continue;
+    }
+    int logScale = logTable[discrepancy] - logTable[prevDiscrepancy];
+    if (logScale < 0) {
+      logScale += order;
+    }
+    BOOL lengthChange = 2 * numErrors <= k;
+    if (lengthChange) {
+      memcpy(temp, lambda, sizeof(lambda));
+    }
+    for (int i = shift; i <= twoS; i++) {
+      lambda[i] ^= ZXReedSolomonMultiplyLog(expTable, logTable, order, prev[i - shift], logScale);
+    }
+    if (lengthChange) {
+      numErrors = k + 1 - numErrors;
+      memcpy(prev, temp, sizeof(prev));
+      prevDiscrepancy = discrepancy;
+      shift = 1;
+    } else {
+      shift++;
+    }
   }
-  ZXGenericGFPoly *sigma = [sigmaOmega objectAtIndex:0];
-  ZXGenericGFPoly *omega = [sigmaOmega objectAtIndex:1];
-  NSArray *errorLocations = [self findErrorLocations:sigma error:error];
-  if (!errorLocations) {
-    return NO;
+  if (numErrors > twoS / 2 || lambda[numErrors] == 0) {
+    return "Error locator degree exceeds correction capacity";
+  }
+
+  // Chien search: term i of lambda(alpha^-p) is lambda_i * alpha^(-i*p), stepped by alpha^-i.
+  int logTerms[numErrors + 1];
+  int logSteps[numErrors + 1];
+  for (int i = 1; i <= numErrors; i++) {
+    logTerms[i] = lambda[i] == 0 ? -1 : logTable[lambda[i]];
+    logSteps[i] = order - i % order;
   }
-  NSArray *errorMagnitudes = [self findErrorMagnitudes:omega errorLocations:errorLocations];
-  for (int i = 0; i < [errorLocations count]; i++) {
-    int position = receivedLen - 1 - [field log:[[errorLocations objectAtIndex:i] intValue]];
-    if (position < 0) {
-      NSDictionary *userInfo = [NSDictionary dictionaryWithObject:@"Bad error location"
-                                                           forKey:NSLocalizedDescriptionKey];
-      
-      if (error) *error = [[[NSError alloc] initWithDomain:ZXErrorDomain code:ZXReedSolomonError userInfo:userInfo] autorelease];
-      return NO;
+  int positions[numErrors];
+  int found = 0;
+  int limit = receivedLen < order ? receivedLen : order;
+  for (int p = 0; p < limit && found < numErrors; p++) {
+    int sum = 1;
+    for (int i = 1; i <= numErrors; i++) {
+      int logTerm = logTerms[i];
+      if (logTerm >= 0) {
+        sum ^= expTable[logTerm];
+        logTerm += logSteps[i];
+        logTerms[i] = logTerm >= order ? logTerm - order : logTerm;
+      }
+    }
+    if (sum == 0) {
+      positions[found++] = p;
     }
-    received[position] = [ZXGenericGF addOrSubtract:received[position] b:[[errorMagnitudes objectAtIndex:i] intValue]];
   }
-  return YES;
-}
-
-- (NSArray *)runEuclideanAlgorithm:(ZXGenericGFPoly *)a b:(ZXGenericGFPoly *)b R:(int)R error:(NSError **)error {
-  if (a.degree < b.degree) {
-    ZXGenericGFPoly *temp = a;
-    a = b;
-    b = temp;
+  if (found != numErrors) {
+    return "Error locator degree does not match number of roots";
   }
 
-  ZXGenericGFPoly *rLast = a;
-  ZXGenericGFPoly *r = b;
-  ZXGenericGFPoly *tLast = field.zero;
-  ZXGenericGFPoly *t = field.one;
-
-  while ([r degree] >= R / 2) {
-    ZXGenericGFPoly *rLastLast = rLast;
-    ZXGenericGFPoly *tLastLast = tLast;
-    rLast = r;
-    tLast = t;
-
-    if ([rLast zero]) {
-      NSDictionary *userInfo = [NSDictionary dictionaryWithObject:@"r_{i-1} was zero"
-                                                           forKey:NSLocalizedDescriptionKey];
-
-      if (error) *error = [[[NSError alloc] initWithDomain:ZXErrorDomain code:ZXReedSolomonError userInfo:userInfo] autorelease];
-      return NO;
+  // Forney: e = X^(1-b) * omega(X^-1) / lambda'(X^-1), with omega = S * lambda mod x^numErrors.
+  int omega[numErrors];
+  for (int k = 0; k < numErrors; k++) {
+    int value = 0;
+    for (int i = 0; i <= k; i++) {
+      if (lambda[i] != 0) {
+        value ^= ZXReedSolomonMultiplyLog(expTable, logTable, order, syndromes[k - i], logTable[lambda[i]]);
+      }
     }
-    r = rLastLast;
-    ZXGenericGFPoly *q = [field zero];
-    int denominatorLeadingTerm = [rLast coefficient:[rLast degree]];
-    int dltInverse = [field inverse:denominatorLeadingTerm];
-
-    while ([r degree] >= [rLast degree] && ![r zero]) {
-      int degreeDiff = [r degree] - [rLast degree];
-      int scale = [field multiply:[r coefficient:[r degree]] b:dltInverse];
-      q = [q addOrSubtract:[field buildMonomial:degreeDiff coefficient:scale]];
-      r = [r addOrSubtract:[rLast multiplyByMonomial:degreeDiff coefficient:scale]];
+    omega[k] = value;
+  }
+  for (int e = 0; e < numErrors; e++) {
+    int p = positions[e];
+    int logXInverse = p == 0 ? 0 : order - p;
+    int numerator = 0;
+    for (int k = numErrors - 1; k >= 0; k--) {
+      numerator = ZXReedSolomonMultiplyLog(expTable, logTable, order, numerator, logXInverse) ^ omega[k];
+    }
+    int logXInverseSquared = 2 * logXInverse >= order ? 2 * logXInverse - order : 2 * logXInverse;
+    int denominator = 0;
+    for (int i = (numErrors - 1) | 1; i >= 1; i -= 2) {
+      denominator = ZXReedSolomonMultiplyLog(expTable, logTable, order, denominator, logXInverseSquared) ^ (i <= numErrors ? lambda[i] : 0);
+    }
+    if (denominator == 0) {
+      return "Error locator derivative was zero";
+    }
+    if (numerator != 0) {
+      int logMagnitude = (logTable[numerator] - logTable[denominator] + (1 - generatorBase) * p) % order;
+      if (logMagnitude < 0) {
+        logMagnitude += order;
+      }
+      received[receivedLen - 1 - p] ^= expTable[logMagnitude];
     }
-
-    t = [[q multiply:tLast] addOrSubtract:tLastLast];
   }
+  ZX_TRACE_COUNT(errorsCorrected, numErrors);
+  return NULL;
+}
 
-  int sigmaTildeAtZero = [t coefficient:0];
-  if (sigmaTildeAtZero == 0) {
-    NSDictionary *userInfo = [NSDictionary dictionaryWithObject:@"sigmaTilde(0) was zero"
-                                                         forKey:NSLocalizedDescriptionKey];
 
-    if (error) *error = [[[NSError alloc] initWithDomain:ZXErrorDomain code:ZXReedSolomonError userInfo:userInfo] autorelease];
-    return NO;
+@implementation ZXReedSolomonDecoder
+
+@synthesize field;
+
+- (id)initWithField:(ZXGenericGF *)aField {
+  if (self = [super init]) {
+    self.field = aField;
   }
 
-  int inverse = [field inverse:sigmaTildeAtZero];
-  ZXGenericGFPoly *sigma = [t multiplyScalar:inverse];
-  ZXGenericGFPoly *omega = [r multiplyScalar:inverse];
-  return [NSArray arrayWithObjects:sigma, omega, nil];
+  return self;
 }
 
-- (NSArray *)findErrorLocations:(ZXGenericGFPoly *)errorLocator error:(NSError **)error {
-  int numErrors = [errorLocator degree];
-  if (numErrors == 1) {
-    return [NSArray arrayWithObject:[NSNumber numberWithInt:[errorLocator coefficient:1]]];
-  }
-  NSMutableArray *result = [NSMutableArray arrayWithCapacity:numErrors];
-  int e = 0;
-  for (int i = 1; i < [field size] && e < numErrors; i++) {
-    if ([errorLocator evaluateAt:i] == 0) {
-      [result addObject:[NSNumber numberWithInt:[field inverse:i]]];
-      e++;
-    }
-  }
+- (void)dealloc {
+  [field release];
 
-  if (e != numErrors) {
-    NSDictionary *userInfo = [NSDictionary dictionaryWithObject:@"Error locator degree does not match number of roots"
-                                                         forKey:NSLocalizedDescriptionKey];
-    
-    if (error) *error = [[[NSError alloc] initWithDomain:ZXErrorDomain code:ZXReedSolomonError userInfo:userInfo] autorelease];
-    return nil;
-  }
-  return result;
+  [super dealloc];
 }
 
-- (NSArray *)findErrorMagnitudes:(ZXGenericGFPoly *)errorEvaluator errorLocations:(NSArray *)errorLocations {
-  int s = [errorLocations count];
-  NSMutableArray *result = [NSMutableArray array];
-  for (int i = 0; i < s; i++) {
-    int xiInverse = [self.field inverse:[[errorLocations objectAtIndex:i] intValue]];
-    int denominator = 1;
-    for (int j = 0; j < s; j++) {
-      if (i != j) {
-        int term = [self.field multiply:[[errorLocations objectAtIndex:j] intValue] b:xiInverse];
-        int termPlus1 = (term & 0x1) == 0 ? term | 1 : term & ~1;
-        denominator = [self.field multiply:denominator b:termPlus1];
-      }
-    }
 
-    [result addObject:[NSNumber numberWithInt:[self.field multiply:[errorEvaluator evaluateAt:xiInverse] b:[self.field inverse:denominator]]]];
-    if (self.field.generatorBase != 0) {
-      [result replaceObjectAtIndex:i withObject:[NSNumber numberWithInt:[self.field multiply:[[result objectAtIndex:i] intValue] b:xiInverse]]];
-    }
-  }
+/**
+ * Decodes given set of received codewords, which include both data and error-correction
+ * codewords. Really, this means it uses Reed-Solomon to detect and correct errors, in-place,
+ * in the input.
+ */
+- (BOOL)decode:(int *)received receivedLen:(int)receivedLen twoS:(int)twoS error:(NSError **)error {
+  ZX_TRACE_BEGIN(traceStart);
+  const char *failure = ZXReedSolomonDecodeWords(field.expTable, field.logTable, field.size, field.generatorBase,
+                                                 received, receivedLen, twoS);
+  ZX_TRACE_END(traceStart, kZXDecodeStageErrorCorrect);
+  if (failure) {
+    NSDictionary *userInfo = [NSDictionary dictionaryWithObject:[NSString stringWithUTF8String:failure]
+                                                         forKey:NSLocalizedDescriptionKey];
 
-  return result;
+    if (error) *error = [[[NSError alloc] initWithDomain:ZXErrorDomain code:ZXReedSolomonError userInfo:userInfo] autorelease];
+    return NO;
+  }
+  return YES;
 }
 
 @end
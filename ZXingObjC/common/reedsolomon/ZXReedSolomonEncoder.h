@@ -16,13 +16,20 @@
 
 /**
  * Implements Reed-Solomon enbcoding, as the name implies.
+ *
+ * Generator polynomials are built once per degree and kept as log-domain coefficient
+ * arrays; parity is computed with a linear feedback shift register over plain int arrays.
+ * Use encoderForField: to share one encoder, and so one generator cache, per field.
  */
 
 @class ZXGenericGF;
 
 @interface ZXReedSolomonEncoder : NSObject
 
++ (ZXReedSolomonEncoder *)encoderForField:(ZXGenericGF *)field;
+
 - (id)initWithField:(ZXGenericGF *)field;
 - (void)encode:(int *)toEncode toEncodeLen:(int)toEncodeLen ecBytes:(int)ecBytes;
+- (void)encodeData:(const int *)data dataLen:(int)dataLen ecWords:(int *)ecWords ecLen:(int)ecLen;
 
 @end
@@ -15,82 +15,151 @@
  */
 
 #import "ZXGenericGF.h"
-#import "ZXGenericGFPoly.h"
 #import "ZXReedSolomonEncoder.h"
 
 @interface ZXReedSolomonEncoder ()
 
-@property (nonatomic, retain) NSMutableArray *cachedGenerators;
 @property (nonatomic, retain) ZXGenericGF *field;
 
+- (const int *)generatorLogs:(int)degree;
+
 @end
 
+/**
+ * Divides data(x) * x^ecLen by the generator with a shift register: each data word is
+ * added to the leading parity word and the result, when non-zero, is multiplied into
+ * every generator coefficient. generatorLogs holds the logs of coefficients 1..ecLen
+ * (the leading coefficient is always 1), or -1 for a zero coefficient.
+ */
+static void ZXReedSolomonEncodeWords(const int *expTable, const int *logTable, int order, const int *generatorLogs,
+                                     const int *data, int dataLen, int *ecWords, int ecLen) {
+  memset(ecWords, 0, ecLen * sizeof(int));
+  for (int i = 0; i < dataLen; i++) {
+    int feedback = data[i] ^ ecWords[0];
+    if (feedback == 0) {
+      memmove(ecWords, ecWords + 1, (ecLen - 1) * sizeof(int));
+      ecWords[ecLen - 1] = 0;
+      continue;
+    }
+    int logFeedback = logTable[feedback];
+    for (int j = 0; j < ecLen; j++) {
+      int next = j + 1 < ecLen ? ecWords[j + 1] : 0;
+      int logCoefficient = generatorLogs[j];
+      if (logCoefficient >= 0) {
+        int e = logFeedback + logCoefficient;
+        next ^= expTable[e >= order ? e - order : e];
+      }
+      ecWords[j] = next;
+    }
+  }
+}
 
-@implementation ZXReedSolomonEncoder
+@implementation ZXReedSolomonEncoder {
+  int **cachedGenerators;
+}
 
-@synthesize cachedGenerators;
 @synthesize field;
 
++ (ZXReedSolomonEncoder *)encoderForField:(ZXGenericGF *)aField {
+  static NSMutableArray *sharedEncoders = nil;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    sharedEncoders = [[NSMutableArray alloc] init];
+  });
+
+  @synchronized(sharedEncoders) {
+    for (ZXReedSolomonEncoder *encoder in sharedEncoders) {
+      if ([encoder.field isEqual:aField] && encoder.field.generatorBase == aField.generatorBase) {
+        return encoder;
+      }
+    }
+    ZXReedSolomonEncoder *encoder = [[[ZXReedSolomonEncoder alloc] initWithField:aField] autorelease];
+    [sharedEncoders addObject:encoder];
+    return encoder;
+  }
+}
+
 - (id)initWithField:(ZXGenericGF *)aField {
   if (self = [super init]) {
     self.field = aField;
-    int one = 1;
-    self.cachedGenerators = [NSMutableArray arrayWithObject:[[[ZXGenericGFPoly alloc] initWithField:aField coefficients:&one coefficientsLen:1] autorelease]];
+    // A generator of degree size - 1 or more would repeat roots, so that bounds the cache.
+    cachedGenerators = (int **)calloc(aField.size, sizeof(int *));
   }
 
   return self;
 }
 
 - (void)dealloc {
-  [cachedGenerators release];
+  if (cachedGenerators != NULL) {
+    for (int i = 0; i < field.size; i++) {
+      free(cachedGenerators[i]);
+    }
+    free(cachedGenerators);
+  }
   [field release];
 
   [super dealloc];
 }
 
-- (ZXGenericGFPoly *)buildGenerator:(int)degree {
-  if (degree >= self.cachedGenerators.count) {
-    ZXGenericGFPoly *lastGenerator = [self.cachedGenerators objectAtIndex:[cachedGenerators count] - 1];
-    for (int d = [self.cachedGenerators count]; d <= degree; d++) {
-      int next[2] = { 1, [field exp:d - 1 + field.generatorBase] };
-      ZXGenericGFPoly *nextGenerator = [lastGenerator multiply:[[[ZXGenericGFPoly alloc] initWithField:field coefficients:next coefficientsLen:2] autorelease]];
-      [self.cachedGenerators addObject:nextGenerator];
-      lastGenerator = nextGenerator;
+/**
+ * Returns the log-domain coefficients 1..degree of the product of (x - a^(i + generatorBase))
+ * for i in [0, degree), building it on first use. The arrays are never freed while the
+ * encoder lives, so callers can use them outside the lock.
+ */
+- (const int *)generatorLogs:(int)degree {
+  @synchronized(self) {
+    if (cachedGenerators[degree] == NULL) {
+      int *expTable = field.expTable;
+      int *logTable = field.logTable;
+      int order = field.size - 1;
+      int generator[degree + 1];
+      generator[0] = 1;
+      for (int d = 1; d <= degree; d++) {
+        int logRoot = (d - 1 + field.generatorBase) % order;
+        generator[d] = 0;
+        for (int i = d; i > 0; i--) {
+          if (generator[i - 1] != 0) {
+            int e = logTable[generator[i - 1]] + logRoot;
+            generator[i] ^= expTable[e >= order ? e - order : e];
+          }
+        }
+      }
+      int *logs = (int *)malloc(degree * sizeof(int));
+      for (int i = 0; i < degree; i++) {
+        logs[i] = generator[i + 1] == 0 ? -1 : logTable[generator[i + 1]];
+      }
+      cachedGenerators[degree] = logs;
     }
+    return cachedGenerators[degree];
   }
-
-  return (ZXGenericGFPoly *)[self.cachedGenerators objectAtIndex:degree];
 }
 
 - (void)encode:(int *)toEncode toEncodeLen:(int)toEncodeLen ecBytes:(int)ecBytes {
-  if (ecBytes == 0) {
+  [self encodeData:toEncode dataLen:toEncodeLen - ecBytes ecWords:toEncode + toEncodeLen - ecBytes ecLen:ecBytes];
+}
+
+/**
+ * Computes ecLen error correction words for dataLen data words into ecWords, which must not
+ * overlap the data except by starting right after it.
+ */
+- (void)encodeData:(const int *)data dataLen:(int)dataLen ecWords:(int *)ecWords ecLen:(int)ecLen {
+  if (ecLen <= 0) {
     @throw [NSException exceptionWithName:NSInvalidArgumentException
                                    reason:@"No error correction bytes"
                                  userInfo:nil];
   }
-  int dataBytes = toEncodeLen - ecBytes;
-  if (dataBytes <= 0) {
+  if (dataLen <= 0) {
     @throw [NSException exceptionWithName:NSInvalidArgumentException
                                    reason:@"No data bytes provided"
                                  userInfo:nil];
   }
-  ZXGenericGFPoly *generator = [self buildGenerator:ecBytes];
-  int infoCoefficients[dataBytes];
-  for (int i = 0; i < dataBytes; i++) {
-    infoCoefficients[i] = toEncode[i];
-  }
-  ZXGenericGFPoly *info = [[[ZXGenericGFPoly alloc] initWithField:field coefficients:infoCoefficients coefficientsLen:dataBytes] autorelease];
-  info = [info multiplyByMonomial:ecBytes coefficient:1];
-  ZXGenericGFPoly *remainder = [[info divide:generator] objectAtIndex:1];
-  int *coefficients = remainder.coefficients;
-  int coefficientsLen = remainder.coefficientsLen;
-  int numZeroCoefficients = ecBytes - coefficientsLen;
-  for (int i = 0; i < numZeroCoefficients; i++) {
-    toEncode[dataBytes + i] = 0;
-  }
-  for (int i = 0; i < coefficientsLen; i++) {
-    toEncode[dataBytes + numZeroCoefficients + i] = coefficients[i];
+  if (ecLen >= field.size) {
+    @throw [NSException exceptionWithName:NSInvalidArgumentException
+                                   reason:@"Too many error correction bytes for the field"
+                                 userInfo:nil];
   }
+  const int *generatorLogs = [self generatorLogs:ecLen];
+  ZXReedSolomonEncodeWords(field.expTable, field.logTable, field.size - 1, generatorLogs, data, dataLen, ecWords, ecLen);
 }
 
 @end
@@ -20,6 +20,7 @@
 #import "ZXDataMatrixReader.h"
 #import "ZXDataMatrixDetector.h"
 #import "ZXDecodeHints.h"
+#import "ZXDecodeTrace.h"
 #import "ZXDecoderResult.h"
 #import "ZXDetectorResult.h"
 #import "ZXErrors.h"
@@ -83,14 +84,24 @@
     if (!matrix) {
       return nil;
     }
-    ZXDataMatrixDetector *detector = [[[ZXDataMatrixDetector alloc] initWithImage:matrix error:error] autorelease];
-    if (!detector) {
+    // The detector walks out from the center a bounded distance rather than scanning rows, so
+    // cancellation is checked around it instead of inside it.
+    if (hints.cancelled) {
+      if (error) *error = NotFoundErrorInstance();
       return nil;
     }
-    ZXDetectorResult *detectorResult = [detector detectWithError:error];
+    ZX_TRACE_BEGIN(traceStart);
+    ZXDataMatrixDetector *detector = [[[ZXDataMatrixDetector alloc] initWithImage:matrix error:error] autorelease];
+    ZXDetectorResult *detectorResult = detector ? [detector detectWithError:error] : nil;
+    ZX_TRACE_END(traceStart, kZXDecodeStageDetect);
     if (!detectorResult) {
       return nil;
     }
+    ZX_TRACE_COUNT(candidatesFound, 1);
+    if (hints.cancelled) {
+      if (error) *error = NotFoundErrorInstance();
+      return nil;
+    }
     decoderResult = [decoder decodeMatrix:detectorResult.bits error:error];
     if (!decoderResult) {
       return nil;
@@ -21,7 +21,7 @@
 #import "ZXDefaultPlacement.h"
 #import "ZXDimension.h"
 #import "ZXEncodeHints.h"
-#import "ZXHighLevelEncoder.h"
+#import "ZXMinimalEncoder.h"
 #import "ZXSymbolInfo.h"
 #import "ZXSymbolShapeHint.h"
 
@@ -72,7 +72,7 @@
   }
 
   //1. step: Data encodation
-  NSString *encoded = [ZXHighLevelEncoder encodeHighLevel:contents shape:shape minSize:minSize maxSize:maxSize];
+  NSString *encoded = [ZXMinimalEncoder encodeHighLevel:contents shape:shape minSize:minSize maxSize:maxSize];
 
   ZXSymbolInfo *symbolInfo = [ZXSymbolInfo lookup:encoded.length shape:shape minSize:minSize maxSize:maxSize fail:YES];
 
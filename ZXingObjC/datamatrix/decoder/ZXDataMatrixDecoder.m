@@ -20,6 +20,7 @@
 #import "ZXDataMatrixDecodedBitStreamParser.h"
 #import "ZXDataMatrixDecoder.h"
 #import "ZXDataMatrixVersion.h"
+#import "ZXDecodeTrace.h"
 #import "ZXDecoderResult.h"
 #import "ZXErrors.h"
 #import "ZXGenericGF.h"
@@ -110,7 +111,10 @@
     }
   }
 
-  return [ZXDataMatrixDecodedBitStreamParser decode:resultBytes length:totalBytes error:error];
+  ZX_TRACE_BEGIN(traceStart);
+  ZXDecoderResult *result = [ZXDataMatrixDecodedBitStreamParser decode:resultBytes length:totalBytes error:error];
+  ZX_TRACE_END(traceStart, kZXDecodeStageParse);
+  return result;
 }
 
 
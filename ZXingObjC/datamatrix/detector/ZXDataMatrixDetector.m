@@ -15,6 +15,7 @@
  */
 
 #import "ZXDataMatrixDetector.h"
+#import "ZXDecodeTrace.h"
 #import "ZXDetectorResult.h"
 #import "ZXErrors.h"
 #import "ZXGridSampler.h"
@@ -346,17 +347,20 @@
                  dimensionY:(int)dimensionY
                       error:(NSError **)error {
   ZXGridSampler *sampler = [ZXGridSampler instance];
-  return [sampler sampleGrid:anImage
-                  dimensionX:dimensionX dimensionY:dimensionY
-                       p1ToX:0.5f p1ToY:0.5f
-                       p2ToX:dimensionX - 0.5f p2ToY:0.5f
-                       p3ToX:dimensionX - 0.5f p3ToY:dimensionY - 0.5f
-                       p4ToX:0.5f p4ToY:dimensionY - 0.5f
-                     p1FromX:[topLeft x] p1FromY:[topLeft y]
-                     p2FromX:[topRight x] p2FromY:[topRight y]
-                     p3FromX:[bottomRight x] p3FromY:[bottomRight y]
-                     p4FromX:[bottomLeft x] p4FromY:[bottomLeft y]
-                       error:error];
+  ZX_TRACE_BEGIN(traceStart);
+  ZXBitMatrix *bits = [sampler sampleGrid:anImage
+                               dimensionX:dimensionX dimensionY:dimensionY
+                                    p1ToX:0.5f p1ToY:0.5f
+                                    p2ToX:dimensionX - 0.5f p2ToY:0.5f
+                                    p3ToX:dimensionX - 0.5f p3ToY:dimensionY - 0.5f
+                                    p4ToX:0.5f p4ToY:dimensionY - 0.5f
+                                  p1FromX:[topLeft x] p1FromY:[topLeft y]
+                                  p2FromX:[topRight x] p2FromY:[topRight y]
+                                  p3FromX:[bottomRight x] p3FromY:[bottomRight y]
+                                  p4FromX:[bottomLeft x] p4FromY:[bottomLeft y]
+                                    error:error];
+  ZX_TRACE_END(traceStart, kZXDecodeStageSample);
+  return bits;
 }
 
 
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2013 ZXing authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * The largest number of data codewords in an ECC 200 symbol (144x144).
+ */
+extern int const DATA_MATRIX_MAX_DATA_CODEWORDS;
+
+/**
+ * DataMatrix ECC 200 data encoder that finds the shortest encodation of a message across the
+ * ASCII, C40, Text, ANSI X12, EDIFACT and Base 256 modes.
+ *
+ * ZXHighLevelEncoder follows the look-ahead heuristic of ISO/IEC 16022:2000(E) annex P, which
+ * rescans the rest of the message at every mode decision. This encoder instead walks the message
+ * bytes once, keeping the cheapest way to reach each position in each mode, so it runs in time
+ * linear in the message length. Its result is never longer than ZXHighLevelEncoder's and can
+ * fit a smaller symbol.
+ */
+
+@class ZXDimension, ZXSymbolShapeHint;
+
+@interface ZXMinimalEncoder : NSObject
+
+/**
+ * Encodes length ISO-8859-1 bytes into codewords, padded to the data capacity of the smallest
+ * symbol that holds them, and returns the number of codewords written. Raises
+ * NSInvalidArgumentException if no allowed symbol holds the message or if its data capacity is
+ * more than capacity.
+ */
++ (int)encodeBytes:(const unsigned char *)bytes length:(int)length shape:(ZXSymbolShapeHint *)shape
+           minSize:(ZXDimension *)minSize maxSize:(ZXDimension *)maxSize
+         codewords:(unsigned char *)codewords capacity:(int)capacity;
+
+/**
+ * Performs message encoding of a DataMatrix message, returning the codewords 0..255 as
+ * characters as ZXHighLevelEncoder does.
+ */
++ (NSString *)encodeHighLevel:(NSString *)msg;
+
++ (NSString *)encodeHighLevel:(NSString *)msg shape:(ZXSymbolShapeHint *)shape
+                      minSize:(ZXDimension *)minSize maxSize:(ZXDimension *)maxSize;
+
+@end
@@ -0,0 +1,581 @@
+/*
+ * Copyright 2013 ZXing authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import "ZXMinimalEncoder.h"
+#import "ZXSymbolInfo.h"
+#import "ZXSymbolShapeHint.h"
+
+int const DATA_MATRIX_MAX_DATA_CODEWORDS = 1558;
+
+/**
+ * Each position in the message has one node per mode, and C40, Text, X12 and EDIFACT have one
+ * node per number of values still waiting for their triplet or quadruplet. Base 256 has one
+ * node for segments with a one byte length field and one for those with two.
+ */
+enum {
+  ZXMinimalStateASCII = 0,
+  ZXMinimalStateC40,
+  ZXMinimalStateText = ZXMinimalStateC40 + 3,
+  ZXMinimalStateX12 = ZXMinimalStateText + 3,
+  ZXMinimalStateEdifact = ZXMinimalStateX12 + 3,
+  ZXMinimalStateBase256Short = ZXMinimalStateEdifact + 4,
+  ZXMinimalStateBase256Long,
+  ZXMinimalStateCount
+};
+
+const int MINIMAL_UNREACHED = INT_MAX / 2;
+
+/**
+ * Longest Base 256 segment with a one byte length field
+ */
+const int MINIMAL_BASE256_SHORT = 249;
+
+/**
+ * Codewords taken by an EDIFACT unlatch after 0-3 pending values
+ */
+static const int MINIMAL_EDIFACT_UNLATCH_BYTES[4] = {1, 2, 3, 3};
+
+typedef struct {
+  int *cost;
+  int *fromPosition;
+  unsigned char *fromState;
+  // Fewest ASCII codewords for the rest of the message from each position
+  int *asciiTail;
+} ZXMinimalGraph;
+
+/**
+ * A way to finish the message: the node it leaves from, whether the rest of the message goes
+ * out as ASCII without an unlatch, the codeword count to size the symbol for and how many of the
+ * symbol's codewords may be left over for the ending to be valid.
+ */
+typedef struct {
+  int position;
+  int state;
+  BOOL asciiTail;
+  int length;
+  int maxUnused;
+} ZXMinimalCandidate;
+
+static int ZXMinimalC40Values(unsigned char c, BOOL text, int *values) {
+  int count = 0;
+  if (c >= 128) {
+    values[count++] = 1; //Shift 2 Set
+    values[count++] = 30; //Upper Shift
+    c -= 128;
+  }
+  if (c == ' ') {
+    values[count++] = 3;
+  } else if (c >= '0' && c <= '9') {
+    values[count++] = c - '0' + 4;
+  } else if (!text && c >= 'A' && c <= 'Z') {
+    values[count++] = c - 'A' + 14;
+  } else if (text && c >= 'a' && c <= 'z') {
+    values[count++] = c - 'a' + 14;
+  } else if (c <= 0x1f) {
+    values[count++] = 0; //Shift 1 Set
+    values[count++] = c;
+  } else if (c >= '!' && c <= '/') {
+    values[count++] = 1; //Shift 2 Set
+    values[count++] = c - '!';
+  } else if (c >= ':' && c <= '@') {
+    values[count++] = 1;
+    values[count++] = c - ':' + 15;
+  } else if (c >= '[' && c <= '_') {
+    values[count++] = 1;
+    values[count++] = c - '[' + 22;
+  } else if (!text) {
+    values[count++] = 2; //Shift 3 Set
+    values[count++] = c - '`';
+  } else if (c == '`') {
+    values[count++] = 2;
+    values[count++] = 0;
+  } else if (c >= 'A' && c <= 'Z') {
+    values[count++] = 2;
+    values[count++] = c - 'A' + 1;
+  } else {
+    values[count++] = 2;
+    values[count++] = c - '{' + 27;
+  }
+  return count;
+}
+
+static int ZXMinimalX12Value(unsigned char c) {
+  if (c == '\r') {
+    return 0;
+  } else if (c == '*') {
+    return 1;
+  } else if (c == '>') {
+    return 2;
+  } else if (c == ' ') {
+    return 3;
+  } else if (c >= '0' && c <= '9') {
+    return c - '0' + 4;
+  } else if (c >= 'A' && c <= 'Z') {
+    return c - 'A' + 14;
+  }
+  return -1;
+}
+
+static int ZXMinimalEdifactValue(unsigned char c) {
+  if (c >= ' ' && c <= '?') {
+    return c;
+  } else if (c >= '@' && c <= '^') {
+    return c - 64;
+  }
+  return -1;
+}
+
+static BOOL ZXMinimalIsDigit(unsigned char c) {
+  return c >= '0' && c <= '9';
+}
+
+static int ZXMinimalGroup(int state) {
+  if (state >= ZXMinimalStateBase256Short) {
+    return ZXMinimalStateBase256Short;
+  } else if (state >= ZXMinimalStateEdifact) {
+    return ZXMinimalStateEdifact;
+  } else if (state >= ZXMinimalStateX12) {
+    return ZXMinimalStateX12;
+  } else if (state >= ZXMinimalStateText) {
+    return ZXMinimalStateText;
+  } else if (state >= ZXMinimalStateC40) {
+    return ZXMinimalStateC40;
+  }
+  return ZXMinimalStateASCII;
+}
+
+static void ZXMinimalRelax(ZXMinimalGraph *graph, int position, int state, int cost, int fromPosition, int fromState) {
+  int index = position * ZXMinimalStateCount + state;
+  if (cost < graph->cost[index]) {
+    graph->cost[index] = cost;
+    graph->fromPosition[index] = fromPosition;
+    graph->fromState[index] = (unsigned char)fromState;
+  }
+}
+
+/**
+ * Finds the fewest codewords that reach every node, front to back. At each position the modes
+ * first unlatch to ASCII and ASCII then latches to the others; each byte then moves every mode
+ * on to the next position.
+ */
+static void ZXMinimalBuildGraph(const unsigned char *bytes, int length, int base, ZXMinimalGraph *graph, int *entry, int *window) {
+  for (int i = 0, nodes = (length + 1) * ZXMinimalStateCount; i < nodes; i++) {
+    graph->cost[i] = MINIMAL_UNREACHED;
+  }
+  graph->cost[ZXMinimalStateASCII] = base;
+  graph->fromPosition[ZXMinimalStateASCII] = -1;
+
+  graph->asciiTail[length] = 0;
+  for (int i = length - 1; i >= 0; i--) {
+    graph->asciiTail[i] = graph->asciiTail[i + 1] + (bytes[i] >= 128 ? 2 : 1);
+    if (i + 1 < length && ZXMinimalIsDigit(bytes[i]) && ZXMinimalIsDigit(bytes[i + 1])
+        && graph->asciiTail[i + 2] + 1 < graph->asciiTail[i]) {
+      graph->asciiTail[i] = graph->asciiTail[i + 2] + 1;
+    }
+  }
+
+  // A Base 256 segment from j to i costs entry[j] (ASCII at j plus the latch and a length byte)
+  // plus i - j, and one more byte past MINIMAL_BASE256_SHORT. The cheapest entry in reach of a
+  // one byte length field is kept at the head of a monotonic queue, the cheapest older one in a
+  // running minimum.
+  int windowHead = 0;
+  int windowTail = 0;
+  int longBest = MINIMAL_UNREACHED;
+  int longFrom = -1;
+
+  for (int i = 0; i <= length; i++) {
+    int *cost = graph->cost + i * ZXMinimalStateCount;
+    if (i > 0) {
+      int j = i - 1;
+      if (entry[j] < MINIMAL_UNREACHED) {
+        while (windowTail > windowHead && entry[window[windowTail - 1]] - window[windowTail - 1] >= entry[j] - j) {
+          windowTail--;
+        }
+        window[windowTail++] = j;
+      }
+      while (windowTail > windowHead && window[windowHead] < i - MINIMAL_BASE256_SHORT) {
+        windowHead++;
+      }
+      if (windowTail > windowHead) {
+        int from = window[windowHead];
+        ZXMinimalRelax(graph, i, ZXMinimalStateBase256Short, entry[from] + i - from, from, ZXMinimalStateASCII);
+      }
+      j = i - MINIMAL_BASE256_SHORT - 1;
+      if (j >= 0 && entry[j] < MINIMAL_UNREACHED && entry[j] - j < longBest) {
+        longBest = entry[j] - j;
+        longFrom = j;
+      }
+      if (longFrom >= 0) {
+        ZXMinimalRelax(graph, i, ZXMinimalStateBase256Long, longBest + i + 1, longFrom, ZXMinimalStateASCII);
+      }
+    }
+
+    ZXMinimalRelax(graph, i, ZXMinimalStateASCII, cost[ZXMinimalStateC40] + 1, i, ZXMinimalStateC40);
+    ZXMinimalRelax(graph, i, ZXMinimalStateASCII, cost[ZXMinimalStateText] + 1, i, ZXMinimalStateText);
+    ZXMinimalRelax(graph, i, ZXMinimalStateASCII, cost[ZXMinimalStateX12] + 1, i, ZXMinimalStateX12);
+    for (int p = 0; p < 4; p++) {
+      ZXMinimalRelax(graph, i, ZXMinimalStateASCII, cost[ZXMinimalStateEdifact + p] + MINIMAL_EDIFACT_UNLATCH_BYTES[p],
+                     i, ZXMinimalStateEdifact + p);
+    }
+    ZXMinimalRelax(graph, i, ZXMinimalStateASCII, cost[ZXMinimalStateBase256Short], i, ZXMinimalStateBase256Short);
+    ZXMinimalRelax(graph, i, ZXMinimalStateASCII, cost[ZXMinimalStateBase256Long], i, ZXMinimalStateBase256Long);
+
+    int ascii = cost[ZXMinimalStateASCII];
+    entry[i] = ascii < MINIMAL_UNREACHED ? ascii + 2 : MINIMAL_UNREACHED;
+    if (ascii < MINIMAL_UNREACHED) {
+      ZXMinimalRelax(graph, i, ZXMinimalStateC40, ascii + 1, i, ZXMinimalStateASCII);
+      ZXMinimalRelax(graph, i, ZXMinimalStateText, ascii + 1, i, ZXMinimalStateASCII);
+      ZXMinimalRelax(graph, i, ZXMinimalStateX12, ascii + 1, i, ZXMinimalStateASCII);
+      ZXMinimalRelax(graph, i, ZXMinimalStateEdifact, ascii + 1, i, ZXMinimalStateASCII);
+    }
+    if (i == length) {
+      break;
+    }
+
+    unsigned char c = bytes[i];
+    if (ascii < MINIMAL_UNREACHED) {
+      ZXMinimalRelax(graph, i + 1, ZXMinimalStateASCII, ascii + (c >= 128 ? 2 : 1), i, ZXMinimalStateASCII);
+      if (i + 1 < length && ZXMinimalIsDigit(c) && ZXMinimalIsDigit(bytes[i + 1])) {
+        ZXMinimalRelax(graph, i + 2, ZXMinimalStateASCII, ascii + 1, i, ZXMinimalStateASCII);
+      }
+    }
+
+    int values[4];
+    for (int state = ZXMinimalStateC40; state <= ZXMinimalStateText; state += 3) {
+      int count = ZXMinimalC40Values(c, state == ZXMinimalStateText, values);
+      for (int p = 0; p < 3; p++) {
+        if (cost[state + p] < MINIMAL_UNREACHED) {
+          ZXMinimalRelax(graph, i + 1, state + (p + count) % 3, cost[state + p] + 2 * ((p + count) / 3), i, state + p);
+        }
+      }
+    }
+    if (ZXMinimalX12Value(c) >= 0) {
+      for (int p = 0; p < 3; p++) {
+        if (cost[ZXMinimalStateX12 + p] < MINIMAL_UNREACHED) {
+          ZXMinimalRelax(graph, i + 1, ZXMinimalStateX12 + (p + 1) % 3, cost[ZXMinimalStateX12 + p] + (p == 2 ? 2 : 0),
+                         i, ZXMinimalStateX12 + p);
+        }
+      }
+    }
+    if (ZXMinimalEdifactValue(c) >= 0) {
+      for (int p = 0; p < 4; p++) {
+        if (cost[ZXMinimalStateEdifact + p] < MINIMAL_UNREACHED) {
+          ZXMinimalRelax(graph, i + 1, ZXMinimalStateEdifact + (p + 1) % 4, cost[ZXMinimalStateEdifact + p] + (p == 3 ? 3 : 0),
+                         i, ZXMinimalStateEdifact + p);
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Lists the ways to end the message. Besides ending in any mode, the last one or two codewords
+ * of a symbol are read as ASCII without an unlatch when they follow a C40, Text or X12 triplet
+ * (one codeword) or an EDIFACT quadruplet (two), and a Base 256 segment that fills the symbol
+ * may give its length as 0.
+ */
+static int ZXMinimalEndCandidates(ZXMinimalGraph *graph, int length, ZXMinimalCandidate *candidates) {
+  static const int endStates[] = {ZXMinimalStateASCII, ZXMinimalStateC40, ZXMinimalStateC40 + 2,
+    ZXMinimalStateText, ZXMinimalStateText + 2, ZXMinimalStateX12,
+    ZXMinimalStateEdifact, ZXMinimalStateEdifact + 1, ZXMinimalStateEdifact + 2, ZXMinimalStateEdifact + 3,
+    ZXMinimalStateBase256Short, ZXMinimalStateBase256Long};
+  // Codewords still to write: a padded last triplet, or the EDIFACT values and unlatch
+  static const int endBytes[] = {0, 0, 2, 0, 2, 0, 0, 2, 3, 3, 0, 0};
+  static const int tripletStates[] = {ZXMinimalStateC40, ZXMinimalStateText, ZXMinimalStateX12};
+
+  int count = 0;
+  const int *cost = graph->cost + length * ZXMinimalStateCount;
+  for (int i = 0; i < sizeof(endStates) / sizeof(int); i++) {
+    if (cost[endStates[i]] < MINIMAL_UNREACHED) {
+      candidates[count++] = (ZXMinimalCandidate){length, endStates[i], NO, cost[endStates[i]] + endBytes[i], INT_MAX};
+    }
+  }
+  if (cost[ZXMinimalStateBase256Long] < MINIMAL_UNREACHED) {
+    candidates[count++] = (ZXMinimalCandidate){length, ZXMinimalStateBase256Long, NO, cost[ZXMinimalStateBase256Long] - 1, 0};
+  }
+  for (int j = length - 1; j >= 0 && j >= length - 4; j--) {
+    int tail = graph->asciiTail[j];
+    const int *tailCost = graph->cost + j * ZXMinimalStateCount;
+    if (tail == 1) {
+      for (int i = 0; i < 3; i++) {
+        if (tailCost[tripletStates[i]] < MINIMAL_UNREACHED) {
+          candidates[count++] = (ZXMinimalCandidate){j, tripletStates[i], YES, tailCost[tripletStates[i]] + 1, 0};
+        }
+      }
+    }
+    if (tail <= 2 && tailCost[ZXMinimalStateEdifact] < MINIMAL_UNREACHED) {
+      candidates[count++] = (ZXMinimalCandidate){j, ZXMinimalStateEdifact, YES, tailCost[ZXMinimalStateEdifact] + tail, 2 - tail};
+    }
+  }
+  return count;
+}
+
+static void ZXMinimalWrite(unsigned char *codewords, int *written, int codeword) {
+  codewords[(*written)++] = (unsigned char)codeword;
+}
+
+static void ZXMinimalWriteBase256(unsigned char *codewords, int *written, int value) {
+  int pseudoRandom = ((149 * (*written + 1)) % 255) + 1;
+  int randomized = value + pseudoRandom;
+  ZXMinimalWrite(codewords, written, randomized <= 255 ? randomized : randomized - 256);
+}
+
+static void ZXMinimalWriteASCII(const unsigned char *bytes, int *position, BOOL pairDigits, unsigned char *codewords, int *written) {
+  unsigned char c = bytes[*position];
+  if (pairDigits) {
+    ZXMinimalWrite(codewords, written, (c - '0') * 10 + (bytes[*position + 1] - '0') + 130);
+    *position += 2;
+  } else if (c >= 128) {
+    ZXMinimalWrite(codewords, written, 235); //Upper Shift
+    ZXMinimalWrite(codewords, written, c - 128 + 1);
+    (*position)++;
+  } else {
+    ZXMinimalWrite(codewords, written, c + 1);
+    (*position)++;
+  }
+}
+
+static void ZXMinimalWriteTriplets(int *values, int *count, unsigned char *codewords, int *written) {
+  int i = 0;
+  for (; i + 3 <= *count; i += 3) {
+    int v = (1600 * values[i]) + (40 * values[i + 1]) + values[i + 2] + 1;
+    ZXMinimalWrite(codewords, written, v / 256);
+    ZXMinimalWrite(codewords, written, v % 256);
+  }
+  *count -= i;
+  memmove(values, values + i, *count * sizeof(int));
+}
+
+static void ZXMinimalWriteEdifact(const unsigned char *pending, int count, unsigned char *codewords, int *written) {
+  int v = 0;
+  for (int i = 0; i < 4; i++) {
+    v = (v << 6) | (i < count ? ZXMinimalEdifactValue(pending[i]) : (i == count ? 31 : 0));
+  }
+  for (int i = 0, n = MIN(count + 1, 3); i < n; i++) {
+    ZXMinimalWrite(codewords, written, (v >> (16 - 8 * i)) & 0xFF);
+  }
+}
+
+/**
+ * Ends an EDIFACT segment. Once two or fewer codewords remain in the symbol the decoder reads
+ * them as ASCII, so the unlatch is dropped and any pending characters go out as ASCII.
+ */
+static void ZXMinimalUnlatchEdifact(const unsigned char *pending, int count, int capacity, unsigned char *codewords, int *written) {
+  if (capacity - *written <= 2) {
+    for (int i = 0; i < count; i++) {
+      ZXMinimalWrite(codewords, written, pending[i] + 1);
+    }
+  } else {
+    ZXMinimalWriteEdifact(pending, count, codewords, written);
+  }
+}
+
+/**
+ * Replays the cheapest path to the chosen ending and writes its codewords, then pads the symbol.
+ */
+static int ZXMinimalWritePath(const unsigned char *bytes, int length, ZXMinimalGraph *graph, ZXMinimalCandidate *candidate,
+                              int capacity, unsigned char *codewords, int written, int *path) {
+  // Each position is left by at most one unlatch, one latch and one byte.
+  int pathLength = 0;
+  int position = candidate->position;
+  int state = candidate->state;
+  while (YES) {
+    path[pathLength++] = position * ZXMinimalStateCount + state;
+    int index = position * ZXMinimalStateCount + state;
+    if (graph->fromPosition[index] < 0) {
+      break;
+    }
+    position = graph->fromPosition[index];
+    state = graph->fromState[index];
+  }
+
+  int values[8];
+  int valueCount = 0;
+  unsigned char edifact[4];
+  int edifactCount = 0;
+  for (int step = pathLength - 1; step > 0; step--) {
+    int from = path[step] / ZXMinimalStateCount;
+    int fromGroup = ZXMinimalGroup(path[step] % ZXMinimalStateCount);
+    int to = path[step - 1] / ZXMinimalStateCount;
+    int toGroup = ZXMinimalGroup(path[step - 1] % ZXMinimalStateCount);
+
+    if (toGroup == ZXMinimalStateBase256Short) {
+      int count = to - from;
+      ZXMinimalWrite(codewords, &written, 231); //Latch to Base 256
+      if (to == length && !candidate->asciiTail && written + 1 + count == capacity) {
+        ZXMinimalWriteBase256(codewords, &written, 0); //Segment runs to the end of the symbol
+      } else if (count <= MINIMAL_BASE256_SHORT) {
+        ZXMinimalWriteBase256(codewords, &written, count);
+      } else {
+        ZXMinimalWriteBase256(codewords, &written, (count / 250) + 249);
+        ZXMinimalWriteBase256(codewords, &written, count % 250);
+      }
+      for (int i = from; i < to; i++) {
+        ZXMinimalWriteBase256(codewords, &written, bytes[i]);
+      }
+    } else if (from == to && toGroup == ZXMinimalStateASCII) {
+      if (fromGroup == ZXMinimalStateEdifact) {
+        ZXMinimalUnlatchEdifact(edifact, edifactCount, capacity, codewords, &written);
+        edifactCount = 0;
+      } else if (fromGroup != ZXMinimalStateBase256Short) {
+        ZXMinimalWrite(codewords, &written, 254); //Unlatch
+      }
+    } else if (from == to) {
+      if (toGroup == ZXMinimalStateC40) {
+        ZXMinimalWrite(codewords, &written, 230);
+      } else if (toGroup == ZXMinimalStateText) {
+        ZXMinimalWrite(codewords, &written, 239);
+      } else if (toGroup == ZXMinimalStateX12) {
+        ZXMinimalWrite(codewords, &written, 238);
+      } else {
+        ZXMinimalWrite(codewords, &written, 240);
+      }
+    } else if (toGroup == ZXMinimalStateASCII) {
+      int i = from;
+      ZXMinimalWriteASCII(bytes, &i, to - from == 2, codewords, &written);
+    } else if (toGroup == ZXMinimalStateEdifact) {
+      edifact[edifactCount++] = bytes[from];
+      if (edifactCount == 4) {
+        ZXMinimalWriteEdifact(edifact, 4, codewords, &written);
+        edifactCount = 0;
+      }
+    } else {
+      if (toGroup == ZXMinimalStateX12) {
+        values[valueCount++] = ZXMinimalX12Value(bytes[from]);
+      } else {
+        valueCount += ZXMinimalC40Values(bytes[from], toGroup == ZXMinimalStateText, values + valueCount);
+      }
+      ZXMinimalWriteTriplets(values, &valueCount, codewords, &written);
+    }
+  }
+
+  int endGroup = ZXMinimalGroup(candidate->state);
+  if (candidate->asciiTail) {
+    for (int i = candidate->position; i < length;) {
+      BOOL pairDigits = i + 1 < length && ZXMinimalIsDigit(bytes[i]) && ZXMinimalIsDigit(bytes[i + 1])
+        && graph->asciiTail[i] == graph->asciiTail[i + 2] + 1;
+      ZXMinimalWriteASCII(bytes, &i, pairDigits, codewords, &written);
+    }
+  } else if (endGroup == ZXMinimalStateC40 || endGroup == ZXMinimalStateText || endGroup == ZXMinimalStateX12) {
+    if (valueCount == 2) {
+      values[valueCount++] = 0; //Shift 1 completes the last triplet
+      ZXMinimalWriteTriplets(values, &valueCount, codewords, &written);
+    }
+    if (written < capacity) {
+      ZXMinimalWrite(codewords, &written, 254); //Unlatch
+    }
+  } else if (endGroup == ZXMinimalStateEdifact) {
+    ZXMinimalUnlatchEdifact(edifact, edifactCount, capacity, codewords, &written);
+  }
+
+  //Padding
+  if (written < capacity) {
+    ZXMinimalWrite(codewords, &written, 129);
+  }
+  while (written < capacity) {
+    int pseudoRandom = ((149 * (written + 1)) % 253) + 1;
+    int randomized = 129 + pseudoRandom;
+    ZXMinimalWrite(codewords, &written, randomized <= 254 ? randomized : randomized - 254);
+  }
+  return written;
+}
+
+@implementation ZXMinimalEncoder
+
++ (int)encodeBytes:(const unsigned char *)bytes length:(int)length shape:(ZXSymbolShapeHint *)shape
+           minSize:(ZXDimension *)minSize maxSize:(ZXDimension *)maxSize
+         codewords:(unsigned char *)codewords capacity:(int)capacity {
+  int written = 0;
+  if (length >= 9 && memcmp(bytes, "[)>\x1e", 4) == 0 && bytes[4] == '0' && (bytes[5] == '5' || bytes[5] == '6')
+      && bytes[6] == 0x1d && bytes[length - 2] == 0x1e && bytes[length - 1] == 0x04) {
+    if (capacity > 0) {
+      ZXMinimalWrite(codewords, &written, bytes[5] == '5' ? 236 : 237); //05 or 06 Macro
+    }
+    bytes += 7;
+    length -= 9;
+  }
+
+  int nodes = (length + 1) * ZXMinimalStateCount;
+  ZXMinimalGraph graph;
+  graph.cost = (int *)malloc(nodes * sizeof(int));
+  graph.fromPosition = (int *)malloc(nodes * sizeof(int));
+  graph.fromState = (unsigned char *)malloc(nodes * sizeof(unsigned char));
+  graph.asciiTail = (int *)malloc((length + 2) * sizeof(int));
+  int *scratch = (int *)malloc((3 * (length + 1) + 1) * sizeof(int));
+  int *entry = (int *)malloc((length + 1) * sizeof(int));
+
+  ZXMinimalBuildGraph(bytes, length, written, &graph, entry, scratch);
+
+  ZXMinimalCandidate candidates[32];
+  int candidateCount = ZXMinimalEndCandidates(&graph, length, candidates);
+  ZXMinimalCandidate *best = NULL;
+  int bestCapacity = 0;
+  for (int i = 0; i < candidateCount; i++) {
+    ZXSymbolInfo *symbolInfo = [ZXSymbolInfo lookup:candidates[i].length shape:shape minSize:minSize maxSize:maxSize fail:NO];
+    if (symbolInfo == nil || symbolInfo.dataCapacity - candidates[i].length > candidates[i].maxUnused) {
+      continue;
+    }
+    if (best == NULL || symbolInfo.dataCapacity < bestCapacity
+        || (symbolInfo.dataCapacity == bestCapacity && candidates[i].length < best->length)) {
+      best = &candidates[i];
+      bestCapacity = symbolInfo.dataCapacity;
+    }
+  }
+
+  if (best != NULL && bestCapacity <= capacity) {
+    written = ZXMinimalWritePath(bytes, length, &graph, best, bestCapacity, codewords, written, scratch);
+  }
+  free(graph.cost);
+  free(graph.fromPosition);
+  free(graph.fromState);
+  free(graph.asciiTail);
+  free(scratch);
+  free(entry);
+
+  if (best == NULL) {
+    [NSException raise:NSInvalidArgumentException format:@"Can't find a symbol arrangement that matches the message. Data codewords: %d", length];
+  }
+  if (bestCapacity > capacity) {
+    [NSException raise:NSInvalidArgumentException format:@"%d codewords do not fit in a buffer of %d", bestCapacity, capacity];
+  }
+  return written;
+}
+
++ (NSString *)encodeHighLevel:(NSString *)msg {
+  return [self encodeHighLevel:msg shape:[ZXSymbolShapeHint forceNone] minSize:nil maxSize:nil];
+}
+
++ (NSString *)encodeHighLevel:(NSString *)msg shape:(ZXSymbolShapeHint *)shape
+                      minSize:(ZXDimension *)minSize maxSize:(ZXDimension *)maxSize {
+  NSData *msgData = [msg dataUsingEncoding:NSISOLatin1StringEncoding];
+  if (!msgData) {
+    [NSException raise:NSInvalidArgumentException format:@"Message contains characters outside ISO-8859-1 encoding."];
+  }
+
+  unsigned char codewords[DATA_MATRIX_MAX_DATA_CODEWORDS];
+  int count = [self encodeBytes:(const unsigned char *)[msgData bytes] length:(int)[msgData length] shape:shape
+                        minSize:minSize maxSize:maxSize codewords:codewords capacity:DATA_MATRIX_MAX_DATA_CODEWORDS];
+
+  unichar *characters = (unichar *)malloc(count * sizeof(unichar));
+  for (int i = 0; i < count; i++) {
+    characters[i] = codewords[i];
+  }
+  NSString *result = [[[NSString alloc] initWithCharacters:characters length:count] autorelease];
+  free(characters);
+  return result;
+}
+
+@end
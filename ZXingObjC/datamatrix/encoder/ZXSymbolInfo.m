@@ -34,6 +34,10 @@ static NSArray *symbols = nil;
 @synthesize rsBlockError = _rsBlockError;
 
 + (void)initialize {
+  if (self != [ZXSymbolInfo class]) {
+    return;
+  }
+
   PROD_SYMBOLS = [[NSArray alloc] initWithObjects:
                   [[[ZXSymbolInfo alloc] initWithRectangular:NO dataCapacity:3 errorCodewords:5 matrixWidth:8 matrixHeight:8 dataRegions:1] autorelease],
                   [[[ZXSymbolInfo alloc] initWithRectangular:NO dataCapacity:5 errorCodewords:7 matrixWidth:10 matrixHeight:10 dataRegions:1] autorelease],
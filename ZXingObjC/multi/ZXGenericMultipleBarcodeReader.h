@@ -19,7 +19,8 @@
 /**
  * Attempts to locate multiple barcodes in an image by repeatedly decoding portion of the image.
  * After one barcode is found, the areas left, above, right and below the barcode's
- * ZXResultPoints are scanned, recursively.
+ * ZXResultPoints are scanned, recursively. The image is binarized at most once: the areas are
+ * cut out of the black matrix already computed for the whole image.
  * 
  * A caller may want to also employ ZXByQuadrantReader when attempting to find multiple
  * 2D barcodes, like QR Codes, in an image, where the presence of multiple barcodes might prevent
@@ -33,6 +34,14 @@
 
 @interface ZXGenericMultipleBarcodeReader : NSObject <ZXMultipleBarcodeReader>
 
+/**
+ * When set, the areas around a found barcode are searched concurrently on the global dispatch
+ * queue. Readers keep per-decode state, so each concurrent search decodes with its own reader
+ * returned by this block rather than with the delegate. Results are merged in the same order
+ * as a serial search and duplicates dropped. Defaults to nil (serial).
+ */
+@property (nonatomic, copy) id<ZXReader> (^delegateFactory)(void);
+
 - (id)initWithDelegate:(id<ZXReader>)delegate;
 
 @end
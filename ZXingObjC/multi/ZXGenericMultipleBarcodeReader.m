@@ -14,9 +14,11 @@
  * limitations under the License.
  */
 
+#import "ZXBinaryBitmap.h"
 #import "ZXErrors.h"
 #import "ZXGenericMultipleBarcodeReader.h"
 #import "ZXReader.h"
+#import "ZXResult.h"
 #import "ZXResultPoint.h"
 
 int const MIN_DIMENSION_TO_RECUR = 100;
@@ -27,7 +29,9 @@ int const MAX_DEPTH = 4;
 @property (nonatomic, assign) id<ZXReader> delegate;
 
 - (BOOL)doDecodeMultiple:(ZXBinaryBitmap *)image hints:(ZXDecodeHints *)hints results:(NSMutableArray *)results
-                 xOffset:(int)xOffset yOffset:(int)yOffset currentDepth:(int)currentDepth error:(NSError **)error;
+                 xOffset:(int)xOffset yOffset:(int)yOffset currentDepth:(int)currentDepth
+                  reader:(id<ZXReader>)reader error:(NSError **)error;
+- (void)addResult:(ZXResult *)result toResults:(NSMutableArray *)results;
 - (ZXResult *)translateResultPoints:(ZXResult *)result xOffset:(int)xOffset yOffset:(int)yOffset;
 
 @end
@@ -35,6 +39,7 @@ int const MAX_DEPTH = 4;
 @implementation ZXGenericMultipleBarcodeReader
 
 @synthesize delegate;
+@synthesize delegateFactory;
 
 - (id)initWithDelegate:(id <ZXReader>)aDelegate {
   if (self = [super init]) {
@@ -44,13 +49,19 @@ int const MAX_DEPTH = 4;
   return self;
 }
 
+- (void)dealloc {
+  [delegateFactory release];
+
+  [super dealloc];
+}
+
 - (NSArray *)decodeMultiple:(ZXBinaryBitmap *)image error:(NSError **)error {
   return [self decodeMultiple:image hints:nil error:error];
 }
 
 - (NSArray *)decodeMultiple:(ZXBinaryBitmap *)image hints:(ZXDecodeHints *)hints error:(NSError **)error {
   NSMutableArray *results = [NSMutableArray array];
-  if (![self doDecodeMultiple:image hints:hints results:results xOffset:0 yOffset:0 currentDepth:0 error:error]) {
+  if (![self doDecodeMultiple:image hints:hints results:results xOffset:0 yOffset:0 currentDepth:0 reader:self.delegate error:error]) {
     return nil;
   } else if (results.count == 0) {
     if (error) *error = NotFoundErrorInstance();
@@ -59,27 +70,23 @@ int const MAX_DEPTH = 4;
   return results;
 }
 
+/**
+ * Returns NO only if nothing could be decoded in image itself. Failing to find anything in the
+ * areas around the barcode just ends that branch of the search.
+ */
 - (BOOL)doDecodeMultiple:(ZXBinaryBitmap *)image hints:(ZXDecodeHints *)hints results:(NSMutableArray *)results
-                 xOffset:(int)xOffset yOffset:(int)yOffset currentDepth:(int)currentDepth error:(NSError **)error {
+                 xOffset:(int)xOffset yOffset:(int)yOffset currentDepth:(int)currentDepth
+                  reader:(id<ZXReader>)reader error:(NSError **)error {
   if (currentDepth > MAX_DEPTH) {
     return YES;
   }
 
-  ZXResult *result = [self.delegate decode:image hints:hints error:error];
+  ZXResult *result = [reader decode:image hints:hints error:error];
   if (!result) {
     return NO;
   }
 
-  BOOL alreadyFound = NO;
-  for (ZXResult *existingResult in results) {
-    if ([[existingResult text] isEqualToString:[result text]]) {
-      alreadyFound = YES;
-      break;
-    }
-  }
-  if (!alreadyFound) {
-    [results addObject:[self translateResultPoints:result xOffset:xOffset yOffset:yOffset]];
-  }
+  [self addResult:[self translateResultPoints:result xOffset:xOffset yOffset:yOffset] toResults:results];
   NSMutableArray *resultPoints = [result resultPoints];
   if (resultPoints == nil || [resultPoints count] == 0) {
     return YES;
@@ -107,22 +114,73 @@ int const MAX_DEPTH = 4;
     }
   }
 
+  // The areas left of, above, right of and below the barcode, as left, top, width, height.
+  int areas[4][4];
+  int count = 0;
   if (minX > MIN_DIMENSION_TO_RECUR) {
-    return [self doDecodeMultiple:[image crop:0 top:0 width:(int)minX height:height] hints:hints results:results xOffset:xOffset yOffset:yOffset currentDepth:currentDepth + 1 error:error];
+    int area[4] = {0, 0, (int)minX, height};
+    memcpy(areas[count++], area, sizeof(area));
   }
   if (minY > MIN_DIMENSION_TO_RECUR) {
-    return [self doDecodeMultiple:[image crop:0 top:0 width:width height:(int)minY] hints:hints results:results xOffset:xOffset yOffset:yOffset currentDepth:currentDepth + 1 error:error];
+    int area[4] = {0, 0, width, (int)minY};
+    memcpy(areas[count++], area, sizeof(area));
   }
   if (maxX < width - MIN_DIMENSION_TO_RECUR) {
-    return [self doDecodeMultiple:[image crop:(int)maxX top:0 width:width - (int)maxX height:height] hints:hints results:results xOffset:xOffset + (int)maxX yOffset:yOffset currentDepth:currentDepth + 1 error:error];
+    int area[4] = {(int)maxX, 0, width - (int)maxX, height};
+    memcpy(areas[count++], area, sizeof(area));
   }
   if (maxY < height - MIN_DIMENSION_TO_RECUR) {
-    return [self doDecodeMultiple:[image crop:0 top:(int)maxY width:width height:height - (int)maxY] hints:hints results:results xOffset:xOffset yOffset:yOffset + (int)maxY currentDepth:currentDepth + 1 error:error];
+    int area[4] = {0, (int)maxY, width, height - (int)maxY};
+    memcpy(areas[count++], area, sizeof(area));
+  }
+
+  NSMutableArray *crops = [NSMutableArray arrayWithCapacity:count];
+  for (int i = 0; i < count; i++) {
+    [crops addObject:[image cropBinarized:areas[i][0] top:areas[i][1] width:areas[i][2] height:areas[i][3]]];
+  }
+
+  if (self.delegateFactory == nil || count < 2) {
+    for (int i = 0; i < count; i++) {
+      [self doDecodeMultiple:[crops objectAtIndex:i] hints:hints results:results
+                     xOffset:xOffset + areas[i][0] yOffset:yOffset + areas[i][1] currentDepth:currentDepth + 1
+                      reader:reader error:nil];
+    }
+    return YES;
+  }
+
+  NSMutableArray *areaResults = [NSMutableArray arrayWithCapacity:count];
+  for (int i = 0; i < count; i++) {
+    [areaResults addObject:[NSMutableArray array]];
+  }
+  int (*areasPtr)[4] = areas;
+  dispatch_apply(count, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+    [self doDecodeMultiple:[crops objectAtIndex:i] hints:hints results:[areaResults objectAtIndex:i]
+                   xOffset:xOffset + areasPtr[i][0] yOffset:yOffset + areasPtr[i][1] currentDepth:currentDepth + 1
+                    reader:self.delegateFactory() error:nil];
+    [pool drain];
+  });
+  for (NSArray *found in areaResults) {
+    for (ZXResult *areaResult in found) {
+      [self addResult:areaResult toResults:results];
+    }
   }
 
   return YES;
 }
 
+/**
+ * Adds result unless a result with the same text was already found.
+ */
+- (void)addResult:(ZXResult *)result toResults:(NSMutableArray *)results {
+  for (ZXResult *existingResult in results) {
+    if ([[existingResult text] isEqualToString:[result text]]) {
+      return;
+    }
+  }
+  [results addObject:result];
+}
+
 - (ZXResult *)translateResultPoints:(ZXResult *)result xOffset:(int)xOffset yOffset:(int)yOffset {
   NSArray *oldResultPoints = [result resultPoints];
   if (oldResultPoints == nil) {
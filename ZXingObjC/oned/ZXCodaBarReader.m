@@ -274,18 +274,13 @@ const char STARTEND_ENCODING[STARTEND_ENCODING_LEN]  = {'A', 'B', 'C', 'D'};
   if (i >= end) {
     return NO;
   }
-  BOOL isWhite = YES;
-  int count = 0;
-  for (; i < end; i++) {
-    if ([row get:i] ^ isWhite) { // that is, exactly one is true
-      count++;
-    } else {
-      [self counterAppend:count];
-      count = 1;
-      isWhite = !isWhite;
-    }
+  int runCount;
+  const int *runStarts = [row runStarts:&runCount];
+  int run = ZXOneDRunIndex(runStarts, runCount, i);
+  [self counterAppend:runStarts[run + 1] - i];
+  for (run++; run < runCount; run++) {
+    [self counterAppend:runStarts[run + 1] - runStarts[run]];
   }
-  [self counterAppend:count];
   return YES;
 }
 
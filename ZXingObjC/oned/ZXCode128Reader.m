@@ -173,6 +173,9 @@ int const CODE_STOP = 106;
 - (NSArray *)findStartPattern:(ZXBitArray *)row {
   int width = row.size;
   int rowOffset = [row nextSet:0];
+  if (rowOffset >= width) {
+    return nil;
+  }
 
   int counterPosition = 0;
 
@@ -181,40 +184,41 @@ int const CODE_STOP = 106;
   memset(counters, 0, patternLength * sizeof(int));
 
   int patternStart = rowOffset;
-  BOOL isWhite = NO;
 
-  for (int i = rowOffset; i < width; i++) {
-    if ([row get:i] ^ isWhite) {
-      counters[counterPosition]++;
-    } else {
-      if (counterPosition == patternLength - 1) {
-        int bestVariance = MAX_AVG_VARIANCE;
-        int bestMatch = -1;
-        for (int startCode = CODE_START_A; startCode <= CODE_START_C; startCode++) {
-          int variance = [ZXOneDReader patternMatchVariance:counters countersSize:patternLength pattern:(int *)CODE_PATTERNS[startCode] maxIndividualVariance:MAX_INDIVIDUAL_VARIANCE];
-          if (variance < bestVariance) {
-            bestVariance = variance;
-            bestMatch = startCode;
-          }
-        }
-        // Look for whitespace before start pattern, >= 50% of width of start pattern
-        if (bestMatch >= 0 &&
-            [row isRange:MAX(0, patternStart - (i - patternStart) / 2) end:patternStart value:NO]) {
-          return [NSArray arrayWithObjects:[NSNumber numberWithInt:patternStart], [NSNumber numberWithInt:i], [NSNumber numberWithInt:bestMatch], nil];
-        }
-        patternStart += counters[0] + counters[1];
-        for (int y = 2; y < patternLength; y++) {
-          counters[y - 2] = counters[y];
+  // Walk the row one run at a time; i is where each new run starts.
+  int runCount;
+  const int *runStarts = [row runStarts:&runCount];
+  int run = ZXOneDRunIndex(runStarts, runCount, rowOffset);
+  counters[0] = runStarts[run + 1] - rowOffset;
+
+  for (run++; run < runCount; run++) {
+    int i = runStarts[run];
+    if (counterPosition == patternLength - 1) {
+      int bestVariance = MAX_AVG_VARIANCE;
+      int bestMatch = -1;
+      for (int startCode = CODE_START_A; startCode <= CODE_START_C; startCode++) {
+        int variance = [ZXOneDReader patternMatchVariance:counters countersSize:patternLength pattern:(int *)CODE_PATTERNS[startCode] maxIndividualVariance:MAX_INDIVIDUAL_VARIANCE];
+        if (variance < bestVariance) {
+          bestVariance = variance;
+          bestMatch = startCode;
         }
-        counters[patternLength - 2] = 0;
-        counters[patternLength - 1] = 0;
-        counterPosition--;
-      } else {
-        counterPosition++;
       }
-      counters[counterPosition] = 1;
-      isWhite = !isWhite;
+      // Look for whitespace before start pattern, >= 50% of width of start pattern
+      if (bestMatch >= 0 &&
+          [row isRange:MAX(0, patternStart - (i - patternStart) / 2) end:patternStart value:NO]) {
+        return [NSArray arrayWithObjects:[NSNumber numberWithInt:patternStart], [NSNumber numberWithInt:i], [NSNumber numberWithInt:bestMatch], nil];
+      }
+      patternStart += counters[0] + counters[1];
+      for (int y = 2; y < patternLength; y++) {
+        counters[y - 2] = counters[y];
+      }
+      counters[patternLength - 2] = 0;
+      counters[patternLength - 1] = 0;
+      counterPosition--;
+    } else {
+      counterPosition++;
     }
+    counters[counterPosition] = runStarts[run + 1] - i;
   }
 
   return nil;
@@ -184,35 +184,39 @@ int const CODE39_ASTERISK_ENCODING = 0x094;
 - (BOOL)findAsteriskPattern:(ZXBitArray *)row a:(int *)a b:(int *)b counters:(int *)counters countersLen:(int)countersLen {
   int width = row.size;
   int rowOffset = [row nextSet:0];
+  if (rowOffset >= width) {
+    return NO;
+  }
 
   int counterPosition = 0;
   int patternStart = rowOffset;
-  BOOL isWhite = NO;
 
-  for (int i = rowOffset; i < width; i++) {
-    if ([row get:i] ^ isWhite) {
-      counters[counterPosition]++;
-    } else {
-      if (counterPosition == countersLen - 1) {
-        if ([self toNarrowWidePattern:counters countersLen:countersLen] == CODE39_ASTERISK_ENCODING &&
-            [row isRange:MAX(0, patternStart - ((i - patternStart) >> 1)) end:patternStart value:NO]) {
-          if (a) *a = patternStart;
-          if (b) *b = i;
-          return YES;
-        }
-        patternStart += counters[0] + counters[1];
-        for (int y = 2; y < countersLen; y++) {
-          counters[y - 2] = counters[y];
-        }
-        counters[countersLen - 2] = 0;
-        counters[countersLen - 1] = 0;
-        counterPosition--;
-      } else {
-        counterPosition++;
+  // Walk the row one run at a time; i is where each new run starts.
+  int runCount;
+  const int *runStarts = [row runStarts:&runCount];
+  int run = ZXOneDRunIndex(runStarts, runCount, rowOffset);
+  counters[0] = runStarts[run + 1] - rowOffset;
+
+  for (run++; run < runCount; run++) {
+    int i = runStarts[run];
+    if (counterPosition == countersLen - 1) {
+      if ([self toNarrowWidePattern:counters countersLen:countersLen] == CODE39_ASTERISK_ENCODING &&
+          [row isRange:MAX(0, patternStart - ((i - patternStart) >> 1)) end:patternStart value:NO]) {
+        if (a) *a = patternStart;
+        if (b) *b = i;
+        return YES;
+      }
+      patternStart += counters[0] + counters[1];
+      for (int y = 2; y < countersLen; y++) {
+        counters[y - 2] = counters[y];
       }
-      counters[counterPosition] = 1;
-      isWhite = !isWhite;
+      counters[countersLen - 2] = 0;
+      counters[countersLen - 1] = 0;
+      counterPosition--;
+    } else {
+      counterPosition++;
     }
+    counters[counterPosition] = runStarts[run + 1] - i;
   }
 
   return NO;
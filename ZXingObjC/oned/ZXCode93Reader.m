@@ -148,6 +148,9 @@ const int CODE93_ASTERISK_ENCODING = 0x15E;
 - (BOOL)findAsteriskPattern:(ZXBitArray *)row a:(int *)a b:(int *)b {
   int width = row.size;
   int rowOffset = [row nextSet:0];
+  if (rowOffset >= width) {
+    return NO;
+  }
 
   int counterPosition = 0;
 
@@ -156,31 +159,32 @@ const int CODE93_ASTERISK_ENCODING = 0x15E;
   memset(counters, 0, patternLength * sizeof(int));
 
   int patternStart = rowOffset;
-  BOOL isWhite = NO;
 
-  for (int i = rowOffset; i < width; i++) {
-    if ([row get:i] ^ isWhite) {
-      counters[counterPosition]++;
-    } else {
-      if (counterPosition == patternLength - 1) {
-        if ([self toPattern:counters countersLen:patternLength] == CODE93_ASTERISK_ENCODING) {
-          if (a) *a = patternStart;
-          if (b) *b = i;
-          return YES;
-        }
-        patternStart += counters[0] + counters[1];
-        for (int y = 2; y < patternLength; y++) {
-          counters[y - 2] = counters[y];
-        }
-        counters[patternLength - 2] = 0;
-        counters[patternLength - 1] = 0;
-        counterPosition--;
-      } else {
-        counterPosition++;
+  // Walk the row one run at a time; i is where each new run starts.
+  int runCount;
+  const int *runStarts = [row runStarts:&runCount];
+  int run = ZXOneDRunIndex(runStarts, runCount, rowOffset);
+  counters[0] = runStarts[run + 1] - rowOffset;
+
+  for (run++; run < runCount; run++) {
+    int i = runStarts[run];
+    if (counterPosition == patternLength - 1) {
+      if ([self toPattern:counters countersLen:patternLength] == CODE93_ASTERISK_ENCODING) {
+        if (a) *a = patternStart;
+        if (b) *b = i;
+        return YES;
+      }
+      patternStart += counters[0] + counters[1];
+      for (int y = 2; y < patternLength; y++) {
+        counters[y - 2] = counters[y];
       }
-      counters[counterPosition] = 1;
-      isWhite = !isWhite;
+      counters[patternLength - 2] = 0;
+      counters[patternLength - 1] = 0;
+      counterPosition--;
+    } else {
+      counterPosition++;
     }
+    counters[counterPosition] = runStarts[run + 1] - i;
   }
 
   return NO;
@@ -213,11 +213,12 @@ const int PATTERNS[PATTERNS_LEN][5] = {
 - (BOOL)validateQuietZone:(ZXBitArray *)row startPattern:(int)startPattern {
   int quietCount = self.narrowLineWidth * 10;
 
-  for (int i = startPattern - 1; quietCount > 0 && i >= 0; i--) {
-    if ([row get:i]) {
-      break;
-    }
-    quietCount--;
+  // The white run ending just before startPattern is the quiet zone.
+  if (quietCount > 0 && startPattern > 0 && ![row get:startPattern - 1]) {
+    int runCount;
+    const int *runStarts = [row runStarts:&runCount];
+    int quietWidth = startPattern - runStarts[ZXOneDRunIndex(runStarts, runCount, startPattern - 1)];
+    quietCount -= MIN(quietCount, quietWidth);
   }
   if (quietCount != 0) {
     return NO;
@@ -268,31 +269,36 @@ const int PATTERNS[PATTERNS_LEN][5] = {
   int counters[patternLength];
   memset(counters, 0, patternLength * sizeof(int));
   int width = row.size;
-  BOOL isWhite = NO;
+  if (rowOffset >= width) {
+    return nil;
+  }
 
   int counterPosition = 0;
   int patternStart = rowOffset;
-  for (int x = rowOffset; x < width; x++) {
-    if ([row get:x] ^ isWhite) {
-      counters[counterPosition]++;
-    } else {
-      if (counterPosition == patternLength - 1) {
-        if ([ZXOneDReader patternMatchVariance:counters countersSize:patternLength pattern:pattern maxIndividualVariance:MAX_INDIVIDUAL_VARIANCE] < MAX_AVG_VARIANCE) {
-          return [NSArray arrayWithObjects:[NSNumber numberWithInt:patternStart], [NSNumber numberWithInt:x], nil];
-        }
-        patternStart += counters[0] + counters[1];
-        for (int y = 2; y < patternLength; y++) {
-          counters[y - 2] = counters[y];
-        }
-        counters[patternLength - 2] = 0;
-        counters[patternLength - 1] = 0;
-        counterPosition--;
-      } else {
-        counterPosition++;
+
+  // Walk the row one run at a time; x is where each new run starts.
+  int runCount;
+  const int *runStarts = [row runStarts:&runCount];
+  int run = ZXOneDRunIndex(runStarts, runCount, rowOffset);
+  counters[0] = runStarts[run + 1] - rowOffset;
+
+  for (run++; run < runCount; run++) {
+    int x = runStarts[run];
+    if (counterPosition == patternLength - 1) {
+      if ([ZXOneDReader patternMatchVariance:counters countersSize:patternLength pattern:pattern maxIndividualVariance:MAX_INDIVIDUAL_VARIANCE] < MAX_AVG_VARIANCE) {
+        return [NSArray arrayWithObjects:[NSNumber numberWithInt:patternStart], [NSNumber numberWithInt:x], nil];
       }
-      counters[counterPosition] = 1;
-      isWhite = !isWhite;
+      patternStart += counters[0] + counters[1];
+      for (int y = 2; y < patternLength; y++) {
+        counters[y - 2] = counters[y];
+      }
+      counters[patternLength - 2] = 0;
+      counters[patternLength - 1] = 0;
+      counterPosition--;
+    } else {
+      counterPosition++;
     }
+    counters[counterPosition] = runStarts[run + 1] - x;
   }
 
   return nil;
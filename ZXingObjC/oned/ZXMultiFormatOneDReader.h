@@ -16,10 +16,17 @@
 
 #import "ZXOneDReader.h"
 
-@class ZXDecodeHints;
+@class ZXDecodeHints, ZXReaderStatistics;
 
 @interface ZXMultiFormatOneDReader : ZXOneDReader
 
+/**
+ * When set, each decode records one attempt per sub-reader it tried, with the time spent across
+ * all rows, and starts by reordering the sub-readers so the most productive formats are tried
+ * first on each row.
+ */
+@property (nonatomic, retain) ZXReaderStatistics *statistics;
+
 - (id)initWithHints:(ZXDecodeHints *)hints;
 
 @end
@@ -19,14 +19,21 @@
 #import "ZXCode39Reader.h"
 #import "ZXCode93Reader.h"
 #import "ZXDecodeHints.h"
+#import "ZXDecodeTrace.h"
 #import "ZXErrors.h"
 #import "ZXITFReader.h"
 #import "ZXMultiFormatOneDReader.h"
 #import "ZXMultiFormatUPCEANReader.h"
+#import "ZXReaderStatistics.h"
 #import "ZXRSS14Reader.h"
 #import "ZXRSSExpandedReader.h"
 
-@interface ZXMultiFormatOneDReader ()
+@interface ZXMultiFormatOneDReader () {
+  // Per-reader totals for the decode in progress, indexed like readers; NULL when not recording
+  uint64_t *readerDurations;
+  int *readerAttempts;
+  BOOL *readerHits;
+}
 
 @property (nonatomic, retain) NSMutableArray *readers;
 
@@ -35,6 +42,7 @@
 @implementation ZXMultiFormatOneDReader
 
 @synthesize readers;
+@synthesize statistics;
 
 - (id)initWithHints:(ZXDecodeHints *)hints {
   if (self = [super init]) {
@@ -94,13 +102,71 @@
 
 - (void)dealloc {
   [readers release];
+  [statistics release];
 
   [super dealloc];
 }
 
+/**
+ * With statistics set, row attempts are totalled per sub-reader over the whole decode and recorded
+ * once at the end, so a decode counts as one attempt per sub-reader however many rows it scans.
+ */
+- (ZXResult *)decode:(ZXBinaryBitmap *)image hints:(ZXDecodeHints *)hints error:(NSError **)error {
+  int count = (int)[self.readers count];
+  if (self.statistics == nil || count == 0) {
+    return [super decode:image hints:hints error:error];
+  }
+
+  if (count > 1) {
+    self.readers = [[[self.statistics orderedReaders:self.readers] mutableCopy] autorelease];
+  }
+  NSArray *decodeReaders = [[self.readers copy] autorelease];
+  uint64_t durations[count];
+  int attempts[count];
+  BOOL hits[count];
+  memset(durations, 0, sizeof(durations));
+  memset(attempts, 0, sizeof(attempts));
+  memset(hits, 0, sizeof(hits));
+  readerDurations = durations;
+  readerAttempts = attempts;
+  readerHits = hits;
+
+  ZXResult *result = [super decode:image hints:hints error:error];
+
+  readerDurations = NULL;
+  readerAttempts = NULL;
+  readerHits = NULL;
+
+  // A cancelled decode didn't give its readers a fair try, so its misses aren't recorded
+  if (result != nil || !hints.cancelled) {
+    NSMutableArray *attempted = [NSMutableArray arrayWithCapacity:count];
+    NSTimeInterval attemptedDurations[count];
+    BOOL attemptedHits[count];
+    for (int i = 0; i < count; i++) {
+      if (attempts[i] > 0) {
+        attemptedDurations[[attempted count]] = durations[i] / 1e9;
+        attemptedHits[[attempted count]] = hits[i];
+        [attempted addObject:[decodeReaders objectAtIndex:i]];
+      }
+    }
+    [self.statistics recordReaders:attempted hits:attemptedHits durations:attemptedDurations];
+  }
+  return result;
+}
+
 - (ZXResult *)decodeRow:(int)rowNumber row:(ZXBitArray *)row hints:(ZXDecodeHints *)hints error:(NSError **)error {
-  for (ZXOneDReader *reader in self.readers) {
+  int count = (int)[self.readers count];
+  for (int i = 0; i < count; i++) {
+    ZXOneDReader *reader = [self.readers objectAtIndex:i];
+    uint64_t start = readerDurations ? ZXDecodeTraceNow() : 0;
     ZXResult *result = [reader decodeRow:rowNumber row:row hints:hints error:error];
+    if (readerDurations) {
+      readerDurations[i] += ZXDecodeTraceNow() - start;
+      readerAttempts[i]++;
+      if (result) {
+        readerHits[i] = YES;
+      }
+    }
     if (result) {
       return result;
     }
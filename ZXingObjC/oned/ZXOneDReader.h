@@ -24,6 +24,12 @@
 extern int const INTEGER_MATH_SHIFT;
 extern int const PATTERN_MATCH_RESULT_SCALE_FACTOR;
 
+/**
+ * Returns the index of the run in runStarts, as returned by -[ZXBitArray runStarts:], that
+ * contains position, or runCount if position is at or past the end of the row.
+ */
+int ZXOneDRunIndex(const int *runStarts, int runCount, int position);
+
 @class ZXBitArray, ZXDecodeHints, ZXResult;
 
 @interface ZXOneDReader : NSObject <ZXReader>
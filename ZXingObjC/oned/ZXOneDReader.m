@@ -17,6 +17,7 @@
 #import "ZXBinaryBitmap.h"
 #import "ZXBitArray.h"
 #import "ZXDecodeHints.h"
+#import "ZXDecodeTrace.h"
 #import "ZXErrors.h"
 #import "ZXOneDReader.h"
 #import "ZXResult.h"
@@ -25,6 +26,23 @@
 int const INTEGER_MATH_SHIFT = 8;
 int const PATTERN_MATCH_RESULT_SCALE_FACTOR = 1 << INTEGER_MATH_SHIFT;
 
+int ZXOneDRunIndex(const int *runStarts, int runCount, int position) {
+  if (position >= runStarts[runCount]) {
+    return runCount;
+  }
+  int low = 0;
+  int high = runCount - 1;
+  while (low < high) {
+    int mid = (low + high + 1) >> 1;
+    if (runStarts[mid] <= position) {
+      low = mid;
+    } else {
+      high = mid - 1;
+    }
+  }
+  return low;
+}
+
 @interface ZXOneDReader ()
 
 - (ZXResult *)doDecode:(ZXBinaryBitmap *)image hints:(ZXDecodeHints *)hints error:(NSError **)error;
@@ -45,7 +63,7 @@ int const PATTERN_MATCH_RESULT_SCALE_FACTOR = 1 << INTEGER_MATH_SHIFT;
     return result;
   } else if (decodeError.code == ZXNotFoundError) {
     BOOL tryHarder = hints != nil && hints.tryHarder;
-    if (tryHarder && [image rotateSupported]) {
+    if (tryHarder && [image rotateSupported] && !hints.cancelled) {
       ZXBinaryBitmap *rotatedImage = [image rotateCounterClockwise];
       ZXResult *result = [self doDecode:rotatedImage hints:hints error:error];
       if (!result) {
@@ -95,7 +113,8 @@ int const PATTERN_MATCH_RESULT_SCALE_FACTOR = 1 << INTEGER_MATH_SHIFT;
 - (ZXResult *)doDecode:(ZXBinaryBitmap *)image hints:(ZXDecodeHints *)hints error:(NSError **)error {
   int width = image.width;
   int height = image.height;
-  ZXBitArray *row = [[[ZXBitArray alloc] initWithSize:width] autorelease];
+  // Let the binarizer provide the first row so it can come from its buffer pool; it is reused after.
+  ZXBitArray *row = nil;
   int middle = height >> 1;
   BOOL tryHarder = hints != nil && hints.tryHarder;
   int rowStep = MAX(1, height >> (tryHarder ? 8 : 5));
@@ -106,7 +125,13 @@ int const PATTERN_MATCH_RESULT_SCALE_FACTOR = 1 << INTEGER_MATH_SHIFT;
     maxLines = 15;
   }
 
+  // hints may be swapped for a copy below, so cancellation is read from the caller's
+  ZXDecodeHints *callerHints = hints;
+
   for (int x = 0; x < maxLines; x++) {
+    if (callerHints.cancelled) {
+      break;
+    }
     int rowStepsAboveOrBelow = (x + 1) >> 1;
     BOOL isAbove = (x & 0x01) == 0;
     int rowNumber = middle + rowStep * (isAbove ? rowStepsAboveOrBelow : -rowStepsAboveOrBelow);
@@ -115,13 +140,15 @@ int const PATTERN_MATCH_RESULT_SCALE_FACTOR = 1 << INTEGER_MATH_SHIFT;
     }
 
     NSError *rowError = nil;
-    row = [image blackRow:rowNumber row:row error:&rowError];
-    if (!row && rowError.code == ZXNotFoundError) {
+    ZX_TRACE_COUNT(rowsScanned, 1);
+    ZXBitArray *blackRow = [image blackRow:rowNumber row:row error:&rowError];
+    if (!blackRow && rowError.code == ZXNotFoundError) {
       continue;
-    } else if (!row) {
+    } else if (!blackRow) {
       if (error) *error = rowError;
       return nil;
     }
+    row = blackRow;
 
     for (int attempt = 0; attempt < 2; attempt++) {
       if (attempt == 1) {
@@ -174,23 +201,22 @@ int const PATTERN_MATCH_RESULT_SCALE_FACTOR = 1 << INTEGER_MATH_SHIFT;
   if (start >= end) {
     return NO;
   }
-  BOOL isWhite = ![row get:start];
+
+  // Each counter takes a whole run; the first one only the part of its run from start on.
+  int runCount;
+  const int *runStarts = [row runStarts:&runCount];
+  int run = ZXOneDRunIndex(runStarts, runCount, start);
   int counterPosition = 0;
-  int i = start;
+  counters[0] = runStarts[run + 1] - start;
+  int i = runStarts[++run];
 
   while (i < end) {
-    if ([row get:i] ^ isWhite) {
-      counters[counterPosition]++;
-    } else {
-      counterPosition++;
-      if (counterPosition == numCounters) {
-        break;
-      } else {
-        counters[counterPosition] = 1;
-        isWhite = !isWhite;
-      }
+    counterPosition++;
+    if (counterPosition == numCounters) {
+      break;
     }
-    i++;
+    counters[counterPosition] = runStarts[run + 1] - i;
+    i = runStarts[++run];
   }
 
   if (!(counterPosition == numCounters || (counterPosition == numCounters - 1 && i == end))) {
@@ -200,17 +226,13 @@ int const PATTERN_MATCH_RESULT_SCALE_FACTOR = 1 << INTEGER_MATH_SHIFT;
 }
 
 + (BOOL)recordPatternInReverse:(ZXBitArray *)row start:(int)start counters:(int[])counters countersSize:(int)countersSize {
-  int numTransitionsLeft = countersSize;
-  BOOL last = [row get:start];
-
-  while (start > 0 && numTransitionsLeft >= 0) {
-    if ([row get:--start] != last) {
-      numTransitionsLeft--;
-      last = !last;
-    }
-  }
+  // Step back over countersSize whole runs before the one containing start, and there must be
+  // at least one more run before those.
+  int runCount;
+  const int *runStarts = [row runStarts:&runCount];
+  int run = ZXOneDRunIndex(runStarts, runCount, start);
 
-  if (numTransitionsLeft >= 0 || ![self recordPattern:row start:start + 1 counters:counters countersSize:countersSize]) {
+  if (run - countersSize - 1 < 0 || ![self recordPattern:row start:runStarts[run - countersSize] counters:counters countersSize:countersSize]) {
     return NO;
   }
   return YES;
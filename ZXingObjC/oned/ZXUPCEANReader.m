@@ -267,15 +267,19 @@ const int L_AND_G_PATTERNS[L_AND_G_PATTERNS_LEN][L_AND_G_PATTERNS_SUB_LEN] = {
   memset(counters, 0, patternLength * sizeof(int));
   int width = row.size;
 
-  BOOL isWhite = whiteFirst;
   rowOffset = whiteFirst ? [row nextUnset:rowOffset] : [row nextSet:rowOffset];
   int counterPosition = 0;
   int patternStart = rowOffset;
 
-  for (int x = rowOffset; x < width; x++) {
-    if ([row get:x] ^ isWhite) {
-      counters[counterPosition]++;
-    } else {
+  if (rowOffset < width) {
+    // Walk the row one run at a time; x is where each new run starts.
+    int runCount;
+    const int *runStarts = [row runStarts:&runCount];
+    int run = ZXOneDRunIndex(runStarts, runCount, rowOffset);
+    counters[0] = runStarts[run + 1] - rowOffset;
+
+    for (run++; run < runCount; run++) {
+      int x = runStarts[run];
       if (counterPosition == patternLength - 1) {
         if ([self patternMatchVariance:counters countersSize:patternLength pattern:pattern maxIndividualVariance:MAX_INDIVIDUAL_VARIANCE] < MAX_AVG_VARIANCE) {
           return NSMakeRange(patternStart, x - patternStart);
@@ -292,8 +296,7 @@ const int L_AND_G_PATTERNS[L_AND_G_PATTERNS_LEN][L_AND_G_PATTERNS_SUB_LEN] = {
       } else {
         counterPosition++;
       }
-      counters[counterPosition] = 1;
-      isWhite = !isWhite;
+      counters[counterPosition] = runStarts[run + 1] - x;
     }
   }
 
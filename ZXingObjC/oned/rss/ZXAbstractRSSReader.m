@@ -80,6 +80,10 @@ const int RSS_EXPANDED_FINDER_PATTERNS[RSS_EXPANDED_FINDER_PATTERNS_LEN][RSS_EXP
 @synthesize evenCountsLen;
 
 + (void)initialize {
+  if (self != [ZXAbstractRSSReader class]) {
+    return;
+  }
+
   MAX_AVG_VARIANCE = (int)(PATTERN_MATCH_RESULT_SCALE_FACTOR * 0.2f);
   MAX_INDIVIDUAL_VARIANCE = (int)(PATTERN_MATCH_RESULT_SCALE_FACTOR * 0.45f);
 }
@@ -294,52 +294,52 @@ const int INSIDE_ODD_WIDEST[4] = {2,4,6,8};
   counters[2] = 0;
   counters[3] = 0;
 
+  // The right finder pattern starts on white, the left one on black.
   int width = row.size;
-  BOOL isWhite = NO;
-  while (rowOffset < width) {
-    isWhite = ![row get:rowOffset];
-    if (rightFinderPattern == isWhite) {
-      break;
-    }
-    rowOffset++;
+  rowOffset = rightFinderPattern ? [row nextUnset:rowOffset] : [row nextSet:rowOffset];
+  if (rowOffset >= width) {
+    return nil;
   }
 
   int counterPosition = 0;
   int patternStart = rowOffset;
-  for (int x = rowOffset; x < width; x++) {
-    if ([row get:x] ^ isWhite) {
-      counters[counterPosition]++;
-    } else {
-      if (counterPosition == 3) {
-        if ([ZXAbstractRSSReader isFinderPattern:counters countersLen:countersLen]) {
-          return [NSArray arrayWithObjects:[NSNumber numberWithInt:patternStart], [NSNumber numberWithInt:x], nil];
-        }
-        patternStart += counters[0] + counters[1];
-        counters[0] = counters[2];
-        counters[1] = counters[3];
-        counters[2] = 0;
-        counters[3] = 0;
-        counterPosition--;
-      } else {
-        counterPosition++;
+
+  // Walk the row one run at a time; x is where each new run starts.
+  int runCount;
+  const int *runStarts = [row runStarts:&runCount];
+  int run = ZXOneDRunIndex(runStarts, runCount, rowOffset);
+  counters[0] = runStarts[run + 1] - rowOffset;
+
+  for (run++; run < runCount; run++) {
+    int x = runStarts[run];
+    if (counterPosition == 3) {
+      if ([ZXAbstractRSSReader isFinderPattern:counters countersLen:countersLen]) {
+        return [NSArray arrayWithObjects:[NSNumber numberWithInt:patternStart], [NSNumber numberWithInt:x], nil];
       }
-      counters[counterPosition] = 1;
-      isWhite = !isWhite;
+      patternStart += counters[0] + counters[1];
+      counters[0] = counters[2];
+      counters[1] = counters[3];
+      counters[2] = 0;
+      counters[3] = 0;
+      counterPosition--;
+    } else {
+      counterPosition++;
     }
+    counters[counterPosition] = runStarts[run + 1] - x;
   }
 
   return nil;
 }
 
 - (ZXRSSFinderPattern *)parseFoundFinderPattern:(ZXBitArray *)row rowNumber:(int)rowNumber right:(BOOL)right startEnd:(NSArray *)startEnd {
-  BOOL firstIsBlack = [row get:[[startEnd objectAtIndex:0] intValue]];
-  int firstElementStart = [[startEnd objectAtIndex:0] intValue] - 1;
-
-  while (firstElementStart >= 0 && firstIsBlack ^ [row get:firstElementStart]) {
-    firstElementStart--;
+  // The first element is the whole run of the other color just before the pattern.
+  int patternStart = [[startEnd objectAtIndex:0] intValue];
+  int firstElementStart = patternStart;
+  if (patternStart > 0 && [row get:patternStart] != [row get:patternStart - 1]) {
+    int runCount;
+    const int *runStarts = [row runStarts:&runCount];
+    firstElementStart = runStarts[ZXOneDRunIndex(runStarts, runCount, patternStart - 1)];
   }
-
-  firstElementStart++;
   int firstCounter = [[startEnd objectAtIndex:0] intValue] - firstElementStart;
 
   int countersLen = self.decodeFinderCountersLen;
@@ -491,48 +491,47 @@ const int MAX_PAIRS = 11;
     searchingEvenPair = !searchingEvenPair;
   }
 
-  BOOL isWhite = NO;
-  while (rowOffset < width) {
-    isWhite = ![row get:rowOffset];
-    if (!isWhite) {
-      break;
-    }
-    rowOffset++;
+  rowOffset = [row nextSet:rowOffset];
+  if (rowOffset >= width) {
+    return NO;
   }
 
   int counterPosition = 0;
   int patternStart = rowOffset;
-  for (int x = rowOffset; x < width; x++) {
-    if ([row get:x] ^ isWhite) {
-      counters[counterPosition]++;
-    } else {
-      if (counterPosition == 3) {
-        if (searchingEvenPair) {
-          [self reverseCounters:counters length:countersLen];
-        }
 
-        if ([ZXAbstractRSSReader isFinderPattern:counters countersLen:countersLen]) {
-          startEnd[0] = patternStart;
-          startEnd[1] = x;
-          return YES;
-        }
+  // Walk the row one run at a time; x is where each new run starts.
+  int runCount;
+  const int *runStarts = [row runStarts:&runCount];
+  int run = ZXOneDRunIndex(runStarts, runCount, rowOffset);
+  counters[0] = runStarts[run + 1] - rowOffset;
+
+  for (run++; run < runCount; run++) {
+    int x = runStarts[run];
+    if (counterPosition == 3) {
+      if (searchingEvenPair) {
+        [self reverseCounters:counters length:countersLen];
+      }
 
-        if (searchingEvenPair) {
-          [self reverseCounters:counters length:countersLen];
-        }
+      if ([ZXAbstractRSSReader isFinderPattern:counters countersLen:countersLen]) {
+        startEnd[0] = patternStart;
+        startEnd[1] = x;
+        return YES;
+      }
 
-        patternStart += counters[0] + counters[1];
-        counters[0] = counters[2];
-        counters[1] = counters[3];
-        counters[2] = 0;
-        counters[3] = 0;
-        counterPosition--;
-      } else {
-        counterPosition++;
+      if (searchingEvenPair) {
+        [self reverseCounters:counters length:countersLen];
       }
-      counters[counterPosition] = 1;
-      isWhite = !isWhite;
+
+      patternStart += counters[0] + counters[1];
+      counters[0] = counters[2];
+      counters[1] = counters[3];
+      counters[2] = 0;
+      counters[3] = 0;
+      counterPosition--;
+    } else {
+      counterPosition++;
     }
+    counters[counterPosition] = runStarts[run + 1] - x;
   }
   return NO;
 }
@@ -554,13 +553,13 @@ const int MAX_PAIRS = 11;
   if (oddPattern) {
     // If pattern number is odd, we need to locate element 1 *before *the current block.
 
-    int firstElementStart = startEnd[0] - 1;
-    // Locate element 1
-    while (firstElementStart >= 0 && ![row get:firstElementStart]) {
-      firstElementStart--;
+    // Locate element 1: the white run just before the block.
+    int firstElementStart = startEnd[0];
+    if (firstElementStart > 0 && ![row get:firstElementStart - 1]) {
+      int runCount;
+      const int *runStarts = [row runStarts:&runCount];
+      firstElementStart = runStarts[ZXOneDRunIndex(runStarts, runCount, firstElementStart - 1)];
     }
-
-    firstElementStart++;
     firstCounter = startEnd[0] - firstElementStart;
     start = firstElementStart;
     end = startEnd[1];
@@ -20,6 +20,8 @@
 
 @class ZXBitMatrix;
 
+extern int const MAX_CW_CAPACITY;
+
 @interface ZXPDF417BitMatrixParser : NSObject
 
 @property (nonatomic, retain, readonly) NSMutableArray *erasures;
@@ -27,5 +29,6 @@
 
 - (id)initWithBitMatrix:(ZXBitMatrix *)bitMatrix;
 - (NSArray *)readCodewords;
+- (int)readCodewords:(int *)codewords erasures:(int *)erasures erasuresLen:(int *)erasuresLen;
 
 @end
@@ -673,7 +673,7 @@ const int CODEWORD_TABLE[2787] = {2627, 1819, 2622, 2621, 1813,
 
 - (int)codeword:(long)symbol;
 - (int)findCodewordIndex:(long)symbol;
-- (int)processRow:(int *)rowCounters rowCountersLen:(unsigned int)rowCountersLen rowNumber:(int)rowNumber rowHeight:(int)rowHeight codewords:(NSMutableArray *)codewords next:(int)next;
+- (int)processRow:(int *)rowCounters rowCountersLen:(unsigned int)rowCountersLen rowNumber:(int)rowNumber rowHeight:(int)rowHeight codewords:(int *)codewords erasures:(int *)erasures next:(int)next;
 
 @end
 
@@ -717,13 +717,36 @@ const int CODEWORD_TABLE[2787] = {2627, 1819, 2622, 2621, 1813,
  * them into a codeword array.
  */
 - (NSArray *)readCodewords {
+  int codewords[MAX_CW_CAPACITY];
+  int erasureCodewords[MAX_CW_CAPACITY];
+  int erasuresLen;
+  int codewordsLen = [self readCodewords:codewords erasures:erasureCodewords erasuresLen:&erasuresLen];
+  if (codewordsLen == -1) {
+    return nil;
+  }
+
+  self.erasures = [NSMutableArray arrayWithCapacity:erasuresLen];
+  for (int i = 0; i < erasuresLen; i++) {
+    [self.erasures addObject:[NSNumber numberWithInt:erasureCodewords[i]]];
+  }
+
+  NSMutableArray *result = [NSMutableArray arrayWithCapacity:codewordsLen];
+  for (int i = 0; i < codewordsLen; i++) {
+    [result addObject:[NSNumber numberWithInt:codewords[i]]];
+  }
+  return result;
+}
+
+
+/**
+ * Like readCodewords, into codewords and erasures that each have room for MAX_CW_CAPACITY values.
+ * Returns the number of codewords read, or -1 if the symbol could not be read.
+ */
+- (int)readCodewords:(int *)codewords erasures:(int *)erasures erasuresLen:(int *)erasuresLen {
   int width = bitMatrix.width;
   int height = bitMatrix.height;
 
-  self.erasures = [NSMutableArray arrayWithCapacity:MAX_CW_CAPACITY];
-  for (int i = 0; i < MAX_CW_CAPACITY; i++) {
-    [self.erasures addObject:[NSNumber numberWithInt:0]];
-  }
+  self.eraseCount = 0;
 
   // Get the number of pixels in a module across the X dimension
   //float moduleWidth = bitMatrix.getModuleWidth();
@@ -732,10 +755,7 @@ const int CODEWORD_TABLE[2787] = {2627, 1819, 2622, 2621, 1813,
   int rowCounters[width];
   memset(rowCounters, 0, width * sizeof(int));
   
-  NSMutableArray *codewords = [NSMutableArray arrayWithCapacity:MAX_CW_CAPACITY];
-  for (int i = 0; i < MAX_CW_CAPACITY; i++) {
-    [codewords addObject:[NSNumber numberWithInt:0]];
-  }
+  memset(codewords, 0, MAX_CW_CAPACITY * sizeof(int));
 
   int next = 0;
   int matchingConsecutiveScans = 0;
@@ -746,7 +766,7 @@ const int CODEWORD_TABLE[2787] = {2627, 1819, 2622, 2621, 1813,
     if (rowNumber >= MAX_ROWS) {
       // Something is wrong, since we have exceeded
       // the maximum rows in the specification.
-      return nil;
+      return -1;
     }
     int rowDifference = 0;
     // Scan a line of modules and check the
@@ -778,11 +798,11 @@ const int CODEWORD_TABLE[2787] = {2627, 1819, 2622, 2621, 1813,
     } else {
       if (rowInProgress) {
         // Process Row
-        next = [self processRow:rowCounters rowCountersLen:width rowNumber:rowNumber rowHeight:rowHeight codewords:codewords next:next];
+        next = [self processRow:rowCounters rowCountersLen:width rowNumber:rowNumber rowHeight:rowHeight codewords:codewords erasures:erasures next:next];
         if (next == -1) {
           // Something is wrong, since we have exceeded
           // the maximum columns in the specification.
-          return nil;
+          return -1;
         }
         // Reinitialize the row counters.
         for (int j = 0; j < width; j++) {
@@ -802,17 +822,17 @@ const int CODEWORD_TABLE[2787] = {2627, 1819, 2622, 2621, 1813,
     if (rowNumber >= MAX_ROWS) {
       // Something is wrong, since we have exceeded
       // the maximum rows in the specification.
-      return nil;
+      return -1;
     }
-    next = [self processRow:rowCounters rowCountersLen:width rowNumber:rowNumber rowHeight:rowHeight codewords:codewords next:next];
+    next = [self processRow:rowCounters rowCountersLen:width rowNumber:rowNumber rowHeight:rowHeight codewords:codewords erasures:erasures next:next];
     if (next == -1) {
-      return nil;
+      return -1;
     }
     rowNumber++;
     self.rows = rowNumber;
   }
-  self.erasures = [[[self.erasures subarrayWithRange:NSMakeRange(0, self.eraseCount)] mutableCopy] autorelease];
-  return [codewords subarrayWithRange:NSMakeRange(0, next)];
+  *erasuresLen = self.eraseCount;
+  return next;
 }
 
 
@@ -822,7 +842,7 @@ const int CODEWORD_TABLE[2787] = {2627, 1819, 2622, 2621, 1813,
  * elements, each of which can be one to six modules wide. The four bar and
  * four space elements shall measure 17 modules in total.
  */
-- (int)processRow:(int *)rowCounters rowCountersLen:(unsigned int)rowCountersLen rowNumber:(int)rowNumber rowHeight:(int)rowHeight codewords:(NSMutableArray *)codewords next:(int)next {
+- (int)processRow:(int *)rowCounters rowCountersLen:(unsigned int)rowCountersLen rowNumber:(int)rowNumber rowHeight:(int)rowHeight codewords:(int *)codewords erasures:(int *)erasures next:(int)next {
   int width = bitMatrix.width;
   int columnNumber = 0;
   long symbol = 0;
@@ -840,14 +860,17 @@ const int CODEWORD_TABLE[2787] = {2627, 1819, 2622, 2621, 1813,
       int cw = [self codeword:symbol];
       if (cw < 0 && i < width - MODULES_IN_SYMBOL) {
         // Skip errors on the Right row indicator column
-        if (eraseCount >= erasures.count) {
+        if (eraseCount >= MAX_CW_CAPACITY || next >= MAX_CW_CAPACITY) {
           return -1;
         }
-        [self.erasures addObject:[NSNumber numberWithInt:next]];
+        erasures[eraseCount] = next;
         next++;
         self.eraseCount++;
       } else {
-        [codewords replaceObjectAtIndex:next++ withObject:[NSNumber numberWithInt:cw]];
+        if (next >= MAX_CW_CAPACITY) {
+          return -1;
+        }
+        codewords[next++] = cw;
       }
     } else {
       // Left row indicator column
@@ -866,12 +889,12 @@ const int CODEWORD_TABLE[2787] = {2627, 1819, 2622, 2621, 1813,
     // Overwrite the last codeword i.e. Right Row Indicator
     --next;
     if (ecLevel < 0 && rowNumber % 3 == 2) {
-      self.rightColumnECData = [[codewords objectAtIndex:next] intValue];
+      self.rightColumnECData = codewords[next];
       if (self.rightColumnECData == self.leftColumnECData && self.leftColumnECData != 0) {
         self.ecLevel = ((self.rightColumnECData % 30) - self.rows % 3) / 3;
       }
     }
-    [codewords replaceObjectAtIndex:next withObject:[NSNumber numberWithInt:0]];
+    codewords[next] = 0;
   }
   return next;
 }
@@ -23,5 +23,6 @@
 @interface ZXPDF417DecodedBitStreamParser : NSObject
 
 + (ZXDecoderResult *)decode:(NSArray *)codewords error:(NSError **)error;
++ (ZXDecoderResult *)decode:(int *)codewords length:(int)length error:(NSError **)error;
 
 @end
@@ -63,11 +63,11 @@ static NSArray *EXP900 = nil;
 
 @interface ZXPDF417DecodedBitStreamParser ()
 
-+ (int)byteCompaction:(int)mode codewords:(NSArray *)codewords codeIndex:(int)codeIndex result:(NSMutableString *)result;
++ (int)byteCompaction:(int)mode codewords:(int *)codewords codeIndex:(int)codeIndex result:(NSMutableString *)result;
 + (NSString *)decodeBase900toBase10:(int *)codewords count:(int)count;
 + (void)decodeTextCompaction:(int *)textCompactionData byteCompactionData:(int *)byteCompactionData length:(unsigned int)length result:(NSMutableString *)result;
-+ (int)numericCompaction:(NSArray *)codewords codeIndex:(int)codeIndex result:(NSMutableString *)result;
-+ (int)textCompaction:(NSArray *)codewords codeIndex:(int)codeIndex result:(NSMutableString *)result;
++ (int)numericCompaction:(int *)codewords codeIndex:(int)codeIndex result:(NSMutableString *)result;
++ (int)textCompaction:(int *)codewords codeIndex:(int)codeIndex result:(NSMutableString *)result;
 
 @end
 
@@ -89,10 +89,19 @@ static NSArray *EXP900 = nil;
     if (error) *error = NotFoundErrorInstance();
     return nil;
   }
+  int length = codewords.count;
+  int codewordsInts[length];
+  for (int i = 0; i < length; i++) {
+    codewordsInts[i] = [[codewords objectAtIndex:i] intValue];
+  }
+  return [self decode:codewordsInts length:length error:error];
+}
+
++ (ZXDecoderResult *)decode:(int *)codewords length:(int)length error:(NSError **)error {
   NSMutableString *result = [NSMutableString stringWithCapacity:100];
   int codeIndex = 1;
-  int code = [[codewords objectAtIndex:codeIndex++] intValue];
-  while (codeIndex < [[codewords objectAtIndex:0] intValue]) {
+  int code = codewords[codeIndex++];
+  while (codeIndex < codewords[0]) {
     switch (code) {
     case TEXT_COMPACTION_MODE_LATCH:
       codeIndex = [self textCompaction:codewords codeIndex:codeIndex result:result];
@@ -114,8 +123,8 @@ static NSArray *EXP900 = nil;
       codeIndex = [self textCompaction:codewords codeIndex:codeIndex result:result];
       break;
     }
-    if (codeIndex < [codewords count]) {
-      code = [[codewords objectAtIndex:codeIndex++] intValue];
+    if (codeIndex < length) {
+      code = codewords[codeIndex++];
     } else {
       if (error) *error = NotFoundErrorInstance();
       return nil;
@@ -134,8 +143,8 @@ static NSArray *EXP900 = nil;
  * encoded, i.e. values 32 - 126 inclusive in accordance with ISO/IEC 646 (IRV), as
  * well as selected control characters.
  */
-+ (int)textCompaction:(NSArray *)codewords codeIndex:(int)codeIndex result:(NSMutableString *)result {
-  int count = [[codewords objectAtIndex:0] intValue] << 1;
++ (int)textCompaction:(int *)codewords codeIndex:(int)codeIndex result:(NSMutableString *)result {
+  int count = codewords[0] << 1;
   // 2 character per codeword
   int textCompactionData[count];
   // Used to hold the byte compaction value if there is a mode shift
@@ -148,8 +157,8 @@ static NSArray *EXP900 = nil;
 
   int index = 0;
   BOOL end = NO;
-  while ((codeIndex < [[codewords objectAtIndex:0] intValue]) && !end) {
-    int code = [[codewords objectAtIndex:codeIndex++] intValue];
+  while ((codeIndex < codewords[0]) && !end) {
+    int code = codewords[codeIndex++];
     if (code < TEXT_COMPACTION_MODE_LATCH) {
       textCompactionData[index] = code / 30;
       textCompactionData[index + 1] = code % 30;
@@ -170,7 +179,7 @@ static NSArray *EXP900 = nil;
         break;
       case MODE_SHIFT_TO_BYTE_COMPACTION_MODE:
         textCompactionData[index] = MODE_SHIFT_TO_BYTE_COMPACTION_MODE;
-        code = [[codewords objectAtIndex:codeIndex++] intValue];
+        code = codewords[codeIndex++];
         byteCompactionData[index] = code;
         index++;
         break;
@@ -344,7 +353,7 @@ static NSArray *EXP900 = nil;
  * This includes all ASCII characters value 0 to 127 inclusive and provides for international
  * character set support.
  */
-+ (int)byteCompaction:(int)mode codewords:(NSArray *)codewords codeIndex:(int)codeIndex result:(NSMutableString *)result {
++ (int)byteCompaction:(int)mode codewords:(int *)codewords codeIndex:(int)codeIndex result:(NSMutableString *)result {
   if (mode == BYTE_COMPACTION_MODE_LATCH) {
     // Total number of Byte Compaction characters to be encoded
     // is not a multiple of 6
@@ -353,12 +362,12 @@ static NSArray *EXP900 = nil;
     char decodedData[6] = {0, 0, 0, 0, 0, 0};
     int byteCompactedCodewords[6] = {0, 0, 0, 0, 0, 0};
     BOOL end = NO;
-    int nextCode = [[codewords objectAtIndex:codeIndex++] intValue];
-    while ((codeIndex < [[codewords objectAtIndex:0] intValue]) && !end) {
+    int nextCode = codewords[codeIndex++];
+    while ((codeIndex < codewords[0]) && !end) {
       byteCompactedCodewords[count++] = nextCode;
       // Base 900
       value = 900 * value + nextCode;
-      nextCode = [[codewords objectAtIndex:codeIndex++] intValue];
+      nextCode = codewords[codeIndex++];
       // perhaps it should be ok to check only nextCode >= TEXT_COMPACTION_MODE_LATCH
       if (nextCode == TEXT_COMPACTION_MODE_LATCH ||
           nextCode == BYTE_COMPACTION_MODE_LATCH ||
@@ -384,7 +393,7 @@ static NSArray *EXP900 = nil;
     }
 
     // if the end of all codewords is reached the last codeword needs to be added
-    if (codeIndex == [[codewords objectAtIndex:0] intValue] && nextCode < TEXT_COMPACTION_MODE_LATCH) {
+    if (codeIndex == codewords[0] && nextCode < TEXT_COMPACTION_MODE_LATCH) {
       byteCompactedCodewords[count++] = nextCode;
     }
 
@@ -400,8 +409,8 @@ static NSArray *EXP900 = nil;
     int count = 0;
     long value = 0;
     BOOL end = NO;
-    while (codeIndex < [[codewords objectAtIndex:0] intValue] && !end) {
-      int code = [[codewords objectAtIndex:codeIndex++] intValue];
+    while (codeIndex < codewords[0] && !end) {
+      int code = codewords[codeIndex++];
       if (code < TEXT_COMPACTION_MODE_LATCH) {
         count++;
         // Base 900
@@ -438,16 +447,16 @@ static NSArray *EXP900 = nil;
 /**
  * Numeric Compaction mode (see 5.4.4) permits efficient encoding of numeric data strings.
  */
-+ (int)numericCompaction:(NSArray *)codewords codeIndex:(int)codeIndex result:(NSMutableString *)result {
++ (int)numericCompaction:(int *)codewords codeIndex:(int)codeIndex result:(NSMutableString *)result {
   int count = 0;
   BOOL end = NO;
 
   int numericCodewords[MAX_NUMERIC_CODEWORDS];
   memset(numericCodewords, 0, MAX_NUMERIC_CODEWORDS * sizeof(int));
 
-  while (codeIndex < [[codewords objectAtIndex:0] intValue] && !end) {
-    int code = [[codewords objectAtIndex:codeIndex++] intValue];
-    if (codeIndex == [[codewords objectAtIndex:0] intValue]) {
+  while (codeIndex < codewords[0] && !end) {
+    int code = codewords[codeIndex++];
+    if (codeIndex == codewords[0]) {
       end = YES;
     }
     if (code < TEXT_COMPACTION_MODE_LATCH) {
@@ -15,6 +15,7 @@
  */
 
 #import "ZXBitMatrix.h"
+#import "ZXDecodeTrace.h"
 #import "ZXErrors.h"
 #import "ZXPDF417BitMatrixParser.h"
 #import "ZXPDF417DecodedBitStreamParser.h"
@@ -28,8 +29,8 @@ int const MAX_EC_CODEWORDS = 512;
 
 @property (nonatomic, retain) ZXPDF417ECErrorCorrection *errorCorrection;
 
-- (BOOL)correctErrors:(NSMutableArray *)codewords erasures:(NSArray *)erasures numECCodewords:(int)numECCodewords;
-- (BOOL)verifyCodewordCount:(NSMutableArray *)codewords numECCodewords:(int)numECCodewords;
+- (BOOL)correctErrors:(int *)codewords codewordsLen:(int)codewordsLen erasures:(int *)erasures erasuresLen:(int)erasuresLen numECCodewords:(int)numECCodewords;
+- (BOOL)verifyCodewordCount:(int *)codewords codewordsLen:(int)codewordsLen numECCodewords:(int)numECCodewords;
 
 @end
 
@@ -75,45 +76,50 @@ int const MAX_EC_CODEWORDS = 512;
  */
 - (ZXDecoderResult *)decodeMatrix:(ZXBitMatrix *)bits error:(NSError **)error {
   ZXPDF417BitMatrixParser *parser = [[[ZXPDF417BitMatrixParser alloc] initWithBitMatrix:bits] autorelease];
-  NSMutableArray *codewords = [[[parser readCodewords] mutableCopy] autorelease];
-  if (codewords.count == 0) {
+  int codewords[MAX_CW_CAPACITY];
+  int erasures[MAX_CW_CAPACITY];
+  int erasuresLen = 0;
+  int codewordsLen = [parser readCodewords:codewords erasures:erasures erasuresLen:&erasuresLen];
+  if (codewordsLen <= 0) {
     if (error) *error = FormatErrorInstance();
     return nil;
   }
 
   int ecLevel = parser.ecLevel;
   int numECCodewords = 1 << (ecLevel + 1);
-  NSArray *erasures = parser.erasures;
 
-  if (![self correctErrors:codewords erasures:erasures numECCodewords:numECCodewords]) {
+  if (![self correctErrors:codewords codewordsLen:codewordsLen erasures:erasures erasuresLen:erasuresLen numECCodewords:numECCodewords]) {
     if (error) *error = ChecksumErrorInstance();
     return nil;
   }
 
-  if (![self verifyCodewordCount:codewords numECCodewords:numECCodewords]) {
+  if (![self verifyCodewordCount:codewords codewordsLen:codewordsLen numECCodewords:numECCodewords]) {
     if (error) *error = FormatErrorInstance();
     return nil;
   }
 
-  return [ZXPDF417DecodedBitStreamParser decode:codewords error:error];
+  ZX_TRACE_BEGIN(traceStart);
+  ZXDecoderResult *result = [ZXPDF417DecodedBitStreamParser decode:codewords length:codewordsLen error:error];
+  ZX_TRACE_END(traceStart, kZXDecodeStageParse);
+  return result;
 }
 
 
 /**
  * Verify that all is OK with the codeword array.
  */
-- (BOOL)verifyCodewordCount:(NSMutableArray *)codewords numECCodewords:(int)numECCodewords {
-  if ([codewords count] < 4) {
+- (BOOL)verifyCodewordCount:(int *)codewords codewordsLen:(int)codewordsLen numECCodewords:(int)numECCodewords {
+  if (codewordsLen < 4) {
     return NO;
   }
 
-  int numberOfCodewords = [[codewords objectAtIndex:0] intValue];
-  if (numberOfCodewords > [codewords count]) {
+  int numberOfCodewords = codewords[0];
+  if (numberOfCodewords > codewordsLen) {
     return NO;
   }
   if (numberOfCodewords == 0) {
-    if (numECCodewords < [codewords count]) {
-      [codewords replaceObjectAtIndex:0 withObject:[NSNumber numberWithInt:[codewords count] - numECCodewords]];
+    if (numECCodewords < codewordsLen) {
+      codewords[0] = codewordsLen - numECCodewords;
     } else {
       return NO;
     }
@@ -126,14 +132,14 @@ int const MAX_EC_CODEWORDS = 512;
  * Given data and error-correction codewords received, possibly corrupted by errors, attempts to
  * orrect the errors in-place.
  */
-- (BOOL)correctErrors:(NSMutableArray *)codewords erasures:(NSArray *)erasures numECCodewords:(int)numECCodewords {
-  if (erasures.count > numECCodewords / 2 + ZX_PDF_MAX_ERRORS ||
+- (BOOL)correctErrors:(int *)codewords codewordsLen:(int)codewordsLen erasures:(int *)erasures erasuresLen:(int)erasuresLen numECCodewords:(int)numECCodewords {
+  if (erasuresLen > numECCodewords / 2 + ZX_PDF_MAX_ERRORS ||
       numECCodewords < 0 || numECCodewords > MAX_EC_CODEWORDS) {
     // Too many errors or EC Codewords is corrupted
     return NO;
   }
 
-  return [self.errorCorrection decode:codewords numECCodewords:numECCodewords erasures:erasures];
+  return [self.errorCorrection decode:codewords receivedLen:codewordsLen numECCodewords:numECCodewords erasures:erasures erasuresLen:erasuresLen];
 }
 
 @end
@@ -20,6 +20,8 @@
 
 @property (nonatomic, retain) ZXModulusPoly *one;
 @property (nonatomic, retain) ZXModulusPoly *zero;
+@property (nonatomic, assign, readonly) int *expTable;
+@property (nonatomic, assign, readonly) int *logTable;
 
 + (ZXModulusGF *)PDF417_GF;
 
@@ -19,8 +19,8 @@
 
 @interface ZXModulusGF ()
 
-@property (nonatomic, retain) NSMutableArray *expTable;
-@property (nonatomic, retain) NSMutableArray *logTable;
+@property (nonatomic, assign) int *expTable;
+@property (nonatomic, assign) int *logTable;
 @property (nonatomic, assign) int modulus;
 
 @end
@@ -34,26 +34,28 @@
 @synthesize zero;
 
 + (ZXModulusGF *)PDF417_GF {
-  return [[[ZXModulusGF alloc] initWithModulus:929 generator:3] autorelease];
+  static ZXModulusGF *PDF417_GF = nil;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    PDF417_GF = [[ZXModulusGF alloc] initWithModulus:929 generator:3];
+  });
+  return PDF417_GF;
 }
 
 - (id)initWithModulus:(int)aModulus generator:(int)generator {
   if (self = [super init]) {
     self.modulus = aModulus;
-    self.expTable = [NSMutableArray arrayWithCapacity:self.modulus];
-    self.logTable = [NSMutableArray arrayWithCapacity:self.modulus];
+    self.expTable = (int *)malloc(modulus * sizeof(int));
+    self.logTable = (int *)malloc(modulus * sizeof(int));
     int x = 1;
-    for (int i = 0; i < self.modulus; i++) {
-      [self.expTable addObject:[NSNumber numberWithInt:x]];
-      x = (x * generator) % self.modulus;
+    for (int i = 0; i < modulus; i++) {
+      expTable[i] = x;
+      x = (x * generator) % modulus;
     }
 
-    for (int i = 0; i < self.size; i++) {
-      [self.logTable addObject:[NSNumber numberWithInt:0]];
-    }
-
-    for (int i = 0; i < self.size - 1; i++) {
-      [self.logTable replaceObjectAtIndex:[[self.expTable objectAtIndex:i] intValue] withObject:[NSNumber numberWithInt:i]];
+    logTable[0] = 0;
+    for (int i = 0; i < modulus - 1; i++) {
+      logTable[expTable[i]] = i;
     }
     // logTable[0] == 0 but this should never be used
     int zeroInt = 0;
@@ -66,6 +68,15 @@
   return self;
 }
 
+- (void)dealloc {
+  free(expTable);
+  free(logTable);
+  [one release];
+  [zero release];
+
+  [super dealloc];
+}
+
 - (ZXModulusPoly *)buildMonomial:(int)degree coefficient:(int)coefficient {
   if (degree < 0) {
     [NSException raise:NSInvalidArgumentException format:@"Degree must be greater than 0."];
@@ -92,21 +103,21 @@
 }
 
 - (int)exp:(int)a {
-  return [[self.expTable objectAtIndex:a] intValue];
+  return expTable[a];
 }
 
 - (int)log:(int)a {
   if (a == 0) {
     [NSException raise:NSInvalidArgumentException format:@"Argument must be non-zero."];
   }
-  return [[self.logTable objectAtIndex:a] intValue];
+  return logTable[a];
 }
 
 - (int)inverse:(int)a {
   if (a == 0) {
     [NSException raise:NSInvalidArgumentException format:@"Argument must be non-zero."];
   }
-  return [[self.expTable objectAtIndex:self.size - [[self.logTable objectAtIndex:a] intValue] - 1] intValue];
+  return expTable[modulus - logTable[a] - 1];
 }
 
 - (int)multiply:(int)a b:(int)b {
@@ -114,8 +125,8 @@
     return 0;
   }
 
-  int logSum = [[self.logTable objectAtIndex:a] intValue] + [[self.logTable objectAtIndex:b] intValue];
-  return [[self.expTable objectAtIndex:logSum % (self.modulus - 1)] intValue];
+  int logSum = logTable[a] + logTable[b];
+  return expTable[logSum % (modulus - 1)];
 }
 
 - (int)size {
@@ -24,5 +24,6 @@
 @interface ZXPDF417ECErrorCorrection : NSObject
 
 - (BOOL)decode:(NSMutableArray *)received numECCodewords:(int)numECCodewords erasures:(NSArray *)erasures;
+- (BOOL)decode:(int *)received receivedLen:(int)receivedLen numECCodewords:(int)numECCodewords erasures:(int *)erasures erasuresLen:(int)erasuresLen;
 
 @end
@@ -14,189 +14,219 @@
  * limitations under the License.
  */
 
+#import "ZXDecodeTrace.h"
 #import "ZXModulusGF.h"
-#import "ZXModulusPoly.h"
 #import "ZXPDF417ECErrorCorrection.h"
 
-@interface ZXPDF417ECErrorCorrection ()
-
-@property (nonatomic, retain) ZXModulusGF *field;
-
-- (NSArray *)runEuclideanAlgorithm:(ZXModulusPoly *)a b:(ZXModulusPoly *)b R:(int)R;
-- (NSArray *)findErrorLocations:(ZXModulusPoly *)errorLocator;
-- (NSArray *)findErrorMagnitudes:(ZXModulusPoly *)errorEvaluator errorLocator:(ZXModulusPoly *)errorLocator errorLocations:(NSArray *)errorLocations;
-
-@end
+static const int PDF417_MODULUS = 929;
 
-@implementation ZXPDF417ECErrorCorrection
-
-@synthesize field;
-
-- (id)init {
-  if (self = [super init]) {
-    self.field = [ZXModulusGF PDF417_GF];
+static inline int ZXPDF417Evaluate(const int *coefficients, int degree, int x) {
+  int result = 0;
+  for (int i = degree; i >= 0; i--) {
+    result = (result * x + coefficients[i]) % PDF417_MODULUS;
   }
-
-  return self;
-}
-
-- (void)dealloc {
-  [field release];
-
-  [super dealloc];
+  return result;
 }
 
-- (BOOL)decode:(NSMutableArray *)received numECCodewords:(int)numECCodewords erasures:(NSArray *)erasures {
-  int coefficients[received.count];
-  for (int i = 0; i < received.count; i++) {
-    coefficients[i] = [[received objectAtIndex:i] intValue];
+static inline int ZXPDF417Degree(const int *coefficients, int degree) {
+  while (degree > 0 && coefficients[degree] == 0) {
+    degree--;
   }
-  ZXModulusPoly *poly = [[[ZXModulusPoly alloc] initWithField:self.field coefficients:coefficients coefficientsLen:received.count] autorelease];
+  return degree;
+}
 
-  int S[numECCodewords];
-  for (int i = 0; i < numECCodewords; i++) {
-    S[i] = 0;
+/**
+ * Corrects received in place. Polynomials are coefficient arrays on the stack indexed by power,
+ * products are reduced modulo 929 directly and the field tables give inverses and logarithms.
+ */
+static BOOL ZXPDF417CorrectErrors(int *received, int receivedLen, int numECCodewords, const int *expTable, const int *logTable) {
+  if (numECCodewords <= 0) {
+    return YES;
   }
+  int R = numECCodewords;
 
+  // S(x) has received(3^(i+1)) as its coefficient of x^i
+  int syndrome[R + 1];
   BOOL error = NO;
-  for (int i = numECCodewords; i > 0; i--) {
-    int eval = [poly evaluateAt:[self.field exp:i]];
-    S[numECCodewords - i] = eval;
+  for (int i = 0; i < R; i++) {
+    int x = expTable[i + 1];
+    int eval = 0;
+    for (int j = 0; j < receivedLen; j++) {
+      eval = (eval * x + received[j]) % PDF417_MODULUS;
+    }
+    syndrome[i] = eval;
     if (eval != 0) {
       error = YES;
     }
   }
+  if (!error) {
+    return YES;
+  }
+  syndrome[R] = 0;
+
+  // Run the Euclidean algorithm on x^R and S(x) until r's degree is less than R/2. Each remainder
+  // is reduced in place over the one before last, and t = tLastLast - q * tLast the same way.
+  int rBuffers[2][R + 1];
+  int tBuffers[2][R + 1];
+  memset(rBuffers, 0, sizeof(rBuffers));
+  memset(tBuffers, 0, sizeof(tBuffers));
+  int *rLast = rBuffers[0];
+  int *r = rBuffers[1];
+  int *tLast = tBuffers[0];
+  int *t = tBuffers[1];
+  rLast[R] = 1;
+  int rLastDegree = R;
+  memcpy(r, syndrome, (R + 1) * sizeof(int));
+  int rDegree = ZXPDF417Degree(r, R - 1);
+  int tLastDegree = 0;
+  t[0] = 1;
+  int tDegree = 0;
+
+  while (rDegree >= R / 2) {
+    int *rLastLast = rLast;
+    int rLastLastDegree = rLastDegree;
+    int *tLastLast = tLast;
+    int tLastLastDegree = tLastDegree;
+    rLast = r;
+    rLastDegree = rDegree;
+    tLast = t;
+    tLastDegree = tDegree;
 
-  if (error) {
-
-    ZXModulusPoly *knownErrors = self.field.one;
-    for (NSNumber *erasure in erasures) {
-      int b = [self.field exp:received.count - 1 - [erasure intValue]];
-      // Add (1 - bx) term:
-      int termCoefficients[2] = { [self.field subtract:0 b:b], 1 };
-      ZXModulusPoly *term = [[[ZXModulusPoly alloc] initWithField:field coefficients:termCoefficients coefficientsLen:2] autorelease];
-      knownErrors = [knownErrors multiply:term];
+    if (rLastDegree == 0 && rLast[0] == 0) {
+      return NO;
     }
 
-    ZXModulusPoly *syndrome = [[[ZXModulusPoly alloc] initWithField:self.field coefficients:S coefficientsLen:numECCodewords] autorelease];
-    //[syndrome multiply:knownErrors];
-
-    NSArray *sigmaOmega = [self runEuclideanAlgorithm:[self.field buildMonomial:numECCodewords coefficient:1] b:syndrome R:numECCodewords];
-    if (!sigmaOmega) {
-      return NO;
+    r = rLastLast;
+    rDegree = rLastLastDegree;
+    t = tLastLast;
+    tDegree = tLastLastDegree;
+    int dltInverse = expTable[PDF417_MODULUS - 1 - logTable[rLast[rLastDegree]]];
+    while (rDegree >= rLastDegree && !(rDegree == 0 && r[0] == 0)) {
+      int degreeDiff = rDegree - rLastDegree;
+      int scale = (r[rDegree] * dltInverse) % PDF417_MODULUS;
+      for (int i = 0; i <= rLastDegree; i++) {
+        r[i + degreeDiff] = (r[i + degreeDiff] + PDF417_MODULUS - (rLast[i] * scale) % PDF417_MODULUS) % PDF417_MODULUS;
+      }
+      rDegree = ZXPDF417Degree(r, rDegree);
+      for (int i = 0; i <= tLastDegree; i++) {
+        t[i + degreeDiff] = (t[i + degreeDiff] + PDF417_MODULUS - (tLast[i] * scale) % PDF417_MODULUS) % PDF417_MODULUS;
+      }
+      tDegree = ZXPDF417Degree(t, MAX(tDegree, tLastDegree + degreeDiff));
     }
+  }
 
-    ZXModulusPoly *sigma = [sigmaOmega objectAtIndex:0];
-    ZXModulusPoly *omega = [sigmaOmega objectAtIndex:1];
+  int sigmaTildeAtZero = t[0];
+  if (sigmaTildeAtZero == 0) {
+    return NO;
+  }
+  int inverse = expTable[PDF417_MODULUS - 1 - logTable[sigmaTildeAtZero]];
+  for (int i = 0; i <= tDegree; i++) {
+    t[i] = (t[i] * inverse) % PDF417_MODULUS;
+  }
+  for (int i = 0; i <= rDegree; i++) {
+    r[i] = (r[i] * inverse) % PDF417_MODULUS;
+  }
 
-    //sigma = [sigma multiply:knownErrors];
+  // Chien's search for the roots of sigma, then Forney's formula for the magnitudes
+  int numErrors = tDegree;
+  int roots[numErrors + 1];
+  int numRoots = 0;
+  for (int i = 1; i < PDF417_MODULUS && numRoots < numErrors; i++) {
+    if (ZXPDF417Evaluate(t, tDegree, i) == 0) {
+      roots[numRoots++] = i;
+    }
+  }
+  if (numRoots != numErrors) {
+    return NO;
+  }
 
-    NSArray *errorLocations = [self findErrorLocations:sigma];
-    if (!errorLocations) return NO;
-    NSArray *errorMagnitudes = [self findErrorMagnitudes:omega errorLocator:sigma errorLocations:errorLocations];
+  int formalDerivative[numErrors + 1];
+  for (int i = 1; i <= numErrors; i++) {
+    formalDerivative[i - 1] = (i * t[i]) % PDF417_MODULUS;
+  }
 
-    for (int i = 0; i < errorLocations.count; i++) {
-      int position = received.count - 1 - [self.field log:[[errorLocations objectAtIndex:i] intValue]];
-      if (position < 0) {
-        return NO;
-      }
-      [received replaceObjectAtIndex:position
-                          withObject:[NSNumber numberWithInt:[self.field subtract:[[received objectAtIndex:position] intValue]
-                                                                                b:[[errorMagnitudes objectAtIndex:i] intValue]]]];
+  int positions[numErrors + 1];
+  int magnitudes[numErrors + 1];
+  for (int i = 0; i < numErrors; i++) {
+    int root = roots[i];
+    int errorLocation = expTable[PDF417_MODULUS - 1 - logTable[root]];
+    positions[i] = receivedLen - 1 - logTable[errorLocation];
+    if (positions[i] < 0) {
+      return NO;
     }
+    int denominator = ZXPDF417Evaluate(formalDerivative, numErrors - 1, root);
+    if (denominator == 0) {
+      return NO;
+    }
+    int numerator = (PDF417_MODULUS - ZXPDF417Evaluate(r, rDegree, root)) % PDF417_MODULUS;
+    magnitudes[i] = (numerator * expTable[PDF417_MODULUS - 1 - logTable[denominator]]) % PDF417_MODULUS;
   }
 
+  for (int i = 0; i < numErrors; i++) {
+    received[positions[i]] = (received[positions[i]] + PDF417_MODULUS - magnitudes[i]) % PDF417_MODULUS;
+  }
+  ZX_TRACE_COUNT(errorsCorrected, numErrors);
   return YES;
 }
 
-- (NSArray *)runEuclideanAlgorithm:(ZXModulusPoly *)a b:(ZXModulusPoly *)b R:(int)R {
-  // Assume a's degree is >= b's
-  if (a.degree < b.degree) {
-    ZXModulusPoly *temp = a;
-    a = b;
-    b = temp;
-  }
+@interface ZXPDF417ECErrorCorrection ()
 
-  ZXModulusPoly *rLast = a;
-  ZXModulusPoly *r = b;
-  ZXModulusPoly *tLast = self.field.zero;
-  ZXModulusPoly *t = self.field.one;
+@property (nonatomic, retain) ZXModulusGF *field;
 
-  // Run Euclidean algorithm until r's degree is less than R/2
-  while (r.degree >= R / 2) {
-    ZXModulusPoly *rLastLast = rLast;
-    ZXModulusPoly *tLastLast = tLast;
-    rLast = r;
-    tLast = t;
+@end
 
-    // Divide rLastLast by rLast, with quotient in q and remainder in r
-    if (rLast.zero) {
-      // Oops, Euclidean algorithm already terminated?
-      return nil;
-    }
-    r = rLastLast;
-    ZXModulusPoly *q = self.field.zero;
-    int denominatorLeadingTerm = [rLast coefficient:rLast.degree];
-    int dltInverse = [self.field inverse:denominatorLeadingTerm];
-    while (r.degree >= rLast.degree && !r.zero) {
-      int degreeDiff = r.degree - rLast.degree;
-      int scale = [self.field multiply:[r coefficient:r.degree] b:dltInverse];
-      q = [q add:[field buildMonomial:degreeDiff coefficient:scale]];
-      r = [r subtract:[rLast multiplyByMonomial:degreeDiff coefficient:scale]];
-    }
+@implementation ZXPDF417ECErrorCorrection
 
-    t = [[[q multiply:tLast] subtract:tLastLast] negative];
-  }
+@synthesize field;
 
-  int sigmaTildeAtZero = [t coefficient:0];
-  if (sigmaTildeAtZero == 0) {
-    return nil;
+- (id)init {
+  if (self = [super init]) {
+    self.field = [ZXModulusGF PDF417_GF];
   }
 
-  int inverse = [self.field inverse:sigmaTildeAtZero];
-  ZXModulusPoly *sigma = [t multiplyScalar:inverse];
-  ZXModulusPoly *omega = [r multiplyScalar:inverse];
-  return [NSArray arrayWithObjects:sigma, omega, nil];
+  return self;
 }
 
-- (NSArray *)findErrorLocations:(ZXModulusPoly *)errorLocator {
-  // This is a direct application of Chien's search
-  int numErrors = errorLocator.degree;
-  NSMutableArray *result = [NSMutableArray arrayWithCapacity:numErrors];
-  for (int i = 1; i < self.field.size && result.count < numErrors; i++) {
-    if ([errorLocator evaluateAt:i] == 0) {
-      [result addObject:[NSNumber numberWithInt:[field inverse:i]]];
-    }
-  }
-  if (result.count != numErrors) {
-    return nil;
-  }
-  return result;
+- (void)dealloc {
+  [field release];
+
+  [super dealloc];
 }
 
-- (NSArray *)findErrorMagnitudes:(ZXModulusPoly *)errorEvaluator errorLocator:(ZXModulusPoly *)errorLocator errorLocations:(NSArray *)errorLocations {
-  int errorLocatorDegree = errorLocator.degree;
-  int formalDerivativeCoefficients[errorLocatorDegree];
-  for (int i = 0; i < errorLocatorDegree; i++) {
-    formalDerivativeCoefficients[i] = 0;
+- (BOOL)decode:(NSMutableArray *)received numECCodewords:(int)numECCodewords erasures:(NSArray *)erasures {
+  int receivedLen = received.count;
+  int codewords[receivedLen];
+  for (int i = 0; i < receivedLen; i++) {
+    codewords[i] = [[received objectAtIndex:i] intValue];
   }
 
-  for (int i = 1; i <= errorLocatorDegree; i++) {
-    formalDerivativeCoefficients[errorLocatorDegree - i] =
-      [self.field multiply:i b:[errorLocator coefficient:i]];
+  int erasuresLen = erasures.count;
+  int erasureCodewords[erasuresLen];
+  for (int i = 0; i < erasuresLen; i++) {
+    erasureCodewords[i] = [[erasures objectAtIndex:i] intValue];
   }
-  ZXModulusPoly *formalDerivative = [[[ZXModulusPoly alloc] initWithField:self.field coefficients:formalDerivativeCoefficients coefficientsLen:errorLocatorDegree] autorelease];
 
-  // This is directly applying Forney's Formula
-  int s = errorLocations.count;
-  NSMutableArray *result = [NSMutableArray arrayWithCapacity:s];
-  for (int i = 0; i < s; i++) {
-    int xiInverse = [self.field inverse:[[errorLocations objectAtIndex:i] intValue]];
-    int numerator = [self.field subtract:0 b:[errorEvaluator evaluateAt:xiInverse]];
-    int denominator = [self.field inverse:[formalDerivative evaluateAt:xiInverse]];
-    [result addObject:[NSNumber numberWithInt:[self.field multiply:numerator b:denominator]]];
+  if (![self decode:codewords receivedLen:receivedLen numECCodewords:numECCodewords erasures:erasureCodewords erasuresLen:erasuresLen]) {
+    return NO;
   }
-  return result;
+
+  for (int i = 0; i < receivedLen; i++) {
+    if (codewords[i] != [[received objectAtIndex:i] intValue]) {
+      [received replaceObjectAtIndex:i withObject:[NSNumber numberWithInt:codewords[i]]];
+    }
+  }
+  return YES;
+}
+
+/**
+ * Corrects the codewords in received in place. As with the array version, erasures only bound how
+ * many errors the caller accepts; their positions are found again like any other error.
+ */
+- (BOOL)decode:(int *)received receivedLen:(int)receivedLen numECCodewords:(int)numECCodewords erasures:(int *)erasures erasuresLen:(int)erasuresLen {
+  ZX_TRACE_BEGIN(traceStart);
+  BOOL corrected = ZXPDF417CorrectErrors(received, receivedLen, numECCodewords, self.field.expTable, self.field.logTable);
+  ZX_TRACE_END(traceStart, kZXDecodeStageErrorCorrect);
+  return corrected;
 }
 
 @end
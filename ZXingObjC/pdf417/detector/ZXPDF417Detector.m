@@ -17,6 +17,7 @@
 #import "ZXBitMatrix.h"
 #import "ZXBinaryBitmap.h"
 #import "ZXDecodeHints.h"
+#import "ZXDecodeTrace.h"
 #import "ZXDetectorResult.h"
 #import "ZXErrors.h"
 #import "ZXGridSampler.h"
@@ -52,8 +53,8 @@ int const STOP_PATTERN_REVERSE[STOP_PATTERN_REVERSE_LEN] = {1, 2, 1, 1, 1, 3, 1,
 
 @property (nonatomic, retain) ZXBinaryBitmap *image;
 
-- (NSMutableArray *)findVertices:(ZXBitMatrix *)matrix tryHarder:(BOOL)tryHarder;
-- (NSMutableArray *)findVertices180:(ZXBitMatrix *)matrix tryHarder:(BOOL)tryHarder;
+- (NSMutableArray *)findVertices:(ZXBitMatrix *)matrix hints:(ZXDecodeHints *)hints;
+- (NSMutableArray *)findVertices180:(ZXBitMatrix *)matrix hints:(ZXDecodeHints *)hints;
 - (void)correctCodeWordVertices:(NSMutableArray *)vertices upsideDown:(BOOL)upsideDown;
 - (float)computeModuleWidth:(NSArray *)vertices;
 - (int)computeDimension:(ZXResultPoint *)topLeft topRight:(ZXResultPoint *)topRight bottomLeft:(ZXResultPoint *)bottomLeft bottomRight:(ZXResultPoint *)bottomRight moduleWidth:(float)moduleWidth;
@@ -108,13 +109,11 @@ int const STOP_PATTERN_REVERSE[STOP_PATTERN_REVERSE_LEN] = {1, 2, 1, 1, 1, 3, 1,
     return nil;
   }
 
-  BOOL tryHarder = hints != nil && hints.tryHarder;
-
   // Try to find the vertices assuming the image is upright.
-  NSMutableArray *vertices = [self findVertices:matrix tryHarder:tryHarder];
+  NSMutableArray *vertices = [self findVertices:matrix hints:hints];
   if (vertices == nil) {
     // Maybe the image is rotated 180 degrees?
-    vertices = [self findVertices180:matrix tryHarder:tryHarder];
+    vertices = [self findVertices180:matrix hints:hints];
     if (vertices != nil) {
       [self correctCodeWordVertices:vertices upsideDown:YES];
     }
@@ -183,7 +182,8 @@ int const STOP_PATTERN_REVERSE[STOP_PATTERN_REVERSE_LEN] = {1, 2, 1, 1, 1, 3, 1,
  * vertices[6] x, y top right codeword area
  * vertices[7] x, y bottom right codeword area
  */
-- (NSMutableArray *)findVertices:(ZXBitMatrix *)matrix tryHarder:(BOOL)tryHarder {
+- (NSMutableArray *)findVertices:(ZXBitMatrix *)matrix hints:(ZXDecodeHints *)hints {
+  BOOL tryHarder = hints != nil && hints.tryHarder;
   int height = matrix.height;
   int width = matrix.width;
 
@@ -200,6 +200,9 @@ int const STOP_PATTERN_REVERSE[STOP_PATTERN_REVERSE_LEN] = {1, 2, 1, 1, 1, 3, 1,
 
   // Top Left
   for (int i = 0; i < height; i += rowStep) {
+    if (hints.cancelled) {
+      return nil;
+    }
     NSRange loc = [self findGuardPattern:matrix column:0 row:i width:width whiteFirst:NO pattern:(int *)PDF417_START_PATTERN patternLen:PDF417_START_PATTERN_LEN counters:counters];
     if (loc.location != NSNotFound) {
       [result replaceObjectAtIndex:0 withObject:[[[ZXResultPoint alloc] initWithX:loc.location y:i] autorelease]];
@@ -212,6 +215,9 @@ int const STOP_PATTERN_REVERSE[STOP_PATTERN_REVERSE_LEN] = {1, 2, 1, 1, 1, 3, 1,
   if (found) { // Found the Top Left vertex
     found = NO;
     for (int i = height - 1; i > 0; i -= rowStep) {
+      if (hints.cancelled) {
+        return nil;
+      }
       NSRange loc = [self findGuardPattern:matrix column:0 row:i width:width whiteFirst:NO pattern:(int *)PDF417_START_PATTERN patternLen:PDF417_START_PATTERN_LEN counters:counters];
       if (loc.location != NSNotFound) {
         [result replaceObjectAtIndex:1 withObject:[[[ZXResultPoint alloc] initWithX:loc.location y:i] autorelease]];
@@ -229,6 +235,9 @@ int const STOP_PATTERN_REVERSE[STOP_PATTERN_REVERSE_LEN] = {1, 2, 1, 1, 1, 3, 1,
   if (found) { // Found the Bottom Left vertex
     found = NO;
     for (int i = 0; i < height; i += rowStep) {
+      if (hints.cancelled) {
+        return nil;
+      }
       NSRange loc = [self findGuardPattern:matrix column:0 row:i width:width whiteFirst:NO pattern:(int *)STOP_PATTERN patternLen:STOP_PATTERN_LEN counters:counters2];
       if (loc.location != NSNotFound) {
         [result replaceObjectAtIndex:2 withObject:[[[ZXResultPoint alloc] initWithX:NSMaxRange(loc) y:i] autorelease]];
@@ -242,6 +251,9 @@ int const STOP_PATTERN_REVERSE[STOP_PATTERN_REVERSE_LEN] = {1, 2, 1, 1, 1, 3, 1,
   if (found) { // Found the Top right vertex
     found = NO;
     for (int i = height - 1; i > 0; i -= rowStep) {
+      if (hints.cancelled) {
+        return nil;
+      }
       NSRange loc = [self findGuardPattern:matrix column:0 row:i width:width whiteFirst:NO pattern:(int *)STOP_PATTERN patternLen:STOP_PATTERN_LEN counters:counters2];
       if (loc.location != NSNotFound) {
         [result replaceObjectAtIndex:3 withObject:[[[ZXResultPoint alloc] initWithX:NSMaxRange(loc) y:i] autorelease]];
@@ -272,7 +284,8 @@ int const STOP_PATTERN_REVERSE[STOP_PATTERN_REVERSE_LEN] = {1, 2, 1, 1, 1, 3, 1,
  * vertices[6] x, y top right codeword area
  * vertices[7] x, y bottom right codeword area
  */
-- (NSMutableArray *)findVertices180:(ZXBitMatrix *)matrix tryHarder:(BOOL)tryHarder {
+- (NSMutableArray *)findVertices180:(ZXBitMatrix *)matrix hints:(ZXDecodeHints *)hints {
+  BOOL tryHarder = hints != nil && hints.tryHarder;
   int height = matrix.height;
   int width = matrix.width;
   int halfWidth = width >> 1;
@@ -290,6 +303,9 @@ int const STOP_PATTERN_REVERSE[STOP_PATTERN_REVERSE_LEN] = {1, 2, 1, 1, 1, 3, 1,
 
   // Top Left
   for (int i = height - 1; i > 0; i -= rowStep) {
+    if (hints.cancelled) {
+      return nil;
+    }
     NSRange loc = [self findGuardPattern:matrix column:halfWidth row:i width:halfWidth whiteFirst:YES pattern:(int *)START_PATTERN_REVERSE patternLen:START_PATTERN_REVERSE_LEN counters:counters];
     if (loc.location != NSNotFound) {
       [result replaceObjectAtIndex:0 withObject:[[[ZXResultPoint alloc] initWithX:NSMaxRange(loc) y:i] autorelease]];
@@ -302,6 +318,9 @@ int const STOP_PATTERN_REVERSE[STOP_PATTERN_REVERSE_LEN] = {1, 2, 1, 1, 1, 3, 1,
   if (found) { // Found the Top Left vertex
     found = NO;
     for (int i = 0; i < height; i += rowStep) {
+      if (hints.cancelled) {
+        return nil;
+      }
       NSRange loc = [self findGuardPattern:matrix column:halfWidth row:i width:halfWidth whiteFirst:YES pattern:(int *)START_PATTERN_REVERSE patternLen:START_PATTERN_REVERSE_LEN counters:counters];
       if (loc.location != NSNotFound) {
         [result replaceObjectAtIndex:1 withObject:[[[ZXResultPoint alloc] initWithX:NSMaxRange(loc) y:i] autorelease]];
@@ -319,6 +338,9 @@ int const STOP_PATTERN_REVERSE[STOP_PATTERN_REVERSE_LEN] = {1, 2, 1, 1, 1, 3, 1,
   if (found) { // Found the Bottom Left vertex
     found = NO;
     for (int i = height - 1; i > 0; i -= rowStep) {
+      if (hints.cancelled) {
+        return nil;
+      }
       NSRange loc = [self findGuardPattern:matrix column:0 row:i width:halfWidth whiteFirst:NO pattern:(int *)STOP_PATTERN_REVERSE patternLen:STOP_PATTERN_REVERSE_LEN counters:counters2];
       if (loc.location != NSNotFound) {
         [result replaceObjectAtIndex:2 withObject:[[[ZXResultPoint alloc] initWithX:loc.location y:i] autorelease]];
@@ -332,6 +354,9 @@ int const STOP_PATTERN_REVERSE[STOP_PATTERN_REVERSE_LEN] = {1, 2, 1, 1, 1, 3, 1,
   if (found) { // Found the Top Right vertex
     found = NO;
     for (int i = 0; i < height; i += rowStep) {
+      if (hints.cancelled) {
+        return nil;
+      }
       NSRange loc = [self findGuardPattern:matrix column:0 row:i width:halfWidth whiteFirst:NO pattern:(int *)STOP_PATTERN_REVERSE patternLen:STOP_PATTERN_REVERSE_LEN counters:counters2];
       if (loc.location != NSNotFound) {
         [result replaceObjectAtIndex:3 withObject:[[[ZXResultPoint alloc] initWithX:loc.location y:i] autorelease]];
@@ -474,26 +499,29 @@ int const STOP_PATTERN_REVERSE[STOP_PATTERN_REVERSE_LEN] = {1, 2, 1, 1, 1, 3, 1,
                  ydimension:(int)ydimension
                       error:(NSError **)error {
   ZXGridSampler *sampler = [ZXGridSampler instance];
-  return [sampler sampleGrid:matrix
-                  dimensionX:xdimension
-                  dimensionY:ydimension
-                       p1ToX:0.0f
-                       p1ToY:0.0f
-                       p2ToX:xdimension
-                       p2ToY:0.0f
-                       p3ToX:xdimension
-                       p3ToY:ydimension
-                       p4ToX:0.0f
-                       p4ToY:ydimension
-                     p1FromX:[topLeft x]
-                     p1FromY:[topLeft y]
-                     p2FromX:[topRight x]
-                     p2FromY:[topRight y]
-                     p3FromX:[bottomRight x]
-                     p3FromY:[bottomRight y]
-                     p4FromX:[bottomLeft x]
-                     p4FromY:[bottomLeft y]
-                       error:error];
+  ZX_TRACE_BEGIN(traceStart);
+  ZXBitMatrix *bits = [sampler sampleGrid:matrix
+                               dimensionX:xdimension
+                               dimensionY:ydimension
+                                    p1ToX:0.0f
+                                    p1ToY:0.0f
+                                    p2ToX:xdimension
+                                    p2ToY:0.0f
+                                    p3ToX:xdimension
+                                    p3ToY:ydimension
+                                    p4ToX:0.0f
+                                    p4ToY:ydimension
+                                  p1FromX:[topLeft x]
+                                  p1FromY:[topLeft y]
+                                  p2FromX:[topRight x]
+                                  p2FromY:[topRight y]
+                                  p3FromX:[bottomRight x]
+                                  p3FromY:[bottomRight y]
+                                  p4FromX:[bottomLeft x]
+                                  p4FromY:[bottomLeft y]
+                                    error:error];
+  ZX_TRACE_END(traceStart, kZXDecodeStageSample);
+  return bits;
 }
 
 - (NSRange)findGuardPattern:(ZXBitMatrix *)matrix column:(int)column row:(int)row width:(int)width whiteFirst:(BOOL)whiteFirst pattern:(int *)pattern patternLen:(int)patternLen counters:(int *)counters {
@@ -18,6 +18,7 @@
 #import "ZXBinaryBitmap.h"
 #import "ZXBitMatrix.h"
 #import "ZXDecodeHints.h"
+#import "ZXDecodeTrace.h"
 #import "ZXDecoderResult.h"
 #import "ZXDetectorResult.h"
 #import "ZXErrors.h"
@@ -79,10 +80,13 @@
     }
     points = [NSArray array];
   } else {
+    ZX_TRACE_BEGIN(traceStart);
     ZXDetectorResult *detectorResult = [[[[ZXQRCodeDetector alloc] initWithImage:matrix] autorelease] detect:hints error:error];
+    ZX_TRACE_END(traceStart, kZXDecodeStageDetect);
     if (!detectorResult) {
       return nil;
     }
+    ZX_TRACE_COUNT(candidatesFound, 1);
     decoderResult = [decoder decodeMatrix:[detectorResult bits] hints:hints error:error];
     if (!decoderResult) {
       return nil;
@@ -16,6 +16,8 @@
 
 #import "ZXWriter.h"
 
+extern int const QUIET_ZONE_SIZE;
+
 /**
  * This object renders a QR Code as a BitMatrix 2D array of greyscale values.
  */
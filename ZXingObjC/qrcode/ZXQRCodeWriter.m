@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#import "ZXBitArray.h"
 #import "ZXBitMatrix.h"
 #import "ZXByteMatrix.h"
 #import "ZXEncodeHints.h"
@@ -86,12 +87,25 @@ int const QUIET_ZONE_SIZE = 4;
 
   ZXBitMatrix *output = [[[ZXBitMatrix alloc] initWithWidth:outputWidth height:outputHeight] autorelease];
 
+  // Scale each module row once, dark runs at a time, and copy it down for every output row.
+  ZXBitArray *row = [[[ZXBitArray alloc] initWithSize:outputWidth] autorelease];
+  unsigned char **array = input.array;
   for (int inputY = 0, outputY = topPadding; inputY < inputHeight; inputY++, outputY += multiple) {
-    for (int inputX = 0, outputX = leftPadding; inputX < inputWidth; inputX++, outputX += multiple) {
-      if ([input getX:inputX y:inputY] == 1) {
-        [output setRegionAtLeft:outputX top:outputY width:multiple height:multiple];
+    [row clear];
+    unsigned char *inputRow = array[inputY];
+    for (int inputX = 0; inputX < inputWidth; inputX++) {
+      if (inputRow[inputX] == 1) {
+        int runEnd = inputX + 1;
+        while (runEnd < inputWidth && inputRow[runEnd] == 1) {
+          runEnd++;
+        }
+        [row setRange:leftPadding + inputX * multiple end:leftPadding + runEnd * multiple];
+        inputX = runEnd;
       }
     }
+    for (int y = 0; y < multiple; y++) {
+      [output setRowAtY:outputY + y row:row];
+    }
   }
 
   return output;
@@ -17,6 +17,15 @@
 #import "ZXBitMatrix.h"
 #import "ZXDataMask.h"
 
+@interface ZXDataMask () {
+  // Indexed by version - 1, built on first use by maskWordsForDimension:
+  int *maskWords[40];
+}
+
+- (const int *)maskWordsForDimension:(int)dimension;
+
+@end
+
 /**
  * 000: mask bits for which (x + y) mod 2 == 0
  */
@@ -164,6 +173,16 @@ static NSArray *DATA_MASKS = nil;
  * make its bits ready to read.
  */
 - (void)unmaskBitMatrix:(ZXBitMatrix *)bits dimension:(int)dimension {
+  if (bits.width == dimension && bits.height == dimension && dimension >= 21 && dimension <= 177 && (dimension & 0x03) == 1) {
+    const int *words = [self maskWordsForDimension:dimension];
+    int *matrixWords = bits.bits;
+    int max = bits.rowSize * dimension;
+    for (int i = 0; i < max; i++) {
+      matrixWords[i] ^= words[i];
+    }
+    return;
+  }
+
   for (int i = 0; i < dimension; i++) {
     for (int j = 0; j < dimension; j++) {
       if ([self isMasked:i j:j]) {
@@ -173,6 +192,37 @@ static NSArray *DATA_MASKS = nil;
   }
 }
 
+/**
+ * Returns the modules flipped by this mask in a symbol of the given version dimension, as the
+ * words of a ZXBitMatrix. They are worked out once per version with isMasked:j: and then shared.
+ */
+- (const int *)maskWordsForDimension:(int)dimension {
+  int version = (dimension - 17) >> 2;
+  @synchronized(self) {
+    if (maskWords[version - 1] == NULL) {
+      int rowSize = (dimension + 31) >> 5;
+      int *words = (int *)calloc(rowSize * dimension, sizeof(int));
+      for (int i = 0; i < dimension; i++) {
+        for (int j = 0; j < dimension; j++) {
+          if ([self isMasked:i j:j]) {
+            words[i * rowSize + (j >> 5)] |= 1 << (j & 0x1f);
+          }
+        }
+      }
+      maskWords[version - 1] = words;
+    }
+    return maskWords[version - 1];
+  }
+}
+
+- (void)dealloc {
+  for (int i = 0; i < 40; i++) {
+    free(maskWords[i]);
+  }
+
+  [super dealloc];
+}
+
 - (BOOL)isMasked:(int)i j:(int)j {
   @throw [NSException exceptionWithName:NSInternalInconsistencyException
                                  reason:[NSString stringWithFormat:@"You must override %@ in a subclass", NSStringFromSelector(_cmd)]
@@ -181,7 +231,8 @@ static NSArray *DATA_MASKS = nil;
 
 
 + (ZXDataMask *)forReference:(int)reference {
-  if (!DATA_MASKS) {
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
     /**
      * See ISO 18004:2006 6.8.1
      */
@@ -194,7 +245,7 @@ static NSArray *DATA_MASKS = nil;
                   [[[ZXDataMask101 alloc] init] autorelease],
                   [[[ZXDataMask110 alloc] init] autorelease],
                   [[[ZXDataMask111 alloc] init] autorelease], nil];
-  }
+  });
 
   if (reference < 0 || reference > 7) {
     [NSException raise:NSInvalidArgumentException  format:@"Invalid reference value"];
@@ -54,11 +54,12 @@ static NSArray *FOR_BITS = nil;
 
 
 + (ZXErrorCorrectionLevel *)forBits:(int)bits {
-  if (!FOR_BITS) {
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
     FOR_BITS = [[NSArray alloc] initWithObjects:[ZXErrorCorrectionLevel errorCorrectionLevelM],
                 [ZXErrorCorrectionLevel errorCorrectionLevelL], [ZXErrorCorrectionLevel errorCorrectionLevelH],
                 [ZXErrorCorrectionLevel errorCorrectionLevelQ], nil];
-  }
+  });
 
   if (bits < 0 || bits >= [FOR_BITS count]) {
     @throw [NSException exceptionWithName:NSInvalidArgumentException
@@ -73,9 +74,10 @@ static NSArray *FOR_BITS = nil;
  */
 + (ZXErrorCorrectionLevel *)errorCorrectionLevelL {
   static ZXErrorCorrectionLevel *thisLevel = nil;
-  if (!thisLevel) {
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
     thisLevel = [[ZXErrorCorrectionLevel alloc] initWithOrdinal:0 bits:0x01 name:@"L"];
-  }
+  });
   return thisLevel;
 }
 
@@ -84,9 +86,10 @@ static NSArray *FOR_BITS = nil;
  */
 + (ZXErrorCorrectionLevel *)errorCorrectionLevelM {
   static ZXErrorCorrectionLevel *thisLevel = nil;
-  if (!thisLevel) {
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
     thisLevel = [[ZXErrorCorrectionLevel alloc] initWithOrdinal:1 bits:0x00 name:@"M"];
-  }
+  });
   return thisLevel;
 }
 
@@ -95,9 +98,10 @@ static NSArray *FOR_BITS = nil;
  */
 + (ZXErrorCorrectionLevel *)errorCorrectionLevelQ {
   static ZXErrorCorrectionLevel *thisLevel = nil;
-  if (!thisLevel) {
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
     thisLevel = [[ZXErrorCorrectionLevel alloc] initWithOrdinal:2 bits:0x03 name:@"Q"];
-  }
+  });
   return thisLevel;
 }
 
@@ -106,9 +110,10 @@ static NSArray *FOR_BITS = nil;
  */
 + (ZXErrorCorrectionLevel *)errorCorrectionLevelH {
   static ZXErrorCorrectionLevel *thisLevel = nil;
-  if (!thisLevel) {
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
     thisLevel = [[ZXErrorCorrectionLevel alloc] initWithOrdinal:3 bits:0x02 name:@"H"];
-  }
+  });
   return thisLevel;
 }
 
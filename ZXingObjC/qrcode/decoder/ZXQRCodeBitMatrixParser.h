@@ -22,5 +22,6 @@
 - (ZXFormatInformation *)readFormatInformationWithError:(NSError **)error;
 - (ZXQRCodeVersion *)readVersionWithError:(NSError **)error;
 - (NSArray *)readCodewordsWithError:(NSError **)error;
+- (BOOL)readCodewordBytes:(uint8_t *)codewords error:(NSError **)error;
 
 @end
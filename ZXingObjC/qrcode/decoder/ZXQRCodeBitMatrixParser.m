@@ -158,59 +158,64 @@
  * QR Code.
  */
 - (NSArray *)readCodewordsWithError:(NSError **)error {
+  ZXQRCodeVersion *version = [self readVersionWithError:error];
+  if (!version) {
+    return nil;
+  }
+
+  int totalCodewords = version.totalCodewords;
+  uint8_t codewords[totalCodewords];
+  if (![self readCodewordBytes:codewords error:error]) {
+    return nil;
+  }
+
+  NSMutableArray *result = [NSMutableArray arrayWithCapacity:totalCodewords];
+  for (int i = 0; i < totalCodewords; i++) {
+    [result addObject:[NSNumber numberWithChar:(char)codewords[i]]];
+  }
+  return result;
+}
+
+/**
+ * Like readCodewordsWithError:, but writes the codewords to a buffer that must have room for the
+ * totalCodewords of the version readVersionWithError: returns.
+ */
+- (BOOL)readCodewordBytes:(uint8_t *)codewords error:(NSError **)error {
   ZXFormatInformation *formatInfo = [self readFormatInformationWithError:error];
   if (!formatInfo) {
-    return nil;
+    return NO;
   }
 
   ZXQRCodeVersion *version = [self readVersionWithError:error];
   if (!version) {
-    return nil;
+    return NO;
   }
 
   ZXDataMask *dataMask = [ZXDataMask forReference:(int)[formatInfo dataMask]];
   int dimension = self.bitMatrix.height;
   [dataMask unmaskBitMatrix:bitMatrix dimension:dimension];
-  ZXBitMatrix *functionPattern = [version buildFunctionPattern];
-  BOOL readingUp = YES;
-  NSMutableArray *result = [NSMutableArray array];
-  int resultOffset = 0;
-  int currentByte = 0;
-  int bitsRead = 0;
-
-  for (int j = dimension - 1; j > 0; j -= 2) {
-    if (j == 6) {
-      j--;
-    }
-
-    for (int count = 0; count < dimension; count++) {
-      int i = readingUp ? dimension - 1 - count : count;
-
-      for (int col = 0; col < 2; col++) {
-        if (![functionPattern getX:j - col y:i]) {
-          bitsRead++;
-          currentByte <<= 1;
-          if ([self.bitMatrix getX:j - col y:i]) {
-            currentByte |= 1;
-          }
-          if (bitsRead == 8) {
-            [result addObject:[NSNumber numberWithChar:(char)currentByte]];
-            resultOffset++;
-            bitsRead = 0;
-            currentByte = 0;
-          }
-        }
-      }
-    }
-
-    readingUp ^= YES;
-  }
 
+  // Read the data modules through the version's precomputed zigzag order, eight bits per codeword
+  int positionsCount;
+  const int *positions = [version dataModulePositions:&positionsCount];
+  const unsigned int *bits = (const unsigned int *)self.bitMatrix.bits;
+  int rowSize = self.bitMatrix.rowSize;
+  int resultOffset = positionsCount >> 3;
   if (resultOffset != [version totalCodewords]) {
     if (error) *error = FormatErrorInstance();
-    return nil;
+    return NO;
   }
-  return result;
+
+  for (int offset = 0; offset < resultOffset; offset++) {
+    int currentByte = 0;
+    for (int bit = 0; bit < 8; bit++) {
+      int position = positions[(offset << 3) + bit];
+      int x = position & 0xFFFF;
+      currentByte = (currentByte << 1) | ((bits[(position >> 16) * rowSize + (x >> 5)] >> (x & 0x1f)) & 1);
+    }
+    codewords[offset] = (uint8_t)currentByte;
+  }
+  return YES;
 }
 
 @end
@@ -29,5 +29,7 @@
 
 - (id)initWithNumDataCodewords:(int)numDataCodewords codewords:(NSMutableArray *)codewords;
 + (NSArray *)dataBlocks:(NSArray *)rawCodewords version:(ZXQRCodeVersion *)version ecLevel:(ZXErrorCorrectionLevel *)ecLevel;
++ (int)dataBlockBytes:(const uint8_t *)rawCodewords version:(ZXQRCodeVersion *)version ecLevel:(ZXErrorCorrectionLevel *)ecLevel
+       blockCodewords:(uint8_t *)blockCodewords numCodewords:(int *)numCodewords numDataCodewords:(int *)numDataCodewords;
 
 @end
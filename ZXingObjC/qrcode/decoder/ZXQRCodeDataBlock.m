@@ -56,34 +56,62 @@
     [NSException raise:NSInvalidArgumentException format:@"Invalid codewords count"];
   }
 
-  ZXQRCodeECBlocks *ecBlocks = [version ecBlocksForLevel:ecLevel];
+  int totalCodewords = version.totalCodewords;
+  uint8_t rawBytes[totalCodewords];
+  for (int i = 0; i < totalCodewords; i++) {
+    rawBytes[i] = (uint8_t)[[rawCodewords objectAtIndex:i] charValue];
+  }
 
-  int totalBlocks = 0;
-  NSArray *ecBlockArray = ecBlocks.ecBlocks;
-  for (ZXQRCodeECB *ecBlock in ecBlockArray) {
-    totalBlocks += ecBlock.count;
+  int maxBlocks = [version ecBlocksForLevel:ecLevel].numBlocks;
+  uint8_t blockBytes[totalCodewords];
+  int numCodewords[maxBlocks];
+  int numDataCodewords[maxBlocks];
+  int numBlocks = [self dataBlockBytes:rawBytes version:version ecLevel:ecLevel
+                        blockCodewords:blockBytes numCodewords:numCodewords numDataCodewords:numDataCodewords];
+
+  NSMutableArray *result = [NSMutableArray arrayWithCapacity:numBlocks];
+  int offset = 0;
+  for (int i = 0; i < numBlocks; i++) {
+    NSMutableArray *newCodewords = [NSMutableArray arrayWithCapacity:numCodewords[i]];
+    for (int j = 0; j < numCodewords[i]; j++) {
+      [newCodewords addObject:[NSNumber numberWithChar:(char)blockBytes[offset++]]];
+    }
+    [result addObject:[[[ZXQRCodeDataBlock alloc] initWithNumDataCodewords:numDataCodewords[i] codewords:newCodewords] autorelease]];
   }
+  return result;
+}
+
+/**
+ * Separates the version.totalCodewords bytes of rawCodewords into their blocks, like dataBlocks:version:ecLevel:,
+ * writing the blocks one after another into blockCodewords, which must hold as many bytes. The
+ * sizes of each block go to numCodewords and numDataCodewords, which must have room for the
+ * numBlocks of the version's blocks at ecLevel. Returns the number of blocks.
+ */
++ (int)dataBlockBytes:(const uint8_t *)rawCodewords version:(ZXQRCodeVersion *)version ecLevel:(ZXErrorCorrectionLevel *)ecLevel
+       blockCodewords:(uint8_t *)blockCodewords numCodewords:(int *)numCodewords numDataCodewords:(int *)numDataCodewords {
+  ZXQRCodeECBlocks *ecBlocks = [version ecBlocksForLevel:ecLevel];
 
-  NSMutableArray *result = [NSMutableArray arrayWithCapacity:totalBlocks];
-  for (ZXQRCodeECB *ecBlock in ecBlockArray) {
+  int numResultBlocks = 0;
+  for (ZXQRCodeECB *ecBlock in ecBlocks.ecBlocks) {
     for (int i = 0; i < ecBlock.count; i++) {
-      int numDataCodewords = ecBlock.dataCodewords;
-      int numBlockCodewords = ecBlocks.ecCodewordsPerBlock + numDataCodewords;
-      NSMutableArray *newCodewords = [NSMutableArray arrayWithCapacity:numBlockCodewords];
-      for (int j = 0; j < numBlockCodewords; j++) {
-        [newCodewords addObject:[NSNull null]];
-      }
-
-      [result addObject:[[[ZXQRCodeDataBlock alloc] initWithNumDataCodewords:numDataCodewords codewords:newCodewords] autorelease]];
+      numDataCodewords[numResultBlocks] = ecBlock.dataCodewords;
+      numCodewords[numResultBlocks] = ecBlocks.ecCodewordsPerBlock + ecBlock.dataCodewords;
+      numResultBlocks++;
     }
   }
 
-  int shorterBlocksTotalCodewords = [[[result objectAtIndex:0] codewords] count];
-  int longerBlocksStartAt = [result count] - 1;
+  int blockOffsets[numResultBlocks];
+  int blockOffset = 0;
+  for (int j = 0; j < numResultBlocks; j++) {
+    blockOffsets[j] = blockOffset;
+    blockOffset += numCodewords[j];
+  }
+
+  int shorterBlocksTotalCodewords = numCodewords[0];
+  int longerBlocksStartAt = numResultBlocks - 1;
 
   while (longerBlocksStartAt >= 0) {
-    int numCodewords = [[[result objectAtIndex:longerBlocksStartAt] codewords] count];
-    if (numCodewords == shorterBlocksTotalCodewords) {
+    if (numCodewords[longerBlocksStartAt] == shorterBlocksTotalCodewords) {
       break;
     }
     longerBlocksStartAt--;
@@ -92,27 +120,25 @@
   longerBlocksStartAt++;
   int shorterBlocksNumDataCodewords = shorterBlocksTotalCodewords - ecBlocks.ecCodewordsPerBlock;
   int rawCodewordsOffset = 0;
-  int numResultBlocks = [result count];
 
   for (int i = 0; i < shorterBlocksNumDataCodewords; i++) {
     for (int j = 0; j < numResultBlocks; j++) {
-      [[[result objectAtIndex:j] codewords] replaceObjectAtIndex:i withObject:[rawCodewords objectAtIndex:rawCodewordsOffset++]];
+      blockCodewords[blockOffsets[j] + i] = rawCodewords[rawCodewordsOffset++];
     }
   }
 
   for (int j = longerBlocksStartAt; j < numResultBlocks; j++) {
-    [[[result objectAtIndex:j] codewords] replaceObjectAtIndex:shorterBlocksNumDataCodewords withObject:[rawCodewords objectAtIndex:rawCodewordsOffset++]];
+    blockCodewords[blockOffsets[j] + shorterBlocksNumDataCodewords] = rawCodewords[rawCodewordsOffset++];
   }
 
-  int max = [[[result objectAtIndex:0] codewords] count];
-  for (int i = shorterBlocksNumDataCodewords; i < max; i++) {
+  for (int i = shorterBlocksNumDataCodewords; i < shorterBlocksTotalCodewords; i++) {
     for (int j = 0; j < numResultBlocks; j++) {
       int iOffset = j < longerBlocksStartAt ? i : i + 1;
-      [[[result objectAtIndex:j] codewords] replaceObjectAtIndex:iOffset withObject:[rawCodewords objectAtIndex:rawCodewordsOffset++]];
+      blockCodewords[blockOffsets[j] + iOffset] = rawCodewords[rawCodewordsOffset++];
     }
   }
 
-  return result;
+  return numResultBlocks;
 }
 
 @end
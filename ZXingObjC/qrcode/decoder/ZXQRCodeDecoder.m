@@ -15,6 +15,7 @@
  */
 
 #import "ZXBitMatrix.h"
+#import "ZXDecodeTrace.h"
 #import "ZXDecoderResult.h"
 #import "ZXErrorCorrectionLevel.h"
 #import "ZXErrors.h"
@@ -31,7 +32,8 @@
 
 @property (nonatomic, retain) ZXReedSolomonDecoder *rsDecoder;
 
-- (BOOL)correctErrors:(NSMutableArray *)codewordBytes numDataCodewords:(int)numDataCodewords error:(NSError **)error;
+- (BOOL)correctErrors:(uint8_t *)codewordBytes numCodewords:(int)numCodewords numDataCodewords:(int)numDataCodewords
+       codewordsInts:(int *)codewordsInts error:(NSError **)error;
 
 @end
 
@@ -99,36 +101,48 @@
   }
   ZXErrorCorrectionLevel *ecLevel = formatInfo.errorCorrectionLevel;
 
-  NSArray *codewords = [parser readCodewordsWithError:error];
-  if (!codewords) {
+  // Every buffer of this decode is carved from one allocation: the block sizes and the Reed-Solomon
+  // work area first, then the raw codewords and the de-interleaved blocks. It is autoreleased,
+  // since the decoder result keeps pointing at the corrected data bytes.
+  int totalCodewords = version.totalCodewords;
+  int maxBlocks = [version ecBlocksForLevel:ecLevel].numBlocks;
+  int maxBlockCodewords = totalCodewords / maxBlocks + 1;
+  int intsLength = 2 * maxBlocks + maxBlockCodewords;
+  NSMutableData *arena = [NSMutableData dataWithLength:intsLength * sizeof(int) + 2 * totalCodewords];
+  int *numCodewords = (int *)[arena mutableBytes];
+  int *numDataCodewords = numCodewords + maxBlocks;
+  int *codewordsInts = numDataCodewords + maxBlocks;
+  uint8_t *rawCodewords = (uint8_t *)(numCodewords + intsLength);
+  uint8_t *blockCodewords = rawCodewords + totalCodewords;
+
+  if (![parser readCodewordBytes:rawCodewords error:error]) {
     return nil;
   }
-  NSArray *dataBlocks = [ZXQRCodeDataBlock dataBlocks:codewords version:version ecLevel:ecLevel];
+  int numBlocks = [ZXQRCodeDataBlock dataBlockBytes:rawCodewords version:version ecLevel:ecLevel
+                                     blockCodewords:blockCodewords numCodewords:numCodewords numDataCodewords:numDataCodewords];
 
+  // The raw codewords are not needed any more, so the corrected data bytes are gathered there
+  unsigned char *resultBytes = rawCodewords;
   int totalBytes = 0;
-  for (ZXQRCodeDataBlock *dataBlock in dataBlocks) {
-    totalBytes += dataBlock.numDataCodewords;
+  int blockOffset = 0;
+  for (int i = 0; i < numBlocks; i++) {
+    if (![self correctErrors:blockCodewords + blockOffset numCodewords:numCodewords[i] numDataCodewords:numDataCodewords[i]
+               codewordsInts:codewordsInts error:error]) {
+      return nil;
+    }
+    memcpy(resultBytes + totalBytes, blockCodewords + blockOffset, numDataCodewords[i]);
+    totalBytes += numDataCodewords[i];
+    blockOffset += numCodewords[i];
   }
 
   if (totalBytes == 0) {
     return nil;
   }
 
-  unsigned char resultBytes[totalBytes];
-  int resultOffset = 0;
-
-  for (ZXQRCodeDataBlock *dataBlock in dataBlocks) {
-    NSMutableArray *codewordBytes = [dataBlock codewords];
-    int numDataCodewords = [dataBlock numDataCodewords];
-    if (![self correctErrors:codewordBytes numDataCodewords:numDataCodewords error:error]) {
-      return nil;
-    }
-    for (int i = 0; i < numDataCodewords; i++) {
-      resultBytes[resultOffset++] = [[codewordBytes objectAtIndex:i] charValue];
-    }
-  }
-
-  return [ZXQRCodeDecodedBitStreamParser decode:resultBytes length:totalBytes version:version ecLevel:ecLevel hints:hints error:error];
+  ZX_TRACE_BEGIN(traceStart);
+  ZXDecoderResult *result = [ZXQRCodeDecodedBitStreamParser decode:resultBytes length:totalBytes version:version ecLevel:ecLevel hints:hints error:error];
+  ZX_TRACE_END(traceStart, kZXDecodeStageParse);
+  return result;
 }
 
 
@@ -136,15 +150,13 @@
  * Given data and error-correction codewords received, possibly corrupted by errors, attempts to
  * correct the errors in-place using Reed-Solomon error correction.
  */
-- (BOOL)correctErrors:(NSMutableArray *)codewordBytes numDataCodewords:(int)numDataCodewords error:(NSError **)error {
-  int numCodewords = [codewordBytes count];
-  int codewordsInts[numCodewords];
-
+- (BOOL)correctErrors:(uint8_t *)codewordBytes numCodewords:(int)numCodewords numDataCodewords:(int)numDataCodewords
+       codewordsInts:(int *)codewordsInts error:(NSError **)error {
   for (int i = 0; i < numCodewords; i++) {
-    codewordsInts[i] = [[codewordBytes objectAtIndex:i] charValue] & 0xFF;
+    codewordsInts[i] = codewordBytes[i];
   }
 
-  int numECCodewords = [codewordBytes count] - numDataCodewords;
+  int numECCodewords = numCodewords - numDataCodewords;
   NSError *decodeError = nil;
   if (![rsDecoder decode:codewordsInts receivedLen:numCodewords twoS:numECCodewords error:&decodeError]) {
     if (decodeError.code == ZXReedSolomonError) {
@@ -157,7 +169,7 @@
   }
 
   for (int i = 0; i < numDataCodewords; i++) {
-    [codewordBytes replaceObjectAtIndex:i withObject:[NSNumber numberWithChar:codewordsInts[i]]];
+    codewordBytes[i] = (uint8_t)codewordsInts[i];
   }
   return YES;
 }
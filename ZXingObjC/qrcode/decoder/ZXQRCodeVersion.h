@@ -72,5 +72,6 @@
 + (ZXQRCodeVersion *)versionForNumber:(int)versionNumber;
 + (ZXQRCodeVersion *)decodeVersionInformation:(int)versionBits;
 - (ZXBitMatrix *)buildFunctionPattern;
+- (const int *)dataModulePositions:(int *)count;
 
 @end
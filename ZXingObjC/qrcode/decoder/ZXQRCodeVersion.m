@@ -129,6 +129,11 @@ int const VERSION_DECODE_INFO[VERSION_DECODE_INFO_LEN] = {
 
 static NSArray *VERSIONS = nil;
 
+// Per version, built on first use: see dataModulePositions:
+static int *DATA_MODULE_POSITIONS[40];
+static int DATA_MODULE_COUNTS[40];
+static dispatch_once_t DATA_MODULE_POSITIONS_ONCE[40];
+
 @interface ZXQRCodeVersion ()
 
 @property (nonatomic, assign) int versionNumber;
@@ -255,6 +260,46 @@ static NSArray *VERSIONS = nil;
   return bitMatrix;
 }
 
+/**
+ * Returns the positions of the data modules in the order their bits are read, two columns at a
+ * time zigzagging up and down from the right, skipping the function patterns. Each position is
+ * packed as (y << 16) | x. The table is built once per version and shared.
+ */
+- (const int *)dataModulePositions:(int *)count {
+  int index = self.versionNumber - 1;
+  dispatch_once(&DATA_MODULE_POSITIONS_ONCE[index], ^{
+    ZXBitMatrix *functionPattern = [self buildFunctionPattern];
+    int dimension = [self dimensionForVersion];
+    int *positions = (int *)malloc(dimension * dimension * sizeof(int));
+    int positionsCount = 0;
+    BOOL readingUp = YES;
+
+    for (int j = dimension - 1; j > 0; j -= 2) {
+      if (j == 6) {
+        j--;
+      }
+
+      for (int count = 0; count < dimension; count++) {
+        int i = readingUp ? dimension - 1 - count : count;
+
+        for (int col = 0; col < 2; col++) {
+          if (![functionPattern getX:j - col y:i]) {
+            positions[positionsCount++] = (i << 16) | (j - col);
+          }
+        }
+      }
+
+      readingUp ^= YES;
+    }
+
+    DATA_MODULE_POSITIONS[index] = positions;
+    DATA_MODULE_COUNTS[index] = positionsCount;
+  });
+
+  *count = DATA_MODULE_COUNTS[index];
+  return DATA_MODULE_POSITIONS[index];
+}
+
 - (NSString *)description {
   return [[NSNumber numberWithInt:self.versionNumber] stringValue];
 }
@@ -32,6 +32,14 @@ extern int const FINDER_PATTERN_MAX_MODULES;
 @property (nonatomic, retain, readonly) ZXBitMatrix *image;
 @property (nonatomic, retain, readonly) NSMutableArray *possibleCenters;
 
+/**
+ * When YES (the default) rows are scanned a 32-bit word of the bit matrix at a time, skipping
+ * all-white and all-black words in bulk, and cross-checks walk cached runs of each row and column
+ * instead of reading pixels one by one. Setting it to NO falls back to per-pixel reads; both
+ * modes find exactly the same patterns.
+ */
+@property (nonatomic, assign) BOOL packedScan;
+
 - (id)initWithImage:(ZXBitMatrix *)image;
 - (id)initWithImage:(ZXBitMatrix *)image resultPointCallback:(id <ZXResultPointCallback>)resultPointCallback;
 - (ZXFinderPatternInfo *)find:(ZXDecodeHints *)hints error:(NSError **)error;
@@ -28,17 +28,159 @@ int const CENTER_QUORUM = 2;
 int const FINDER_PATTERN_MIN_SKIP = 3;
 int const FINDER_PATTERN_MAX_MODULES = 57;
 
-@interface ZXFinderPatternFinder ()
+// Side in pixels of the grid cells candidate centers are bucketed into
+static int const FINDER_PATTERN_CELL_SIZE = 16;
 
-NSInteger centerCompare(id center1, id center2, void *context);
-NSInteger furthestFromAverageCompare(id center1, id center2, void *context);
+/**
+ * The position, size and count of a candidate center, mirroring the ZXQRCodeFinderPattern at the
+ * same index of possibleCenters. next links candidates that share a grid cell.
+ */
+typedef struct {
+  float x;
+  float y;
+  float estimatedModuleSize;
+  int count;
+  int next;
+} ZXFinderPatternCandidate;
+
+/**
+ * Returns the first position at or after from, and before end, whose bit differs from black,
+ * or end if there is none. Whole words of the wanted color are skipped without looking at
+ * individual bits.
+ */
+static int ZXFinderPatternNextTransition(const int *row, int from, int end, BOOL black) {
+  int offset = from >> 5;
+  int words = (end + 31) >> 5;
+  unsigned int flip = black ? 0xFFFFFFFFu : 0;
+  unsigned int currentBits = ((unsigned int)row[offset] ^ flip) & ~((1u << (from & 0x1F)) - 1);
+  while (currentBits == 0) {
+    if (++offset == words) {
+      return end;
+    }
+    currentBits = (unsigned int)row[offset] ^ flip;
+  }
+  int result = (offset << 5) + __builtin_ctz(currentBits);
+  return result > end ? end : result;
+}
+
+/**
+ * Run starts of one row or column of the image, laid out as {runCount, start0, ..., length}.
+ * The first run is always white, possibly empty, so that odd runs are the black ones.
+ */
+static int *ZXFinderPatternLineRuns(ZXBitMatrix *image, BOOL column, int index) {
+  int length = column ? image.height : image.width;
+  int *runs = (int *)malloc((length + 3) * sizeof(int));
+  int *runStarts = runs + 1;
+  int count = 0;
+  runStarts[count++] = 0;
+  BOOL black = NO;
+  if (column) {
+    const unsigned int *bits = (const unsigned int *)image.bits + (index >> 5);
+    int rowSize = image.rowSize;
+    int shift = index & 0x1F;
+    for (int y = 0; y < length; y++) {
+      BOOL bit = ((bits[y * rowSize] >> shift) & 1) != 0;
+      if (bit != black) {
+        runStarts[count++] = y;
+        black = bit;
+      }
+    }
+  } else {
+    const int *row = image.bits + index * image.rowSize;
+    int x = 0;
+    while ((x = ZXFinderPatternNextTransition(row, x, length, black)) < length) {
+      runStarts[count++] = x;
+      black = !black;
+    }
+  }
+  runStarts[count] = length;
+  runs[0] = count;
+  return runs;
+}
+
+/**
+ * Counts pixels of the given color from position going backwards (or forwards), stopping at
+ * limit; this is what one of the per-pixel cross-check loops would count.
+ */
+static int ZXFinderPatternCountRun(const int *runs, int position, BOOL black, BOOL forward, int limit) {
+  int runCount = runs[0];
+  const int *runStarts = runs + 1;
+  if (position < 0 || position >= runStarts[runCount]) {
+    return 0;
+  }
+  int run = ZXOneDRunIndex(runStarts, runCount, position);
+  if ((run & 1) != (black ? 1 : 0)) {
+    return 0;
+  }
+  int count = forward ? runStarts[run + 1] - position : position - runStarts[run] + 1;
+  return count < limit ? count : limit;
+}
+
+/**
+ * Whether candidate a should be picked before b: by module size closer to average or, when
+ * byCount is set, first by higher count and then on a tie by module size further from
+ * firstAverage, which is the order the candidates were left in after outliers were dropped.
+ */
+static BOOL ZXFinderPatternRanksBefore(const ZXFinderPatternCandidate *a, const ZXFinderPatternCandidate *b, float average, float firstAverage, BOOL byCount) {
+  if (byCount && a->count != b->count) {
+    return a->count > b->count;
+  }
+  float dA = fabsf(a->estimatedModuleSize - average);
+  float dB = fabsf(b->estimatedModuleSize - average);
+  if (byCount && dA == dB) {
+    return fabsf(a->estimatedModuleSize - firstAverage) > fabsf(b->estimatedModuleSize - firstAverage);
+  }
+  return dA < dB;
+}
+
+/**
+ * Inserts index into best, the up to three best ranked candidates so far, if it belongs there.
+ * A candidate only displaces those it strictly ranks before.
+ */
+static void ZXFinderPatternKeepBest(int *best, int *bestCount, int index, const ZXFinderPatternCandidate *candidates, float average, float firstAverage, BOOL byCount) {
+  int position = *bestCount;
+  while (position > 0 && ZXFinderPatternRanksBefore(&candidates[index], &candidates[best[position - 1]], average, firstAverage, byCount)) {
+    position--;
+  }
+  if (position == 3) {
+    return;
+  }
+  for (int k = MIN(*bestCount, 2); k > position; k--) {
+    best[k] = best[k - 1];
+  }
+  best[position] = index;
+  if (*bestCount < 3) {
+    (*bestCount)++;
+  }
+}
+
+@interface ZXFinderPatternFinder () {
+  ZXFinderPatternCandidate *candidates;
+  int candidatesCount;
+  int candidatesCapacity;
+  int *cells;
+  int cellsWide;
+  int cellsHigh;
+  int confirmedCount;
+  int firstConfirmed;
+  int secondConfirmed;
+}
 
 @property (nonatomic, retain) ZXBitMatrix *image;
 @property (nonatomic, retain) NSMutableArray *possibleCenters;
 @property (nonatomic, assign) BOOL hasSkipped;
 @property (nonatomic, assign) id <ZXResultPointCallback> resultPointCallback;
+@property (nonatomic, assign) int **lineRuns;
 
 - (float)centerFromEnd:(int *)stateCount end:(int)end;
+- (float)crossCheckRuns:(const int *)runs start:(int)start maxCount:(int)maxCount
+originalStateCountTotal:(int)originalStateCountTotal tolerance:(int)tolerance;
+- (const int *)runsForColumn:(BOOL)column index:(int)index;
+- (int)nextTransitionInRow:(int)y from:(int)x black:(BOOL)black;
+- (void)resetCandidates;
+- (int)candidateNearI:(float)i j:(float)j moduleSize:(float)moduleSize;
+- (int)cellOfX:(float)x y:(float)y;
+- (void)storeCandidate:(int)index pattern:(ZXQRCodeFinderPattern *)pattern;
 - (int)findRowSkip;
 - (BOOL)haveMultiplyConfirmedCenters;
 - (NSMutableArray *)selectBestPatterns;
@@ -51,6 +193,8 @@ NSInteger furthestFromAverageCompare(id center1, id center2, void *context);
 @synthesize possibleCenters;
 @synthesize hasSkipped;
 @synthesize resultPointCallback;
+@synthesize packedScan;
+@synthesize lineRuns;
 
 /**
  * Creates a finder that will search the image for three finder patterns.
@@ -64,14 +208,34 @@ NSInteger furthestFromAverageCompare(id center1, id center2, void *context);
     self.image = anImage;
     self.possibleCenters = [NSMutableArray array];
     self.resultPointCallback = aResultPointCallback;
+    self.packedScan = YES;
+    cellsWide = (anImage.width + FINDER_PATTERN_CELL_SIZE - 1) / FINDER_PATTERN_CELL_SIZE;
+    cellsHigh = (anImage.height + FINDER_PATTERN_CELL_SIZE - 1) / FINDER_PATTERN_CELL_SIZE;
+    cells = (int *)malloc(cellsWide * cellsHigh * sizeof(int));
+    [self resetCandidates];
   }
 
   return self;
 }
 
 - (void)dealloc {
+  if (lineRuns != NULL) {
+    for (int i = 0; i < image.width + image.height; i++) {
+      free(lineRuns[i]);
+    }
+    free(lineRuns);
+    lineRuns = NULL;
+  }
   [image release];
   [possibleCenters release];
+  if (candidates != NULL) {
+    free(candidates);
+    candidates = NULL;
+  }
+  if (cells != NULL) {
+    free(cells);
+    cells = NULL;
+  }
 
   [super dealloc];
 }
@@ -88,15 +252,38 @@ NSInteger furthestFromAverageCompare(id center1, id center2, void *context);
   BOOL done = NO;
   int stateCount[5];
   for (int i = iSkip - 1; i < maxI && !done; i += iSkip) {
+    if (hints.cancelled) {
+      if (error) *error = NotFoundErrorInstance();
+      return nil;
+    }
     stateCount[0] = 0;
     stateCount[1] = 0;
     stateCount[2] = 0;
     stateCount[3] = 0;
     stateCount[4] = 0;
     int currentState = 0;
+    // The run of one color that pixel j is in, when scanning packed words
+    int runEnd = 0;
+    BOOL runBlack = YES;
 
     for (int j = 0; j < maxJ; j++) {
-      if ([image getX:j y:i]) {
+      BOOL black;
+      if (self.packedScan) {
+        while (j >= runEnd) {
+          runBlack = !runBlack;
+          runEnd = [self nextTransitionInRow:i from:j black:runBlack];
+        }
+        black = runBlack;
+        // Pixels that only add to the current count are taken as a whole run
+        if (black == ((currentState & 1) == 0)) {
+          stateCount[currentState] += runEnd - j;
+          j = runEnd - 1;
+          continue;
+        }
+      } else {
+        black = [image getX:j y:i];
+      }
+      if (black) {
         if ((currentState & 1) == 1) {
           currentState++;
         }
@@ -206,6 +393,11 @@ NSInteger furthestFromAverageCompare(id center1, id center2, void *context);
  * finder pattern to see if the same proportion is detected.
  */
 - (float)crossCheckVertical:(int)startI centerJ:(int)centerJ maxCount:(int)maxCount originalStateCountTotal:(int)originalStateCountTotal {
+  if (self.packedScan) {
+    return [self crossCheckRuns:[self runsForColumn:YES index:centerJ] start:startI maxCount:maxCount
+        originalStateCountTotal:originalStateCountTotal tolerance:2];
+  }
+
   int maxI = self.image.height;
   int stateCount[5] = {0, 0, 0, 0, 0};
 
@@ -269,6 +461,11 @@ NSInteger furthestFromAverageCompare(id center1, id center2, void *context);
  * check a vertical cross check and locate the real center of the alignment pattern.
  */
 - (float)crossCheckHorizontal:(int)startJ centerI:(int)centerI maxCount:(int)maxCount originalStateCountTotal:(int)originalStateCountTotal {
+  if (self.packedScan) {
+    return [self crossCheckRuns:[self runsForColumn:NO index:centerI] start:startJ maxCount:maxCount
+        originalStateCountTotal:originalStateCountTotal tolerance:1];
+  }
+
   int maxJ = self.image.width;
   int stateCount[5] = {0, 0, 0, 0, 0};
 
@@ -327,6 +524,82 @@ NSInteger furthestFromAverageCompare(id center1, id center2, void *context);
 }
 
 
+/**
+ * Performs crossCheckVertical or crossCheckHorizontal on the cached runs of a column or row,
+ * counting each stretch of one color in a single step. tolerance is how many fifths of
+ * originalStateCountTotal the new total may differ by.
+ */
+- (float)crossCheckRuns:(const int *)runs start:(int)start maxCount:(int)maxCount
+originalStateCountTotal:(int)originalStateCountTotal tolerance:(int)tolerance {
+  int max = runs[runs[0] + 1];
+  int stateCount[5] = {0, 0, 0, 0, 0};
+
+  int i = start;
+  stateCount[2] = ZXFinderPatternCountRun(runs, i, YES, NO, INT_MAX);
+  i -= stateCount[2];
+  if (i < 0) {
+    return NAN;
+  }
+  stateCount[1] = ZXFinderPatternCountRun(runs, i, NO, NO, maxCount + 1);
+  i -= stateCount[1];
+  if (i < 0 || stateCount[1] > maxCount) {
+    return NAN;
+  }
+  stateCount[0] = ZXFinderPatternCountRun(runs, i, YES, NO, maxCount + 1);
+  if (stateCount[0] > maxCount) {
+    return NAN;
+  }
+
+  i = start + 1;
+  int count = ZXFinderPatternCountRun(runs, i, YES, YES, INT_MAX);
+  stateCount[2] += count;
+  i += count;
+  if (i == max) {
+    return NAN;
+  }
+  stateCount[3] = ZXFinderPatternCountRun(runs, i, NO, YES, maxCount);
+  i += stateCount[3];
+  if (i == max || stateCount[3] >= maxCount) {
+    return NAN;
+  }
+  stateCount[4] = ZXFinderPatternCountRun(runs, i, YES, YES, maxCount);
+  i += stateCount[4];
+  if (stateCount[4] >= maxCount) {
+    return NAN;
+  }
+
+  int stateCountTotal = stateCount[0] + stateCount[1] + stateCount[2] + stateCount[3] + stateCount[4];
+  if (5 * abs(stateCountTotal - originalStateCountTotal) >= tolerance * originalStateCountTotal) {
+    return NAN;
+  }
+  return [ZXFinderPatternFinder foundPatternCross:stateCount] ? [self centerFromEnd:stateCount end:i] : NAN;
+}
+
+/**
+ * Returns the first position at or after x in row y whose color differs from black, or the
+ * image width if the row ends first.
+ */
+- (int)nextTransitionInRow:(int)y from:(int)x black:(BOOL)black {
+  return ZXFinderPatternNextTransition(self.image.bits + y * self.image.rowSize, x, self.image.width, black);
+}
+
+/**
+ * Returns the runs of a column (or row) of the image, computing them the first time they are needed.
+ * Finder pattern candidates on successive sampled rows cross-check the same few columns.
+ */
+- (const int *)runsForColumn:(BOOL)column index:(int)index {
+  int width = self.image.width;
+  if (self.lineRuns == NULL) {
+    self.lineRuns = (int **)calloc(width + self.image.height, sizeof(int *));
+  }
+  int slot = column ? index : width + index;
+  if (self.lineRuns[slot] == NULL) {
+    self.lineRuns[slot] = ZXFinderPatternLineRuns(self.image, column, index);
+  }
+  return self.lineRuns[slot];
+}
+
+
 /**
  * This is called when a horizontal scan finds a possible alignment pattern. It will
  * cross check with a vertical scan, and if successful, will, ah, cross-cross-check
@@ -346,21 +619,15 @@ NSInteger furthestFromAverageCompare(id center1, id center2, void *context);
     centerJ = [self crossCheckHorizontal:(int)centerJ centerI:(int)centerI maxCount:stateCount[2] originalStateCountTotal:stateCountTotal];
     if (!isnan(centerJ)) {
       float estimatedModuleSize = (float)stateCountTotal / 7.0f;
-      BOOL found = NO;
-      int max = [self.possibleCenters count];
-      for (int index = 0; index < max; index++) {
-        ZXQRCodeFinderPattern *center = [self.possibleCenters objectAtIndex:index];
-        if ([center aboutEquals:estimatedModuleSize i:centerI j:centerJ]) {
-          [possibleCenters replaceObjectAtIndex:index
-                                     withObject:[center combineEstimateI:centerI j:centerJ newModuleSize:estimatedModuleSize]];
-          found = YES;
-          break;
-        }
-      }
-
-      if (!found) {
-        ZXResultPoint *point = [[[ZXQRCodeFinderPattern alloc] initWithPosX:centerJ posY:centerI estimatedModuleSize:estimatedModuleSize] autorelease];
+      int index = [self candidateNearI:centerI j:centerJ moduleSize:estimatedModuleSize];
+      if (index >= 0) {
+        ZXQRCodeFinderPattern *center = [[self.possibleCenters objectAtIndex:index] combineEstimateI:centerI j:centerJ newModuleSize:estimatedModuleSize];
+        [possibleCenters replaceObjectAtIndex:index withObject:center];
+        [self storeCandidate:index pattern:center];
+      } else {
+        ZXQRCodeFinderPattern *point = [[[ZXQRCodeFinderPattern alloc] initWithPosX:centerJ posY:centerI estimatedModuleSize:estimatedModuleSize] autorelease];
         [self.possibleCenters addObject:point];
+        [self storeCandidate:candidatesCount pattern:point];
         if (self.resultPointCallback != nil) {
           [self.resultPointCallback foundPossibleResultPoint:point];
         }
@@ -378,127 +645,183 @@ NSInteger furthestFromAverageCompare(id center1, id center2, void *context);
  * allow us to infer that the third pattern must lie below a certain point farther
  * down in the image.
  */
-- (int) findRowSkip {
-  int max = [self.possibleCenters count];
-  if (max <= 1) {
+- (int)findRowSkip {
+  if (secondConfirmed < 0) {
     return 0;
   }
-  ZXQRCodeFinderPattern *firstConfirmedCenter = nil;
-  for (int i = 0; i < max; i++) {
-    ZXQRCodeFinderPattern *center = [self.possibleCenters objectAtIndex:i];
-    if ([center count] >= CENTER_QUORUM) {
-      if (firstConfirmedCenter == nil) {
-        firstConfirmedCenter = center;
-      } else {
-        hasSkipped = YES;
-        return (int)(fabsf([firstConfirmedCenter x] - [center x]) - fabsf([firstConfirmedCenter y] - [center y])) / 2;
-      }
-    }
-  }
-  return 0;
+  ZXQRCodeFinderPattern *firstConfirmedCenter = [self.possibleCenters objectAtIndex:firstConfirmed];
+  ZXQRCodeFinderPattern *center = [self.possibleCenters objectAtIndex:secondConfirmed];
+  hasSkipped = YES;
+  return (int)(fabsf([firstConfirmedCenter x] - [center x]) - fabsf([firstConfirmedCenter y] - [center y])) / 2;
 }
 
-
 - (BOOL)haveMultiplyConfirmedCenters {
-  int confirmedCount = 0;
-  float totalModuleSize = 0.0f;
-  int max = [self.possibleCenters count];
-  for (int i = 0; i < max; i++) {
-    ZXQRCodeFinderPattern *pattern = [self.possibleCenters objectAtIndex:i];
-    if ([pattern count] >= CENTER_QUORUM) {
-      confirmedCount++;
-      totalModuleSize += [pattern estimatedModuleSize];
-    }
-  }
   if (confirmedCount < 3) {
     return NO;
   }
+  float totalModuleSize = 0.0f;
+  for (int i = 0; i < candidatesCount; i++) {
+    if (candidates[i].count >= CENTER_QUORUM) {
+      totalModuleSize += candidates[i].estimatedModuleSize;
+    }
+  }
 
-  float average = totalModuleSize / (float)max;
+  float average = totalModuleSize / (float)candidatesCount;
   float totalDeviation = 0.0f;
-  for (int i = 0; i < max; i++) {
-    ZXQRCodeFinderPattern *pattern = [self.possibleCenters objectAtIndex:i];
-    totalDeviation += fabsf([pattern estimatedModuleSize] - average);
+  for (int i = 0; i < candidatesCount; i++) {
+    totalDeviation += fabsf(candidates[i].estimatedModuleSize - average);
   }
   return totalDeviation <= 0.05f * totalModuleSize;
 }
-
-/**
- * Orders by ZXFinderPattern count, descending.
- */
-NSInteger centerCompare(id center1, id center2, void *context) {
-  float average = [(NSNumber *)context floatValue];
-
-  if ([((ZXQRCodeFinderPattern *)center2) count] == [((ZXQRCodeFinderPattern *)center1) count]) {
-    float dA = fabsf([((ZXQRCodeFinderPattern *)center2) estimatedModuleSize] - average);
-    float dB = fabsf([((ZXQRCodeFinderPattern *)center1) estimatedModuleSize] - average);
-    return dA < dB ? 1 : dA == dB ? 0 : -1;
-  } else {
-    return [((ZXQRCodeFinderPattern *)center2) count] - [((ZXQRCodeFinderPattern *)center1) count];
-  }
-}
-
-/**
- * Orders by furthest from average
- */
-NSInteger furthestFromAverageCompare(id center1, id center2, void *context) {
-  float average = [(NSNumber *)context floatValue];
-
-  float dA = fabsf([((ZXQRCodeFinderPattern *)center2) estimatedModuleSize] - average);
-  float dB = fabsf([((ZXQRCodeFinderPattern *)center1) estimatedModuleSize] - average);
-  return dA < dB ? -1 : dA == dB ? 0 : 1;
-}
-
-
 /**
  * Returns the 3 best ZXFinderPatterns from our list of candidates. The "best" are
  * those that have been detected at least CENTER_QUORUM times, and whose module
  * size differs from the average among those patterns the least
  */
 - (NSMutableArray *)selectBestPatterns {
-  int startSize = [self.possibleCenters count];
+  int startSize = candidatesCount;
   if (startSize < 3) {
     return nil;
   }
 
-  if (startSize > 3) {
+  int best[3];
+  int bestCount = 0;
+  if (startSize == 3) {
+    for (int i = 0; i < 3; i++) {
+      best[bestCount++] = i;
+    }
+  } else {
     float totalModuleSize = 0.0f;
     float square = 0.0f;
     for (int i = 0; i < startSize; i++) {
-      float size = [[self.possibleCenters objectAtIndex:i] estimatedModuleSize];
+      float size = candidates[i].estimatedModuleSize;
       totalModuleSize += size;
       square += size * size;
     }
     float average = totalModuleSize / (float)startSize;
     float stdDev = (float)sqrt(square / startSize - average * average);
-
-    [self.possibleCenters sortUsingFunction:furthestFromAverageCompare context:[NSNumber numberWithFloat:average]];
-
     float limit = MAX(0.2f * average, stdDev);
 
-    for (int i = 0; i < [self.possibleCenters count] && [self.possibleCenters count] > 3; i++) {
-      ZXQRCodeFinderPattern *pattern = [self.possibleCenters objectAtIndex:i];
-      if (fabsf([pattern estimatedModuleSize] - average) > limit) {
-        [self.possibleCenters removeObjectAtIndex:i];
-        i--;
+    // Those furthest from the average are dropped while they are beyond limit and more than three remain
+    int kept = 0;
+    float keptModuleSize = 0.0f;
+    for (int i = 0; i < startSize; i++) {
+      if (fabsf(candidates[i].estimatedModuleSize - average) <= limit) {
+        kept++;
+        keptModuleSize += candidates[i].estimatedModuleSize;
+      }
+    }
+
+    if (kept <= 3) {
+      // Ties go to the later candidate, the one a stable sort furthest first would keep
+      for (int i = startSize - 1; i >= 0; i--) {
+        ZXFinderPatternKeepBest(best, &bestCount, i, candidates, average, average, NO);
+      }
+    } else {
+      float keptAverage = keptModuleSize / (float)kept;
+      for (int i = 0; i < startSize; i++) {
+        if (fabsf(candidates[i].estimatedModuleSize - average) <= limit) {
+          ZXFinderPatternKeepBest(best, &bestCount, i, candidates, keptAverage, average, YES);
+        }
       }
     }
   }
 
-  if ([self.possibleCenters count] > 3) {
-    float totalModuleSize = 0.0f;
-    for (int i = 0; i < [self.possibleCenters count]; i++) {
-      totalModuleSize += [[self.possibleCenters objectAtIndex:i] estimatedModuleSize];
+  NSMutableArray *result = [NSMutableArray arrayWithObjects:[self.possibleCenters objectAtIndex:best[0]],
+                            [self.possibleCenters objectAtIndex:best[1]], [self.possibleCenters objectAtIndex:best[2]], nil];
+  if (startSize > 3) {
+    self.possibleCenters = [NSMutableArray arrayWithArray:result];
+    [self resetCandidates];
+    for (int i = 0; i < 3; i++) {
+      [self storeCandidate:i pattern:[self.possibleCenters objectAtIndex:i]];
     }
+  }
+  return result;
+}
 
-    float average = totalModuleSize / (float)[self.possibleCenters count];
+/**
+ * Empties the candidate store; possibleCenters must be emptied or refilled to match.
+ */
+- (void)resetCandidates {
+  candidatesCount = 0;
+  confirmedCount = 0;
+  firstConfirmed = -1;
+  secondConfirmed = -1;
+  for (int i = 0; i < cellsWide * cellsHigh; i++) {
+    cells[i] = -1;
+  }
+}
 
-    [self.possibleCenters sortUsingFunction:centerCompare context:[NSNumber numberWithFloat:average]];
+- (int)cellOfX:(float)x y:(float)y {
+  int cellX = MIN(MAX((int)floorf(x / FINDER_PATTERN_CELL_SIZE), 0), cellsWide - 1);
+  int cellY = MIN(MAX((int)floorf(y / FINDER_PATTERN_CELL_SIZE), 0), cellsHigh - 1);
+  return cellY * cellsWide + cellX;
+}
 
-    self.possibleCenters = [[[NSMutableArray alloc] initWithArray:[possibleCenters subarrayWithRange:NSMakeRange(0, 3)]] autorelease];
+/**
+ * Returns the index of the first candidate that "about equals" a center at the stated position
+ * and size, as ZXQRCodeFinderPattern's aboutEquals would decide, or -1. Only the grid cells
+ * within moduleSize of the position are looked at.
+ */
+- (int)candidateNearI:(float)i j:(float)j moduleSize:(float)moduleSize {
+  int first = [self cellOfX:j - moduleSize y:i - moduleSize];
+  int last = [self cellOfX:j + moduleSize y:i + moduleSize];
+  int found = -1;
+  for (int row = first / cellsWide; row <= last / cellsWide; row++) {
+    for (int column = first % cellsWide; column <= last % cellsWide; column++) {
+      for (int index = cells[row * cellsWide + column]; index >= 0; index = candidates[index].next) {
+        ZXFinderPatternCandidate *candidate = &candidates[index];
+        if ((found < 0 || index < found) &&
+            fabsf(i - candidate->y) <= moduleSize && fabsf(j - candidate->x) <= moduleSize) {
+          float moduleSizeDiff = fabsf(moduleSize - candidate->estimatedModuleSize);
+          if (moduleSizeDiff <= 1.0f || moduleSizeDiff <= candidate->estimatedModuleSize) {
+            found = index;
+          }
+        }
+      }
+    }
   }
-
-  return [NSMutableArray arrayWithObjects:[self.possibleCenters objectAtIndex:0], [self.possibleCenters objectAtIndex:1], [self.possibleCenters objectAtIndex:2], nil];
+  return found;
 }
 
+/**
+ * Records pattern as the candidate at index, either replacing it or, when index is
+ * candidatesCount, appending it, and moves it to the grid cell of its new position.
+ */
+- (void)storeCandidate:(int)index pattern:(ZXQRCodeFinderPattern *)pattern {
+  BOOL wasConfirmed = NO;
+  if (index == candidatesCount) {
+    if (candidatesCount == candidatesCapacity) {
+      candidatesCapacity = MAX(16, candidatesCapacity * 2);
+      candidates = (ZXFinderPatternCandidate *)realloc(candidates, candidatesCapacity * sizeof(ZXFinderPatternCandidate));
+    }
+    candidatesCount++;
+  } else {
+    wasConfirmed = candidates[index].count >= CENTER_QUORUM;
+    int *link = &cells[[self cellOfX:candidates[index].x y:candidates[index].y]];
+    while (*link != index) {
+      link = &candidates[*link].next;
+    }
+    *link = candidates[index].next;
+  }
+
+  ZXFinderPatternCandidate *candidate = &candidates[index];
+  candidate->x = pattern.x;
+  candidate->y = pattern.y;
+  candidate->estimatedModuleSize = pattern.estimatedModuleSize;
+  candidate->count = pattern.count;
+  int cell = [self cellOfX:candidate->x y:candidate->y];
+  candidate->next = cells[cell];
+  cells[cell] = index;
+
+  if (!wasConfirmed && candidate->count >= CENTER_QUORUM) {
+    confirmedCount++;
+    if (firstConfirmed < 0 || index < firstConfirmed) {
+      secondConfirmed = firstConfirmed;
+      firstConfirmed = index;
+    } else if (secondConfirmed < 0 || index < secondConfirmed) {
+      secondConfirmed = index;
+    }
+  }
+}
 @end
@@ -18,6 +18,7 @@
 #import "ZXAlignmentPatternFinder.h"
 #import "ZXBitMatrix.h"
 #import "ZXDecodeHints.h"
+#import "ZXDecodeTrace.h"
 #import "ZXDetectorResult.h"
 #import "ZXErrors.h"
 #import "ZXFinderPatternFinder.h"
@@ -173,7 +174,10 @@
 
 - (ZXBitMatrix *)sampleGrid:(ZXBitMatrix *)anImage transform:(ZXPerspectiveTransform *)transform dimension:(int)dimension error:(NSError **)error {
   ZXGridSampler *sampler = [ZXGridSampler instance];
-  return [sampler sampleGrid:anImage dimensionX:dimension dimensionY:dimension transform:transform error:error];
+  ZX_TRACE_BEGIN(traceStart);
+  ZXBitMatrix *bits = [sampler sampleGrid:anImage dimensionX:dimension dimensionY:dimension transform:transform error:error];
+  ZX_TRACE_END(traceStart, kZXDecodeStageSample);
+  return bits;
 }
 
 
@@ -43,10 +43,12 @@ const int ALPHANUMERIC_TABLE[96] = {
 
 const NSStringEncoding DEFAULT_BYTE_MODE_ENCODING = NSISOLatin1StringEncoding;
 
+// From version 10 up, scoring the mask patterns concurrently outweighs the dispatch overhead.
+static const int PARALLEL_MASK_DIMENSION = 57;
+
 @interface ZXEncoder ()
 
 + (void)appendECI:(ZXECI *)eci bits:(ZXBitArray *)bits;
-+ (int)chooseMaskPattern:(ZXBitArray *)bits ecLevel:(ZXErrorCorrectionLevel *)ecLevel version:(ZXQRCodeVersion *)version matrix:(ZXByteMatrix *)matrix error:(NSError **)error;
 + (ZXMode *)chooseMode:(NSString *)content encoding:(NSStringEncoding)encoding;
 + (ZXQRCodeVersion *)chooseVersion:(int)numInputBits ecLevel:(ZXErrorCorrectionLevel *)ecLevel error:(NSError **)error;
 + (BOOL)isOnlyDoubleByteKanji:(NSString *)content;
@@ -56,14 +58,6 @@ const NSStringEncoding DEFAULT_BYTE_MODE_ENCODING = NSISOLatin1StringEncoding;
 
 @implementation ZXEncoder
 
-+ (int)calculateMaskPenalty:(ZXByteMatrix *)matrix {
-  return [ZXMaskUtil applyMaskPenaltyRule1:matrix]
-    + [ZXMaskUtil applyMaskPenaltyRule2:matrix]
-    + [ZXMaskUtil applyMaskPenaltyRule3:matrix]
-    + [ZXMaskUtil applyMaskPenaltyRule4:matrix];
-}
-
-
 /**
  * Encode "bytes" with the error correction level "ecLevel". The encoding mode will be chosen
  * internally by chooseMode(). On success, store the result in "qrCode".
@@ -245,20 +239,111 @@ const NSStringEncoding DEFAULT_BYTE_MODE_ENCODING = NSISOLatin1StringEncoding;
   return YES;
 }
 
+/**
+ * Lays the symbol out once without a mask, then scores each mask pattern by flipping the data
+ * cells and rewriting the type information on packed rows and columns. Symbols of at least
+ * PARALLEL_MASK_DIMENSION modules score their masks concurrently. Ties go to the lowest mask,
+ * as when each pattern was built and scored in turn.
+ */
 + (int)chooseMaskPattern:(ZXBitArray *)bits ecLevel:(ZXErrorCorrectionLevel *)ecLevel version:(ZXQRCodeVersion *)version matrix:(ZXByteMatrix *)matrix error:(NSError **)error {
-  int minPenalty = NSIntegerMax;
-  int bestMaskPattern = -1;
+  // Type information for mask 0 reserves its cells; whatever is still empty takes data.
+  [ZXMatrixUtil clearMatrix:matrix];
+  if (![ZXMatrixUtil embedBasicPatterns:version matrix:matrix error:error] ||
+      ![ZXMatrixUtil embedTypeInfo:ecLevel maskPattern:0 matrix:matrix error:error] ||
+      ![ZXMatrixUtil maybeEmbedVersionInfo:version matrix:matrix error:error]) {
+    return -1;
+  }
+
+  int dimension = matrix.width;
+  int words = (dimension + 63) >> 6;
+  int size = dimension * words;
+  uint64_t *packed = (uint64_t *)calloc((4 + 2 * NUM_MASK_PATTERNS) * size, sizeof(uint64_t));
+  uint64_t *dataRows = packed;
+  uint64_t *dataColumns = packed + size;
+  uint64_t *baseRows = packed + 2 * size;
+  uint64_t *baseColumns = packed + 3 * size;
+  uint64_t *maskedMatrices = packed + 4 * size;
+
+  unsigned char **array = matrix.array;
+  for (int y = 0; y < dimension; y++) {
+    for (int x = 0; x < dimension; x++) {
+      if (array[y][x] == (unsigned char)-1) {
+        dataRows[y * words + (x >> 6)] |= 1ULL << (x & 63);
+        dataColumns[x * words + (y >> 6)] |= 1ULL << (y & 63);
+      }
+    }
+  }
+  if (![ZXMatrixUtil embedDataBits:bits maskPattern:-1 matrix:matrix error:error]) {
+    free(packed);
+    return -1;
+  }
+  for (int y = 0; y < dimension; y++) {
+    for (int x = 0; x < dimension; x++) {
+      if (array[y][x] == 1) {
+        baseRows[y * words + (x >> 6)] |= 1ULL << (x & 63);
+        baseColumns[x * words + (y >> 6)] |= 1ULL << (y & 63);
+      }
+    }
+  }
 
+  // Type information only occupies row 8 and column 8; note the cells where each mask's differs.
+  int maxFlips = 2 * dimension;
+  int *flips = (int *)malloc(NUM_MASK_PATTERNS * (maxFlips + 2) * sizeof(int));
+  int *flipCounts = flips + NUM_MASK_PATTERNS * maxFlips;
+  int *penalties = flipCounts + NUM_MASK_PATTERNS;
   for (int maskPattern = 0; maskPattern < NUM_MASK_PATTERNS; maskPattern++) {
-    if (![ZXMatrixUtil buildMatrix:bits ecLevel:ecLevel version:version maskPattern:maskPattern matrix:matrix error:error]) {
+    if (![ZXMatrixUtil embedTypeInfo:ecLevel maskPattern:maskPattern matrix:matrix error:error]) {
+      free(flips);
+      free(packed);
       return -1;
     }
-    int penalty = [self calculateMaskPenalty:matrix];
-    if (penalty < minPenalty) {
-      minPenalty = penalty;
+    int count = 0;
+    for (int i = 0; i < dimension; i++) {
+      if (array[8][i] != ((baseRows[8 * words + (i >> 6)] >> (i & 63)) & 1)) {
+        flips[maskPattern * maxFlips + count++] = 8 * dimension + i;
+      }
+      if (i != 8 && array[i][8] != ((baseRows[i * words] >> 8) & 1)) {
+        flips[maskPattern * maxFlips + count++] = i * dimension + 8;
+      }
+    }
+    flipCounts[maskPattern] = count;
+  }
+
+  void (^scoreMask)(size_t) = ^(size_t maskPattern) {
+    uint64_t *rows = maskedMatrices + 2 * size * maskPattern;
+    uint64_t *columns = rows + size;
+    [ZXMaskUtil packDataMask:(int)maskPattern dimension:dimension rows:rows columns:columns];
+    for (int i = 0; i < size; i++) {
+      rows[i] = baseRows[i] ^ (rows[i] & dataRows[i]);
+      columns[i] = baseColumns[i] ^ (columns[i] & dataColumns[i]);
+    }
+    for (int i = 0; i < flipCounts[maskPattern]; i++) {
+      int cell = flips[maskPattern * maxFlips + i];
+      int x = cell % dimension;
+      int y = cell / dimension;
+      rows[y * words + (x >> 6)] ^= 1ULL << (x & 63);
+      columns[x * words + (y >> 6)] ^= 1ULL << (y & 63);
+    }
+    penalties[maskPattern] = [ZXMaskUtil packedMaskPenalty:rows columns:columns dimension:dimension];
+  };
+  if (dimension >= PARALLEL_MASK_DIMENSION) {
+    dispatch_apply(NUM_MASK_PATTERNS, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), scoreMask);
+  } else {
+    for (int maskPattern = 0; maskPattern < NUM_MASK_PATTERNS; maskPattern++) {
+      scoreMask(maskPattern);
+    }
+  }
+
+  int minPenalty = NSIntegerMax;
+  int bestMaskPattern = -1;
+  for (int maskPattern = 0; maskPattern < NUM_MASK_PATTERNS; maskPattern++) {
+    if (penalties[maskPattern] < minPenalty) {
+      minPenalty = penalties[maskPattern];
       bestMaskPattern = maskPattern;
     }
   }
+  free(flips);
+  free(packed);
   return bestMaskPattern;
 }
 
@@ -469,20 +554,16 @@ const NSStringEncoding DEFAULT_BYTE_MODE_ENCODING = NSISOLatin1StringEncoding;
 }
 
 + (unsigned char *)generateECBytes:(unsigned char[])dataBytes numDataBytes:(int)numDataBytes numEcBytesInBlock:(int)numEcBytesInBlock {
-  int toEncodeLen = numDataBytes + numEcBytesInBlock;
-  int toEncode[toEncodeLen];
+  int data[numDataBytes];
   for (int i = 0; i < numDataBytes; i++) {
-    toEncode[i] = dataBytes[i] & 0xFF;
-  }
-  for (int i = numDataBytes; i < toEncodeLen; i++) {
-    toEncode[i] = 0;
+    data[i] = dataBytes[i] & 0xFF;
   }
-
-  [[[[ZXReedSolomonEncoder alloc] initWithField:[ZXGenericGF QrCodeField256]] autorelease] encode:toEncode toEncodeLen:toEncodeLen ecBytes:numEcBytesInBlock];
+  int ecWords[numEcBytesInBlock];
+  [[ZXReedSolomonEncoder encoderForField:[ZXGenericGF QrCodeField256]] encodeData:data dataLen:numDataBytes ecWords:ecWords ecLen:numEcBytesInBlock];
 
   unsigned char *ecBytes = (unsigned char *)malloc(numEcBytesInBlock * sizeof(unsigned char));
   for (int i = 0; i < numEcBytesInBlock; i++) {
-    ecBytes[i] = (unsigned char)toEncode[numDataBytes + i];
+    ecBytes[i] = (unsigned char)ecWords[i];
   }
 
   return ecBytes;
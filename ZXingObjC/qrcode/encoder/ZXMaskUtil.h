@@ -23,5 +23,7 @@
 + (int)applyMaskPenaltyRule3:(ZXByteMatrix *)matrix;
 + (int)applyMaskPenaltyRule4:(ZXByteMatrix *)matrix;
 + (BOOL)dataMaskBit:(int)maskPattern x:(int)x y:(int)y;
++ (void)packDataMask:(int)maskPattern dimension:(int)dimension rows:(uint64_t *)rows columns:(uint64_t *)columns;
++ (int)packedMaskPenalty:(const uint64_t *)rows columns:(const uint64_t *)columns dimension:(int)dimension;
 
 @end
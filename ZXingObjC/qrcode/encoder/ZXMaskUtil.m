@@ -24,6 +24,147 @@ const int N2 = 3;
 const int N3 = 40;
 const int N4 = 10;
 
+// Mask pattern conditions from 8.8 of JISX0510:2004; "maskPattern" must be in [0, 7].
+static BOOL ZXMaskUtilMaskBit(int maskPattern, int x, int y) {
+  int intermediate;
+  int temp;
+  switch (maskPattern) {
+  case 0:
+    intermediate = (y + x) & 0x1;
+    break;
+  case 1:
+    intermediate = y & 0x1;
+    break;
+  case 2:
+    intermediate = x % 3;
+    break;
+  case 3:
+    intermediate = (y + x) % 3;
+    break;
+  case 4:
+    intermediate = ((int)((unsigned int)y >> 1) + (x / 3)) & 0x1;
+    break;
+  case 5:
+    temp = y * x;
+    intermediate = (temp & 0x1) + (temp % 3);
+    break;
+  case 6:
+    temp = y * x;
+    intermediate = ((temp & 0x1) + (temp % 3)) & 0x1;
+    break;
+  default:
+    temp = y * x;
+    intermediate = ((temp % 3) + ((y + x) & 0x1)) & 0x1;
+    break;
+  }
+  return intermediate == 0;
+}
+
+static inline BOOL ZXMaskUtilGetBit(const uint64_t *line, int i) {
+  return (line[i >> 6] >> (i & 63)) & 1;
+}
+
+// Bits of word i of a packed line shifted toward lower indices, so bit x holds line bit x + k.
+static inline uint64_t ZXMaskUtilShiftDown(const uint64_t *line, int words, int i, int k) {
+  uint64_t word = line[i] >> k;
+  if (i + 1 < words) {
+    word |= line[i + 1] << (64 - k);
+  }
+  return word;
+}
+
+// Bits of word i of a packed line shifted toward higher indices, so bit x holds line bit x - k.
+static inline uint64_t ZXMaskUtilShiftUp(const uint64_t *line, int i, int k) {
+  uint64_t word = line[i] << k;
+  if (i > 0) {
+    word |= line[i - 1] >> (64 - k);
+  }
+  return word;
+}
+
+// The bits of word i that stand for indices below limit.
+static inline uint64_t ZXMaskUtilBitsBelow(int i, int limit) {
+  int n = limit - (i << 6);
+  return n <= 0 ? 0 : n >= 64 ? ~0ULL : (1ULL << n) - 1;
+}
+
+/**
+ * Rules 1 and 3 along one packed line. A run of length L >= 5 costs N1 + L - 5; it holds
+ * L - 4 windows of five equal cells, so the cost is the window count plus N1 - 1 per run.
+ */
+static int ZXMaskUtilLinePenalty(const uint64_t *line, int words, int dimension) {
+  uint64_t same[words];
+  uint64_t windows[words];
+  for (int i = 0; i < words; i++) {
+    same[i] = ~(line[i] ^ ZXMaskUtilShiftDown(line, words, i, 1)) & ZXMaskUtilBitsBelow(i, dimension - 1);
+  }
+  int penalty = 0;
+  for (int i = 0; i < words; i++) {
+    windows[i] = same[i] & ZXMaskUtilShiftDown(same, words, i, 1) & ZXMaskUtilShiftDown(same, words, i, 2) &
+      ZXMaskUtilShiftDown(same, words, i, 3);
+  }
+  for (int i = 0; i < words; i++) {
+    uint64_t runStarts = windows[i] & ~ZXMaskUtilShiftUp(windows, i, 1);
+    penalty += __builtin_popcountll(windows[i]) + (N1 - 1) * __builtin_popcountll(runStarts);
+  }
+  // A run of exactly five that ends the line has never been counted; keep it that way.
+  int last = dimension - 5;
+  if (last >= 0 && ZXMaskUtilGetBit(windows, last) && (last == 0 || !ZXMaskUtilGetBit(windows, last - 1))) {
+    penalty -= N1;
+  }
+
+  // 1011101 preceded or followed by four light cells.
+  for (int i = 0; i < words; i++) {
+    uint64_t finder = line[i] & ~ZXMaskUtilShiftDown(line, words, i, 1) & ZXMaskUtilShiftDown(line, words, i, 2) &
+      ZXMaskUtilShiftDown(line, words, i, 3) & ZXMaskUtilShiftDown(line, words, i, 4) &
+      ~ZXMaskUtilShiftDown(line, words, i, 5) & ZXMaskUtilShiftDown(line, words, i, 6);
+    if (finder == 0) {
+      continue;
+    }
+    uint64_t lightAfter = ~(ZXMaskUtilShiftDown(line, words, i, 7) | ZXMaskUtilShiftDown(line, words, i, 8) |
+                            ZXMaskUtilShiftDown(line, words, i, 9) | ZXMaskUtilShiftDown(line, words, i, 10)) &
+      ZXMaskUtilBitsBelow(i, dimension - 10);
+    uint64_t lightBefore = ~(ZXMaskUtilShiftUp(line, i, 1) | ZXMaskUtilShiftUp(line, i, 2) |
+                             ZXMaskUtilShiftUp(line, i, 3) | ZXMaskUtilShiftUp(line, i, 4)) &
+      ~ZXMaskUtilBitsBelow(i, 4);
+    penalty += N3 * __builtin_popcountll(finder & (lightAfter | lightBefore));
+  }
+  return penalty;
+}
+
+/**
+ * All four rules over a packed matrix and its transpose; matches the sum of the
+ * applyMaskPenaltyRule methods on the same cells.
+ */
+static int ZXMaskUtilPackedPenalty(const uint64_t *rows, const uint64_t *columns, int dimension) {
+  int words = (dimension + 63) >> 6;
+  int penalty = 0;
+  int numDarkCells = 0;
+  int blocks = 0;
+  for (int y = 0; y < dimension; y++) {
+    const uint64_t *row = rows + y * words;
+    penalty += ZXMaskUtilLinePenalty(row, words, dimension);
+    penalty += ZXMaskUtilLinePenalty(columns + y * words, words, dimension);
+    for (int i = 0; i < words; i++) {
+      numDarkCells += __builtin_popcountll(row[i]);
+    }
+    if (y + 1 < dimension) {
+      const uint64_t *next = row + words;
+      for (int i = 0; i < words; i++) {
+        uint64_t same = ~(row[i] ^ ZXMaskUtilShiftDown(row, words, i, 1)) & ~(next[i] ^ ZXMaskUtilShiftDown(next, words, i, 1)) &
+          ~(row[i] ^ next[i]) & ZXMaskUtilBitsBelow(i, dimension - 1);
+        blocks += __builtin_popcountll(same);
+      }
+    }
+  }
+  penalty += N2 * blocks;
+
+  int numTotalCells = dimension * dimension;
+  double darkRatio = (double) numDarkCells / numTotalCells;
+  int fivePercentVariances = abs((int)(darkRatio * 100 - 50)) / 5; // * 100.0 / 5.0
+  return penalty + fivePercentVariances * N4;
+}
+
 @interface ZXMaskUtil ()
 
 + (int)applyMaskPenaltyRule1Internal:(ZXByteMatrix *)matrix isHorizontal:(BOOL)isHorizontal;
@@ -149,41 +290,41 @@ const int N4 = 10;
  * pattern conditions.
  */
 + (BOOL)dataMaskBit:(int)maskPattern x:(int)x y:(int)y {
-  int intermediate;
-  int temp;
-  switch (maskPattern) {
-  case 0:
-    intermediate = (y + x) & 0x1;
-    break;
-  case 1:
-    intermediate = y & 0x1;
-    break;
-  case 2:
-    intermediate = x % 3;
-    break;
-  case 3:
-    intermediate = (y + x) % 3;
-    break;
-  case 4:
-    intermediate = ((int)((unsigned int)y >> 1) + (x / 3)) & 0x1;
-    break;
-  case 5:
-    temp = y * x;
-    intermediate = (temp & 0x1) + (temp % 3);
-    break;
-  case 6:
-    temp = y * x;
-    intermediate = ((temp & 0x1) + (temp % 3)) & 0x1;
-    break;
-  case 7:
-    temp = y * x;
-    intermediate = ((temp % 3) + ((y + x) & 0x1)) & 0x1;
-    break;
-  default:
-      [NSException raise:NSInvalidArgumentException 
-                  format:@"Invalid mask pattern: %d", maskPattern];
+  if (maskPattern < 0 || maskPattern > 7) {
+    [NSException raise:NSInvalidArgumentException
+                format:@"Invalid mask pattern: %d", maskPattern];
   }
-  return intermediate == 0;
+  return ZXMaskUtilMaskBit(maskPattern, x, y);
+}
+
+/**
+ * Fill rows, and columns with its transpose, with the cells "maskPattern" flips, packed
+ * 64 to a word with (dimension + 63) / 64 words per line.
+ */
++ (void)packDataMask:(int)maskPattern dimension:(int)dimension rows:(uint64_t *)rows columns:(uint64_t *)columns {
+  if (maskPattern < 0 || maskPattern > 7) {
+    [NSException raise:NSInvalidArgumentException
+                format:@"Invalid mask pattern: %d", maskPattern];
+  }
+  int words = (dimension + 63) >> 6;
+  memset(rows, 0, dimension * words * sizeof(uint64_t));
+  memset(columns, 0, dimension * words * sizeof(uint64_t));
+  for (int y = 0; y < dimension; y++) {
+    for (int x = 0; x < dimension; x++) {
+      if (ZXMaskUtilMaskBit(maskPattern, x, y)) {
+        rows[y * words + (x >> 6)] |= 1ULL << (x & 63);
+        columns[x * words + (y >> 6)] |= 1ULL << (y & 63);
+      }
+    }
+  }
+}
+
+/**
+ * The total of all four penalty rules for a matrix packed as by packDataMask:, computed a
+ * word at a time. "columns" must hold the transpose of "rows".
+ */
++ (int)packedMaskPenalty:(const uint64_t *)rows columns:(const uint64_t *)columns dimension:(int)dimension {
+  return ZXMaskUtilPackedPenalty(rows, columns, dimension);
 }
 
 /**
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2012 ZXing authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import <malloc/malloc.h>
+#import "ZXAztecCode.h"
+#import "ZXAztecDecoder.h"
+#import "ZXAztecDecoderTestCase.h"
+#import "ZXAztecDetectorResult.h"
+#import "ZXAztecEncoder.h"
+#import "ZXDecoderResult.h"
+
+@interface ZXAztecDecoderTestCase ()
+
+- (NSString *)largeText;
+
+@end
+
+@implementation ZXAztecDecoderTestCase
+
+- (void)testDecodeFullRangeSymbol {
+  NSString *text = [self largeText];
+  NSData *bytes = [text dataUsingEncoding:NSISOLatin1StringEncoding];
+  ZXAztecCode *aztec = [ZXAztecEncoder encode:(unsigned char *)[bytes bytes] len:[bytes length] minECCPercent:25];
+  STAssertFalse(aztec.compact, @"Expected a full symbol");
+  STAssertTrue(aztec.layers > 22, @"Expected 12-bit codewords, got %d layers", aztec.layers);
+
+  ZXAztecDetectorResult *r = [[[ZXAztecDetectorResult alloc] initWithBits:aztec.matrix points:[NSArray array] compact:aztec.compact nbDatablocks:aztec.codeWords nbLayers:aztec.layers] autorelease];
+  ZXDecoderResult *res = [[[[ZXAztecDecoder alloc] init] autorelease] decode:r error:nil];
+  STAssertEqualObjects(res.text, text, @"Data did not match");
+}
+
+- (void)testDecodeAllocationCount {
+  NSString *text = [self largeText];
+  NSData *bytes = [text dataUsingEncoding:NSISOLatin1StringEncoding];
+  ZXAztecCode *aztec = [ZXAztecEncoder encode:(unsigned char *)[bytes bytes] len:[bytes length] minECCPercent:25];
+  ZXAztecDetectorResult *r = [[[ZXAztecDetectorResult alloc] initWithBits:aztec.matrix points:[NSArray array] compact:aztec.compact nbDatablocks:aztec.codeWords nbLayers:aztec.layers] autorelease];
+  ZXAztecDecoder *decoder = [[[ZXAztecDecoder alloc] init] autorelease];
+
+  // Blocks still in use before the pool drains include everything autoreleased by the decode, so
+  // this bounds the whole decode independently of how many bits the symbol holds.
+  NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+  malloc_statistics_t before;
+  malloc_zone_statistics(NULL, &before);
+  ZXDecoderResult *res = [decoder decode:r error:nil];
+  malloc_statistics_t after;
+  malloc_zone_statistics(NULL, &after);
+  STAssertEqualObjects(res.text, text, @"Data did not match");
+  [pool drain];
+
+  // Boxing every raw and corrected bit and making a string per decoded character, the old decoder
+  // allocated at least one block per character of the text; now the count doesn't grow with it.
+  int allocations = (int)after.blocks_in_use - (int)before.blocks_in_use;
+  int oldAllocations = (int)[text length];
+  STAssertTrue(allocations < 64, @"Expected fewer than 64 allocations, got %d", allocations);
+  STAssertTrue(allocations * 16 < oldAllocations, @"Expected far fewer allocations than the %d characters decoded, got %d",
+               oldAllocations, allocations);
+}
+
+- (NSString *)largeText {
+  NSMutableString *text = [NSMutableString string];
+  for (int i = 0; i < 26; i++) {
+    [text appendFormat:@"%d. Lorem ipsum dolor sit amet, consectetur adipiscing elit. Größe & Co. ", i];
+  }
+  return text;
+}
+
+@end
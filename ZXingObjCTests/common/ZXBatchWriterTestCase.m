@@ -0,0 +1,141 @@
+/*
+ * Copyright 2012 ZXing authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import "ZXBatchWriter.h"
+#import "ZXBatchWriterTestCase.h"
+#import "ZXBitMatrix.h"
+#import "ZXCode128Writer.h"
+#import "ZXEncodeHints.h"
+#import "ZXErrorCorrectionLevel.h"
+#import "ZXQRCodeWriter.h"
+
+@interface ZXBatchWriterTestCase ()
+
+- (NSArray *)payloads:(int)count;
+- (void)assertRaster:(const unsigned char *)raster batchWriter:(ZXBatchWriter *)batchWriter
+           equalsMatrix:(ZXBitMatrix *)matrix contents:(NSString *)contents;
+- (BOOL)rasterIsWhite:(const unsigned char *)raster batchWriter:(ZXBatchWriter *)batchWriter;
+
+@end
+
+@implementation ZXBatchWriterTestCase
+
+- (NSArray *)payloads:(int)count {
+  NSMutableArray *payloads = [NSMutableArray arrayWithCapacity:count];
+  for (int i = 0; i < count; i++) {
+    [payloads addObject:[NSString stringWithFormat:@"SERIAL-%08d-%@", i * 7919, i % 3 ? @"LOT" : @"http://example.com/item"]];
+  }
+  return payloads;
+}
+
+- (void)assertRaster:(const unsigned char *)raster batchWriter:(ZXBatchWriter *)batchWriter
+           equalsMatrix:(ZXBitMatrix *)matrix contents:(NSString *)contents {
+  STAssertEquals(matrix.width, batchWriter.width, @"Expected the writer to keep the requested width");
+  STAssertEquals(matrix.height, batchWriter.height, @"Expected the writer to keep the requested height");
+  for (int y = 0; y < matrix.height; y++) {
+    for (int x = 0; x < matrix.width; x++) {
+      BOOL black = (raster[y * batchWriter.bytesPerRow + (x >> 3)] & (0x80 >> (x & 7))) != 0;
+      if (black != [matrix getX:x y:y]) {
+        STFail(@"Raster for %@ differs from the writer at (%d,%d)", contents, x, y);
+        return;
+      }
+    }
+  }
+}
+
+- (BOOL)rasterIsWhite:(const unsigned char *)raster batchWriter:(ZXBatchWriter *)batchWriter {
+  for (size_t i = 0; i < batchWriter.bytesPerRaster; i++) {
+    if (raster[i] != 0) {
+      return NO;
+    }
+  }
+  return YES;
+}
+
+- (void)testQRCodeMatchesWriter {
+  ZXEncodeHints *hints = [ZXEncodeHints hints];
+  hints.errorCorrectionLevel = [ZXErrorCorrectionLevel errorCorrectionLevelM];
+  hints.margin = [NSNumber numberWithInt:2];
+  // An odd width exercises padding that does not start on a byte boundary.
+  ZXBatchWriter *batchWriter = [[[ZXBatchWriter alloc] initWithFormat:kBarcodeFormatQRCode width:203 height:190 hints:hints] autorelease];
+  STAssertEquals(batchWriter.bytesPerRow, 26, @"Expected rows rounded up to whole bytes");
+
+  NSArray *contents = [self payloads:24];
+  NSIndexSet *failedIndexes = nil;
+  NSData *rasters = [batchWriter encodeContents:contents failedIndexes:&failedIndexes];
+  STAssertEquals(failedIndexes.count, (NSUInteger)0, @"Expected every payload to encode");
+  STAssertEquals(rasters.length, contents.count * batchWriter.bytesPerRaster, @"Expected one raster per payload");
+
+  ZXQRCodeWriter *writer = [[[ZXQRCodeWriter alloc] init] autorelease];
+  for (int i = 0; i < contents.count; i++) {
+    ZXBitMatrix *matrix = [writer encode:[contents objectAtIndex:i] format:kBarcodeFormatQRCode width:203 height:190 hints:hints error:nil];
+    [self assertRaster:(const unsigned char *)rasters.bytes + i * batchWriter.bytesPerRaster batchWriter:batchWriter
+          equalsMatrix:matrix contents:[contents objectAtIndex:i]];
+  }
+}
+
+- (void)testCode128MatchesWriter {
+  ZXBatchWriter *batchWriter = [[[ZXBatchWriter alloc] initWithFormat:kBarcodeFormatCode128 width:300 height:20 hints:nil] autorelease];
+  NSArray *contents = [self payloads:10];
+  NSIndexSet *failedIndexes = nil;
+  NSData *rasters = [batchWriter encodeContents:contents failedIndexes:&failedIndexes];
+  STAssertEquals(failedIndexes.count, (NSUInteger)0, @"Expected every payload to encode");
+
+  ZXCode128Writer *writer = [[[ZXCode128Writer alloc] init] autorelease];
+  for (int i = 0; i < contents.count; i++) {
+    ZXBitMatrix *matrix = [writer encode:[contents objectAtIndex:i] format:kBarcodeFormatCode128 width:300 height:20 hints:nil error:nil];
+    [self assertRaster:(const unsigned char *)rasters.bytes + i * batchWriter.bytesPerRaster batchWriter:batchWriter
+          equalsMatrix:matrix contents:[contents objectAtIndex:i]];
+  }
+}
+
+- (void)testFailuresAreWhite {
+  ZXBatchWriter *batchWriter = [[[ZXBatchWriter alloc] initWithFormat:kBarcodeFormatQRCode width:64 height:64 hints:nil] autorelease];
+  NSMutableString *tooLong = [NSMutableString string];
+  for (int i = 0; i < 200; i++) {
+    [tooLong appendString:@"0123456789"];
+  }
+  NSArray *contents = [NSArray arrayWithObjects:@"fits", @"", tooLong, @"also fits", nil];
+
+  unsigned char *buffer = (unsigned char *)malloc(contents.count * batchWriter.bytesPerRaster);
+  memset(buffer, 0xAA, contents.count * batchWriter.bytesPerRaster);
+  NSIndexSet *failedIndexes = [batchWriter encodeContents:contents buffer:buffer];
+
+  NSMutableIndexSet *expected = [NSMutableIndexSet indexSetWithIndex:1];
+  [expected addIndex:2];
+  STAssertEqualObjects(failedIndexes, expected, @"Expected the empty and oversized payloads to fail");
+  for (int i = 0; i < contents.count; i++) {
+    BOOL white = [self rasterIsWhite:buffer + i * batchWriter.bytesPerRaster batchWriter:batchWriter];
+    STAssertEquals(white, [failedIndexes containsIndex:i], @"Expected only failed rasters to be white at %d", i);
+  }
+  free(buffer);
+}
+
+- (void)testChunksMatchOneBatch {
+  ZXBatchWriter *batchWriter = [[[ZXBatchWriter alloc] initWithFormat:kBarcodeFormatQRCode width:120 height:120 hints:nil] autorelease];
+  NSArray *contents = [self payloads:30];
+  NSData *whole = [batchWriter encodeContents:contents failedIndexes:nil];
+
+  batchWriter.maxConcurrentEncodes = 3;
+  NSMutableData *chunked = [NSMutableData data];
+  for (int start = 0; start < contents.count; start += 7) {
+    NSArray *chunk = [contents subarrayWithRange:NSMakeRange(start, MIN(7, contents.count - start))];
+    [chunked appendData:[batchWriter encodeContents:chunk failedIndexes:nil]];
+  }
+  STAssertEqualObjects(chunked, whole, @"Expected chunked encoding to match a single batch");
+}
+
+@end
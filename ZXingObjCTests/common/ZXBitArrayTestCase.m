@@ -17,6 +17,13 @@
 #import "ZXBitArray.h"
 #import "ZXBitArrayTestCase.h"
 
+/**
+ * An irregular pattern, so that runs of every length cross word boundaries.
+ */
+static BOOL BulkPatternBit(int i) {
+  return i % 3 == 0 || i % 7 == 2 || (i / 100) % 4 == 1;
+}
+
 @implementation ZXBitArrayTestCase
 
 - (void)testGetSet {
@@ -162,4 +169,215 @@
   STAssertFalse([array isRange:0 end:64 value:NO], @"Expected range 0-64 of YES to be false");
 }
 
+- (void)testRunStarts {
+  ZXBitArray *array = [[[ZXBitArray alloc] initWithSize:100] autorelease];
+  [array setRange:3 end:5];
+  [array setRange:31 end:65];
+  [array set:99];
+
+  int runCount;
+  const int *runStarts = [array runStarts:&runCount];
+  int expected[] = {0, 3, 5, 31, 65, 99, 100};
+  STAssertEquals(runCount, 6, @"Expected 6 runs");
+  for (int i = 0; i <= runCount; i++) {
+    STAssertEquals(runStarts[i], expected[i], @"Expected runStarts[%d] to be %d", i, expected[i]);
+  }
+
+  // Reversing flips the cached runs, which must match a fresh scan of the reversed bits.
+  [array reverse];
+  runStarts = [array runStarts:&runCount];
+  int reversed[] = {0, 1, 35, 69, 95, 97, 100};
+  STAssertEquals(runCount, 6, @"Expected 6 runs after reversing");
+  for (int i = 0; i <= runCount; i++) {
+    STAssertEquals(runStarts[i], reversed[i], @"Expected reversed runStarts[%d] to be %d", i, reversed[i]);
+  }
+  STAssertTrue([array get:0], @"Expected the first run to be black after reversing");
+  STAssertFalse([array get:1], @"Expected the second run to be white after reversing");
+
+  // Any modification drops the cached runs.
+  [array clear];
+  runStarts = [array runStarts:&runCount];
+  STAssertEquals(runCount, 1, @"Expected a single run after clearing");
+  STAssertEquals(runStarts[1], 100, @"Expected the run to cover the array");
+}
+
+- (void)testAppendBits {
+  ZXBitArray *words = [[[ZXBitArray alloc] init] autorelease];
+  ZXBitArray *bits = [[[ZXBitArray alloc] init] autorelease];
+  srand(0x5EED);
+  for (int i = 0; i < 200; i++) {
+    int numBits = rand() % 33;
+    int value = (int)((unsigned int)rand() << 16 ^ (unsigned int)rand());
+    [words appendBits:value numBits:numBits];
+    for (int j = numBits - 1; j >= 0; j--) {
+      [bits appendBit:((value >> j) & 1) == 1];
+    }
+  }
+  STAssertEquals(words.size, bits.size, @"Expected sizes to match");
+  for (int i = 0; i < bits.size; i++) {
+    STAssertEquals([words get:i], [bits get:i], @"Expected bit %d to match", i);
+  }
+}
+
+- (void)testAppendBitArray {
+  int offsets[] = {0, 1, 31, 32, 33, 63};
+  for (int o = 0; o < sizeof(offsets) / sizeof(int); o++) {
+    ZXBitArray *array = [[[ZXBitArray alloc] init] autorelease];
+    for (int i = 0; i < offsets[o]; i++) {
+      [array appendBit:i % 3 == 0];
+    }
+    ZXBitArray *other = [[[ZXBitArray alloc] initWithSize:70] autorelease];
+    for (int i = 0; i < 70; i += 2) {
+      [other set:i];
+    }
+    [other set:69];
+
+    [array appendBitArray:other];
+    STAssertEquals(array.size, offsets[o] + 70, @"Expected the sizes to add up at offset %d", offsets[o]);
+    for (int i = 0; i < 70; i++) {
+      STAssertEquals([array get:offsets[o] + i], [other get:i], @"Expected bit %d to match at offset %d", i, offsets[o]);
+    }
+    STAssertEquals([array nextSet:offsets[o] + 70], array.size, @"Expected nothing set past the end");
+
+    // Appending an array to itself doubles it.
+    int size = array.size;
+    [array appendBitArray:array];
+    STAssertEquals(array.size, 2 * size, @"Expected the size to double");
+    for (int i = 0; i < size; i++) {
+      STAssertEquals([array get:size + i], [array get:i], @"Expected bit %d to repeat", i);
+    }
+  }
+}
+
+- (void)testToBytes {
+  ZXBitArray *array = [[[ZXBitArray alloc] init] autorelease];
+  [array appendBits:0x5 numBits:3];
+  [array appendBits:0xA5C3E10F numBits:32];
+  [array appendBits:0x99 numBits:8];
+
+  unsigned char bytes[5];
+  [array toBytes:3 array:bytes offset:0 numBytes:5];
+  const unsigned char expected[] = {0xA5, 0xC3, 0xE1, 0x0F, 0x99};
+  for (int i = 0; i < 5; i++) {
+    STAssertEquals(bytes[i], expected[i], @"Expected byte %d to be %02X", i, expected[i]);
+  }
+}
+
+- (void)testReverse {
+  int sizes[] = {1, 31, 32, 33, 64, 100};
+  for (int s = 0; s < sizeof(sizes) / sizeof(int); s++) {
+    int size = sizes[s];
+    ZXBitArray *array = [[[ZXBitArray alloc] initWithSize:size] autorelease];
+    for (int i = 0; i < size; i++) {
+      if (i % 3 == 0 || i % 7 == 0) {
+        [array set:i];
+      }
+    }
+    [array reverse];
+    for (int i = 0; i < size; i++) {
+      int original = size - 1 - i;
+      STAssertEquals([array get:i], (BOOL)(original % 3 == 0 || original % 7 == 0),
+                     @"Expected bit %d to be reversed at size %d", i, size);
+    }
+    STAssertEquals([array nextSet:size], size, @"Expected nothing set past the end at size %d", size);
+    for (int i = size; i < (size + 31) / 32 * 32; i++) {
+      STAssertFalse([array get:i], @"Expected padding bit %d to stay clear at size %d", i, size);
+    }
+  }
+}
+
+- (void)testXorAfterAppending {
+  ZXBitArray *appended = [[[ZXBitArray alloc] init] autorelease];
+  for (int i = 0; i < 40; i++) {
+    [appended appendBit:i % 2 == 0];
+  }
+  ZXBitArray *fixed = [[[ZXBitArray alloc] initWithSize:40] autorelease];
+  [fixed setRange:0 end:40];
+
+  [appended xor:fixed];
+  for (int i = 0; i < 40; i++) {
+    STAssertEquals([appended get:i], (BOOL)(i % 2 == 1), @"Expected bit %d to be flipped", i);
+  }
+}
+
+/**
+ * Runs the word-at-a-time operations at the sizes the bulk operation benchmark used and checks them
+ * against bit-by-bit loops over get:.
+ */
+- (void)testBulkOperationsMatchBitByBit {
+  int sizes[] = {4096, 4093};
+  for (int n = 0; n < sizeof(sizes) / sizeof(int); n++) {
+    int size = sizes[n];
+    ZXBitArray *source = [[[ZXBitArray alloc] initWithSize:size] autorelease];
+    BOOL expected[size];
+    for (int i = 0; i < size; i++) {
+      expected[i] = BulkPatternBit(i);
+      if (expected[i]) {
+        [source set:i];
+      }
+    }
+
+    int mismatches = 0;
+    ZXBitArray *appended = [[[ZXBitArray alloc] init] autorelease];
+    for (int i = 0; i < size / 12; i++) {
+      [appended appendBits:i numBits:12];
+    }
+    STAssertEquals(appended.size, size / 12 * 12, @"Expected 12 bits per value");
+    for (int i = 0; i < appended.size; i++) {
+      BOOL bit = ((i / 12) >> (11 - i % 12)) & 1;
+      mismatches += [appended get:i] != bit ? 1 : 0;
+    }
+    STAssertEquals(mismatches, 0, @"Expected appendBits:numBits: to match bit by bit at size %d", size);
+
+    mismatches = 0;
+    appended = [[[ZXBitArray alloc] init] autorelease];
+    [appended appendBit:YES];
+    [appended appendBitArray:source];
+    STAssertEquals(appended.size, size + 1, @"Expected the appended bits after the first one");
+    for (int i = 0; i < size; i++) {
+      mismatches += [appended get:i + 1] != expected[i] ? 1 : 0;
+    }
+    STAssertEquals(mismatches, 0, @"Expected appendBitArray: to match bit by bit at size %d", size);
+
+    mismatches = 0;
+    int numBytes = size / 8;
+    unsigned char bytes[numBytes];
+    [source toBytes:0 array:bytes offset:0 numBytes:numBytes];
+    for (int i = 0; i < numBytes; i++) {
+      int byte = 0;
+      for (int j = 0; j < 8; j++) {
+        byte = (byte << 1) | (expected[i * 8 + j] ? 1 : 0);
+      }
+      mismatches += bytes[i] != byte ? 1 : 0;
+    }
+    STAssertEquals(mismatches, 0, @"Expected toBytes: to match bit by bit at size %d", size);
+
+    for (int from = 0; from < size; from += 61) {
+      int nextSet = from;
+      while (nextSet < size && !expected[nextSet]) {
+        nextSet++;
+      }
+      int nextUnset = from;
+      while (nextUnset < size && expected[nextUnset]) {
+        nextUnset++;
+      }
+      int end = MIN(size, from + 61);
+      BOOL allUnset = YES;
+      for (int i = from; i < end; i++) {
+        allUnset = allUnset && !expected[i];
+      }
+      STAssertEquals([source nextSet:from], nextSet, @"Expected nextSet:%d to match at size %d", from, size);
+      STAssertEquals([source nextUnset:from], nextUnset, @"Expected nextUnset:%d to match at size %d", from, size);
+      STAssertEquals([source isRange:from end:end value:NO], allUnset, @"Expected isRange:%d end:%d to match at size %d", from, end, size);
+    }
+
+    mismatches = 0;
+    [source reverse];
+    for (int i = 0; i < size; i++) {
+      mismatches += [source get:i] != expected[size - 1 - i] ? 1 : 0;
+    }
+    STAssertEquals(mismatches, 0, @"Expected reverse to match bit by bit at size %d", size);
+  }
+}
+
 @end
@@ -119,4 +119,102 @@
   }
 }
 
+- (void)testRegion {
+  ZXBitMatrix *matrix = [[[ZXBitMatrix alloc] initWithWidth:100 height:10] autorelease];
+  for (int y = 0; y < 10; y++) {
+    for (int x = 0; x < 100; x++) {
+      if ((x * 7 + y * 3) % 5 == 0) {
+        [matrix setX:x y:y];
+      }
+    }
+  }
+
+  int lefts[] = {0, 1, 31, 32, 45};
+  for (int i = 0; i < sizeof(lefts) / sizeof(int); i++) {
+    int left = lefts[i];
+    int width = 100 - left - 3;
+    ZXBitMatrix *region = [matrix regionAtLeft:left top:2 width:width height:7];
+    STAssertEquals(region.width, width, @"Expected region.width to be %d", width);
+    STAssertEquals(region.height, 7, @"Expected region.height to be 7");
+    for (int y = 0; y < 7; y++) {
+      for (int x = 0; x < width; x++) {
+        STAssertEquals([region getX:x y:y], [matrix getX:left + x y:y + 2], @"Expected region (%d,%d) to match at left %d", x, y, left);
+      }
+      // Nothing from outside the region may leak into the padding of the last word.
+      for (int x = width; x < region.rowSize * 32; x++) {
+        STAssertFalse([region getX:x y:y], @"Expected padding (%d,%d) to be off at left %d", x, y, left);
+      }
+    }
+  }
+}
+
+- (void)testSetRow {
+  ZXBitMatrix *matrix = [[[ZXBitMatrix alloc] initWithWidth:70 height:3] autorelease];
+  ZXBitArray *row = [[[ZXBitArray alloc] initWithSize:70] autorelease];
+  [row setRange:5 end:40];
+  [row set:69];
+
+  [matrix setRowAtY:1 row:row];
+  for (int y = 0; y < 3; y++) {
+    for (int x = 0; x < 70; x++) {
+      STAssertEquals([matrix getX:x y:y], (BOOL)(y == 1 && [row get:x]), @"Expected matrix (%d,%d) to match the row", x, y);
+    }
+  }
+}
+
+/**
+ * Runs the word-at-a-time operations on a matrix the size the bulk operation benchmark used and
+ * checks them against bit-by-bit loops over getX:y:.
+ */
+- (void)testBulkOperationsMatchBitByBit {
+  const int dimension = 1024;
+  ZXBitMatrix *matrix = [[[ZXBitMatrix alloc] initWithDimension:dimension] autorelease];
+  for (int i = 0; i < dimension; i += 16) {
+    [matrix setRegionAtLeft:i top:i / 2 width:dimension - i height:8];
+  }
+  int mismatches = 0;
+  for (int y = 0; y < dimension; y++) {
+    for (int x = 0; x < dimension; x++) {
+      // Bands of 8 rows start every 8 rows, each one 16 columns shorter on the left than the last.
+      BOOL bit = x >= (y / 8) * 16 && y / 8 < dimension / 16;
+      mismatches += [matrix getX:x y:y] != bit ? 1 : 0;
+    }
+  }
+  STAssertEquals(mismatches, 0, @"Expected setRegion to match bit by bit");
+
+  // Make it irregular enough that a misplaced word shows.
+  for (int y = 0; y < dimension; y += 5) {
+    for (int x = y % 11; x < dimension; x += 13) {
+      [matrix flipX:x y:y];
+    }
+  }
+
+  int left = 13;
+  int top = 7;
+  int width = dimension - 40;
+  int height = dimension - 20;
+  ZXBitMatrix *region = [matrix regionAtLeft:left top:top width:width height:height];
+  mismatches = 0;
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      mismatches += [region getX:x y:y] != [matrix getX:left + x y:top + y] ? 1 : 0;
+    }
+  }
+  STAssertEquals(mismatches, 0, @"Expected regionAtLeft: to match bit by bit");
+
+  ZXBitMatrix *mirrored = [[[ZXBitMatrix alloc] initWithDimension:dimension] autorelease];
+  ZXBitArray *row = nil;
+  for (int y = 0; y < dimension; y++) {
+    row = [matrix rowAtY:y row:row];
+    [mirrored setRowAtY:dimension - 1 - y row:row];
+  }
+  mismatches = 0;
+  for (int y = 0; y < dimension; y++) {
+    for (int x = 0; x < dimension; x++) {
+      mismatches += [mirrored getX:x y:dimension - 1 - y] != [matrix getX:x y:y] ? 1 : 0;
+    }
+  }
+  STAssertEquals(mismatches, 0, @"Expected rowAtY: and setRowAtY: to match bit by bit");
+}
+
 @end
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2012 ZXing authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import "ZXBinaryBitmap.h"
+#import "ZXBitMatrix.h"
+#import "ZXDecodeTrace.h"
+#import "ZXDecodeTraceTestCase.h"
+#import "ZXFrameLuminanceSource.h"
+#import "ZXHybridBinarizer.h"
+#import "ZXQRCodeReader.h"
+#import "ZXQRCodeWriter.h"
+#import "ZXResult.h"
+
+static const int MODULE_SIZE = 4;
+
+@interface ZXDecodeTraceTestCase ()
+
+- (ZXBinaryBitmap *)bitmapForCode:(ZXBitMatrix *)code flipX:(int)flipX y:(int)flipY;
+
+@end
+
+@implementation ZXDecodeTraceTestCase
+
+/**
+ * Renders a writer's module matrix at MODULE_SIZE pixels a module, inverting one module.
+ */
+- (ZXBinaryBitmap *)bitmapForCode:(ZXBitMatrix *)code flipX:(int)flipX y:(int)flipY {
+  int size = code.width * MODULE_SIZE;
+  unsigned char *pixels = (unsigned char *)malloc(size * size);
+  for (int y = 0; y < size; y++) {
+    for (int x = 0; x < size; x++) {
+      int moduleX = x / MODULE_SIZE;
+      int moduleY = y / MODULE_SIZE;
+      BOOL black = [code getX:moduleX y:moduleY] != (moduleX == flipX && moduleY == flipY);
+      pixels[y * size + x] = black ? 0 : 255;
+    }
+  }
+  ZXFrameLuminanceSource *source = [[[ZXFrameLuminanceSource alloc] initWithPixels:pixels
+                                                                       pixelFormat:kZXFramePixelFormatLuminance
+                                                                         dataWidth:size dataHeight:size bytesPerRow:size
+                                                                          rotation:0 downscale:1] autorelease];
+  free(pixels);
+  return [[[ZXBinaryBitmap alloc] initWithBinarizer:[[[ZXHybridBinarizer alloc] initWithSource:source] autorelease]] autorelease];
+}
+
+- (void)testTracingIsCompiledIn {
+  STAssertTrue([ZXDecodeTrace enabled], @"Expected the tests to be built with ZX_DECODE_TRACE=1");
+}
+
+- (void)testStageNames {
+  for (int stage = 0; stage < kZXDecodeStageCount; stage++) {
+    STAssertNotNil([ZXDecodeTrace nameOfStage:(ZXDecodeStage)stage], @"Expected a name for stage %d", stage);
+  }
+}
+
+- (void)testTraceRecordsQRCodeDecode {
+  NSString *contents = @"Decode trace";
+  ZXBitMatrix *code = [[[[ZXQRCodeWriter alloc] init] autorelease] encode:contents format:kBarcodeFormatQRCode
+                                                                    width:0 height:0 error:nil];
+  STAssertNotNil(code, @"Expected the QR code to encode");
+
+  // The bottom right module of the symbol, inside the 4 module quiet zone, is always a data module.
+  ZXBinaryBitmap *bitmap = [self bitmapForCode:code flipX:code.width - 5 y:code.height - 5];
+
+  ZXDecodeTrace *trace = [ZXDecodeTrace trace];
+  [trace begin];
+  ZXResult *result = [[[[ZXQRCodeReader alloc] init] autorelease] decode:bitmap error:nil];
+  [trace end];
+  STAssertEqualObjects(result.text, contents, @"Contents don't match");
+
+  ZXDecodeStats stats = trace.stats;
+  STAssertTrue(stats.endTime >= stats.startTime, @"Expected monotonic trace times");
+
+  for (int stage = 0; stage < kZXDecodeStageCount; stage++) {
+    NSString *name = [ZXDecodeTrace nameOfStage:(ZXDecodeStage)stage];
+    STAssertTrue(stats.stageCount[stage] > 0, @"Expected the %@ stage to run", name);
+    STAssertTrue(stats.stageFirstStart[stage] >= stats.startTime, @"Expected %@ to start after the trace", name);
+    STAssertTrue(stats.stageLastEnd[stage] <= stats.endTime, @"Expected %@ to end before the trace", name);
+    STAssertTrue(stats.stageDuration[stage] <= stats.endTime - stats.startTime,
+                 @"Expected %@ to take no longer than the trace", name);
+  }
+  STAssertEquals(stats.candidatesFound, 1, @"Expected one detected symbol");
+  STAssertEquals(stats.errorsCorrected, 1, @"Expected the flipped module's codeword to be corrected");
+  STAssertTrue(stats.allocations > 0, @"Expected the binarized matrix to be counted");
+  STAssertEquals(stats.rowsScanned, 0, @"Expected no 1D rows for a QR code");
+}
+
+- (void)testNestedTracesRestoreTheOuterTrace {
+  ZXDecodeTrace *outer = [ZXDecodeTrace trace];
+  ZXDecodeTrace *inner = [ZXDecodeTrace trace];
+  [outer begin];
+  [inner begin];
+  ZX_TRACE_COUNT(rowsScanned, 1);
+  [inner end];
+  ZX_TRACE_COUNT(rowsScanned, 2);
+  [outer end];
+  ZX_TRACE_COUNT(rowsScanned, 4);
+
+  STAssertEquals(inner.stats.rowsScanned, 1, @"Expected the inner trace to see only its own rows");
+  STAssertEquals(outer.stats.rowsScanned, 2, @"Expected the outer trace to resume after the inner one");
+  STAssertEquals([[[outer dictionary] objectForKey:@"rowsScanned"] intValue], 2,
+                 @"Expected the exported rows to match");
+}
+
+@end
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2012 ZXing authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import "ZXBitMatrix.h"
+#import "ZXDefaultGridSampler.h"
+#import "ZXDefaultGridSamplerTestCase.h"
+#import "ZXErrors.h"
+#import "ZXPerspectiveTransform.h"
+
+@interface ZXDefaultGridSamplerTestCase ()
+
+- (ZXBitMatrix *)noiseWithWidth:(int)width height:(int)height;
+
+@end
+
+@implementation ZXDefaultGridSamplerTestCase
+
+- (ZXBitMatrix *)noiseWithWidth:(int)width height:(int)height {
+  ZXBitMatrix *image = [[[ZXBitMatrix alloc] initWithWidth:width height:height] autorelease];
+  unsigned int seed = 42;
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      seed = seed * 1103515245 + 12345;
+      if ((seed >> 16) & 1) {
+        [image setX:x y:y];
+      }
+    }
+  }
+  return image;
+}
+
+- (void)testSampleGridInsideImage {
+  // A version 40 QR code, tilted in perspective, well inside the image
+  int dimension = 177;
+  ZXBitMatrix *image = [self noiseWithWidth:801 height:601];
+  ZXPerspectiveTransform *transform =
+    [ZXPerspectiveTransform quadrilateralToQuadrilateral:3.5f y0:3.5f
+                                                      x1:dimension - 3.5f y1:3.5f
+                                                      x2:dimension - 3.5f y2:dimension - 3.5f
+                                                      x3:3.5f y3:dimension - 3.5f
+                                                     x0p:120.3f y0p:80.7f
+                                                     x1p:690.1f y1p:60.2f
+                                                     x2p:720.8f y2p:560.4f
+                                                     x3p:90.6f y3p:520.9f];
+  ZXDefaultGridSampler *sampler = [[[ZXDefaultGridSampler alloc] init] autorelease];
+  ZXBitMatrix *bits = [sampler sampleGrid:image dimensionX:dimension dimensionY:dimension transform:transform error:nil];
+  STAssertNotNil(bits, @"Expected the grid to be sampled");
+
+  int compared = 0;
+  for (int y = 0; y < dimension; y++) {
+    for (int x = 0; x < dimension; x++) {
+      float point[2] = {x + 0.5f, y + 0.5f};
+      [transform transformPoints:point pointsLen:2];
+      // Rounding may legitimately differ right at a pixel edge
+      if (point[0] - floorf(point[0]) < 0.001f || point[1] - floorf(point[1]) < 0.001f ||
+          ceilf(point[0]) - point[0] < 0.001f || ceilf(point[1]) - point[1] < 0.001f) {
+        continue;
+      }
+      STAssertEquals([bits getX:x y:y], [image getX:(int)point[0] y:(int)point[1]],
+                     @"Expected module (%d, %d) to be sampled from (%f, %f)", x, y, point[0], point[1]);
+      compared++;
+    }
+  }
+  STAssertTrue(compared > dimension * dimension * 9 / 10, @"Expected most modules to be compared");
+}
+
+- (void)testSampleGridAtImageEdge {
+  ZXBitMatrix *image = [self noiseWithWidth:100 height:100];
+  ZXDefaultGridSampler *sampler = [[[ZXDefaultGridSampler alloc] init] autorelease];
+
+  // The top left module lands on the border of the image, so the checked path samples the grid
+  ZXPerspectiveTransform *edge =
+    [ZXPerspectiveTransform quadrilateralToQuadrilateral:0.5f y0:0.5f x1:20.5f y1:0.5f x2:20.5f y2:20.5f x3:0.5f y3:20.5f
+                                                     x0p:-0.5f y0p:-0.5f x1p:80.0f y1p:0.5f x2p:80.0f y2p:80.0f x3p:0.5f y3p:80.0f];
+  ZXBitMatrix *bits = [sampler sampleGrid:image dimensionX:21 dimensionY:21 transform:edge error:nil];
+  STAssertNotNil(bits, @"Expected the grid to be sampled");
+  STAssertEquals([bits getX:0 y:0], [image getX:0 y:0], @"Expected the corner to be sampled from the border");
+
+  ZXPerspectiveTransform *outside =
+    [ZXPerspectiveTransform quadrilateralToQuadrilateral:0.5f y0:0.5f x1:20.5f y1:0.5f x2:20.5f y2:20.5f x3:0.5f y3:20.5f
+                                                     x0p:50.0f y0p:50.0f x1p:150.0f y1p:50.0f x2p:150.0f y2p:150.0f x3p:50.0f y3p:150.0f];
+  NSError *error = nil;
+  STAssertNil([sampler sampleGrid:image dimensionX:21 dimensionY:21 transform:outside error:&error],
+              @"Expected a grid beyond the image to fail");
+  STAssertTrue(error.code == ZXNotFoundError, @"Expected a not found error");
+}
+
+@end
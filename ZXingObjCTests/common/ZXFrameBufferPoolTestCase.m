@@ -0,0 +1,161 @@
+/*
+ * Copyright 2012 ZXing authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import <malloc/malloc.h>
+#import "ZXBinaryBitmap.h"
+#import "ZXBitArray.h"
+#import "ZXBitMatrix.h"
+#import "ZXFrameBufferPool.h"
+#import "ZXFrameBufferPoolTestCase.h"
+#import "ZXHybridBinarizer.h"
+#import "ZXPlanarYUVLuminanceSource.h"
+
+static const int FRAME_WIDTH = 640;
+static const int FRAME_HEIGHT = 480;
+
+@interface ZXFrameBufferPoolTestCase ()
+
+- (void)decodeFrame:(unsigned char *)yuv length:(int)length pool:(ZXFrameBufferPool *)pool;
+
+@end
+
+@implementation ZXFrameBufferPoolTestCase
+
+- (void)decodeFrame:(unsigned char *)yuv length:(int)length pool:(ZXFrameBufferPool *)pool {
+  ZXPlanarYUVLuminanceSource *source = [[[ZXPlanarYUVLuminanceSource alloc] initWithYuvData:yuv yuvDataLen:length
+                                                                                  dataWidth:FRAME_WIDTH dataHeight:FRAME_HEIGHT
+                                                                                       left:0 top:0
+                                                                                      width:FRAME_WIDTH height:FRAME_HEIGHT
+                                                                          reverseHorizontal:NO bufferPool:pool] autorelease];
+  ZXHybridBinarizer *binarizer = [[[ZXHybridBinarizer alloc] initWithSource:source] autorelease];
+  binarizer.bufferPool = pool;
+  ZXBinaryBitmap *bitmap = [[[ZXBinaryBitmap alloc] initWithBinarizer:binarizer] autorelease];
+
+  STAssertNotNil([bitmap blackMatrixWithError:nil], @"Expected a black matrix");
+  ZXBitArray *row = nil;
+  for (int y = 0; y < FRAME_HEIGHT; y += 16) {
+    ZXBitArray *blackRow = [bitmap blackRow:y row:row error:nil];
+    if (blackRow) {
+      row = blackRow;
+    }
+  }
+}
+
+- (void)testSteadyStateAllocatesNothing {
+  int length = FRAME_WIDTH * FRAME_HEIGHT * 3 / 2;
+  unsigned char *yuv = (unsigned char *)malloc(length);
+  ZXFrameBufferPool *pool = [[[ZXFrameBufferPool alloc] init] autorelease];
+
+  int warmAllocationCount = 0;
+  for (int frame = 0; frame < 20; frame++) {
+    for (int i = 0; i < length; i++) {
+      yuv[i] = (unsigned char)((i % FRAME_WIDTH) / 8 % 2 ? 40 + frame : 200 - frame);
+    }
+
+    // Each frame is autoreleased before the next, as in a capture callback. Bytes still in use
+    // before the pool drains include everything the frame allocated, so once the buffers are
+    // recycled only the small per-frame objects are left.
+    NSAutoreleasePool *autoreleasePool = [[NSAutoreleasePool alloc] init];
+    malloc_statistics_t before;
+    malloc_zone_statistics(NULL, &before);
+    [self decodeFrame:yuv length:length pool:pool];
+    malloc_statistics_t after;
+    malloc_zone_statistics(NULL, &after);
+    [autoreleasePool drain];
+
+    int allocated = (int)after.size_in_use - (int)before.size_in_use;
+    if (frame == 0) {
+      warmAllocationCount = pool.allocationCount;
+      STAssertTrue(warmAllocationCount > 0, @"Expected the first frame to fill the pool");
+      STAssertTrue(allocated > FRAME_WIDTH * FRAME_HEIGHT, @"Expected the first frame to allocate its buffers, got %d bytes", allocated);
+    } else {
+      STAssertEquals(pool.allocationCount, warmAllocationCount, @"Expected frame %d to allocate no new buffers", frame);
+      STAssertTrue(allocated < 16 * 1024, @"Expected frame %d to allocate under 16 KB, got %d bytes", frame, allocated);
+    }
+    STAssertEquals(pool.recycledCount, warmAllocationCount, @"Expected every buffer to be recycled after frame %d", frame);
+  }
+
+  STAssertTrue(pool.reuseCount >= 19 * warmAllocationCount, @"Expected every buffer to be reused on every frame");
+  free(yuv);
+}
+
+- (void)testBufferInUseIsNotHandedOutTwice {
+  ZXFrameBufferPool *pool = [[[ZXFrameBufferPool alloc] init] autorelease];
+  ZXBitMatrix *first = [pool bitMatrixWithWidth:50 height:50];
+  ZXBitMatrix *second = [pool bitMatrixWithWidth:50 height:50];
+  STAssertTrue(first != second, @"Expected a checked out matrix not to be handed out again");
+  STAssertEquals(pool.allocationCount, 2, @"Expected two allocations");
+}
+
+- (void)testRecycledBufferIsReused {
+  ZXFrameBufferPool *pool = [[[ZXFrameBufferPool alloc] init] autorelease];
+  ZXBitMatrix *matrix = [pool bitMatrixWithWidth:50 height:50];
+  [matrix setX:3 y:4];
+  [pool recycle:matrix];
+  [pool recycle:matrix];
+  STAssertEquals(pool.recycledCount, 1, @"Expected recycling twice to keep one copy");
+
+  STAssertTrue([pool bitArrayWithSize:50] != (id)matrix, @"Expected a buffer of another kind not to match");
+  STAssertTrue([pool bitMatrixWithWidth:50 height:51] != matrix, @"Expected a matrix of another size not to match");
+  ZXBitMatrix *reused = [pool bitMatrixWithWidth:50 height:50];
+  STAssertTrue(reused == matrix, @"Expected the recycled matrix to be reused");
+  STAssertFalse([reused getX:3 y:4], @"Expected a reused matrix to be cleared");
+  STAssertEquals(pool.reuseCount, 1, @"Expected one reuse");
+  STAssertEquals(pool.recycledCount, 0, @"Expected the pool to be empty");
+}
+
+- (void)testLeastRecentlyRecycledBufferIsEvicted {
+  ZXFrameBufferPool *pool = [[[ZXFrameBufferPool alloc] init] autorelease];
+  pool.maxBufferCount = 2;
+  NSMutableData *oldest = [pool dataWithLength:100];
+  NSMutableData *middle = [pool dataWithLength:100];
+  NSMutableData *newest = [pool dataWithLength:200];
+  [pool recycle:oldest];
+  [pool recycle:middle];
+  [pool recycle:newest];
+  STAssertEquals(pool.recycledCount, 2, @"Expected the pool to stay at its cap");
+
+  STAssertTrue([pool dataWithLength:100] == middle, @"Expected the remaining buffer of that length");
+  STAssertTrue([pool dataWithLength:100] != oldest, @"Expected the oldest buffer to have been evicted");
+  STAssertTrue([pool dataWithLength:200] == newest, @"Expected the newest buffer to be kept");
+
+  [pool recycle:oldest];
+  [pool recycle:middle];
+  pool.maxBufferCount = 0;
+  STAssertEquals(pool.recycledCount, 0, @"Expected lowering the cap to evict");
+}
+
+- (void)testCropKeepsSharedBuffer {
+  int length = FRAME_WIDTH * FRAME_HEIGHT * 3 / 2;
+  unsigned char *yuv = (unsigned char *)calloc(length, 1);
+  ZXFrameBufferPool *pool = [[[ZXFrameBufferPool alloc] init] autorelease];
+
+  NSAutoreleasePool *autoreleasePool = [[NSAutoreleasePool alloc] init];
+  ZXPlanarYUVLuminanceSource *source = [[ZXPlanarYUVLuminanceSource alloc] initWithYuvData:yuv yuvDataLen:length
+                                                                                dataWidth:FRAME_WIDTH dataHeight:FRAME_HEIGHT
+                                                                                     left:0 top:0
+                                                                                    width:FRAME_WIDTH height:FRAME_HEIGHT
+                                                                        reverseHorizontal:NO bufferPool:pool];
+  ZXLuminanceSource *crop = [[[source crop:10 top:10 width:100 height:100] crop:5 top:5 width:50 height:50] retain];
+  [source release];
+  [autoreleasePool drain];
+  STAssertEquals(pool.recycledCount, 0, @"Expected the buffer not to be recycled while a crop uses it");
+  [crop release];
+  STAssertEquals(pool.recycledCount, 1, @"Expected the buffer to be recycled with its last user");
+  free(yuv);
+}
+
+@end
@@ -0,0 +1,216 @@
+/*
+ * Copyright 2012 ZXing authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import "ZXBinaryBitmap.h"
+#import "ZXBitMatrix.h"
+#import "ZXCode128Reader.h"
+#import "ZXCode128Writer.h"
+#import "ZXDecodeHints.h"
+#import "ZXFrameLuminanceSource.h"
+#import "ZXFrameLuminanceSourceTestCase.h"
+#import "ZXHybridBinarizer.h"
+#import "ZXResult.h"
+
+@interface ZXFrameLuminanceSourceTestCase ()
+
+- (void)assertSource:(ZXLuminanceSource *)source equals:(const unsigned char *)expected
+               width:(int)width height:(int)height;
+
+@end
+
+@implementation ZXFrameLuminanceSourceTestCase
+
+- (void)assertSource:(ZXLuminanceSource *)source equals:(const unsigned char *)expected
+               width:(int)width height:(int)height {
+  STAssertEquals(source.width, width, @"Widths don't match");
+  STAssertEquals(source.height, height, @"Heights don't match");
+  unsigned char *matrix = [source matrix];
+  for (int i = 0; i < width * height; i++) {
+    STAssertEquals(matrix[i], expected[i], @"Luminance %d doesn't match", i);
+  }
+  free(matrix);
+}
+
+- (void)testRotations {
+  // Three pixels wide, two high, in rows padded to a stride of 5.
+  const unsigned char frame[] = {1, 2, 3, 99, 99,
+                                 4, 5, 6, 99, 99};
+  const unsigned char rotated0[] = {1, 2, 3, 4, 5, 6};
+  const unsigned char rotated90[] = {4, 1, 5, 2, 6, 3};
+  const unsigned char rotated180[] = {6, 5, 4, 3, 2, 1};
+  const unsigned char rotated270[] = {3, 6, 2, 5, 1, 4};
+
+  for (int rotation = 0; rotation < 360; rotation += 90) {
+    ZXFrameLuminanceSource *source = [[[ZXFrameLuminanceSource alloc] initWithPixels:frame
+                                                                         pixelFormat:kZXFramePixelFormatLuminance
+                                                                           dataWidth:3 dataHeight:2 bytesPerRow:5
+                                                                            rotation:rotation downscale:1] autorelease];
+    const unsigned char *expected = rotation == 0 ? rotated0 : rotation == 90 ? rotated90 :
+      rotation == 180 ? rotated180 : rotated270;
+    BOOL quarterTurn = rotation == 90 || rotation == 270;
+    [self assertSource:source equals:expected width:quarterTurn ? 2 : 3 height:quarterTurn ? 3 : 2];
+  }
+}
+
+- (void)testBGRADownscale {
+  // Four 2x2 boxes: white, black, pure green, and a checkerboard of white and black.
+  unsigned char frame[4 * 4 * 4];
+  const unsigned char boxes[4][2][2][3] = {
+    {{{255, 255, 255}, {255, 255, 255}}, {{255, 255, 255}, {255, 255, 255}}},
+    {{{0, 0, 0}, {0, 0, 0}}, {{0, 0, 0}, {0, 0, 0}}},
+    {{{0, 255, 0}, {0, 255, 0}}, {{0, 255, 0}, {0, 255, 0}}},
+    {{{255, 255, 255}, {0, 0, 0}}, {{0, 0, 0}, {255, 255, 255}}}
+  };
+  for (int y = 0; y < 4; y++) {
+    for (int x = 0; x < 4; x++) {
+      const unsigned char *bgr = boxes[(y / 2) * 2 + x / 2][y % 2][x % 2];
+      unsigned char *pixel = frame + (y * 4 + x) * 4;
+      pixel[0] = bgr[0];
+      pixel[1] = bgr[1];
+      pixel[2] = bgr[2];
+      pixel[3] = 0xFF;
+    }
+  }
+
+  // Green alone is 601 * 255 / 1024, and the checkerboard averages to half of white.
+  const unsigned char expected[] = {255, 0, 150, 128};
+  ZXFrameLuminanceSource *source = [[[ZXFrameLuminanceSource alloc] initWithPixels:frame
+                                                                       pixelFormat:kZXFramePixelFormatBGRA
+                                                                         dataWidth:4 dataHeight:4 bytesPerRow:16
+                                                                          rotation:0 downscale:2] autorelease];
+  [self assertSource:source equals:expected width:2 height:2];
+}
+
+- (void)testDownscaleDropsPartialBoxes {
+  unsigned char frame[9 * 6];
+  for (int i = 0; i < 9 * 6; i++) {
+    frame[i] = (unsigned char)(i % 9 < 4 ? 16 : 240);
+  }
+
+  ZXFrameLuminanceSource *source = [[[ZXFrameLuminanceSource alloc] initWithPixels:frame
+                                                                       pixelFormat:kZXFramePixelFormatLuminance
+                                                                         dataWidth:9 dataHeight:6 bytesPerRow:9
+                                                                          rotation:90 downscale:4] autorelease];
+  const unsigned char expected[] = {16, 240};
+  [self assertSource:source equals:expected width:1 height:2];
+}
+
+- (void)testRotateCounterClockwiseMatchesFrameRotation {
+  int dataWidth = 31;
+  int dataHeight = 17;
+  unsigned char *frame = (unsigned char *)malloc(dataWidth * dataHeight * 4);
+  for (int i = 0; i < dataWidth * dataHeight * 4; i++) {
+    frame[i] = (unsigned char)(i * 7919 >> 3);
+  }
+
+  ZXFrameLuminanceSource *source = [[[ZXFrameLuminanceSource alloc] initWithPixels:frame
+                                                                       pixelFormat:kZXFramePixelFormatBGRA
+                                                                         dataWidth:dataWidth dataHeight:dataHeight
+                                                                       bytesPerRow:dataWidth * 4
+                                                                          rotation:90 downscale:1] autorelease];
+  ZXFrameLuminanceSource *expected = [[[ZXFrameLuminanceSource alloc] initWithPixels:frame
+                                                                         pixelFormat:kZXFramePixelFormatBGRA
+                                                                           dataWidth:dataWidth dataHeight:dataHeight
+                                                                         bytesPerRow:dataWidth * 4
+                                                                            rotation:0 downscale:1] autorelease];
+  free(frame);
+
+  STAssertTrue([source rotateSupported], @"Expected rotation to be supported");
+  unsigned char *expectedMatrix = [expected matrix];
+  [self assertSource:[source rotateCounterClockwise] equals:expectedMatrix width:dataWidth height:dataHeight];
+  free(expectedMatrix);
+}
+
+- (void)testCropThenRotate {
+  const unsigned char frame[] = {1, 2, 3, 4,
+                                 5, 6, 7, 8,
+                                 9, 10, 11, 12};
+  ZXFrameLuminanceSource *source = [[[ZXFrameLuminanceSource alloc] initWithPixels:frame
+                                                                       pixelFormat:kZXFramePixelFormatLuminance
+                                                                         dataWidth:4 dataHeight:3 bytesPerRow:4
+                                                                          rotation:0 downscale:1] autorelease];
+  ZXLuminanceSource *cropped = [source crop:1 top:1 width:2 height:2];
+  const unsigned char croppedExpected[] = {6, 7, 10, 11};
+  [self assertSource:cropped equals:croppedExpected width:2 height:2];
+
+  const unsigned char rotatedExpected[] = {7, 11, 6, 10};
+  [self assertSource:[cropped rotateCounterClockwise] equals:rotatedExpected width:2 height:2];
+}
+
+- (void)testRotateCounterClockwise45 {
+  // A horizontal dark band through the middle of a light frame becomes a rising diagonal.
+  int dataWidth = 41;
+  int dataHeight = 21;
+  unsigned char *frame = (unsigned char *)malloc(dataWidth * dataHeight);
+  memset(frame, 200, dataWidth * dataHeight);
+  memset(frame + (dataHeight / 2 - 1) * dataWidth, 0, 3 * dataWidth);
+
+  ZXFrameLuminanceSource *source = [[[ZXFrameLuminanceSource alloc] initWithPixels:frame
+                                                                       pixelFormat:kZXFramePixelFormatLuminance
+                                                                         dataWidth:dataWidth dataHeight:dataHeight
+                                                                       bytesPerRow:dataWidth
+                                                                          rotation:0 downscale:1] autorelease];
+  free(frame);
+  ZXLuminanceSource *rotated = [source rotateCounterClockwise45];
+
+  int size = rotated.width;
+  STAssertEquals(size, 44, @"Expected the bounding square of the rotated frame");
+  STAssertEquals(rotated.height, size, @"Expected a square result");
+  unsigned char *matrix = [rotated matrix];
+  STAssertEquals(matrix[0], (unsigned char)0xFF, @"Expected corners outside the frame to be white");
+  int quarter = size / 4;
+  STAssertEquals(matrix[(size / 2) * size + size / 2], (unsigned char)0, @"Expected the centre on the line");
+  STAssertEquals(matrix[(size / 2 - quarter) * size + size / 2 + quarter], (unsigned char)0,
+                 @"Expected the line to rise to the right");
+  STAssertTrue(matrix[(size / 2 + quarter) * size + size / 2 + quarter] != 0,
+               @"Expected the falling diagonal to be off the line");
+  free(matrix);
+}
+
+- (void)testTryHarderDecodesRotatedFrame {
+  NSString *contents = @"ZXing frame";
+  ZXBitMatrix *code = [[[[ZXCode128Writer alloc] init] autorelease] encode:contents format:kBarcodeFormatCode128
+                                                                     width:0 height:0 error:nil];
+  STAssertNotNil(code, @"Expected the barcode to encode");
+
+  // Draw the bars across the frame, so the barcode reads top to bottom, at three pixels a module.
+  int moduleSize = 3;
+  int dataWidth = 120;
+  int dataHeight = code.width * moduleSize;
+  int bytesPerRow = dataWidth * 4;
+  unsigned char *frame = (unsigned char *)malloc(bytesPerRow * dataHeight);
+  for (int y = 0; y < dataHeight; y++) {
+    unsigned char value = [code getX:y / moduleSize y:0] ? 0 : 255;
+    memset(frame + y * bytesPerRow, value, bytesPerRow);
+  }
+
+  ZXFrameLuminanceSource *source = [[[ZXFrameLuminanceSource alloc] initWithPixels:frame
+                                                                       pixelFormat:kZXFramePixelFormatBGRA
+                                                                         dataWidth:dataWidth dataHeight:dataHeight
+                                                                       bytesPerRow:bytesPerRow
+                                                                          rotation:0 downscale:1] autorelease];
+  free(frame);
+  ZXBinaryBitmap *bitmap = [[[ZXBinaryBitmap alloc] initWithBinarizer:
+                             [[[ZXHybridBinarizer alloc] initWithSource:source] autorelease]] autorelease];
+  ZXDecodeHints *hints = [ZXDecodeHints hints];
+  hints.tryHarder = YES;
+
+  ZXResult *result = [[[[ZXCode128Reader alloc] init] autorelease] decode:bitmap hints:hints error:nil];
+  STAssertNotNil(result, @"Expected try harder to find the barcode after rotating");
+  STAssertEqualObjects(result.text, contents, @"Contents don't match");
+}
+
+@end
@@ -0,0 +1,179 @@
+/*
+ * Copyright 2012 ZXing authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import "ZXBitArray.h"
+#import "ZXBitMatrix.h"
+#import "ZXCGImageLuminanceSource.h"
+#import "ZXGlobalHistogramBinarizer.h"
+#import "ZXGlobalHistogramBinarizerTestCase.h"
+#import "ZXImage.h"
+
+/**
+ * The boxed, bit-at-a-time implementation the binarizer used to ship with. Kept here as the
+ * reference output the kernels must reproduce.
+ */
+static int ReferenceEstimateBlackPoint(NSArray *buckets) {
+  int numBuckets = [buckets count];
+  int maxBucketCount = 0;
+  int firstPeak = 0;
+  int firstPeakSize = 0;
+  for (int x = 0; x < numBuckets; x++) {
+    if ([[buckets objectAtIndex:x] intValue] > firstPeakSize) {
+      firstPeak = x;
+      firstPeakSize = [[buckets objectAtIndex:x] intValue];
+    }
+    if ([[buckets objectAtIndex:x] intValue] > maxBucketCount) {
+      maxBucketCount = [[buckets objectAtIndex:x] intValue];
+    }
+  }
+
+  int secondPeak = 0;
+  int secondPeakScore = 0;
+  for (int x = 0; x < numBuckets; x++) {
+    int distanceToBiggest = x - firstPeak;
+    int score = [[buckets objectAtIndex:x] intValue] * distanceToBiggest * distanceToBiggest;
+    if (score > secondPeakScore) {
+      secondPeak = x;
+      secondPeakScore = score;
+    }
+  }
+
+  if (firstPeak > secondPeak) {
+    int temp = firstPeak;
+    firstPeak = secondPeak;
+    secondPeak = temp;
+  }
+
+  if (secondPeak - firstPeak <= numBuckets >> 4) {
+    return -1;
+  }
+
+  int bestValley = secondPeak - 1;
+  int bestValleyScore = -1;
+  for (int x = secondPeak - 1; x > firstPeak; x--) {
+    int fromFirst = x - firstPeak;
+    int score = fromFirst * fromFirst * (secondPeak - x) * (maxBucketCount - [[buckets objectAtIndex:x] intValue]);
+    if (score > bestValleyScore) {
+      bestValley = x;
+      bestValleyScore = score;
+    }
+  }
+
+  return bestValley << 3;
+}
+
+static ZXBitArray *ReferenceBlackRow(ZXLuminanceSource *source, int y) {
+  int width = source.width;
+  ZXBitArray *row = [[[ZXBitArray alloc] initWithSize:width] autorelease];
+  unsigned char *luminances = [source row:y];
+  NSMutableArray *buckets = [NSMutableArray arrayWithCapacity:32];
+  for (int x = 0; x < 32; x++) {
+    [buckets addObject:[NSNumber numberWithInt:0]];
+  }
+  for (int x = 0; x < width; x++) {
+    int pixel = luminances[x] & 0xff;
+    [buckets replaceObjectAtIndex:pixel >> 3
+                       withObject:[NSNumber numberWithInt:[[buckets objectAtIndex:pixel >> 3] intValue] + 1]];
+  }
+  int blackPoint = ReferenceEstimateBlackPoint(buckets);
+  if (blackPoint == -1) {
+    free(luminances);
+    return nil;
+  }
+
+  int left = luminances[0] & 0xff;
+  int center = luminances[1] & 0xff;
+  for (int x = 1; x < width - 1; x++) {
+    int right = luminances[x + 1] & 0xff;
+    int luminance = ((center << 2) - left - right) >> 1;
+    if (luminance < blackPoint) {
+      [row set:x];
+    }
+    left = center;
+    center = right;
+  }
+  free(luminances);
+  return row;
+}
+
+@interface ZXGlobalHistogramBinarizerTestCase ()
+
+- (NSArray *)benchmarkSources;
+
+@end
+
+@implementation ZXGlobalHistogramBinarizerTestCase
+
+- (NSArray *)benchmarkSources {
+  NSMutableArray *sources = [NSMutableArray array];
+  NSBundle *bundle = [NSBundle bundleForClass:[self class]];
+  for (NSString *directory in [NSArray arrayWithObjects:@"Resources/benchmark/android-1", @"Resources/benchmark/android-2", nil]) {
+    for (NSString *file in [bundle pathsForResourcesOfType:nil inDirectory:directory]) {
+      NSString *extension = [[file pathExtension] lowercaseString];
+      if (![extension isEqualToString:@"jpg"] && ![extension isEqualToString:@"png"]) {
+        continue;
+      }
+      ZXImage *image = [[[ZXImage alloc] initWithURL:[NSURL fileURLWithPath:file]] autorelease];
+      [sources addObject:[[[ZXCGImageLuminanceSource alloc] initWithCGImage:image.cgimage] autorelease]];
+    }
+  }
+  return sources;
+}
+
+- (void)testBlackRowMatchesReference {
+  for (ZXLuminanceSource *source in [self benchmarkSources]) {
+    ZXGlobalHistogramBinarizer *binarizer = [[[ZXGlobalHistogramBinarizer alloc] initWithSource:source] autorelease];
+    for (int y = 0; y < source.height; y++) {
+      ZXBitArray *expected = ReferenceBlackRow(source, y);
+      ZXBitArray *actual = [binarizer blackRow:y row:nil error:nil];
+      if (expected == nil) {
+        STAssertNil(actual, @"Expected row %d to have no black point", y);
+        continue;
+      }
+      for (int x = 0; x < source.width; x++) {
+        STAssertEquals([actual get:x], [expected get:x], @"Row %d differs from reference at x=%d", y, x);
+      }
+    }
+  }
+}
+
+- (void)testBlackMatrixMatchesThreshold {
+  for (ZXLuminanceSource *source in [self benchmarkSources]) {
+    ZXGlobalHistogramBinarizer *binarizer = [[[ZXGlobalHistogramBinarizer alloc] initWithSource:source] autorelease];
+    ZXBitMatrix *matrix = [binarizer blackMatrixWithError:nil];
+    if (!matrix) {
+      continue;
+    }
+    // Every black pixel must be darker than every white one; that only holds for a single global threshold.
+    unsigned char *luminances = source.matrix;
+    int darkestWhite = 256;
+    int brightestBlack = -1;
+    for (int y = 0; y < source.height; y++) {
+      for (int x = 0; x < source.width; x++) {
+        int pixel = luminances[y * source.width + x];
+        if ([matrix getX:x y:y]) {
+          brightestBlack = MAX(brightestBlack, pixel);
+        } else {
+          darkestWhite = MIN(darkestWhite, pixel);
+        }
+      }
+    }
+    free(luminances);
+    STAssertTrue(brightestBlack < darkestWhite, @"Expected a single global threshold");
+  }
+}
+
+@end
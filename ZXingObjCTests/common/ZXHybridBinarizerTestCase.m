@@ -0,0 +1,171 @@
+/*
+ * Copyright 2012 ZXing authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import "ZXBitMatrix.h"
+#import "ZXCGImageLuminanceSource.h"
+#import "ZXHybridBinarizer.h"
+#import "ZXHybridBinarizerTestCase.h"
+#import "ZXImage.h"
+#import "ZXPlanarYUVLuminanceSource.h"
+
+/**
+ * The per-pixel implementation the binarizer used to ship with, kept as the reference output
+ * that the word-at-a-time kernels must reproduce bit for bit.
+ */
+static ZXBitMatrix *ReferenceBlackMatrix(ZXLuminanceSource *source) {
+  int width = source.width;
+  int height = source.height;
+  unsigned char *luminances = source.matrix;
+  int subWidth = (width + 7) >> 3;
+  int subHeight = (height + 7) >> 3;
+  int blackPoints[subHeight][subWidth];
+
+  for (int y = 0; y < subHeight; y++) {
+    int yoffset = MIN(y << 3, height - 8);
+    for (int x = 0; x < subWidth; x++) {
+      int xoffset = MIN(x << 3, width - 8);
+      int sum = 0;
+      int min = 0xFF;
+      int max = 0;
+      for (int yy = 0, offset = yoffset * width + xoffset; yy < 8; yy++, offset += width) {
+        for (int xx = 0; xx < 8; xx++) {
+          int pixel = luminances[offset + xx] & 0xFF;
+          sum += pixel;
+          if (pixel < min) {
+            min = pixel;
+          }
+          if (pixel > max) {
+            max = pixel;
+          }
+        }
+        if (max - min > 24) {
+          for (yy++, offset += width; yy < 8; yy++, offset += width) {
+            for (int xx = 0; xx < 8; xx++) {
+              sum += luminances[offset + xx] & 0xFF;
+            }
+          }
+        }
+      }
+
+      int average = sum >> 6;
+      if (max - min <= 24) {
+        average = min >> 1;
+        if (y > 0 && x > 0) {
+          int averageNeighborBlackPoint = (blackPoints[y - 1][x] + (2 * blackPoints[y][x - 1]) + blackPoints[y - 1][x - 1]) >> 2;
+          if (min < averageNeighborBlackPoint) {
+            average = averageNeighborBlackPoint;
+          }
+        }
+      }
+      blackPoints[y][x] = average;
+    }
+  }
+
+  ZXBitMatrix *matrix = [[[ZXBitMatrix alloc] initWithWidth:width height:height] autorelease];
+  for (int y = 0; y < subHeight; y++) {
+    int yoffset = MIN(y << 3, height - 8);
+    for (int x = 0; x < subWidth; x++) {
+      int xoffset = MIN(x << 3, width - 8);
+      int left = MIN(MAX(x, 2), subWidth - 3);
+      int top = MIN(MAX(y, 2), subHeight - 3);
+      int sum = 0;
+      for (int z = -2; z <= 2; z++) {
+        for (int w = -2; w <= 2; w++) {
+          sum += blackPoints[top + z][left + w];
+        }
+      }
+      int average = sum / 25;
+      for (int yy = 0, offset = yoffset * width + xoffset; yy < 8; yy++, offset += width) {
+        for (int xx = 0; xx < 8; xx++) {
+          if ((luminances[offset + xx] & 0xFF) <= average) {
+            [matrix setX:xoffset + xx y:yoffset + yy];
+          }
+        }
+      }
+    }
+  }
+
+  free(luminances);
+  return matrix;
+}
+
+/**
+ * A synthetic document-scanner sized frame: a smooth gradient with a grid of hard-edged dark
+ * squares, so that both the high and low contrast black point branches are exercised. The odd
+ * dimensions force clamped edge blocks.
+ */
+static ZXLuminanceSource *SyntheticSource(int width, int height) {
+  int length = width * height;
+  unsigned char *pixels = (unsigned char *)malloc(length);
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      BOOL dark = ((x / 13) & 1) && ((y / 17) & 1) && ((x * 7 + y * 3) % 101 < 60);
+      pixels[y * width + x] = dark ? 20 + (x + y) % 30 : 120 + (x * 3 + y * 5) * 100 / (width * 3 + height * 5);
+    }
+  }
+  ZXLuminanceSource *source = [[[ZXPlanarYUVLuminanceSource alloc] initWithYuvData:pixels yuvDataLen:length
+                                                                          dataWidth:width dataHeight:height
+                                                                               left:0 top:0
+                                                                              width:width height:height
+                                                                  reverseHorizontal:NO] autorelease];
+  free(pixels);
+  return source;
+}
+
+@implementation ZXHybridBinarizerTestCase
+
+- (void)testConcurrentMatchesSerial {
+  ZXLuminanceSource *source = SyntheticSource(1021, 763);
+  ZXBitMatrix *serial = [[[[ZXHybridBinarizer alloc] initWithSource:source] autorelease] blackMatrixWithError:nil];
+
+  for (int concurrency = 2; concurrency <= 16; concurrency++) {
+    ZXHybridBinarizer *binarizer = [[[ZXHybridBinarizer alloc] initWithSource:source] autorelease];
+    binarizer.concurrency = concurrency;
+    ZXBitMatrix *concurrent = [binarizer blackMatrixWithError:nil];
+    STAssertTrue(memcmp(serial.bits, concurrent.bits, serial.rowSize * serial.height * sizeof(int)) == 0,
+                 @"Expected %d bands to binarize identically to the serial path", concurrency);
+  }
+}
+
+- (void)testBlackMatrixMatchesReferenceOnBlackBoxImages {
+  NSString *base = [[[NSBundle bundleForClass:[self class]] resourcePath] stringByAppendingPathComponent:@"Resources/blackbox"];
+  NSDirectoryEnumerator *enumerator = [[NSFileManager defaultManager] enumeratorAtPath:base];
+  int compared = 0;
+
+  for (NSString *file in enumerator) {
+    NSString *extension = [[file pathExtension] lowercaseString];
+    if (![extension isEqualToString:@"jpg"] && ![extension isEqualToString:@"jpeg"] &&
+        ![extension isEqualToString:@"gif"] && ![extension isEqualToString:@"png"]) {
+      continue;
+    }
+
+    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+    ZXImage *image = [[[ZXImage alloc] initWithURL:[NSURL fileURLWithPath:[base stringByAppendingPathComponent:file]]] autorelease];
+    ZXLuminanceSource *source = [[[ZXCGImageLuminanceSource alloc] initWithCGImage:image.cgimage] autorelease];
+    if (source.width >= 40 && source.height >= 40) {
+      ZXBitMatrix *expected = ReferenceBlackMatrix(source);
+      ZXBitMatrix *actual = [[[[ZXHybridBinarizer alloc] initWithSource:source] autorelease] blackMatrixWithError:nil];
+      STAssertTrue(memcmp(expected.bits, actual.bits, expected.rowSize * expected.height * sizeof(int)) == 0,
+                   @"Expected %@ to binarize identically to the reference implementation", file);
+      compared++;
+    }
+    [pool drain];
+  }
+
+  STAssertTrue(compared > 0, @"Expected black box images");
+}
+
+@end
@@ -0,0 +1,245 @@
+/*
+ * Copyright 2012 ZXing authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import "ZXAztecReader.h"
+#import "ZXBinaryBitmap.h"
+#import "ZXBitMatrix.h"
+#import "ZXCGImageLuminanceSource.h"
+#import "ZXCode128Writer.h"
+#import "ZXDataMatrixReader.h"
+#import "ZXDecodeHints.h"
+#import "ZXErrors.h"
+#import "ZXHybridBinarizer.h"
+#import "ZXImage.h"
+#import "ZXMultiFormatOneDReader.h"
+#import "ZXMultiFormatReader.h"
+#import "ZXMultiFormatReaderTestCase.h"
+#import "ZXPDF417Reader.h"
+#import "ZXPlanarYUVLuminanceSource.h"
+#import "ZXQRCodeReader.h"
+#import "ZXQRCodeWriter.h"
+#import "ZXReaderStatistics.h"
+#import "ZXResult.h"
+
+#define IMAGES_PER_DIRECTORY 4
+
+static const int TWO_FORMAT_IMAGE_WIDTH = 300;
+static const int TWO_FORMAT_IMAGE_HEIGHT = 280;
+
+@interface ZXMultiFormatReaderTestCase ()
+
+- (NSArray *)sourcesInDirectory:(NSString *)directory;
+- (ZXBinaryBitmap *)bitmapWithSource:(ZXLuminanceSource *)source;
+- (ZXLuminanceSource *)twoFormatSource;
+
+@end
+
+@implementation ZXMultiFormatReaderTestCase
+
+- (NSArray *)sourcesInDirectory:(NSString *)directory {
+  NSString *base = [[[NSBundle bundleForClass:[self class]] resourcePath] stringByAppendingPathComponent:@"Resources/blackbox"];
+  NSString *path = [base stringByAppendingPathComponent:directory];
+  NSArray *files = [[[NSFileManager defaultManager] contentsOfDirectoryAtPath:path error:nil] sortedArrayUsingSelector:@selector(compare:)];
+  NSMutableArray *sources = [NSMutableArray array];
+
+  for (NSString *file in files) {
+    if (sources.count == IMAGES_PER_DIRECTORY) {
+      break;
+    }
+    NSString *extension = [[file pathExtension] lowercaseString];
+    if (![extension isEqualToString:@"jpg"] && ![extension isEqualToString:@"jpeg"] &&
+        ![extension isEqualToString:@"gif"] && ![extension isEqualToString:@"png"]) {
+      continue;
+    }
+    ZXImage *image = [[[ZXImage alloc] initWithURL:[NSURL fileURLWithPath:[path stringByAppendingPathComponent:file]]] autorelease];
+    [sources addObject:[[[ZXCGImageLuminanceSource alloc] initWithCGImage:image.cgimage] autorelease]];
+  }
+
+  return sources;
+}
+
+- (ZXBinaryBitmap *)bitmapWithSource:(ZXLuminanceSource *)source {
+  return [ZXBinaryBitmap binaryBitmapWithBinarizer:[[[ZXHybridBinarizer alloc] initWithSource:source] autorelease]];
+}
+
+/**
+ * A Code 128 barcode above a QR code, so that both the 1D and the QR code reader can decode it.
+ */
+- (ZXLuminanceSource *)twoFormatSource {
+  unsigned char *luminances = (unsigned char *)malloc(TWO_FORMAT_IMAGE_WIDTH * TWO_FORMAT_IMAGE_HEIGHT);
+  memset(luminances, 0xFF, TWO_FORMAT_IMAGE_WIDTH * TWO_FORMAT_IMAGE_HEIGHT);
+
+  ZXBitMatrix *code128 = [[[[ZXCode128Writer alloc] init] autorelease] encode:@"CODE-128" format:kBarcodeFormatCode128
+                                                                        width:200 height:60 error:nil];
+  ZXBitMatrix *qrCode = [[[[ZXQRCodeWriter alloc] init] autorelease] encode:@"QR CODE" format:kBarcodeFormatQRCode
+                                                                      width:150 height:150 error:nil];
+  NSArray *matrices = [NSArray arrayWithObjects:code128, qrCode, nil];
+  int tops[] = {20, 110};
+  for (int i = 0; i < matrices.count; i++) {
+    ZXBitMatrix *matrix = [matrices objectAtIndex:i];
+    int left = (TWO_FORMAT_IMAGE_WIDTH - matrix.width) / 2;
+    for (int y = 0; y < matrix.height; y++) {
+      for (int x = 0; x < matrix.width; x++) {
+        if ([matrix getX:x y:y]) {
+          luminances[(tops[i] + y) * TWO_FORMAT_IMAGE_WIDTH + left + x] = 0;
+        }
+      }
+    }
+  }
+
+  ZXPlanarYUVLuminanceSource *source = [[[ZXPlanarYUVLuminanceSource alloc] initWithYuvData:luminances
+                                                                                 yuvDataLen:TWO_FORMAT_IMAGE_WIDTH * TWO_FORMAT_IMAGE_HEIGHT
+                                                                                  dataWidth:TWO_FORMAT_IMAGE_WIDTH
+                                                                                 dataHeight:TWO_FORMAT_IMAGE_HEIGHT
+                                                                                       left:0
+                                                                                        top:0
+                                                                                      width:TWO_FORMAT_IMAGE_WIDTH
+                                                                                     height:TWO_FORMAT_IMAGE_HEIGHT
+                                                                          reverseHorizontal:NO] autorelease];
+  free(luminances);
+  return source;
+}
+
+/**
+ * The black box images hold a single barcode each, so the concurrent reader must find the same one.
+ */
+- (void)testConcurrentDecodeFindsWhatSerialDecodeFinds {
+  NSMutableArray *sources = [NSMutableArray array];
+  NSArray *directories = [NSArray arrayWithObjects:@"qrcode-1", @"datamatrix-1", @"aztec-1", @"pdf417",
+                          @"code128-1", @"ean13-1", nil];
+  for (NSString *directory in directories) {
+    [sources addObjectsFromArray:[self sourcesInDirectory:directory]];
+  }
+  STAssertTrue(sources.count > 0, @"Expected black box images");
+
+  ZXMultiFormatReader *serialReader = [ZXMultiFormatReader reader];
+  serialReader.hints = nil;
+  ZXMultiFormatReader *concurrentReader = [ZXMultiFormatReader reader];
+  concurrentReader.hints = nil;
+  concurrentReader.concurrent = YES;
+
+  int decoded = 0;
+  for (NSUInteger i = 0; i < sources.count; i++) {
+    ZXLuminanceSource *source = [sources objectAtIndex:i];
+    ZXResult *expected = [serialReader decodeWithState:[self bitmapWithSource:source] error:nil];
+    NSError *error = nil;
+    ZXResult *actual = [concurrentReader decodeWithState:[self bitmapWithSource:source] error:&error];
+    if (expected == nil) {
+      STAssertNil(actual, @"Concurrent decode of image %d found a result the serial decode did not", (int)i);
+      STAssertNotNil(error, @"Expected an error when nothing is found");
+    } else {
+      STAssertEqualObjects(actual.text, expected.text, @"Concurrent decode of image %d differs from serial decode", (int)i);
+      STAssertEquals(actual.barcodeFormat, expected.barcodeFormat, @"Concurrent decode of image %d found another format", (int)i);
+      decoded++;
+    }
+  }
+  STAssertTrue(decoded > 0, @"Expected some images to decode");
+}
+
+- (void)testConcurrentDecodeKeepsSerialOrderForTies {
+  ZXLuminanceSource *source = [self twoFormatSource];
+  // The 1D reader comes first by default and last when trying harder.
+  for (int tryHarder = 0; tryHarder < 2; tryHarder++) {
+    ZXDecodeHints *hints = [ZXDecodeHints hints];
+    hints.tryHarder = tryHarder == 1;
+    ZXBarcodeFormat expectedFormat = hints.tryHarder ? kBarcodeFormatQRCode : kBarcodeFormatCode128;
+
+    ZXMultiFormatReader *serialReader = [ZXMultiFormatReader reader];
+    serialReader.hints = hints;
+    ZXResult *expected = [serialReader decodeWithState:[self bitmapWithSource:source] error:nil];
+    STAssertNotNil(expected, @"Expected the image to decode");
+    STAssertEquals(expected.barcodeFormat, expectedFormat, @"Expected the serial order's first format");
+
+    ZXMultiFormatReader *concurrentReader = [ZXMultiFormatReader reader];
+    concurrentReader.hints = hints;
+    concurrentReader.concurrent = YES;
+    // Readers finish in a different order from run to run, so repeat to catch a race.
+    for (int i = 0; i < 10; i++) {
+      ZXResult *actual = [concurrentReader decodeWithState:[self bitmapWithSource:source] error:nil];
+      STAssertEquals(actual.barcodeFormat, expectedFormat, @"Expected the serial order's first format to win");
+      STAssertEqualObjects(actual.text, expected.text, @"Expected the serial order's result");
+    }
+  }
+}
+
+- (void)testCancelledHintsFindNothing {
+  ZXDecodeHints *hints = [ZXDecodeHints hints];
+  hints.tryHarder = YES;
+  ZXDecodeHints *cancelledHints = [[hints copy] autorelease];
+  cancelledHints.cancelled = YES;
+  STAssertTrue([[[cancelledHints copy] autorelease] cancelled], @"Expected a copy to stay cancelled");
+
+  ZXLuminanceSource *qrSource = [[self sourcesInDirectory:@"qrcode-1"] objectAtIndex:0];
+  ZXQRCodeReader *qrReader = [[[ZXQRCodeReader alloc] init] autorelease];
+  STAssertNotNil([qrReader decode:[self bitmapWithSource:qrSource] hints:hints error:nil], @"Expected the QR code to decode");
+  NSError *error = nil;
+  STAssertNil([qrReader decode:[self bitmapWithSource:qrSource] hints:cancelledHints error:&error],
+              @"Expected a cancelled QR decode to find nothing");
+  STAssertEquals(error.code, (NSInteger)ZXNotFoundError, @"Expected a not found error");
+
+  ZXLuminanceSource *oneDSource = [[self sourcesInDirectory:@"code128-1"] objectAtIndex:0];
+  ZXMultiFormatOneDReader *oneDReader = [[[ZXMultiFormatOneDReader alloc] initWithHints:hints] autorelease];
+  STAssertNotNil([oneDReader decode:[self bitmapWithSource:oneDSource] hints:hints error:nil], @"Expected the Code 128 barcode to decode");
+  error = nil;
+  STAssertNil([oneDReader decode:[self bitmapWithSource:oneDSource] hints:cancelledHints error:&error],
+              @"Expected a cancelled 1D decode to find nothing");
+  STAssertEquals(error.code, (NSInteger)ZXNotFoundError, @"Expected a not found error");
+
+  NSArray *matrixReaders = [NSArray arrayWithObjects:[[[ZXDataMatrixReader alloc] init] autorelease],
+                            [[[ZXAztecReader alloc] init] autorelease], [[[ZXPDF417Reader alloc] init] autorelease], nil];
+  NSArray *matrixDirectories = [NSArray arrayWithObjects:@"datamatrix-1", @"aztec-1", @"pdf417", nil];
+  for (int i = 0; i < matrixReaders.count; i++) {
+    id<ZXReader> reader = [matrixReaders objectAtIndex:i];
+    ZXLuminanceSource *source = [[self sourcesInDirectory:[matrixDirectories objectAtIndex:i]] objectAtIndex:0];
+    STAssertNotNil([reader decode:[self bitmapWithSource:source] hints:hints error:nil], @"Expected %@ to decode", reader);
+    error = nil;
+    STAssertNil([reader decode:[self bitmapWithSource:source] hints:cancelledHints error:&error],
+                @"Expected a cancelled decode by %@ to find nothing", reader);
+    STAssertEquals(error.code, (NSInteger)ZXNotFoundError, @"Expected a not found error");
+  }
+}
+
+- (void)testOneDStatisticsRecordOneAttemptPerDecode {
+  ZXDecodeHints *hints = [ZXDecodeHints hints];
+  hints.tryHarder = YES;
+  ZXMultiFormatOneDReader *reader = [[[ZXMultiFormatOneDReader alloc] initWithHints:hints] autorelease];
+  reader.statistics = [ZXReaderStatistics statisticsWithWindowSize:64];
+
+  NSArray *sources = [self sourcesInDirectory:@"code128-1"];
+  STAssertTrue(sources.count > 0, @"Expected black box images");
+  int decoded = 0;
+  for (ZXLuminanceSource *source in sources) {
+    if ([reader decode:[self bitmapWithSource:source] hints:hints error:nil]) {
+      decoded++;
+    }
+  }
+  STAssertTrue(decoded > 0, @"Expected the Code 128 images to decode");
+
+  // Each decode scans many rows, but counts as a single attempt for every sub-reader it tried
+  NSDictionary *statistics = [reader.statistics statistics];
+  STAssertTrue(statistics.count > 0, @"Expected attempts to be recorded");
+  for (NSString *key in statistics) {
+    NSDictionary *readerStatistics = [statistics objectForKey:key];
+    int attempts = [[readerStatistics objectForKey:ZXReaderStatisticsAttemptsKey] intValue];
+    STAssertTrue(attempts >= 1 && attempts <= (int)sources.count, @"Expected at most one attempt per decode for %@", key);
+    STAssertTrue([[readerStatistics objectForKey:ZXReaderStatisticsAverageDurationKey] doubleValue] > 0.0,
+                 @"Expected time to be recorded for %@", key);
+  }
+  NSDictionary *code128Statistics = [statistics objectForKey:@"ZXCode128Reader"];
+  STAssertEquals([[code128Statistics objectForKey:ZXReaderStatisticsHitsKey] intValue], decoded, @"Expected a hit per decode");
+}
+
+@end
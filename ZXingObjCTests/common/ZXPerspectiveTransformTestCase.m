@@ -61,6 +61,35 @@ static float EPSILON = 0.0001f;
   [self assertPointEqualsExpectedX:328.09116f expectedY:334.16385f sourceX:50.0f sourceY:50.0f pt:pt];
 }
 
+- (void)testTransformGridRow {
+  ZXPerspectiveTransform *pt = [ZXPerspectiveTransform quadrilateralToQuadrilateral:3.5f y0:3.5f
+                                                                                 x1:53.5f y1:3.5f
+                                                                                 x2:53.5f y2:53.5f
+                                                                                 x3:3.5f y3:53.5f
+                                                                                x0p:103.0f y0p:110.0f
+                                                                                x1p:300.0f y1p:120.0f
+                                                                                x2p:290.0f y2p:270.0f
+                                                                                x3p:150.0f y3p:280.0f];
+  float xValues[57];
+  float yValues[57];
+  [pt transformGridRow:20.5f count:57 xValues:xValues yValues:yValues];
+  for (int x = 0; x < 57; x++) {
+    [self assertPointEqualsExpectedX:xValues[x] expectedY:yValues[x] sourceX:x + 0.5f sourceY:20.5f pt:pt];
+  }
+}
+
+- (void)testPreservesConvexityOfPoints {
+  ZXPerspectiveTransform *pt = [ZXPerspectiveTransform squareToQuadrilateral:2.0f y0:3.0f
+                                                                          x1:10.0f y1:4.0f
+                                                                          x2:16.0f y2:15.0f
+                                                                          x3:4.0f y3:9.0f];
+  float inside[8] = {0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f};
+  STAssertTrue([pt preservesConvexityOfPoints:inside pointsLen:8], @"Expected the unit square to stay convex");
+  // Along the diagonal the denominator reaches zero at about (1.92, 1.92)
+  float across[4] = {0.0f, 0.0f, 3.0f, 3.0f};
+  STAssertFalse([pt preservesConvexityOfPoints:across pointsLen:4], @"Expected the line at infinity to be crossed");
+}
+
 - (void)assertPointEqualsExpectedX:(float)expectedX
                          expectedY:(float)expectedY
                            sourceX:(float)sourceX
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2012 ZXing authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import "ZXPlanarYUVLuminanceSource.h"
+#import "ZXPlanarYUVLuminanceSourceTestCase.h"
+
+static const int COLS = 6;
+static const int ROWS = 4;
+
+@interface ZXPlanarYUVLuminanceSourceTestCase ()
+
+- (ZXPlanarYUVLuminanceSource *)source;
+
+@end
+
+@implementation ZXPlanarYUVLuminanceSourceTestCase
+
+- (ZXPlanarYUVLuminanceSource *)source {
+  unsigned char yuv[ROWS * COLS + ROWS * COLS / 2];
+  for (int i = 0; i < sizeof(yuv); i++) {
+    yuv[i] = (unsigned char)(i * 7);
+  }
+  return [[[ZXPlanarYUVLuminanceSource alloc] initWithYuvData:yuv yuvDataLen:sizeof(yuv) dataWidth:COLS dataHeight:ROWS
+                                                         left:0 top:0 width:COLS height:ROWS reverseHorizontal:NO] autorelease];
+}
+
+- (void)testBorrowedLuminancesMatchCopies {
+  ZXPlanarYUVLuminanceSource *source = [self source];
+  int stride;
+  const unsigned char *luminances = [source borrowLuminances:&stride];
+  STAssertTrue(luminances != NULL, @"Expected YUV luminance to be readable in place");
+  STAssertEquals(stride, COLS, @"Expected the stride to be the data width");
+
+  unsigned char *matrix = source.matrix;
+  for (int y = 0; y < ROWS; y++) {
+    unsigned char *row = [source row:y];
+    STAssertTrue(memcmp(row, luminances + y * stride, COLS) == 0, @"Row %d differs from borrowed luminance", y);
+    STAssertTrue(memcmp(matrix + y * COLS, luminances + y * stride, COLS) == 0, @"Matrix row %d differs from borrowed luminance", y);
+    free(row);
+  }
+  free(matrix);
+}
+
+- (void)testCropSharesBuffer {
+  ZXPlanarYUVLuminanceSource *source = [self source];
+  int stride;
+  const unsigned char *luminances = [source borrowLuminances:&stride];
+
+  ZXLuminanceSource *cropped = [source crop:1 top:1 width:COLS - 2 height:ROWS - 2];
+  int croppedStride;
+  const unsigned char *croppedLuminances = [cropped borrowLuminances:&croppedStride];
+  STAssertEquals(croppedStride, stride, @"Expected a crop to keep the parent's stride");
+  STAssertTrue(croppedLuminances == luminances + stride + 1, @"Expected a crop to point into the parent's buffer");
+
+  for (int y = 0; y < cropped.height; y++) {
+    unsigned char *row = [cropped row:y];
+    STAssertTrue(memcmp(row, luminances + (y + 1) * stride + 1, cropped.width) == 0, @"Cropped row %d is wrong", y);
+    free(row);
+  }
+}
+
+@end
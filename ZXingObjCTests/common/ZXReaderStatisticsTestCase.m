@@ -0,0 +1,79 @@
+/*
+ * Copyright 2012 ZXing authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#import "ZXAztecReader.h"
+#import "ZXCode128Reader.h"
+#import "ZXDataMatrixReader.h"
+#import "ZXQRCodeReader.h"
+#import "ZXReaderStatistics.h"
+#import "ZXReaderStatisticsTestCase.h"
+
+@implementation ZXReaderStatisticsTestCase
+
+- (void)testKeepsDefaultOrderWithoutHits {
+  ZXReaderStatistics *statistics = [ZXReaderStatistics statisticsWithWindowSize:8];
+  NSArray *readers = [NSArray arrayWithObjects:[[[ZXQRCodeReader alloc] init] autorelease],
+                      [[[ZXDataMatrixReader alloc] init] autorelease],
+                      [[[ZXAztecReader alloc] init] autorelease], nil];
+  for (id reader in readers) {
+    [statistics recordReader:reader hit:NO duration:0.01];
+  }
+
+  STAssertEqualObjects([statistics orderedReaders:readers], readers, @"Expected the default order");
+}
+
+- (void)testOrdersByHitsPerSecond {
+  ZXReaderStatistics *statistics = [ZXReaderStatistics statisticsWithWindowSize:8];
+  ZXQRCodeReader *qrCode = [[[ZXQRCodeReader alloc] init] autorelease];
+  ZXDataMatrixReader *dataMatrix = [[[ZXDataMatrixReader alloc] init] autorelease];
+  ZXCode128Reader *code128 = [[[ZXCode128Reader alloc] init] autorelease];
+  NSArray *readers = [NSArray arrayWithObjects:qrCode, dataMatrix, code128, nil];
+
+  for (int i = 0; i < 8; i++) {
+    [statistics recordReader:qrCode hit:NO duration:0.01];
+    // Data Matrix hits as often as Code 128 but costs four times as much.
+    [statistics recordReader:dataMatrix hit:i % 2 == 0 duration:0.02];
+    [statistics recordReader:code128 hit:i % 2 == 0 duration:0.005];
+  }
+
+  NSArray *expected = [NSArray arrayWithObjects:code128, dataMatrix, qrCode, nil];
+  STAssertEqualObjects([statistics orderedReaders:readers], expected, @"Expected the cheapest likely reader first");
+}
+
+- (void)testWindowForgetsOldAttempts {
+  ZXReaderStatistics *statistics = [ZXReaderStatistics statisticsWithWindowSize:4];
+  ZXQRCodeReader *qrCode = [[[ZXQRCodeReader alloc] init] autorelease];
+  ZXDataMatrixReader *dataMatrix = [[[ZXDataMatrixReader alloc] init] autorelease];
+  NSArray *readers = [NSArray arrayWithObjects:qrCode, dataMatrix, nil];
+
+  for (int i = 0; i < 4; i++) {
+    [statistics recordReader:qrCode hit:YES duration:0.01];
+  }
+  for (int i = 0; i < 4; i++) {
+    [statistics recordReader:qrCode hit:NO duration:0.01];
+    [statistics recordReader:dataMatrix hit:YES duration:0.01];
+  }
+
+  STAssertEquals([[statistics orderedReaders:readers] objectAtIndex:0], (id)dataMatrix, @"Expected old QR code hits to be forgotten");
+
+  NSDictionary *qrCodeStatistics = [[statistics statistics] objectForKey:@"ZXQRCodeReader"];
+  STAssertEquals([[qrCodeStatistics objectForKey:ZXReaderStatisticsAttemptsKey] intValue], 4, @"Expected a full window");
+  STAssertEquals([[qrCodeStatistics objectForKey:ZXReaderStatisticsHitsKey] intValue], 0, @"Expected no hits in the window");
+  STAssertEqualsWithAccuracy([[qrCodeStatistics objectForKey:ZXReaderStatisticsAverageDurationKey] doubleValue], 0.01, 1e-9, @"Expected the average duration");
+}
+
+@end
@@ -0,0 +1,135 @@
+/*
+ * Copyright 2012 ZXing authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#import "ZXBinaryBitmap.h"
+#import "ZXCGImageLuminanceSource.h"
+#import "ZXGenericGF.h"
+#import "ZXGridSampler.h"
+#import "ZXHybridBinarizer.h"
+#import "ZXImage.h"
+#import "ZXMultiFormatReader.h"
+#import "ZXQRCodeVersion.h"
+#import "ZXResult.h"
+#import "ZXSharedTables.h"
+#import "ZXSharedTablesTestCase.h"
+
+#define STRESS_IMAGES_PER_DIRECTORY 4
+#define STRESS_ROUNDS 8
+
+@interface ZXSharedTablesTestCase ()
+
+- (NSArray *)stressSources;
+- (NSString *)decode:(ZXLuminanceSource *)source;
+
+@end
+
+@implementation ZXSharedTablesTestCase
+
+- (NSArray *)stressSources {
+  NSString *base = [[[NSBundle bundleForClass:[self class]] resourcePath] stringByAppendingPathComponent:@"Resources/blackbox"];
+  NSArray *directories = [NSArray arrayWithObjects:@"qrcode-1", @"datamatrix-1", @"aztec-1", @"pdf417",
+                          @"code128-1", @"ean13-1", @"rss14-1", @"rssexpanded-1", nil];
+  NSMutableArray *sources = [NSMutableArray array];
+
+  for (NSString *directory in directories) {
+    NSString *path = [base stringByAppendingPathComponent:directory];
+    NSArray *files = [[[NSFileManager defaultManager] contentsOfDirectoryAtPath:path error:nil] sortedArrayUsingSelector:@selector(compare:)];
+    int count = 0;
+    for (NSString *file in files) {
+      if (count == STRESS_IMAGES_PER_DIRECTORY) {
+        break;
+      }
+      NSString *extension = [[file pathExtension] lowercaseString];
+      if (![extension isEqualToString:@"jpg"] && ![extension isEqualToString:@"jpeg"] &&
+          ![extension isEqualToString:@"gif"] && ![extension isEqualToString:@"png"]) {
+        continue;
+      }
+      ZXImage *image = [[[ZXImage alloc] initWithURL:[NSURL fileURLWithPath:[path stringByAppendingPathComponent:file]]] autorelease];
+      [sources addObject:[[[ZXCGImageLuminanceSource alloc] initWithCGImage:image.cgimage] autorelease]];
+      count++;
+    }
+  }
+
+  return sources;
+}
+
+- (NSString *)decode:(ZXLuminanceSource *)source {
+  ZXBinaryBitmap *bitmap = [[[ZXBinaryBitmap alloc] initWithBinarizer:[[[ZXHybridBinarizer alloc] initWithSource:source] autorelease]] autorelease];
+  ZXResult *result = [[ZXMultiFormatReader reader] decode:bitmap error:nil];
+  return result ? result.text : (NSString *)[NSNull null];
+}
+
+- (void)testInitializeSharedTablesFromManyThreads {
+  ZXGenericGF *fields[64];
+  ZXQRCodeVersion *versions[64];
+  ZXGridSampler *samplers[64];
+  ZXGenericGF **fieldsOut = fields;
+  ZXQRCodeVersion **versionsOut = versions;
+  ZXGridSampler **samplersOut = samplers;
+
+  dispatch_apply(64, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+    [ZXSharedTables initializeSharedTables];
+    fieldsOut[i] = [ZXGenericGF QrCodeField256];
+    versionsOut[i] = [ZXQRCodeVersion versionForNumber:7];
+    samplersOut[i] = [ZXGridSampler instance];
+  });
+
+  for (int i = 1; i < 64; i++) {
+    STAssertEquals(fields[i], fields[0], @"Expected a single shared QR code field");
+    STAssertEquals(versions[i], versions[0], @"Expected a single shared version table");
+    STAssertEquals(samplers[i], samplers[0], @"Expected a single shared grid sampler");
+  }
+}
+
+/**
+ * Decodes every format from many threads at once, without warming the tables first, and
+ * checks each thread sees exactly what a serial decode of the same image produces.
+ */
+- (void)testConcurrentDecodeMatchesSerial {
+  NSArray *sources = [self stressSources];
+  NSUInteger count = sources.count;
+  STAssertTrue(count > 0, @"Expected black box images");
+
+  NSMutableArray *concurrentTexts = [NSMutableArray arrayWithCapacity:count * STRESS_ROUNDS];
+  for (NSUInteger i = 0; i < count * STRESS_ROUNDS; i++) {
+    [concurrentTexts addObject:[NSNull null]];
+  }
+  NSLock *lock = [[[NSLock alloc] init] autorelease];
+  dispatch_apply(count * STRESS_ROUNDS, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+    NSString *text = [self decode:[sources objectAtIndex:i % count]];
+    [lock lock];
+    [concurrentTexts replaceObjectAtIndex:i withObject:text];
+    [lock unlock];
+    [pool drain];
+  });
+
+  int decoded = 0;
+  for (NSUInteger i = 0; i < count; i++) {
+    NSString *expected = [self decode:[sources objectAtIndex:i]];
+    if (expected != (NSString *)[NSNull null]) {
+      decoded++;
+    }
+    for (int round = 0; round < STRESS_ROUNDS; round++) {
+      STAssertEqualObjects([concurrentTexts objectAtIndex:round * count + i], expected,
+                           @"Concurrent decode of image %d in round %d differs from serial decode", i, round);
+    }
+  }
+  STAssertTrue(decoded > 0, @"Expected some images to decode");
+}
+
+@end
@@ -417,6 +417,48 @@ const int RANDOM_SEED = 3735928559;
   [self testEncodeDecodeRandom:[ZXGenericGF AztecData12] dataSize:3072 ecSize:1023];
 }
 
+- (void)testSharedEncoder {
+  ZXReedSolomonEncoder *qrEncoder = [ZXReedSolomonEncoder encoderForField:[ZXGenericGF QrCodeField256]];
+  STAssertEquals(qrEncoder, [ZXReedSolomonEncoder encoderForField:[ZXGenericGF QrCodeField256]], @"Expected one encoder per field");
+  STAssertEquals([ZXReedSolomonEncoder encoderForField:[ZXGenericGF AztecData8]],
+                 [ZXReedSolomonEncoder encoderForField:[ZXGenericGF DataMatrixField256]], @"Expected equal fields to share an encoder");
+  STAssertFalse(qrEncoder == [ZXReedSolomonEncoder encoderForField:[ZXGenericGF DataMatrixField256]],
+                @"Expected fields with different generator bases to use different encoders");
+}
+
+- (void)testSharedEncoderConcurrently {
+  ZXGenericGF *field = [ZXGenericGF AztecData10];
+  const int dataSize = 100;
+  const int maxEcSize = 60;
+  int dataWords[dataSize];
+  srand(RANDOM_SEED);
+  for (int i = 0; i < dataSize; i++) {
+    dataWords[i] = rand() % field.size;
+  }
+  int *expected = (int *)calloc((maxEcSize + 1) * maxEcSize, sizeof(int));
+  ZXReedSolomonEncoder *reference = [[[ZXReedSolomonEncoder alloc] initWithField:field] autorelease];
+  for (int ecSize = 1; ecSize <= maxEcSize; ecSize++) {
+    [reference encodeData:dataWords dataLen:dataSize ecWords:expected + ecSize * maxEcSize ecLen:ecSize];
+  }
+
+  // Blocks can't capture arrays, so hand the data in through a pointer.
+  const int *data = dataWords;
+  __block int mismatches = 0;
+  ZXReedSolomonEncoder *shared = [ZXReedSolomonEncoder encoderForField:field];
+  dispatch_apply(maxEcSize * 8, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+    int ecSize = (int)(i % maxEcSize) + 1;
+    int ecWords[ecSize];
+    [shared encodeData:data dataLen:dataSize ecWords:ecWords ecLen:ecSize];
+    if (memcmp(ecWords, expected + ecSize * maxEcSize, ecSize * sizeof(int)) != 0) {
+      @synchronized(self) {
+        mismatches++;
+      }
+    }
+  });
+  free(expected);
+  STAssertEquals(mismatches, 0, @"Expected concurrent encodes to match a private encoder");
+}
+
 - (void)corrupt:(int *)received receivedLen:(int)receivedLen howMany:(int)howMany max:(int)max {
   BOOL corrupted[receivedLen];
   for (int i = 0; i < receivedLen; i++) {
@@ -475,6 +517,11 @@ const int RANDOM_SEED = 3735928559;
   [encoder encode:message toEncodeLen:length ecBytes:ecWordsLen];
   [self assertDataEqualsExpected:messageExpected received:message length:length
                          message:[NSString stringWithFormat:@"Encode in %@ (%d,%d) failed", field, dataWordsLen, ecWordsLen]];
+
+  int sharedEcWords[ecWordsLen];
+  [[ZXReedSolomonEncoder encoderForField:field] encodeData:dataWords dataLen:dataWordsLen ecWords:sharedEcWords ecLen:ecWordsLen];
+  [self assertDataEqualsExpected:ecWords received:sharedEcWords length:ecWordsLen
+                         message:[NSString stringWithFormat:@"Shared encode in %@ (%d,%d) failed", field, dataWordsLen, ecWordsLen]];
 }
 
 - (void)testDecoder:(ZXGenericGF *)field dataWords:(int *)dataWords dataWordsLen:(int)dataWordsLen ecWords:(int *)ecWords ecWordsLen:(int)ecWordsLen {
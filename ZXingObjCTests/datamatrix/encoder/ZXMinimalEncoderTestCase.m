@@ -0,0 +1,101 @@
+/*
+ * Copyright 2013 ZXing authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import "ZXDataMatrixDecodedBitStreamParser.h"
+#import "ZXDecoderResult.h"
+#import "ZXHighLevelEncoder.h"
+#import "ZXHighLevelEncodeTestCase.h"
+#import "ZXMinimalEncoder.h"
+#import "ZXMinimalEncoderTestCase.h"
+#import "ZXSymbolShapeHint.h"
+
+@interface ZXMinimalEncoderTestCase ()
+
+- (NSArray *)messages;
+- (NSString *)encodeHighLevel:(NSString *)msg;
+
+@end
+
+@implementation ZXMinimalEncoderTestCase
+
+- (NSArray *)messages {
+  return [NSArray arrayWithObjects:@"123456", @"123456£", @"30Q324343430794<OQQ", @"AIMAIMAIM", @"AIMAIAB", @"AIMAIAb",
+          @"AIMAIMAIMË", @"AIMAIMAIMë", @"A1B2C3D4E5F6G7H8I9J0K1L2", @"AIMAIMAIMAIMAIMAIM", @"AIMAIMAIMAIMAIMAI",
+          @"AIMAIMAIMAIMAIMA", @"AIMAIMAIMA", @"AIMAIMAIMAIMAIMAIMAI", @"aimaimaim", @"aimaimaim'", @"aimaimaIm",
+          @"aimaimaimB", @"ABC>ABC123>AB", @"ABC>ABC123>ABC", @"ABC>ABC123>ABCD", @"ABC>ABC123>ABCDE",
+          @"ABC>ABC123>ABCDEF", @".A.C1.3.DATA.123DATA.123DATA", @".A.C1.3.X.X2..", @".A.C1.3.X.X2.", @".A.C1.3.X.X2",
+          @".A.C1.3.X.X", @".A.C1.3.X.", @".A.C1.3.X", @"«äöüéàá-", @"«äöüéàá-«äöüéàá-«äöüéàá-", @"CREX-TAN:h",
+          @"CREX-TAN:hh", @"CREX-TAN:hhh", @"http://www.example.com/item?id=12345&lot=ABC-987", nil];
+}
+
+- (NSString *)encodeHighLevel:(NSString *)msg {
+  return [ZXHighLevelEncodeTestCase visualize:[ZXMinimalEncoder encodeHighLevel:msg]];
+}
+
+- (void)testEncodations {
+  STAssertEqualObjects([self encodeHighLevel:@"123456"], @"142 164 186", @"");
+  STAssertEqualObjects([self encodeHighLevel:@"AIMAIMAIM"], @"230 91 11 91 11 91 11 254", @"");
+  //The last value is read as ASCII when a single codeword remains after a Text triplet
+  STAssertEqualObjects([self encodeHighLevel:@"aimaimaim'"], @"239 91 11 91 11 91 11 40", @"");
+  STAssertEqualObjects([self encodeHighLevel:@"aimaimaimB"], @"239 91 11 91 11 91 11 67", @"");
+  //The two last values are read as ASCII when two codewords remain after an EDIFACT quadruplet
+  STAssertEqualObjects([self encodeHighLevel:@"CREX-TAN:hh"], @"68 240 72 86 45 80 19 186 105 105", @"");
+
+  NSString *visualized = [self encodeHighLevel:[NSString stringWithFormat:@"[)>%C05%C5555%C6666%C%C",
+                                                (unichar)0x001E, (unichar)0x001D, (unichar)0x001C,
+                                                (unichar)0x001E, (unichar)0x0004]];
+  STAssertEqualObjects(visualized, @"236 185 185 29 196 196 129 56", @"");
+}
+
+- (void)testNeverLongerThanHighLevelEncoder {
+  for (NSString *msg in [self messages]) {
+    NSString *minimal = [ZXMinimalEncoder encodeHighLevel:msg];
+    NSString *highLevel = [ZXHighLevelEncoder encodeHighLevel:msg];
+    STAssertTrue(minimal.length <= highLevel.length, @"Expected %@ to fit in %d codewords, got %d",
+                 msg, (int)highLevel.length, (int)minimal.length);
+  }
+}
+
+- (void)testRoundTrip {
+  NSMutableString *mixed = [NSMutableString string];
+  for (int i = 0; i < 40; i++) {
+    [mixed appendFormat:@"LOT%04d-ab %C%C*>\r", i * 37, (unichar)(0xC0 + i % 32), (unichar)(0xE0 + i % 32)];
+  }
+  NSArray *messages = [[self messages] arrayByAddingObject:mixed];
+  unsigned char codewords[1558];
+  for (NSString *msg in messages) {
+    NSData *data = [msg dataUsingEncoding:NSISOLatin1StringEncoding];
+    int count = [ZXMinimalEncoder encodeBytes:(const unsigned char *)data.bytes length:(int)data.length
+                                        shape:[ZXSymbolShapeHint forceNone] minSize:nil maxSize:nil
+                                    codewords:codewords capacity:DATA_MATRIX_MAX_DATA_CODEWORDS];
+    ZXDecoderResult *result = [ZXDataMatrixDecodedBitStreamParser decode:codewords length:count error:nil];
+    STAssertEqualObjects(result.text, msg, @"Expected the codewords to decode to the message");
+  }
+}
+
+- (void)testCapacityTooSmall {
+  unsigned char codewords[3];
+  const char *msg = "AIMAIMAIMAIM";
+  @try {
+    [ZXMinimalEncoder encodeBytes:(const unsigned char *)msg length:(int)strlen(msg) shape:[ZXSymbolShapeHint forceNone]
+                          minSize:nil maxSize:nil codewords:codewords capacity:3];
+    STFail(@"The message needs more than 3 codewords");
+  } @catch (NSException *exception) {
+    // expected
+  }
+}
+
+@end
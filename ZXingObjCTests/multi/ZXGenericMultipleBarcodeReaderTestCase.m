@@ -0,0 +1,223 @@
+/*
+ * Copyright 2012 ZXing authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import "ZXBinaryBitmap.h"
+#import "ZXBitMatrix.h"
+#import "ZXCode128Reader.h"
+#import "ZXCode128Writer.h"
+#import "ZXDecodeHints.h"
+#import "ZXGenericMultipleBarcodeReader.h"
+#import "ZXGenericMultipleBarcodeReaderTestCase.h"
+#import "ZXHybridBinarizer.h"
+#import "ZXMultiFormatReader.h"
+#import "ZXPlanarYUVLuminanceSource.h"
+#import "ZXQRCodeWriter.h"
+#import "ZXResult.h"
+#import "ZXResultPoint.h"
+
+static const int MULTI_IMAGE_WIDTH = 440;
+static const int MULTI_IMAGE_HEIGHT = 100;
+static const int MIXED_IMAGE_WIDTH = 560;
+static const int MIXED_IMAGE_HEIGHT = 300;
+
+@interface ZXGenericMultipleBarcodeReaderTestCase ()
+
+- (ZXBinaryBitmap *)twoBarcodeBitmap;
+- (ZXBinaryBitmap *)mixedBarcodeBitmap;
+- (ZXDecodeHints *)mixedBarcodeHints;
+- (void)assertMixedResults:(NSArray *)results;
+
+@end
+
+@implementation ZXGenericMultipleBarcodeReaderTestCase
+
+/**
+ * Two Code 128 barcodes side by side, so the area right of the first one found starts at an
+ * offset that is not a multiple of 32.
+ */
+- (ZXBinaryBitmap *)twoBarcodeBitmap {
+  unsigned char *luminances = (unsigned char *)malloc(MULTI_IMAGE_WIDTH * MULTI_IMAGE_HEIGHT);
+  memset(luminances, 0xFF, MULTI_IMAGE_WIDTH * MULTI_IMAGE_HEIGHT);
+
+  ZXCode128Writer *writer = [[[ZXCode128Writer alloc] init] autorelease];
+  NSArray *contents = [NSArray arrayWithObjects:@"LEFT-1234", @"RIGHT-5678", nil];
+  for (int i = 0; i < contents.count; i++) {
+    ZXBitMatrix *matrix = [writer encode:[contents objectAtIndex:i] format:kBarcodeFormatCode128 width:200 height:60 hints:nil error:nil];
+    int left = 10 + i * 225;
+    for (int y = 0; y < matrix.height; y++) {
+      for (int x = 0; x < matrix.width; x++) {
+        if ([matrix getX:x y:y]) {
+          luminances[(20 + y) * MULTI_IMAGE_WIDTH + left + x] = 0;
+        }
+      }
+    }
+  }
+
+  ZXPlanarYUVLuminanceSource *source = [[[ZXPlanarYUVLuminanceSource alloc] initWithYuvData:luminances
+                                                                                 yuvDataLen:MULTI_IMAGE_WIDTH * MULTI_IMAGE_HEIGHT
+                                                                                  dataWidth:MULTI_IMAGE_WIDTH
+                                                                                 dataHeight:MULTI_IMAGE_HEIGHT
+                                                                                       left:0
+                                                                                        top:0
+                                                                                      width:MULTI_IMAGE_WIDTH
+                                                                                     height:MULTI_IMAGE_HEIGHT
+                                                                          reverseHorizontal:NO] autorelease];
+  free(luminances);
+  return [[[ZXBinaryBitmap alloc] initWithBinarizer:[[[ZXHybridBinarizer alloc] initWithSource:source] autorelease]] autorelease];
+}
+
+/**
+ * A Code 128 barcode left of a QR code. The 1D reader runs first and finds the Code 128 barcode,
+ * so the QR code is only found in the area right of it, cut out of the shared black matrix.
+ */
+- (ZXBinaryBitmap *)mixedBarcodeBitmap {
+  unsigned char *luminances = (unsigned char *)malloc(MIXED_IMAGE_WIDTH * MIXED_IMAGE_HEIGHT);
+  memset(luminances, 0xFF, MIXED_IMAGE_WIDTH * MIXED_IMAGE_HEIGHT);
+
+  ZXBitMatrix *code128 = [[[[ZXCode128Writer alloc] init] autorelease] encode:@"LEFT-1234" format:kBarcodeFormatCode128
+                                                                        width:200 height:60 hints:nil error:nil];
+  ZXBitMatrix *qrCode = [[[[ZXQRCodeWriter alloc] init] autorelease] encode:@"RIGHT-QR-5678" format:kBarcodeFormatQRCode
+                                                                      width:220 height:220 hints:nil error:nil];
+  NSArray *matrices = [NSArray arrayWithObjects:code128, qrCode, nil];
+  int lefts[] = {20, 310};
+  int tops[] = {120, 40};
+  for (int i = 0; i < matrices.count; i++) {
+    ZXBitMatrix *matrix = [matrices objectAtIndex:i];
+    for (int y = 0; y < matrix.height; y++) {
+      for (int x = 0; x < matrix.width; x++) {
+        if ([matrix getX:x y:y]) {
+          luminances[(tops[i] + y) * MIXED_IMAGE_WIDTH + lefts[i] + x] = 0;
+        }
+      }
+    }
+  }
+
+  ZXPlanarYUVLuminanceSource *source = [[[ZXPlanarYUVLuminanceSource alloc] initWithYuvData:luminances
+                                                                                 yuvDataLen:MIXED_IMAGE_WIDTH * MIXED_IMAGE_HEIGHT
+                                                                                  dataWidth:MIXED_IMAGE_WIDTH
+                                                                                 dataHeight:MIXED_IMAGE_HEIGHT
+                                                                                       left:0
+                                                                                        top:0
+                                                                                      width:MIXED_IMAGE_WIDTH
+                                                                                     height:MIXED_IMAGE_HEIGHT
+                                                                          reverseHorizontal:NO] autorelease];
+  free(luminances);
+  ZXBinaryBitmap *bitmap = [[[ZXBinaryBitmap alloc] initWithBinarizer:[[[ZXHybridBinarizer alloc] initWithSource:source] autorelease]] autorelease];
+  // With the black matrix computed the areas around the first barcode are cut out of it.
+  STAssertNotNil([bitmap blackMatrixWithError:nil], @"Expected the image to binarize");
+  return bitmap;
+}
+
+- (ZXDecodeHints *)mixedBarcodeHints {
+  ZXDecodeHints *hints = [ZXDecodeHints hints];
+  [hints addPossibleFormat:kBarcodeFormatCode128];
+  [hints addPossibleFormat:kBarcodeFormatQRCode];
+  return hints;
+}
+
+- (void)assertMixedResults:(NSArray *)results {
+  STAssertEquals(results.count, (NSUInteger)2, @"Expected both barcodes once each");
+  if (results.count != 2) {
+    return;
+  }
+
+  ZXResult *code128 = [results objectAtIndex:0];
+  STAssertEqualObjects(code128.text, @"LEFT-1234", @"Expected the Code 128 barcode to be found first");
+  STAssertEquals(code128.barcodeFormat, kBarcodeFormatCode128, @"");
+
+  ZXResult *qrCode = [results objectAtIndex:1];
+  STAssertEqualObjects(qrCode.text, @"RIGHT-QR-5678", @"Expected the QR code in the area right of it");
+  STAssertEquals(qrCode.barcodeFormat, kBarcodeFormatQRCode, @"");
+  // Points found in the cropped area are translated back to the whole image.
+  for (ZXResultPoint *point in qrCode.resultPoints) {
+    STAssertTrue(point.x > 310 && point.x < 530 && point.y > 40 && point.y < 260,
+                 @"Expected the QR code's points where it was drawn, got (%f,%f)", point.x, point.y);
+  }
+}
+
+- (void)testCropBinarizedMatchesParent {
+  ZXBinaryBitmap *bitmap = [self twoBarcodeBitmap];
+  ZXBitMatrix *parent = [bitmap blackMatrixWithError:nil];
+  STAssertNotNil(parent, @"Expected the image to binarize");
+
+  int left = 37;
+  int top = 11;
+  ZXBinaryBitmap *cropped = [bitmap cropBinarized:left top:top width:301 height:70];
+  ZXBitMatrix *region = [cropped blackMatrixWithError:nil];
+  STAssertEquals(region.width, 301, @"");
+  STAssertEquals(region.height, 70, @"");
+  for (int y = 0; y < region.height; y++) {
+    for (int x = 0; x < region.width; x++) {
+      if ([region getX:x y:y] != [parent getX:left + x y:top + y]) {
+        STFail(@"Cropped black matrix differs from the parent at (%d,%d)", x, y);
+        return;
+      }
+    }
+  }
+}
+
+- (void)testDecodeMultiple {
+  ZXBinaryBitmap *bitmap = [self twoBarcodeBitmap];
+  // With the black matrix computed the areas around the first barcode are cut out of it.
+  STAssertNotNil([bitmap blackMatrixWithError:nil], @"Expected the image to binarize");
+
+  ZXGenericMultipleBarcodeReader *reader =
+    [[[ZXGenericMultipleBarcodeReader alloc] initWithDelegate:[[[ZXCode128Reader alloc] init] autorelease]] autorelease];
+  NSError *error = nil;
+  NSArray *results = [reader decodeMultiple:bitmap error:&error];
+  STAssertNotNil(results, @"Expected to decode the image: %@", error);
+  STAssertEquals(results.count, (NSUInteger)2, @"Expected both barcodes");
+
+  for (ZXResult *result in results) {
+    BOOL right = [result.text isEqualToString:@"RIGHT-5678"];
+    STAssertTrue(right || [result.text isEqualToString:@"LEFT-1234"], @"Unexpected result %@", result.text);
+    // Points found in a cropped area are translated back to the whole image.
+    for (ZXResultPoint *point in result.resultPoints) {
+      STAssertEquals(right, point.x > 220, @"Expected %@ to be reported on its own side at x=%f", result.text, point.x);
+    }
+  }
+}
+
+- (void)testDecodeMultipleWithMatrixReader {
+  ZXGenericMultipleBarcodeReader *reader =
+    [[[ZXGenericMultipleBarcodeReader alloc] initWithDelegate:[ZXMultiFormatReader reader]] autorelease];
+  NSError *error = nil;
+  NSArray *results = [reader decodeMultiple:[self mixedBarcodeBitmap] hints:[self mixedBarcodeHints] error:&error];
+  STAssertNotNil(results, @"Expected to decode the image: %@", error);
+  [self assertMixedResults:results];
+}
+
+- (void)testDecodeMultipleConcurrently {
+  ZXGenericMultipleBarcodeReader *reader =
+    [[[ZXGenericMultipleBarcodeReader alloc] initWithDelegate:[ZXMultiFormatReader reader]] autorelease];
+  __block int factoryCalls = 0;
+  reader.delegateFactory = ^id<ZXReader>(void) {
+    __sync_fetch_and_add(&factoryCalls, 1);
+    return [ZXMultiFormatReader reader];
+  };
+
+  // The QR code lies partly in the areas above and below the Code 128 barcode too, so those are
+  // searched alongside the area right of it and their results merged.
+  for (int i = 0; i < 5; i++) {
+    NSError *error = nil;
+    NSArray *results = [reader decodeMultiple:[self mixedBarcodeBitmap] hints:[self mixedBarcodeHints] error:&error];
+    STAssertNotNil(results, @"Expected to decode the image: %@", error);
+    [self assertMixedResults:results];
+  }
+  STAssertTrue(factoryCalls > 0, @"Expected the areas to be searched with readers from the factory");
+}
+
+@end
@@ -14,8 +14,151 @@
  * limitations under the License.
  */
 
+#import "ZXModulusGF.h"
+#import "ZXModulusPoly.h"
 #import "ZXPDF417ECErrorCorrection.h"
 #import "ZXPDF417ECErrorCorrectionTestCase.h"
+#import "ZXPDF417ErrorCorrection.h"
+
+/**
+ * The polynomial-object implementation decode: used to ship with, kept as the reference that the
+ * int array decoder must agree with, including on inputs with more errors than it can correct.
+ */
+static NSArray *ReferenceEuclideanAlgorithm(ZXModulusGF *field, ZXModulusPoly *a, ZXModulusPoly *b, int R) {
+  // Assume a's degree is >= b's
+  if (a.degree < b.degree) {
+    ZXModulusPoly *temp = a;
+    a = b;
+    b = temp;
+  }
+
+  ZXModulusPoly *rLast = a;
+  ZXModulusPoly *r = b;
+  ZXModulusPoly *tLast = field.zero;
+  ZXModulusPoly *t = field.one;
+
+  // Run Euclidean algorithm until r's degree is less than R/2
+  while (r.degree >= R / 2) {
+    ZXModulusPoly *rLastLast = rLast;
+    ZXModulusPoly *tLastLast = tLast;
+    rLast = r;
+    tLast = t;
+
+    // Divide rLastLast by rLast, with quotient in q and remainder in r
+    if (rLast.zero) {
+      // Oops, Euclidean algorithm already terminated?
+      return nil;
+    }
+    r = rLastLast;
+    ZXModulusPoly *q = field.zero;
+    int denominatorLeadingTerm = [rLast coefficient:rLast.degree];
+    int dltInverse = [field inverse:denominatorLeadingTerm];
+    while (r.degree >= rLast.degree && !r.zero) {
+      int degreeDiff = r.degree - rLast.degree;
+      int scale = [field multiply:[r coefficient:r.degree] b:dltInverse];
+      q = [q add:[field buildMonomial:degreeDiff coefficient:scale]];
+      r = [r subtract:[rLast multiplyByMonomial:degreeDiff coefficient:scale]];
+    }
+
+    t = [[[q multiply:tLast] subtract:tLastLast] negative];
+  }
+
+  int sigmaTildeAtZero = [t coefficient:0];
+  if (sigmaTildeAtZero == 0) {
+    return nil;
+  }
+
+  int inverse = [field inverse:sigmaTildeAtZero];
+  ZXModulusPoly *sigma = [t multiplyScalar:inverse];
+  ZXModulusPoly *omega = [r multiplyScalar:inverse];
+  return [NSArray arrayWithObjects:sigma, omega, nil];
+}
+
+static NSArray *ReferenceErrorLocations(ZXModulusGF *field, ZXModulusPoly *errorLocator) {
+  // This is a direct application of Chien's search
+  int numErrors = errorLocator.degree;
+  NSMutableArray *result = [NSMutableArray arrayWithCapacity:numErrors];
+  for (int i = 1; i < field.size && result.count < numErrors; i++) {
+    if ([errorLocator evaluateAt:i] == 0) {
+      [result addObject:[NSNumber numberWithInt:[field inverse:i]]];
+    }
+  }
+  if (result.count != numErrors) {
+    return nil;
+  }
+  return result;
+}
+
+static NSArray *ReferenceErrorMagnitudes(ZXModulusGF *field, ZXModulusPoly *errorEvaluator, ZXModulusPoly *errorLocator, NSArray *errorLocations) {
+  int errorLocatorDegree = errorLocator.degree;
+  int formalDerivativeCoefficients[errorLocatorDegree];
+  for (int i = 0; i < errorLocatorDegree; i++) {
+    formalDerivativeCoefficients[i] = 0;
+  }
+
+  for (int i = 1; i <= errorLocatorDegree; i++) {
+    formalDerivativeCoefficients[errorLocatorDegree - i] = [field multiply:i b:[errorLocator coefficient:i]];
+  }
+  ZXModulusPoly *formalDerivative = [[[ZXModulusPoly alloc] initWithField:field coefficients:formalDerivativeCoefficients coefficientsLen:errorLocatorDegree] autorelease];
+
+  // This is directly applying Forney's Formula
+  int s = errorLocations.count;
+  NSMutableArray *result = [NSMutableArray arrayWithCapacity:s];
+  for (int i = 0; i < s; i++) {
+    int xiInverse = [field inverse:[[errorLocations objectAtIndex:i] intValue]];
+    int numerator = [field subtract:0 b:[errorEvaluator evaluateAt:xiInverse]];
+    int denominator = [field inverse:[formalDerivative evaluateAt:xiInverse]];
+    [result addObject:[NSNumber numberWithInt:[field multiply:numerator b:denominator]]];
+  }
+  return result;
+}
+
+static BOOL ReferenceDecode(NSMutableArray *received, int numECCodewords) {
+  ZXModulusGF *field = [ZXModulusGF PDF417_GF];
+  int coefficients[received.count];
+  for (int i = 0; i < received.count; i++) {
+    coefficients[i] = [[received objectAtIndex:i] intValue];
+  }
+  ZXModulusPoly *poly = [[[ZXModulusPoly alloc] initWithField:field coefficients:coefficients coefficientsLen:received.count] autorelease];
+
+  int S[numECCodewords];
+  BOOL error = NO;
+  for (int i = numECCodewords; i > 0; i--) {
+    int eval = [poly evaluateAt:[field exp:i]];
+    S[numECCodewords - i] = eval;
+    if (eval != 0) {
+      error = YES;
+    }
+  }
+  if (!error) {
+    return YES;
+  }
+
+  ZXModulusPoly *syndrome = [[[ZXModulusPoly alloc] initWithField:field coefficients:S coefficientsLen:numECCodewords] autorelease];
+  NSArray *sigmaOmega = ReferenceEuclideanAlgorithm(field, [field buildMonomial:numECCodewords coefficient:1], syndrome, numECCodewords);
+  if (!sigmaOmega) {
+    return NO;
+  }
+
+  ZXModulusPoly *sigma = [sigmaOmega objectAtIndex:0];
+  ZXModulusPoly *omega = [sigmaOmega objectAtIndex:1];
+  NSArray *errorLocations = ReferenceErrorLocations(field, sigma);
+  if (!errorLocations) {
+    return NO;
+  }
+  NSArray *errorMagnitudes = ReferenceErrorMagnitudes(field, omega, sigma, errorLocations);
+
+  for (int i = 0; i < errorLocations.count; i++) {
+    int position = received.count - 1 - [field log:[[errorLocations objectAtIndex:i] intValue]];
+    if (position < 0) {
+      return NO;
+    }
+    [received replaceObjectAtIndex:position
+                        withObject:[NSNumber numberWithInt:[field subtract:[[received objectAtIndex:position] intValue]
+                                                                         b:[[errorMagnitudes objectAtIndex:i] intValue]]]];
+  }
+  return YES;
+}
 
 @interface ZXPDF417ECErrorCorrectionTestCase ()
 
@@ -158,6 +301,87 @@ const int MAX_ERRORS = ERROR_LIMIT / 2;
   STAssertFalse([self checkDecode:received], @"Should not have decoded");
 }
 
+- (void)testMaxErrorsInIntArray {
+  int receivedLen = PDF417_TEST_WITH_EC.count;
+  for (int i = 0; i < PDF417_TEST.count; i++) {
+    NSMutableArray *corrupted = [NSMutableArray arrayWithArray:PDF417_TEST_WITH_EC];
+    [self corrupt:corrupted howMany:MAX_ERRORS];
+    int received[receivedLen];
+    for (int j = 0; j < receivedLen; j++) {
+      received[j] = [[corrupted objectAtIndex:j] intValue];
+    }
+
+    STAssertTrue([self.ec decode:received receivedLen:receivedLen numECCodewords:ECC_BYTES erasures:NULL erasuresLen:0], @"Expected to decode");
+    for (int j = 0; j < receivedLen; j++) {
+      STAssertEquals(received[j], [[PDF417_TEST_WITH_EC objectAtIndex:j] intValue], @"Expected codeword %d to be corrected", j);
+    }
+  }
+}
+
+- (void)testDecodeAllECLevels {
+  const int dataLen = 400;
+  for (int level = 0; level <= 8; level++) {
+    int numECCodewords = [ZXPDF417ErrorCorrection errorCorrectionCodewordCount:level];
+    // The encoder drops EC codewords that are zero, so draw data until none are
+    NSString *data;
+    NSString *ecCodewords;
+    do {
+      unichar dataCodewords[dataLen];
+      for (int i = 0; i < dataLen; i++) {
+        dataCodewords[i] = (unichar)(1 + arc4random() % 899);
+      }
+      data = [NSString stringWithCharacters:dataCodewords length:dataLen];
+      ecCodewords = [ZXPDF417ErrorCorrection generateErrorCorrection:data errorCorrectionLevel:level];
+    } while (ecCodewords.length != numECCodewords);
+
+    int receivedLen = dataLen + numECCodewords;
+    NSMutableArray *expected = [NSMutableArray arrayWithCapacity:receivedLen];
+    for (int i = 0; i < dataLen; i++) {
+      [expected addObject:[NSNumber numberWithInt:[data characterAtIndex:i]]];
+    }
+    for (int i = 0; i < numECCodewords; i++) {
+      [expected addObject:[NSNumber numberWithInt:[ecCodewords characterAtIndex:i]]];
+    }
+    NSMutableArray *corrupted = [NSMutableArray arrayWithArray:expected];
+    [self corrupt:corrupted howMany:numECCodewords / 2];
+
+    NSMutableArray *receivedArray = [NSMutableArray arrayWithArray:corrupted];
+    STAssertTrue([self.ec decode:receivedArray numECCodewords:numECCodewords erasures:[NSArray array]], @"Expected level %d to decode", level);
+    STAssertEqualObjects(receivedArray, expected, @"Expected level %d to be corrected", level);
+
+    int received[receivedLen];
+    for (int i = 0; i < receivedLen; i++) {
+      received[i] = [[corrupted objectAtIndex:i] intValue];
+    }
+    STAssertTrue([self.ec decode:received receivedLen:receivedLen numECCodewords:numECCodewords erasures:NULL erasuresLen:0], @"Expected level %d to decode", level);
+    for (int i = 0; i < receivedLen; i++) {
+      STAssertEquals(received[i], [[expected objectAtIndex:i] intValue], @"Expected level %d codeword %d to be corrected", level, i);
+    }
+
+    // From no errors to one more than can be corrected, the int decoder must give up, or
+    // miscorrect, exactly where the original one does.
+    int maxErrors = numECCodewords / 2;
+    int step = MAX(1, maxErrors / 8);
+    for (int errors = 0; errors <= maxErrors + 1; errors = errors < maxErrors ? MIN(errors + step, maxErrors) : errors + 1) {
+      NSMutableArray *reference = [NSMutableArray arrayWithArray:expected];
+      [self corrupt:reference howMany:errors];
+      for (int i = 0; i < receivedLen; i++) {
+        received[i] = [[reference objectAtIndex:i] intValue];
+      }
+      BOOL referenceDecoded = ReferenceDecode(reference, numECCodewords);
+      BOOL decoded = [self.ec decode:received receivedLen:receivedLen numECCodewords:numECCodewords erasures:NULL erasuresLen:0];
+      STAssertEquals(decoded, referenceDecoded, @"Expected level %d with %d errors to decode as the original did", level, errors);
+      if (decoded && referenceDecoded) {
+        int mismatches = 0;
+        for (int i = 0; i < receivedLen; i++) {
+          mismatches += received[i] != [[reference objectAtIndex:i] intValue] ? 1 : 0;
+        }
+        STAssertEquals(mismatches, 0, @"Expected level %d with %d errors to be corrected as the original did", level, errors);
+      }
+    }
+  }
+}
+
 /*
 - (void)testMaxErasures {
   for (int i = 0; i < PDF417_TEST.count; i++) { // # iterations is kind of arbitrary
@@ -0,0 +1,243 @@
+/*
+ * Copyright 2012 ZXing authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import "ZXBitMatrix.h"
+#import "ZXDecodeHints.h"
+#import "ZXFinderPatternFinder.h"
+#import "ZXFinderPatternFinderTestCase.h"
+#import "ZXFinderPatternInfo.h"
+#import "ZXQRCodeFinderPattern.h"
+#import "ZXQRCodeWriter.h"
+
+@interface ZXFinderPatternFinder (Candidates)
+
+- (int)candidateNearI:(float)i j:(float)j moduleSize:(float)moduleSize;
+- (NSMutableArray *)selectBestPatterns;
+
+@end
+
+/**
+ * Matches and selects candidates the way ZXFinderPatternFinder did before its candidate store:
+ * a scan over every candidate for each hit, and two sorts to pick the best three.
+ */
+@interface ZXLinearFinderPatternFinder : ZXFinderPatternFinder
+
+@end
+
+static NSInteger linearCenterCompare(id center1, id center2, void *context) {
+  float average = [(NSNumber *)context floatValue];
+
+  if ([((ZXQRCodeFinderPattern *)center2) count] == [((ZXQRCodeFinderPattern *)center1) count]) {
+    float dA = fabsf([((ZXQRCodeFinderPattern *)center2) estimatedModuleSize] - average);
+    float dB = fabsf([((ZXQRCodeFinderPattern *)center1) estimatedModuleSize] - average);
+    return dA < dB ? 1 : dA == dB ? 0 : -1;
+  } else {
+    return [((ZXQRCodeFinderPattern *)center2) count] - [((ZXQRCodeFinderPattern *)center1) count];
+  }
+}
+
+static NSInteger linearFurthestFromAverageCompare(id center1, id center2, void *context) {
+  float average = [(NSNumber *)context floatValue];
+
+  float dA = fabsf([((ZXQRCodeFinderPattern *)center2) estimatedModuleSize] - average);
+  float dB = fabsf([((ZXQRCodeFinderPattern *)center1) estimatedModuleSize] - average);
+  return dA < dB ? -1 : dA == dB ? 0 : 1;
+}
+
+@implementation ZXLinearFinderPatternFinder
+
+- (int)candidateNearI:(float)i j:(float)j moduleSize:(float)moduleSize {
+  int max = [self.possibleCenters count];
+  for (int index = 0; index < max; index++) {
+    if ([[self.possibleCenters objectAtIndex:index] aboutEquals:moduleSize i:i j:j]) {
+      return index;
+    }
+  }
+  return -1;
+}
+
+- (NSMutableArray *)selectBestPatterns {
+  NSMutableArray *centers = self.possibleCenters;
+  int startSize = [centers count];
+  if (startSize < 3) {
+    return nil;
+  }
+
+  if (startSize > 3) {
+    float totalModuleSize = 0.0f;
+    float square = 0.0f;
+    for (int i = 0; i < startSize; i++) {
+      float size = [[centers objectAtIndex:i] estimatedModuleSize];
+      totalModuleSize += size;
+      square += size * size;
+    }
+    float average = totalModuleSize / (float)startSize;
+    float stdDev = (float)sqrt(square / startSize - average * average);
+
+    [centers sortUsingFunction:linearFurthestFromAverageCompare context:[NSNumber numberWithFloat:average]];
+
+    float limit = MAX(0.2f * average, stdDev);
+
+    for (int i = 0; i < [centers count] && [centers count] > 3; i++) {
+      ZXQRCodeFinderPattern *pattern = [centers objectAtIndex:i];
+      if (fabsf([pattern estimatedModuleSize] - average) > limit) {
+        [centers removeObjectAtIndex:i];
+        i--;
+      }
+    }
+  }
+
+  if ([centers count] > 3) {
+    float totalModuleSize = 0.0f;
+    for (int i = 0; i < [centers count]; i++) {
+      totalModuleSize += [[centers objectAtIndex:i] estimatedModuleSize];
+    }
+
+    float average = totalModuleSize / (float)[centers count];
+
+    [centers sortUsingFunction:linearCenterCompare context:[NSNumber numberWithFloat:average]];
+  }
+
+  return [NSMutableArray arrayWithObjects:[centers objectAtIndex:0], [centers objectAtIndex:1], [centers objectAtIndex:2], nil];
+}
+
+@end
+
+@interface ZXFinderPatternFinderTestCase ()
+
+- (ZXBitMatrix *)frameWithCode:(BOOL)withCode;
+- (ZXBitMatrix *)clutterFrameWithWidth:(int)width height:(int)height;
+- (void)assertPattern:(ZXQRCodeFinderPattern *)packed equals:(ZXQRCodeFinderPattern *)pixel;
+- (void)assertCandidateStoreMatchesLinearScan:(ZXBitMatrix *)frame tryHarder:(BOOL)tryHarder;
+
+@end
+
+@implementation ZXFinderPatternFinderTestCase
+
+// A frame wider than one word per row, with speckle noise and optionally a code at an unaligned offset
+- (ZXBitMatrix *)frameWithCode:(BOOL)withCode {
+  ZXBitMatrix *frame = [[[ZXBitMatrix alloc] initWithWidth:641 height:480] autorelease];
+  unsigned int seed = 1234567;
+  for (int i = 0; i < 4000; i++) {
+    seed = seed * 1103515245 + 12345;
+    int x = (seed >> 8) % frame.width;
+    seed = seed * 1103515245 + 12345;
+    int y = (seed >> 8) % frame.height;
+    [frame setRegionAtLeft:x top:y width:MIN(3, frame.width - x) height:1];
+  }
+  if (withCode) {
+    ZXQRCodeWriter *writer = [[[ZXQRCodeWriter alloc] init] autorelease];
+    ZXBitMatrix *code = [writer encode:@"http://www.google.com/" format:kBarcodeFormatQRCode width:300 height:300 error:nil];
+    STAssertNotNil(code, @"Code should not be nil");
+    for (int y = 0; y < code.height; y++) {
+      for (int x = 0; x < code.width; x++) {
+        if ([code getX:x y:y] != [frame getX:x + 123 y:y + 77]) {
+          [frame flipX:x + 123 y:y + 77];
+        }
+      }
+    }
+  }
+  return frame;
+}
+
+// Thousands of lone 1:1:3:1:1 bullseyes of varying module size, each one a finder pattern candidate
+- (ZXBitMatrix *)clutterFrameWithWidth:(int)width height:(int)height {
+  ZXBitMatrix *frame = [[[ZXBitMatrix alloc] initWithWidth:width height:height] autorelease];
+  unsigned int seed = 7654321;
+  for (int top = 2; top + 40 < height; top += 36) {
+    for (int left = 2; left + 40 < width; left += 36) {
+      seed = seed * 1103515245 + 12345;
+      int module = 2 + (seed >> 16) % 3;
+      int x = left + (seed >> 8) % 4;
+      int y = top + (seed >> 12) % 4;
+      [frame setRegionAtLeft:x top:y width:7 * module height:module];
+      [frame setRegionAtLeft:x top:y + 6 * module width:7 * module height:module];
+      [frame setRegionAtLeft:x top:y + module width:module height:5 * module];
+      [frame setRegionAtLeft:x + 6 * module top:y + module width:module height:5 * module];
+      [frame setRegionAtLeft:x + 2 * module top:y + 2 * module width:3 * module height:3 * module];
+    }
+  }
+  return frame;
+}
+
+- (void)assertPattern:(ZXQRCodeFinderPattern *)packed equals:(ZXQRCodeFinderPattern *)pixel {
+  STAssertEquals(packed.x, pixel.x, @"Expected x to match the reference scan");
+  STAssertEquals(packed.y, pixel.y, @"Expected y to match the reference scan");
+  STAssertEquals(packed.estimatedModuleSize, pixel.estimatedModuleSize, @"Expected module size to match the reference scan");
+  STAssertEquals(packed.count, pixel.count, @"Expected count to match the reference scan");
+}
+
+- (void)testPackedScanMatchesPixelScan {
+  ZXBitMatrix *frame = [self frameWithCode:YES];
+
+  ZXFinderPatternFinder *pixelFinder = [[[ZXFinderPatternFinder alloc] initWithImage:frame] autorelease];
+  pixelFinder.packedScan = NO;
+  ZXFinderPatternInfo *pixelInfo = [pixelFinder find:nil error:nil];
+  STAssertNotNil(pixelInfo, @"Expected the per-pixel scan to find the code");
+
+  ZXFinderPatternFinder *packedFinder = [[[ZXFinderPatternFinder alloc] initWithImage:frame] autorelease];
+  STAssertTrue(packedFinder.packedScan, @"Expected the packed scan to be the default");
+  ZXFinderPatternInfo *packedInfo = [packedFinder find:nil error:nil];
+  STAssertNotNil(packedInfo, @"Expected the packed scan to find the code");
+
+  [self assertPattern:packedInfo.topLeft equals:pixelInfo.topLeft];
+  [self assertPattern:packedInfo.topRight equals:pixelInfo.topRight];
+  [self assertPattern:packedInfo.bottomLeft equals:pixelInfo.bottomLeft];
+  STAssertEquals([packedFinder.possibleCenters count], [pixelFinder.possibleCenters count],
+                 @"Expected both scans to consider the same candidates");
+}
+
+- (void)testPackedScanWithoutCode {
+  ZXBitMatrix *frame = [self frameWithCode:NO];
+
+  ZXFinderPatternFinder *pixelFinder = [[[ZXFinderPatternFinder alloc] initWithImage:frame] autorelease];
+  pixelFinder.packedScan = NO;
+  ZXFinderPatternFinder *packedFinder = [[[ZXFinderPatternFinder alloc] initWithImage:frame] autorelease];
+
+  STAssertNil([packedFinder find:nil error:nil], @"Expected no finder patterns in noise");
+  STAssertNil([pixelFinder find:nil error:nil], @"Expected no finder patterns in noise");
+  STAssertEquals([packedFinder.possibleCenters count], [pixelFinder.possibleCenters count],
+                 @"Expected both scans to consider the same candidates");
+}
+
+- (void)assertCandidateStoreMatchesLinearScan:(ZXBitMatrix *)frame tryHarder:(BOOL)tryHarder {
+  ZXDecodeHints *hints = [ZXDecodeHints hints];
+  hints.tryHarder = tryHarder;
+
+  ZXFinderPatternFinder *linearFinder = [[[ZXLinearFinderPatternFinder alloc] initWithImage:frame] autorelease];
+  ZXFinderPatternInfo *linearInfo = [linearFinder find:hints error:nil];
+  ZXFinderPatternFinder *finder = [[[ZXFinderPatternFinder alloc] initWithImage:frame] autorelease];
+  ZXFinderPatternInfo *info = [finder find:hints error:nil];
+
+  STAssertNotNil(linearInfo, @"Expected the linear scan to pick three bullseyes");
+  STAssertNotNil(info, @"Expected the candidate store to pick three bullseyes");
+  [self assertPattern:info.topLeft equals:linearInfo.topLeft];
+  [self assertPattern:info.topRight equals:linearInfo.topRight];
+  [self assertPattern:info.bottomLeft equals:linearInfo.bottomLeft];
+}
+
+- (void)testCandidateStoreMatchesLinearScan {
+  [self assertCandidateStoreMatchesLinearScan:[self clutterFrameWithWidth:800 height:600] tryHarder:NO];
+  [self assertCandidateStoreMatchesLinearScan:[self clutterFrameWithWidth:800 height:600] tryHarder:YES];
+  [self assertCandidateStoreMatchesLinearScan:[self frameWithCode:YES] tryHarder:YES];
+}
+
+// The high clutter frame the candidate store was built for, where the linear scan is quadratic
+- (void)testHighClutterMatchesLinearScan {
+  [self assertCandidateStoreMatchesLinearScan:[self clutterFrameWithWidth:1920 height:1440] tryHarder:YES];
+}
+
+@end
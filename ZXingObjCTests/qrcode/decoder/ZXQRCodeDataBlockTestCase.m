@@ -0,0 +1,144 @@
+/*
+ * Copyright 2012 ZXing authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import "ZXErrorCorrectionLevel.h"
+#import "ZXQRCodeDataBlock.h"
+#import "ZXQRCodeDataBlockTestCase.h"
+#import "ZXQRCodeVersion.h"
+
+/**
+ * The NSArray implementation dataBlocks: used to ship with, kept as the reference layout that
+ * dataBlockBytes: must reproduce codeword for codeword.
+ */
+static NSArray *ReferenceDataBlocks(const uint8_t *rawCodewords, ZXQRCodeVersion *version, ZXErrorCorrectionLevel *ecLevel) {
+  ZXQRCodeECBlocks *ecBlocks = [version ecBlocksForLevel:ecLevel];
+
+  NSMutableArray *result = [NSMutableArray arrayWithCapacity:ecBlocks.numBlocks];
+  for (ZXQRCodeECB *ecBlock in ecBlocks.ecBlocks) {
+    for (int i = 0; i < ecBlock.count; i++) {
+      int numDataCodewords = ecBlock.dataCodewords;
+      int numBlockCodewords = ecBlocks.ecCodewordsPerBlock + numDataCodewords;
+      NSMutableArray *codewords = [NSMutableArray arrayWithCapacity:numBlockCodewords];
+      for (int j = 0; j < numBlockCodewords; j++) {
+        [codewords addObject:[NSNumber numberWithInt:0]];
+      }
+      [result addObject:[[[ZXQRCodeDataBlock alloc] initWithNumDataCodewords:numDataCodewords codewords:codewords] autorelease]];
+    }
+  }
+
+  int shorterBlocksTotalCodewords = (int)[[[result objectAtIndex:0] codewords] count];
+  int longerBlocksStartAt = (int)[result count] - 1;
+  while (longerBlocksStartAt >= 0) {
+    int numCodewords = (int)[[[result objectAtIndex:longerBlocksStartAt] codewords] count];
+    if (numCodewords == shorterBlocksTotalCodewords) {
+      break;
+    }
+    longerBlocksStartAt--;
+  }
+  longerBlocksStartAt++;
+
+  int shorterBlocksNumDataCodewords = shorterBlocksTotalCodewords - ecBlocks.ecCodewordsPerBlock;
+  int rawCodewordsOffset = 0;
+  int numResultBlocks = (int)[result count];
+  for (int i = 0; i < shorterBlocksNumDataCodewords; i++) {
+    for (int j = 0; j < numResultBlocks; j++) {
+      [[[result objectAtIndex:j] codewords] replaceObjectAtIndex:i
+                                                      withObject:[NSNumber numberWithInt:rawCodewords[rawCodewordsOffset++]]];
+    }
+  }
+
+  for (int j = longerBlocksStartAt; j < numResultBlocks; j++) {
+    [[[result objectAtIndex:j] codewords] replaceObjectAtIndex:shorterBlocksNumDataCodewords
+                                                    withObject:[NSNumber numberWithInt:rawCodewords[rawCodewordsOffset++]]];
+  }
+
+  int max = (int)[[[result objectAtIndex:0] codewords] count];
+  for (int i = shorterBlocksNumDataCodewords; i < max; i++) {
+    for (int j = 0; j < numResultBlocks; j++) {
+      int iOffset = j < longerBlocksStartAt ? i : i + 1;
+      [[[result objectAtIndex:j] codewords] replaceObjectAtIndex:iOffset
+                                                      withObject:[NSNumber numberWithInt:rawCodewords[rawCodewordsOffset++]]];
+    }
+  }
+  return result;
+}
+
+@implementation ZXQRCodeDataBlockTestCase
+
+- (void)testDataBlocksInterleaving {
+  // Version 5-Q has two blocks of 15 data codewords followed by two of 16
+  ZXQRCodeVersion *version = [ZXQRCodeVersion versionForNumber:5];
+  ZXErrorCorrectionLevel *ecLevel = [ZXErrorCorrectionLevel errorCorrectionLevelQ];
+  int totalCodewords = version.totalCodewords;
+  uint8_t rawCodewords[totalCodewords];
+  for (int i = 0; i < totalCodewords; i++) {
+    rawCodewords[i] = (uint8_t)i;
+  }
+
+  uint8_t blockCodewords[totalCodewords];
+  int numCodewords[4];
+  int numDataCodewords[4];
+  int numBlocks = [ZXQRCodeDataBlock dataBlockBytes:rawCodewords version:version ecLevel:ecLevel
+                                     blockCodewords:blockCodewords numCodewords:numCodewords numDataCodewords:numDataCodewords];
+  STAssertEquals(numBlocks, 4, @"Expected 4 blocks");
+  STAssertEquals(numDataCodewords[0], 15, @"Expected 15 data codewords");
+  STAssertEquals(numDataCodewords[3], 16, @"Expected 16 data codewords");
+  STAssertEquals(numCodewords[3] - numDataCodewords[3], numCodewords[0] - numDataCodewords[0], @"Expected equal EC lengths");
+
+  // Data codewords are dealt out round-robin, the extra one only to the longer blocks
+  int offset = numCodewords[0] + numCodewords[1] + numCodewords[2];
+  STAssertEquals((int)blockCodewords[0], 0, @"Expected first codeword in block 0");
+  STAssertEquals((int)blockCodewords[numCodewords[0]], 1, @"Expected second codeword in block 1");
+  STAssertEquals((int)blockCodewords[offset + 14], 14 * 4 + 3, @"Expected interleaved codeword");
+  STAssertEquals((int)blockCodewords[offset + 15], 15 * 4 + 1, @"Expected extra codeword of the last block");
+  STAssertEquals((int)blockCodewords[numCodewords[0] - 1], (totalCodewords - 4) & 0xFF, @"Expected last EC codeword of block 0");
+}
+
+- (void)testDataBlockBytesMatchesReference {
+  for (int versionNumber = 1; versionNumber <= 40; versionNumber++) {
+    ZXQRCodeVersion *version = [ZXQRCodeVersion versionForNumber:versionNumber];
+    for (int bits = 0; bits < 4; bits++) {
+      ZXErrorCorrectionLevel *ecLevel = [ZXErrorCorrectionLevel forBits:bits];
+      int totalCodewords = version.totalCodewords;
+      uint8_t rawCodewords[totalCodewords];
+      for (int i = 0; i < totalCodewords; i++) {
+        rawCodewords[i] = (uint8_t)(i * 7 + versionNumber);
+      }
+
+      int maxBlocks = [version ecBlocksForLevel:ecLevel].numBlocks;
+      uint8_t blockCodewords[totalCodewords];
+      int numCodewords[maxBlocks];
+      int numDataCodewords[maxBlocks];
+      int numBlocks = [ZXQRCodeDataBlock dataBlockBytes:rawCodewords version:version ecLevel:ecLevel
+                                         blockCodewords:blockCodewords numCodewords:numCodewords numDataCodewords:numDataCodewords];
+      NSArray *dataBlocks = ReferenceDataBlocks(rawCodewords, version, ecLevel);
+      STAssertEquals(numBlocks, (int)[dataBlocks count], @"Block counts differ for version %d", versionNumber);
+
+      int offset = 0;
+      for (int i = 0; i < numBlocks; i++) {
+        ZXQRCodeDataBlock *dataBlock = [dataBlocks objectAtIndex:i];
+        STAssertEquals(numDataCodewords[i], dataBlock.numDataCodewords, @"Data codewords differ for version %d", versionNumber);
+        STAssertEquals(numCodewords[i], (int)[dataBlock.codewords count], @"Codewords differ for version %d", versionNumber);
+        for (int j = 0; j < numCodewords[i]; j++) {
+          STAssertEquals((int)blockCodewords[offset++], [[dataBlock.codewords objectAtIndex:j] intValue],
+                         @"Codeword %d of block %d differs for version %d", j, i, versionNumber);
+        }
+      }
+    }
+  }
+}
+
+@end
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#import "ZXBitMatrix.h"
 #import "ZXErrorCorrectionLevel.h"
 #import "ZXQRCodeVersion.h"
 #import "ZXQRCodeVersionTestCase.h"
@@ -62,6 +63,25 @@
   }
 }
 
+- (void)testDataModulePositions {
+  for (int number = 1; number <= 40; number++) {
+    ZXQRCodeVersion *version = [ZXQRCodeVersion versionForNumber:number];
+    ZXBitMatrix *functionPattern = [version buildFunctionPattern];
+    int dimension = version.dimensionForVersion;
+    int count;
+    const int *positions = [version dataModulePositions:&count];
+    STAssertEquals(count >> 3, version.totalCodewords, @"Expected the data modules of version %d to hold its codewords", number);
+    STAssertEquals([version dataModulePositions:&count], positions, @"Expected the table of version %d to be shared", number);
+
+    // The first module read is always the bottom right one
+    STAssertEquals(positions[0], ((dimension - 1) << 16) | (dimension - 1), @"Expected version %d to start bottom right", number);
+    for (int i = 0; i < count; i++) {
+      STAssertFalse([functionPattern getX:positions[i] & 0xFFFF y:positions[i] >> 16],
+                    @"Expected version %d to skip function patterns", number);
+    }
+  }
+}
+
 - (void)testDecodeVersionInformation {
   // Spot check
   [self doTestVersion:7 mask:0x07C94];
@@ -15,11 +15,14 @@
  */
 
 #import "ZXBitArray.h"
+#import "ZXByteMatrix.h"
 #import "ZXEncodeHints.h"
 #import "ZXEncoder.h"
 #import "ZXEncoderTestCase.h"
 #import "ZXErrorCorrectionLevel.h"
 #import "ZXErrors.h"
+#import "ZXMaskUtil.h"
+#import "ZXMatrixUtil.h"
 #import "ZXMode.h"
 #import "ZXQRCode.h"
 #import "ZXQRCodeVersion.h"
@@ -521,6 +524,42 @@
   STAssertEqualObjects([bits description], expected, @"Expected bits to equal %@", expected);
 }
 
+- (void)testChooseMaskPattern {
+  // Versions below and above the concurrent threshold, with and without version information.
+  int versions[] = {1, 2, 7, 10, 27, 40};
+  NSArray *ecLevels = [NSArray arrayWithObjects:[ZXErrorCorrectionLevel errorCorrectionLevelL],
+                       [ZXErrorCorrectionLevel errorCorrectionLevelH], nil];
+  srand(0x5EED);
+  for (int v = 0; v < sizeof(versions) / sizeof(int); v++) {
+    ZXQRCodeVersion *version = [ZXQRCodeVersion versionForNumber:versions[v]];
+    int dimension = version.dimensionForVersion;
+    for (ZXErrorCorrectionLevel *ecLevel in ecLevels) {
+      ZXBitArray *bits = [[[ZXBitArray alloc] init] autorelease];
+      for (int i = 0; i < version.totalCodewords; i++) {
+        [bits appendBits:rand() & 0xFF numBits:8];
+      }
+
+      // Build and score every mask in full, as the encoder used to.
+      ZXByteMatrix *matrix = [[[ZXByteMatrix alloc] initWithWidth:dimension height:dimension] autorelease];
+      int minPenalty = NSIntegerMax;
+      int expected = -1;
+      for (int maskPattern = 0; maskPattern < 8; maskPattern++) {
+        STAssertTrue([ZXMatrixUtil buildMatrix:bits ecLevel:ecLevel version:version maskPattern:maskPattern matrix:matrix error:nil],
+                     @"Expected version %d to build", versions[v]);
+        int penalty = [ZXMaskUtil applyMaskPenaltyRule1:matrix] + [ZXMaskUtil applyMaskPenaltyRule2:matrix] +
+          [ZXMaskUtil applyMaskPenaltyRule3:matrix] + [ZXMaskUtil applyMaskPenaltyRule4:matrix];
+        if (penalty < minPenalty) {
+          minPenalty = penalty;
+          expected = maskPattern;
+        }
+      }
+
+      int maskPattern = [ZXEncoder chooseMaskPattern:bits ecLevel:ecLevel version:version matrix:matrix error:nil];
+      STAssertEquals(maskPattern, expected, @"Expected mask %d for version %d-%@", expected, versions[v], ecLevel);
+    }
+  }
+}
+
 // Numbers are from http://www.swetake.com/qr/qr3.html and
 // http://www.swetake.com/qr/qr9.html
 - (void)testGenerateECBytes {
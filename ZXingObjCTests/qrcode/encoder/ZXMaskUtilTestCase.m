@@ -275,4 +275,54 @@ BOOL TestGetDataMaskBitInternal(int maskPattern, int *expected) {
   STAssertTrue(TestGetDataMaskBitInternal(7, (int *)mask7), @"Expected TestGetDataMaskBitInternal to return YES");
 }
 
+- (void)testPackedMaskPenalty {
+  int dimensions[] = {5, 21, 57, 63, 64, 65, 129, 177};
+  srand(0x5EED);
+  for (int d = 0; d < sizeof(dimensions) / sizeof(int); d++) {
+    int dimension = dimensions[d];
+    int words = (dimension + 63) / 64;
+    uint64_t rows[dimension * words];
+    uint64_t columns[dimension * words];
+    for (int trial = 0; trial < 4; trial++) {
+      // Mix noise with masked stripes so every rule has something to find.
+      ZXByteMatrix *matrix = [[[ZXByteMatrix alloc] initWithWidth:dimension height:dimension] autorelease];
+      memset(rows, 0, sizeof(rows));
+      memset(columns, 0, sizeof(columns));
+      for (int y = 0; y < dimension; y++) {
+        for (int x = 0; x < dimension; x++) {
+          BOOL bit = trial == 0 ? rand() % 2 == 0 : [ZXMaskUtil dataMaskBit:trial x:x y:y] != (rand() % 10 == 0);
+          [matrix setX:x y:y boolValue:bit];
+          if (bit) {
+            rows[y * words + x / 64] |= 1ULL << (x % 64);
+            columns[x * words + y / 64] |= 1ULL << (y % 64);
+          }
+        }
+      }
+      int expected = [ZXMaskUtil applyMaskPenaltyRule1:matrix] + [ZXMaskUtil applyMaskPenaltyRule2:matrix] +
+        [ZXMaskUtil applyMaskPenaltyRule3:matrix] + [ZXMaskUtil applyMaskPenaltyRule4:matrix];
+      STAssertEquals([ZXMaskUtil packedMaskPenalty:rows columns:columns dimension:dimension], expected,
+                     @"Expected the packed penalty to match the rules at dimension %d", dimension);
+    }
+  }
+}
+
+- (void)testPackDataMask {
+  const int dimension = 70;
+  const int words = 2;
+  uint64_t rows[dimension * words];
+  uint64_t columns[dimension * words];
+  for (int maskPattern = 0; maskPattern < 8; maskPattern++) {
+    [ZXMaskUtil packDataMask:maskPattern dimension:dimension rows:rows columns:columns];
+    for (int y = 0; y < dimension; y++) {
+      for (int x = 0; x < dimension; x++) {
+        BOOL expected = [ZXMaskUtil dataMaskBit:maskPattern x:x y:y];
+        STAssertEquals((BOOL)((rows[y * words + x / 64] >> (x % 64)) & 1), expected,
+                       @"Expected row bit (%d,%d) of mask %d to match", x, y, maskPattern);
+        STAssertEquals((BOOL)((columns[x * words + y / 64] >> (y % 64)) & 1), expected,
+                       @"Expected column bit (%d,%d) of mask %d to match", x, y, maskPattern);
+      }
+    }
+  }
+}
+
 @end